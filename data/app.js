@@ -22,12 +22,20 @@ async function loadStatus() {
         document.getElementById('current-image').textContent = data.image || 'Ninguna';
         document.getElementById('current-column').textContent = data.column || 0;
         document.getElementById('total-columns').textContent = data.totalColumns || 0;
+        document.getElementById('frame-info').style.display = data.frames > 1 ? 'block' : 'none';
+        document.getElementById('current-frame').textContent = (data.frame || 0) + 1;
+        document.getElementById('total-frames').textContent = data.frames || 0;
         document.getElementById('speed-value').textContent = data.speed;
+        if (data.maxSpeed) {
+            document.getElementById('speed-slider').max = data.maxSpeed;
+        }
         document.getElementById('speed-slider').value = data.speed;
         document.getElementById('brightness-value').textContent = data.brightness;
         document.getElementById('brightness-slider').value = data.brightness;
         document.getElementById('loop-checkbox').checked = data.loopMode;
         document.getElementById('orientation-select').value = data.orientation;
+        document.getElementById('resample-select').value = data.resample;
+        document.getElementById('timing-select').value = data.timing;
         document.getElementById('wifi-ssid').textContent = data.wifiSSID || 'No conectado';
         document.getElementById('ip').textContent = data.wifiIP || '-';
         document.getElementById('space').textContent = Math.round(data.freeSpace / 1024);
@@ -56,7 +64,11 @@ async function loadImages() {
             const card = document.createElement('div');
             card.className = 'image-card';
 
+            // Miniatura con el hash en la URL: el navegador no la vuelve a pedir
+            const thumb = `/api/image/thumb?image=${encodeURIComponent(img.name)}&v=${img.hash || ''}`;
+
             card.innerHTML = `
+                <img class="image-thumb" src="${thumb}" alt="${img.name}" loading="lazy">
                 <h3>${img.name}</h3>
                 <div class="image-info">Dimensiones: ${img.width}x${img.height}</div>
                 <div class="image-info">Tamaño: ${Math.round(img.size / 1024)} KB</div>
@@ -217,6 +229,40 @@ async function updateOrientation(value) {
     }
 }
 
+// Actualizar modo de escalado
+async function updateResample(value) {
+    try {
+        const formData = new FormData();
+        formData.append('resample', value);
+
+        await fetch('/api/settings', {
+            method: 'POST',
+            body: formData
+        });
+
+        console.log('Escalado actualizado a:', value);
+    } catch (error) {
+        console.error('Error:', error);
+    }
+}
+
+// Actualizar modo de sincronía de columnas
+async function updateTiming(value) {
+    try {
+        const formData = new FormData();
+        formData.append('timing', value);
+
+        await fetch('/api/settings', {
+            method: 'POST',
+            body: formData
+        });
+
+        console.log('Sincronía actualizada a:', value);
+    } catch (error) {
+        console.error('Error:', error);
+    }
+}
+
 // Eliminar imagen
 async function deleteImage(imageName) {
     if (!confirm('¿Estás seguro de que quieres eliminar ' + imageName + '?')) {
@@ -278,12 +324,12 @@ async function uploadFile(file) {
     }
 
     // Validar extensión
-    const validExtensions = ['.bmp', '.rgb', '.565'];
+    const validExtensions = ['.bmp', '.png', '.rgb', '.565', '.pov'];
     const fileName = file.name.toLowerCase();
     const isValid = validExtensions.some(ext => fileName.endsWith(ext));
 
     if (!isValid) {
-        alert('Formato de archivo no soportado. Usa BMP, RGB o 565');
+        alert('Formato de archivo no soportado. Usa BMP, PNG, RGB o 565');
         return;
     }
 
@@ -308,14 +354,17 @@ async function uploadFile(file) {
 
         const data = await response.json();
 
-        if (data.success) {
+        // El ESP32 convierte y guarda la imagen después de responder (202)
+        if (data.success && (!data.pending || await waitForUpload(statusText))) {
             statusText.textContent = 'Archivo subido correctamente';
             setTimeout(() => {
                 progressDiv.style.display = 'none';
                 loadImages();
             }, 2000);
         } else {
-            statusText.textContent = 'Error al subir archivo';
+            statusText.textContent = response.status === 409
+                ? 'Hay otra subida en proceso, inténtalo de nuevo'
+                : 'Error al subir archivo';
         }
 
     } catch (error) {
@@ -324,6 +373,27 @@ async function uploadFile(file) {
     }
 }
 
+// Espera a que el dispositivo termine de guardar la subida: true si quedó guardada
+async function waitForUpload(statusText) {
+    statusText.textContent = 'Procesando...';
+    for (let i = 0; i < 120; i++) {
+        await new Promise(resolve => setTimeout(resolve, 250));
+        try {
+            const response = await fetch('/api/upload/status');
+            const data = await response.json();
+            if (data.state === 'done') {
+                return true;
+            }
+            if (data.state !== 'processing') {
+                return false;
+            }
+        } catch (error) {
+            console.error('Error:', error);
+        }
+    }
+    return false;
+}
+
 // Efectos
 async function setEffect(effectName) {
     currentEffect = effectName;
@@ -0,0 +1,382 @@
+#!/usr/bin/env python3
+"""Convierte imágenes al formato nativo .pov (column-major) del firmware.
+
+Uso:
+    python3 scripts/pov_convert.py logo.png -o logo.pov --height 144
+    python3 scripts/pov_convert.py logo.bmp --format rgb565 --stats
+    python3 scripts/pov_convert.py logo.bmp --bench
+    python3 scripts/pov_convert.py texto.bmp --format indexed --stats
+    python3 scripts/pov_convert.py logo.gif --height 144 --format indexed
+    python3 scripts/pov_convert.py f1.bmp f2.bmp f3.bmp --delay 200 -o anim.pov
+
+Varias imágenes de entrada (del mismo tamaño) o un GIF/PNG animado generan un
+.pov animado: el firmware pasa al siguiente fotograma al terminar un barrido
+una vez vencido el retardo del actual. Los BMP de 1, 2, 4, 8 y 24 bits se leen sin dependencias; el resto de formatos
+(PNG, GIF, JPEG...) necesitan Pillow (pip install pillow).
+
+Formato (little-endian), ver POVHeader en src/image_parser.h:
+    header    "POV1", version, pixelFormat, width, height, flags, tableOffset
+    paleta    solo indexado: 2^bits entradas R, G, B
+    frames    solo con flags & 1 (animado): uint16 frameCount y un retardo
+              uint16 en ms por fotograma
+    tabla     width * frameCount + 1 offsets uint32; la columna i ocupa
+              [off[i], off[i+1]) y el fotograma f las columnas f * width...
+    columnas  1 byte de codificación + datos: 0 = raw, 1 = RLE, 2 = igual que la
+              anterior (sin datos), 3 = RLE del XOR con la anterior; las columnas
+              múltiplo de 16 (POV_KEYFRAME_INTERVAL) son siempre raw o RLE
+"""
+
+import argparse
+import os
+import struct
+import sys
+import tempfile
+import time
+from pathlib import Path
+
+POV_MAGIC = b"POV1"
+POV_FORMAT_VERSION = 1
+POV_HEADER = struct.Struct("<4sBBHHHI")
+
+PIXEL_RGB888 = 0
+PIXEL_RGB565 = 1
+PIXEL_INDEXED1 = 2  # 1, 2, 4 y 8 bits por índice
+PIXEL_INDEXED8 = 5
+
+COLUMN_RAW = 0
+COLUMN_RLE = 1
+COLUMN_REPEAT = 2
+COLUMN_DELTA = 3
+COLUMN_NAMES = {COLUMN_RAW: "raw", COLUMN_RLE: "RLE", COLUMN_REPEAT: "repetidas", COLUMN_DELTA: "delta"}
+KEYFRAME_INTERVAL = 16
+FLAG_ANIMATED = 0x0001
+MAX_FRAMES = 64  # MAX_ANIMATION_FRAMES en src/config.h
+DEFAULT_DELAY_MS = 100
+
+
+def index_bits(pixel_format):
+    """Bits por índice de un formato indexado (0 si no lo es)."""
+    if PIXEL_INDEXED1 <= pixel_format <= PIXEL_INDEXED8:
+        return 1 << (pixel_format - PIXEL_INDEXED1)
+    return 0
+
+
+def read_bmp(path):
+    """Lee un BMP sin comprimir de 1/2/4/8/24 bits; devuelve (width, height, filas RGB)."""
+    data = Path(path).read_bytes()
+    if data[:2] != b"BM":
+        raise ValueError("no es un BMP")
+    data_offset = struct.unpack_from("<I", data, 10)[0]
+    header_size, width, height, _, bpp, compression = struct.unpack_from("<IiiHHI", data, 14)
+    colors_used = struct.unpack_from("<I", data, 46)[0]
+    if bpp not in (1, 2, 4, 8, 24) or compression != 0:
+        raise ValueError("solo BMP de 1, 2, 4, 8 o 24 bits sin comprimir")
+
+    palette = []
+    if bpp <= 8:
+        count = colors_used if 0 < colors_used <= (1 << bpp) else (1 << bpp)
+        start = 14 + header_size
+        palette = [(data[start + i * 4 + 2], data[start + i * 4 + 1], data[start + i * 4])
+                   for i in range(count)]
+
+    top_down = height < 0
+    width, height = abs(width), abs(height)
+    row_size = ((bpp * width + 31) // 32) * 4
+    rows = []
+    for y in range(height):
+        file_y = y if top_down else height - 1 - y
+        start = data_offset + file_y * row_size
+        if bpp == 24:
+            row = [(data[start + x * 3 + 2], data[start + x * 3 + 1], data[start + x * 3])
+                   for x in range(width)]
+        else:
+            row = []
+            for x in range(width):
+                byte = data[start + (x * bpp) // 8]
+                index = (byte >> (8 - bpp - (x * bpp) % 8)) & ((1 << bpp) - 1)
+                row.append(palette[index] if index < len(palette) else (0, 0, 0))
+        rows.append(row)
+    return width, height, rows
+
+
+def build_palette(rows):
+    """Paleta en orden de aparición; devuelve (pixelFormat indexado, {rgb: índice}).
+    En animaciones, 'rows' son las filas de todos los fotogramas."""
+    palette = {}
+    for row in rows:
+        for rgb in row:
+            if rgb not in palette:
+                if len(palette) == 256:
+                    sys.exit("Error: más de 256 colores, no se puede usar formato indexado")
+                palette[rgb] = len(palette)
+    bits = next(b for b in (1, 2, 4, 8) if len(palette) <= (1 << b))
+    return PIXEL_INDEXED1 + (1, 2, 4, 8).index(bits), palette
+
+
+def image_rows(image, height=None):
+    """Filas RGB de una imagen de Pillow, escalada a 'height' si se pide."""
+    from PIL import Image
+    image = image.convert("RGB")
+    if height is not None and image.height != height:
+        width = max(1, round(image.width * height / image.height))
+        image = image.resize((width, height), Image.LANCZOS)
+    pixels = image.load()
+    rows = [[pixels[x, y] for x in range(image.width)] for y in range(image.height)]
+    return image.width, image.height, rows
+
+
+def read_frames(path, height=None):
+    """Devuelve (width, height, [filas RGB por fotograma], [retardos ms]); un
+    GIF/PNG animado da un fotograma por imagen, con su duración."""
+    if height is None and str(path).lower().endswith(".bmp"):
+        try:
+            width, height, rows = read_bmp(path)
+            return width, height, [rows], [DEFAULT_DELAY_MS]
+        except ValueError:
+            pass
+
+    try:
+        from PIL import Image, ImageSequence
+    except ImportError:
+        sys.exit("Error: se necesita Pillow para este archivo (pip install pillow)")
+
+    image = Image.open(path)
+    frames = []
+    delays = []
+    for frame in ImageSequence.Iterator(image):
+        width, frame_height, rows = image_rows(frame, height)
+        frames.append(rows)
+        delays.append(frame.info.get("duration", DEFAULT_DELAY_MS))
+    return width, frame_height, frames, delays
+
+
+def pack_pixel(rgb, pixel_format):
+    r, g, b = rgb
+    if pixel_format == PIXEL_RGB565:
+        return struct.pack("<H", ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3))
+    return bytes((r, g, b))
+
+
+def encode_rle(pixels):
+    out = bytearray()
+    i = 0
+    while i < len(pixels):
+        run = 1
+        while i + run < len(pixels) and run < 255 and pixels[i + run] == pixels[i]:
+            run += 1
+        out.append(run)
+        out += pixels[i]
+        i += run
+    return bytes(out)
+
+
+def pack_indices(indices, bits):
+    """Empaqueta índices con el bit más alto primero, como las filas BMP."""
+    out = bytearray()
+    per_byte = 8 // bits
+    for i in range(0, len(indices), per_byte):
+        byte = 0
+        for j, index in enumerate(indices[i:i + per_byte]):
+            byte |= index << (8 - bits * (j + 1))
+        out.append(byte)
+    return bytes(out)
+
+
+def column_pixels(column, pixel_format, palette=None):
+    """Píxeles de archivo de una columna; en RLE indexado, un índice por byte."""
+    if index_bits(pixel_format):
+        return [bytes((palette[rgb],)) for rgb in column]
+    return [pack_pixel(rgb, pixel_format) for rgb in column]
+
+
+def encode_column(pixels, previous, pixel_format, allow_rle):
+    """Misma elección que povEncodeColumn (src/pov_codec.h); previous es None
+    en las columnas clave o sin delta."""
+    if previous is not None and pixels == previous:
+        return bytes([COLUMN_REPEAT])
+    bits = index_bits(pixel_format)
+    if bits:
+        raw = bytes([COLUMN_RAW]) + pack_indices([p[0] for p in pixels], bits)
+    else:
+        raw = bytes([COLUMN_RAW]) + b"".join(pixels)
+    if not allow_rle:
+        return raw
+    rle = bytes([COLUMN_RLE]) + encode_rle(pixels)
+    if previous is not None:
+        xor = [bytes(a ^ b for a, b in zip(p, q)) for p, q in zip(pixels, previous)]
+        delta = bytes([COLUMN_DELTA]) + encode_rle(xor)
+        if len(delta) < len(rle) and len(delta) < len(raw):
+            return delta
+    return rle if len(rle) < len(raw) else raw
+
+
+def build_pov(width, height, rows, pixel_format=PIXEL_RGB888, allow_rle=True, allow_delta=True,
+              frames=None, delays=None):
+    """Con un formato indexado se elige la profundidad mínima para los colores.
+    Con 'frames' (lista de filas por fotograma) y 'delays' (ms) se genera una
+    animación; 'rows' se ignora."""
+    frames = frames if frames is not None else [rows]
+    animated = len(frames) > 1
+    palette = None
+    palette_bytes = b""
+    if index_bits(pixel_format):
+        pixel_format, palette = build_palette([row for frame in frames for row in frame])
+        entries = sorted(palette, key=palette.get)
+        entries += [(0, 0, 0)] * ((1 << index_bits(pixel_format)) - len(entries))
+        palette_bytes = b"".join(bytes(rgb) for rgb in entries)
+
+    frame_bytes = b""
+    if animated:
+        delays = delays or [DEFAULT_DELAY_MS] * len(frames)
+        frame_bytes = struct.pack("<%dH" % (len(frames) + 1), len(frames),
+                                  *(min(max(int(d), 0), 0xFFFF) for d in delays))
+
+    # Los fotogramas van seguidos: la columna x del fotograma f es la f * width + x
+    columns = []
+    previous = None
+    for frame in frames:
+        for x in range(width):
+            pixels = column_pixels([frame[y][x] for y in range(height)], pixel_format, palette)
+            keyframe = len(columns) % KEYFRAME_INTERVAL == 0
+            columns.append(encode_column(pixels, None if keyframe or not allow_delta else previous,
+                                         pixel_format, allow_rle))
+            previous = pixels
+
+    table_offset = POV_HEADER.size + len(palette_bytes) + len(frame_bytes)
+    offset = table_offset + (len(columns) + 1) * 4
+    offsets = []
+    for column in columns:
+        offsets.append(offset)
+        offset += len(column)
+    offsets.append(offset)
+
+    header = POV_HEADER.pack(POV_MAGIC, POV_FORMAT_VERSION, pixel_format,
+                             width, height, FLAG_ANIMATED if animated else 0, table_offset)
+    table = struct.pack("<%dI" % len(offsets), *offsets)
+    return header + palette_bytes + frame_bytes + table + b"".join(columns), columns, pixel_format
+
+
+def print_stats(width, height, columns, pixel_format):
+    """'columns' incluye las de todos los fotogramas."""
+    bits = index_bits(pixel_format) or (16 if pixel_format == PIXEL_RGB565 else 24)
+    frames = len(columns) // width
+    raw_total = len(columns) * (1 + (height * bits + 7) // 8)
+    total = sum(len(c) for c in columns)
+    counts = [sum(1 for c in columns if c[0] == encoding) for encoding in sorted(COLUMN_NAMES)]
+    if frames > 1:
+        print("Fotogramas: %d" % frames)
+    print("Columnas: %d (%s)" % (len(columns), ", ".join("%d %s" % (n, COLUMN_NAMES[e])
+                                                          for e, n in zip(sorted(COLUMN_NAMES), counts))))
+    print("Datos de columnas: %d bytes (%.1f%% de raw)" % (total, 100.0 * total / raw_total))
+    print("Columna mayor: %d bytes" % max(len(c) for c in columns))
+    print("Bits por píxel: %d (%.1fx menos que RGB888 sin comprimir)" %
+          (bits, len(columns) * height * 3.0 / total))
+
+
+def read_columns_bmp(path, width, height):
+    """Patrón de acceso de ImageParser::getColumnBMP: un seek + read por píxel."""
+    ops = 0
+    with open(path, "rb") as f:
+        header = f.read(54)
+        data_offset = struct.unpack_from("<I", header, 10)[0]
+        row_size = (width * 3 + 3) & ~3
+        for x in range(width):
+            f.seek(0)
+            f.read(54)
+            for y in range(height):
+                f.seek(data_offset + (height - 1 - y) * row_size + x * 3)
+                f.read(3)
+                ops += 1
+    return ops
+
+
+def read_columns_pov(path, width):
+    """Patrón de acceso de ImageParser::getColumnPOV: un seek + read por columna."""
+    ops = 0
+    with open(path, "rb") as f:
+        header = POV_HEADER.unpack(f.read(POV_HEADER.size))
+        f.seek(header[6])
+        offsets = struct.unpack("<%dI" % (width + 1), f.read((width + 1) * 4))
+        for x in range(width):
+            f.seek(offsets[x])
+            f.read(offsets[x + 1] - offsets[x])
+            ops += 1
+    return ops
+
+
+def bench(bmp_path, pov_bytes, width, height, repeat=5):
+    with tempfile.NamedTemporaryFile(suffix=".pov", delete=False) as tmp:
+        tmp.write(pov_bytes)
+        pov_path = tmp.name
+    try:
+        results = []
+        for name, reader in (("BMP", lambda: read_columns_bmp(bmp_path, width, height)),
+                             ("POV", lambda: read_columns_pov(pov_path, width))):
+            best = None
+            for _ in range(repeat):
+                start = time.perf_counter()
+                ops = reader()
+                elapsed = time.perf_counter() - start
+                best = elapsed if best is None else min(best, elapsed)
+            results.append((name, ops, best))
+        for name, ops, best in results:
+            print("%s: %d lecturas, %.2f ms por imagen completa" % (name, ops, best * 1000))
+        print("Aceleración: %.1fx" % (results[0][2] / results[1][2]))
+    finally:
+        os.unlink(pov_path)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Convierte imágenes al formato .pov")
+    parser.add_argument("input", nargs="+",
+                        help="Imagen de entrada (BMP 1-24 bits, o cualquiera con Pillow); "
+                             "varias imágenes o un GIF animado generan una animación")
+    parser.add_argument("-o", "--output", help="Archivo .pov de salida (default: mismo nombre)")
+    parser.add_argument("--height", type=int, help="Escalar a esta altura (número de LEDs)")
+    parser.add_argument("--format", choices=("rgb888", "rgb565", "indexed"), default="rgb888",
+                        help="Formato de píxel (default: rgb888); indexed usa paleta de 1-8 bits")
+    parser.add_argument("--no-rle", action="store_true", help="Guardar todas las columnas sin comprimir")
+    parser.add_argument("--no-delta", action="store_true",
+                        help="No codificar columnas respecto a la anterior (repetidas/delta)")
+    parser.add_argument("--delay", type=int,
+                        help="Retardo por fotograma en ms (default: el del GIF, o %d)" % DEFAULT_DELAY_MS)
+    parser.add_argument("--stats", action="store_true", help="Mostrar tamaño por codificación")
+    parser.add_argument("--bench", action="store_true",
+                        help="Comparar lectura por columnas frente al BMP de entrada")
+    args = parser.parse_args()
+
+    frames = []
+    delays = []
+    size = None
+    for path in args.input:
+        width, height, image_frames, image_delays = read_frames(path, args.height)
+        if size is not None and size != (width, height):
+            sys.exit("Error: %s mide %dx%d, los fotogramas anteriores %dx%d" % ((path, width, height) + size))
+        size = (width, height)
+        frames += image_frames
+        delays += image_delays
+    if len(frames) > MAX_FRAMES:
+        sys.exit("Error: %d fotogramas, máximo %d" % (len(frames), MAX_FRAMES))
+    if args.delay is not None:
+        delays = [args.delay] * len(frames)
+
+    pixel_format = {"rgb888": PIXEL_RGB888, "rgb565": PIXEL_RGB565,
+                    "indexed": PIXEL_INDEXED8}[args.format]
+    data, columns, pixel_format = build_pov(width, height, None, pixel_format, not args.no_rle,
+                                            not args.no_rle and not args.no_delta, frames, delays)
+
+    output = Path(args.output) if args.output else Path(args.input[0]).with_suffix(".pov")
+    output.write_bytes(data)
+    print("%s: %dx%d, %d bytes%s" % (output, width, height, len(data),
+                                     ", %d fotogramas" % len(frames) if len(frames) > 1 else ""))
+
+    if args.stats:
+        print_stats(width, height, columns, pixel_format)
+    if args.bench:
+        if len(frames) > 1 or not args.input[0].lower().endswith(".bmp") or args.height:
+            sys.exit("Error: --bench necesita un BMP de entrada sin --height")
+        bench(args.input[0], data, width, height)
+
+
+if __name__ == "__main__":
+    main()
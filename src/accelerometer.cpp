@@ -1,4 +1,5 @@
 #include "accelerometer.h"
+#include "column_scheduler.h"
 
 Accelerometer::Accelerometer() {
 #ifdef HAS_ACCELEROMETER
@@ -12,6 +13,7 @@ Accelerometer::Accelerometer() {
   offsetX = offsetY = offsetZ = 0;
   calibrated = false;
   lastMotionTime = 0;
+  lastSweepSampleUs = 0;
 #endif
 }
 
@@ -49,8 +51,9 @@ bool Accelerometer::init() {
   // Librería no expone getAddress; solo indicar que fue detectado
   Serial.println("LIS3DH detectado");
 
-  // Configurar rango de medición (±2g, ±4g, ±8g, ±16g)
-  lis->setRange(LIS3DH_RANGE_2_G);
+  // Configurar rango de medición (±2g, ±4g, ±8g, ±16g).
+  // ±8g: un barrido rápido con el brazo supera 2g y saturaría el pico que usa SweepEstimator
+  lis->setRange(LIS3DH_RANGE_8_G);
 
   // Configurar data rate
   lis->setDataRate(LIS3DH_DATARATE_100_HZ);
@@ -90,6 +93,13 @@ void Accelerometer::update() {
   float signedDeltaX = x - lastX;
   dirAccumX = (dirAccumX * 0.8f) + (signedDeltaX * 0.2f);  // suavizado exponencial
 
+  // Estimador de barrido: una muestra por periodo del sensor, con su instante
+  uint64_t nowUs = ColumnScheduler::now();
+  if (nowUs - lastSweepSampleUs >= ACCEL_SAMPLE_PERIOD_US) {
+    lastSweepSampleUs = nowUs;
+    sweep.addSample(nowUs, x);
+  }
+
   float totalDelta = sqrt(deltaX*deltaX + deltaY*deltaY + deltaZ*deltaZ);
   motionLevel = totalDelta;
 
@@ -149,6 +159,10 @@ int8_t Accelerometer::getSweepDirection() {
 #endif
 }
 
+SweepEstimator& Accelerometer::getSweep() {
+  return sweep;
+}
+
 void Accelerometer::calibrate() {
 #ifdef HAS_ACCELEROMETER
   if (!initialized) return;
@@ -2,6 +2,8 @@
 #define ACCELEROMETER_H
 
 #include <Arduino.h>
+#include "config.h"
+#include "sweep_estimator.h"
 
 #ifdef HAS_ACCELEROMETER
 #include <Wire.h>
@@ -26,7 +28,10 @@ private:
   // Calibración
   float offsetX, offsetY, offsetZ;
   bool calibrated;
+
+  uint64_t lastSweepSampleUs;
 #endif
+  SweepEstimator sweep;
 
 public:
   Accelerometer();
@@ -40,6 +45,7 @@ public:
   bool isStill();
   float getMotionMagnitude();
   int8_t getSweepDirection();  // -1: negativo, 1: positivo, 0: indeterminado
+  SweepEstimator& getSweep();  // Periodo y velocidad del barrido (eje X)
 
   // Calibración
   void calibrate();
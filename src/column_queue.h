@@ -0,0 +1,63 @@
+#ifndef COLUMN_QUEUE_H
+#define COLUMN_QUEUE_H
+
+#include <stdint.h>
+#include <atomic>
+
+// Cola circular lock-free de un productor y un consumidor (SPSC).
+// El productor escribe directamente en el hueco devuelto por beginPush() y lo
+// publica con commitPush(); el consumidor lee front() y lo libera con pop().
+// Solo usa std::atomic, así que compila igual en el ESP32 que en el host.
+// Capacidad útil: Capacity - 1 elementos.
+template <typename T, uint16_t Capacity>
+class ColumnQueue {
+private:
+  T slots[Capacity];
+  std::atomic<uint16_t> head;  // Próximo hueco a escribir (solo lo avanza el productor)
+  std::atomic<uint16_t> tail;  // Próximo elemento a leer (solo lo avanza el consumidor)
+
+public:
+  ColumnQueue() : head(0), tail(0) {
+  }
+
+  // Productor: hueco libre o nullptr si la cola está llena
+  T* beginPush() {
+    uint16_t h = head.load(std::memory_order_relaxed);
+    uint16_t next = (h + 1) % Capacity;
+    if (next == tail.load(std::memory_order_acquire)) {
+      return nullptr;
+    }
+    return &slots[h];
+  }
+
+  void commitPush() {
+    uint16_t h = head.load(std::memory_order_relaxed);
+    head.store((h + 1) % Capacity, std::memory_order_release);
+  }
+
+  // Consumidor: elemento más antiguo o nullptr si está vacía
+  T* front() {
+    uint16_t t = tail.load(std::memory_order_relaxed);
+    if (t == head.load(std::memory_order_acquire)) {
+      return nullptr;
+    }
+    return &slots[t];
+  }
+
+  void pop() {
+    uint16_t t = tail.load(std::memory_order_relaxed);
+    tail.store((t + 1) % Capacity, std::memory_order_release);
+  }
+
+  uint16_t size() const {
+    uint16_t h = head.load(std::memory_order_acquire);
+    uint16_t t = tail.load(std::memory_order_acquire);
+    return (h + Capacity - t) % Capacity;
+  }
+
+  bool empty() const {
+    return size() == 0;
+  }
+};
+
+#endif
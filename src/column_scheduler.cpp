@@ -0,0 +1,170 @@
+#include "column_scheduler.h"
+
+#if defined(POV_HOST_BUILD)
+  #include <chrono>
+#elif !defined(ESP8266) && !defined(ARDUINO_ARCH_ESP8266)
+  #include <esp_timer.h>
+#endif
+
+ColumnScheduler::ColumnScheduler() : rate(1), anchorUs(0), ticks(0), deadlineUs(0), running(false),
+                                     lastLatenessUs(0), maxLatenessUs(0), sumLatenessUs(0),
+                                     samples(0), overruns(0), skipped(0) {
+}
+
+uint64_t ColumnScheduler::now() {
+#if defined(POV_HOST_BUILD)
+  // En el PC (test/) los tests pasan su propio reloj; esto es solo por completar
+  return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+#elif defined(ESP8266) || defined(ARDUINO_ARCH_ESP8266)
+  return micros64();
+#else
+  return (uint64_t)esp_timer_get_time();
+#endif
+}
+
+void ColumnScheduler::setRate(uint32_t columnsPerSecond, uint64_t nowUs) {
+  if (columnsPerSecond == 0) {
+    columnsPerSecond = 1;
+  }
+  if (columnsPerSecond == rate) {
+    return;
+  }
+
+  rate = columnsPerSecond;
+  if (running) {
+    // Re-anclar en el próximo vencimiento para conservar la fase actual
+    anchorUs = (deadlineUs > nowUs) ? deadlineUs : nowUs;
+    ticks = 0;
+    deadlineUs = anchorUs;
+  }
+}
+
+uint32_t ColumnScheduler::getRate() {
+  return rate;
+}
+
+uint32_t ColumnScheduler::getPeriodUs() {
+  return 1000000UL / rate;
+}
+
+void ColumnScheduler::start(uint64_t nowUs) {
+  anchorUs = nowUs;
+  ticks = 0;
+  deadlineUs = nowUs;
+  running = true;
+}
+
+void ColumnScheduler::stop() {
+  running = false;
+}
+
+bool ColumnScheduler::isRunning() {
+  return running;
+}
+
+uint64_t ColumnScheduler::deadlineFor(uint32_t tick) {
+  return anchorUs + (uint64_t)tick * 1000000ULL / rate;
+}
+
+// Devuelve true si ha vencido la columna actual y avanza al siguiente deadline
+bool ColumnScheduler::poll(uint64_t nowUs) {
+  if (!running || nowUs < deadlineUs) {
+    return false;
+  }
+
+  uint64_t lateness = nowUs - deadlineUs;
+  lastLatenessUs = (lateness > 0xFFFFFFFFULL) ? 0xFFFFFFFFUL : (uint32_t)lateness;
+  if (lastLatenessUs > maxLatenessUs) {
+    maxLatenessUs = lastLatenessUs;
+  }
+  sumLatenessUs += lastLatenessUs;
+  samples++;
+
+  if (lateness >= getPeriodUs()) {
+    // Retraso de más de un periodo: no intentar recuperar en ráfaga,
+    // re-anclar la serie en el instante actual
+    overruns++;
+    anchorUs = nowUs;
+    ticks = 0;
+  }
+
+  ticks++;
+  if (ticks >= rate) {
+    // Cada segundo exacto mover el ancla para que tick * 1e6 no crezca sin límite
+    anchorUs += 1000000ULL;
+    ticks -= rate;
+  }
+  deadlineUs = deadlineFor(ticks);
+  return true;
+}
+
+// Modo indexado por tiempo: devuelve cuántos periodos han vencido desde la
+// última llamada (0 si ninguno). Con retraso no re-ancla: el llamador salta
+// las columnas perdidas y la serie sigue ligada al instante de inicio.
+uint32_t ColumnScheduler::advance(uint64_t nowUs) {
+  if (!running || nowUs < deadlineUs) {
+    return 0;
+  }
+
+  uint64_t lateness = nowUs - deadlineUs;
+  lastLatenessUs = (lateness > 0xFFFFFFFFULL) ? 0xFFFFFFFFUL : (uint32_t)lateness;
+  if (lastLatenessUs > maxLatenessUs) {
+    maxLatenessUs = lastLatenessUs;
+  }
+  sumLatenessUs += lastLatenessUs;
+  samples++;
+
+  // Primer tick cuyo deadline aún no ha llegado. deadlineFor() redondea hacia
+  // abajo, así que el tick t vence si t * 1e6 / rate < elapsed + 1: se
+  // redondea hacia arriba con el mismo criterio (con 3000 Hz el tick 1 vence
+  // a los 333 us, no a los 333.3). Como nowUs >= deadlineUs, el tick actual
+  // ha vencido y siempre se avanza al menos uno
+  uint64_t elapsed = nowUs - anchorUs;
+  uint64_t nextTick = ((elapsed + 1) * rate + 999999ULL) / 1000000ULL;
+  if (nextTick <= ticks) {
+    nextTick = ticks + 1;
+  }
+  uint32_t steps = (uint32_t)(nextTick - ticks);
+  skipped += steps - 1;
+
+  // Mover el ancla por segundos enteros para que tick * 1e6 no crezca sin límite
+  uint64_t seconds = nextTick / rate;
+  anchorUs += seconds * 1000000ULL;
+  ticks = (uint32_t)(nextTick - seconds * rate);
+  deadlineUs = deadlineFor(ticks);
+  return steps;
+}
+
+uint64_t ColumnScheduler::getNextDeadline() {
+  return deadlineUs;
+}
+
+uint32_t ColumnScheduler::getLastJitterUs() {
+  return lastLatenessUs;
+}
+
+uint32_t ColumnScheduler::getMaxJitterUs() {
+  return maxLatenessUs;
+}
+
+uint32_t ColumnScheduler::getAvgJitterUs() {
+  return samples > 0 ? (uint32_t)(sumLatenessUs / samples) : 0;
+}
+
+uint32_t ColumnScheduler::getOverruns() {
+  return overruns;
+}
+
+uint32_t ColumnScheduler::getSkipped() {
+  return skipped;
+}
+
+void ColumnScheduler::resetStats() {
+  lastLatenessUs = 0;
+  maxLatenessUs = 0;
+  sumLatenessUs = 0;
+  samples = 0;
+  overruns = 0;
+  skipped = 0;
+}
@@ -0,0 +1,55 @@
+#ifndef COLUMN_SCHEDULER_H
+#define COLUMN_SCHEDULER_H
+
+#include <Arduino.h>
+
+// Planificador de columnas con deadline absoluto en microsegundos.
+// La columna n vence en anchor + n * 1e6 / rate, así que el periodo no se
+// trunca (120 Hz son 8333.3 us, no 8 ms) y un retraso puntual no desplaza
+// las columnas siguientes. No lee el reloj por sí mismo: recibe "now" en
+// cada llamada, por lo que se puede ejercitar con un reloj simulado.
+class ColumnScheduler {
+private:
+  uint32_t rate;          // Columnas por segundo
+  uint64_t anchorUs;      // Instante de la columna 0 del tramo actual
+  uint32_t ticks;         // Columnas emitidas desde anchorUs
+  uint64_t deadlineUs;    // Próximo vencimiento absoluto
+  bool running;
+
+  // Estadísticas de jitter (retraso respecto al deadline)
+  uint32_t lastLatenessUs;
+  uint32_t maxLatenessUs;
+  uint64_t sumLatenessUs;
+  uint32_t samples;
+  uint32_t overruns;      // Columnas con retraso >= un periodo (re-anclaje)
+  uint32_t skipped;       // Periodos saltados por advance()
+
+public:
+  ColumnScheduler();
+
+  static uint64_t now();  // Reloj de alta resolución del sistema (esp_timer)
+
+  void setRate(uint32_t columnsPerSecond, uint64_t nowUs);
+  uint32_t getRate();
+  uint32_t getPeriodUs();
+
+  void start(uint64_t nowUs);
+  void stop();
+  bool isRunning();
+
+  bool poll(uint64_t nowUs);
+  uint32_t advance(uint64_t nowUs);
+  uint64_t getNextDeadline();
+
+  uint32_t getLastJitterUs();
+  uint32_t getMaxJitterUs();
+  uint32_t getAvgJitterUs();
+  uint32_t getOverruns();
+  uint32_t getSkipped();
+  void resetStats();
+
+private:
+  uint64_t deadlineFor(uint32_t tick);
+};
+
+#endif
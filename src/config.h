@@ -43,13 +43,59 @@ enum LEDStripType {
 #define MAX_IMAGE_HEIGHT MAX_LEDS
 #define MAX_IMAGE_SIZE (100 * 1024)  // 100KB máximo por imagen
 #define IMAGE_BUFFER_SIZE 1024
+#define DECODE_BLOCK_BYTES 4096      // Lectura por bloques de filas (BMP/RGB565)
+#define MAX_ANIMATION_FRAMES 64      // Fotogramas máximos de un .pov animado
+// Heap que se deja libre al decodificar la imagen completa en RAM (WiFi, web, MQTT)
+#define FRAME_BUFFER_HEAP_RESERVE (32 * 1024)
+// Caché LRU de imágenes ya decodificadas (solo con PSRAM); 0 la desactiva
+#define DEFAULT_FRAME_CACHE_KB 2048
+#define MAX_FRAME_CACHE_KB 16384
+// Columnas .pov de la siguiente imagen decodificadas en cada update() (las
+// BMP/RGB565 van de un bloque de filas en cada update())
+#define PREFETCH_STEP_COLUMNS 8
 
 // Configuración POV
 #define DEFAULT_POV_SPEED 30  // FPS de columnas
 #define MIN_POV_SPEED 1
-#define MAX_POV_SPEED 120
+// Tope absoluto; el máximo real lo fija el tiempo de transmisión de la tira
+// (LEDController::getMaxColumnRate): ~110 Hz con 300 WS2811, kHz con APA102
+#define MAX_POV_SPEED 10000
 #define DEFAULT_LOOP_MODE true
 
+// Tarea de render dedicada (solo ESP32 de doble núcleo): consume columnas ya
+// decodificadas de una cola lock-free; loop() solo decodifica y atiende red/control
+#if !defined(ESP8266) && !defined(ARDUINO_ARCH_ESP8266) && !defined(CONFIG_FREERTOS_UNICORE)
+  #define POV_RENDER_TASK
+#endif
+#define RENDER_TASK_CORE 1
+#define RENDER_TASK_PRIORITY 5
+#define RENDER_TASK_STACK 4096
+#define COLUMN_QUEUE_DEPTH 8
+
+// Tiempos de transmisión de la tira (para calcular la tasa máxima de columnas)
+#define WS281X_US_PER_LED 30      // 24 bits a 800 kHz
+#define WS281X_RESET_US 50        // Latch entre frames (el que usa FastLED)
+#define APA102_SPI_MHZ 12         // Reloj SPI usado para APA102
+#define LED_SHOW_OVERHEAD_US 20   // Preparación por frame (brillo, dithering, driver)
+
+// Salida de LEDs asíncrona (ESP32): show() copia a un buffer de envío y retorna;
+// una tarea dedicada transmite (RMT para WS281x, SPI para APA102) mientras
+// quien llama prepara la siguiente columna. waitForIdle() espera al envío en curso.
+// Con tarea de render, la de salida va en el otro núcleo: en el mismo y con más
+// prioridad solo le quitaría CPU mientras FastLED saca los bits. En un solo
+// núcleo (sin tarea de render) se usa solo con WS281x, donde show() espera al
+// RMT sin CPU; APA102 va por SPI software y queda síncrono.
+#if !defined(ESP8266) && !defined(ARDUINO_ARCH_ESP8266)
+  #define LED_ASYNC_OUTPUT
+#endif
+#ifdef POV_RENDER_TASK
+  #define LED_OUTPUT_TASK_CORE (RENDER_TASK_CORE == 0 ? 1 : 0)
+#else
+  #define LED_OUTPUT_TASK_CORE 0
+#endif
+#define LED_OUTPUT_TASK_PRIORITY (RENDER_TASK_PRIORITY + 1)
+#define LED_OUTPUT_TASK_STACK 3072
+
 // Orientación POV
 enum POVOrientation {
   POV_VERTICAL,    // Columnas verticales (default)
@@ -57,6 +103,38 @@ enum POVOrientation {
 };
 #define DEFAULT_POV_ORIENTATION POV_VERTICAL
 
+// Escalado de líneas al número de LEDs
+enum POVResampleMode {
+  POV_RESAMPLE_NEAREST,  // Vecino más cercano (default); imagen no más alta que la tira
+  POV_RESAMPLE_SMOOTH    // Filtro de caja al reducir, interpolación lineal al ampliar
+};
+#define DEFAULT_POV_RESAMPLE POV_RESAMPLE_NEAREST
+
+// Selección de columna en cada deadline
+enum POVTimingMode {
+  POV_TIMING_SEQUENTIAL,  // Siguiente columna siempre (default); un retraso estira la imagen
+  POV_TIMING_TIMED        // Columna según el tiempo desde el inicio del barrido; si hay retraso se saltan
+};
+#define DEFAULT_POV_TIMING POV_TIMING_SEQUENTIAL
+
+// Velocidad adaptativa con acelerómetro: la tasa de columnas sigue la velocidad
+// del barrido para que cada columna ocupe siempre el mismo ancho físico
+#define DEFAULT_POV_AUTO_SPEED false
+#define DEFAULT_COLUMN_PITCH_MM 4.0f   // Ancho físico de una columna
+#define ACCEL_SAMPLE_PERIOD_US 10000   // 100 Hz, igual que el data rate del LIS3DH
+#define SWEEP_FILTER_ALPHA 0.3f        // Paso bajo sobre la aceleración X
+#define SWEEP_HYSTERESIS 0.6f          // m/s² para contar un cruce por cero
+#define SWEEP_MIN_HALF_MS 60           // Medio barrido más rápido aceptado
+#define SWEEP_MAX_HALF_MS 1500         // Medio barrido más lento aceptado
+
+// Sincronía con el barrido: la imagen vuelve a la columna 0 en cada punto de
+// giro y se invierte en el barrido de vuelta (solo con acelerómetro)
+#if defined(BORNHACK_BADGE) && defined(HAS_ACCELEROMETER)
+  #define DEFAULT_POV_SWEEP_SYNC true
+#else
+  #define DEFAULT_POV_SWEEP_SYNC false
+#endif
+
 // WiFi
 #define AP_SSID "POV-Line-Setup"
 #define AP_PASSWORD "povline123"
@@ -67,6 +145,14 @@ enum POVOrientation {
 #define WEB_SERVER_PORT 80
 #define UPLOAD_BUFFER_SIZE 2048
 
+// Transcodificación de subidas: los BMP/RGB565 se guardan como .pov
+// (column-major) mientras llegan los chunks, sin cargar la imagen en RAM
+#define UPLOAD_TRANSCODE true
+#define UPLOAD_TEMP_FILE "/upload.tmp"  // Filas normalizadas durante la subida
+#define TRANSCODE_BAND_BYTES 8192       // RAM para trasponer un grupo de columnas
+#define TRANSCODE_MAX_WIDTH 1024        // Ancho máximo que se transcodifica
+#define PNG_MAX_WINDOW (32 * 1024)      // Ventana zlib máxima de un PNG (la que usan casi todos)
+
 // MQTT
 #define MQTT_PORT 1883
 #define MQTT_KEEPALIVE 60
@@ -77,6 +163,30 @@ enum POVOrientation {
 // Sistema de archivos
 #define CONFIG_FILE "/config.json"
 #define IMAGES_DIR "/images"
+#define CATALOG_FILE "/images.cat"      // Catálogo de /images (ImageManager)
+#define CATALOG_TEMP_FILE "/images.tmp" // Se escribe aquí y se renombra
+#define CATALOG_MAX_IMAGES 1024
+#define THUMB_MAX_SIZE 48               // Lado mayor de las miniaturas (px)
+#define THUMB_EXTENSION ".thm"          // Miniatura BMP junto al archivo: /images/a.pov.thm
+#define PLAYLIST_FILE "/playlist.json"  // Lista de reproducción (Playlist)
+#define PLAYLIST_MAX_ENTRIES 32
+#define PLAYLIST_DEFAULT_DURATION_MS 10000  // Entradas sin duración ni vueltas
+
+// Almacén de imágenes en partición cruda (FlashStore, solo ESP32): copia de
+// los .pov de /images leída por mmap. La partición solo está en
+// partitions_povstore.csv (entorno esp32dev-povstore); con partitions.csv se
+// sigue leyendo todo de LittleFS
+#define FLASH_STORE_LABEL "povstore"
+#define FLASH_STORE_SUBTYPE 0x40   // Subtipo de datos propio (0x40-0xFE)
+#define FLASH_STORE_SECTOR 4096    // Unidad de borrado de la flash
+
+// Formato de los píxeles en el archivo
+enum ImagePixelFormat {
+  PIXEL_FORMAT_BGR888,  // BMP 24 bits
+  PIXEL_FORMAT_RGB888,
+  PIXEL_FORMAT_RGB565,
+  PIXEL_FORMAT_INDEXED  // Índices de 1/2/4/8 bits en una paleta
+};
 
 // Estructura de información de imagen
 struct ImageInfo {
@@ -84,10 +194,23 @@ struct ImageInfo {
   uint16_t width;
   uint16_t height;
   uint32_t fileSize;
-  uint8_t format;  // 0=BMP, 1=RGB565
+  uint8_t format;  // 0=BMP, 1=RGB565, 2=POV (column-major)
   bool valid;
 
-  ImageInfo() : width(0), height(0), fileSize(0), format(0), valid(false) {
+  // Disposición de los píxeles, decodificada una vez al parsear el header
+  uint32_t dataOffset;  // Inicio de los píxeles (POV: tabla de columnas)
+  uint32_t rowStride;   // Bytes por fila, con padding (0 en POV)
+  bool topDown;         // Primera fila del archivo = fila superior
+  uint8_t pixelFormat;  // ImagePixelFormat
+  uint8_t bitsPerPixel;    // 1, 2, 4, 8 (indexado), 16 o 24
+  uint32_t paletteOffset;  // Posición de la paleta en el archivo
+  uint16_t paletteSize;    // Entradas de la paleta (0 sin paleta)
+  uint16_t frameCount;     // Fotogramas (.pov animado); 1 en imágenes fijas
+  uint32_t frameOffset;    // Posición de los retardos por fotograma (0 si no hay)
+
+  ImageInfo() : width(0), height(0), fileSize(0), format(0), valid(false),
+                dataOffset(0), rowStride(0), topDown(true), pixelFormat(PIXEL_FORMAT_RGB888),
+                bitsPerPixel(24), paletteOffset(0), paletteSize(0), frameCount(1), frameOffset(0) {
     filename[0] = '\0';
   }
 };
@@ -115,6 +238,12 @@ struct Config {
   uint16_t povSpeed;
   bool loopMode;
   POVOrientation povOrientation;
+  POVResampleMode povResample;
+  POVTimingMode povTiming;
+  bool povAutoSpeed;
+  bool povSweepSync;
+  float columnPitchMm;
+  uint16_t frameCacheKB;  // Presupuesto de la caché de imágenes (PSRAM)
   char activeImage[32];
 
   // Sistema
@@ -139,6 +268,12 @@ struct Config {
     povSpeed = DEFAULT_POV_SPEED;
     loopMode = DEFAULT_LOOP_MODE;
     povOrientation = DEFAULT_POV_ORIENTATION;
+    povResample = DEFAULT_POV_RESAMPLE;
+    povTiming = DEFAULT_POV_TIMING;
+    povAutoSpeed = DEFAULT_POV_AUTO_SPEED;
+    povSweepSync = DEFAULT_POV_SWEEP_SYNC;
+    columnPitchMm = DEFAULT_COLUMN_PITCH_MM;
+    frameCacheKB = DEFAULT_FRAME_CACHE_KB;
     strcpy(activeImage, "");
 
     strcpy(deviceName, "POV-Line");
@@ -0,0 +1,506 @@
+#include "flash_store.h"
+#include "image_manager.h"
+
+#if defined(ESP32)
+#include <esp_partition.h>
+#include <esp_idf_version.h>
+#elif defined(POV_HOST_BUILD)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// Acceso a la partición: esp_partition en ESP32, un archivo mapeado en el PC.
+// En ESP8266 no hay almacén y todo se lee de LittleFS
+#if defined(ESP32)
+
+static const esp_partition_t* partition = nullptr;
+static const void* mappedPartition = nullptr;
+
+static const uint8_t* mapPartition(uint32_t& size) {
+  if (mappedPartition == nullptr) {
+    partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, (esp_partition_subtype_t)FLASH_STORE_SUBTYPE,
+                                         FLASH_STORE_LABEL);
+    if (partition == nullptr) {
+      return nullptr;
+    }
+#if ESP_IDF_VERSION_MAJOR >= 5
+    esp_partition_mmap_handle_t handle;
+    esp_err_t err = esp_partition_mmap(partition, 0, partition->size, ESP_PARTITION_MMAP_DATA,
+                                       &mappedPartition, &handle);
+#else
+    spi_flash_mmap_handle_t handle;
+    esp_err_t err = esp_partition_mmap(partition, 0, partition->size, SPI_FLASH_MMAP_DATA,
+                                       &mappedPartition, &handle);
+#endif
+    if (err != ESP_OK) {
+      Serial.printf("Error: No se pudo mapear la partición %s (%d)\n", FLASH_STORE_LABEL, err);
+      mappedPartition = nullptr;
+      return nullptr;
+    }
+  }
+  size = partition->size;
+  return (const uint8_t*)mappedPartition;
+}
+
+// Borrar y escribir invalidan la caché de las zonas mapeadas
+static bool eraseFlash(uint32_t offset, uint32_t length) {
+  return esp_partition_erase_range(partition, offset, length) == ESP_OK;
+}
+
+// data tiene que estar en RAM: mientras se escribe la caché de flash está desactivada
+static bool writeFlash(uint32_t offset, const uint8_t* data, uint32_t length) {
+  return esp_partition_write(partition, offset, data, length) == ESP_OK;
+}
+
+static bool readFlash(uint32_t offset, uint8_t* data, uint32_t length) {
+  return esp_partition_read(partition, offset, data, length) == ESP_OK;
+}
+
+#elif defined(POV_HOST_BUILD)
+
+#ifndef FLASH_STORE_HOST_FILE
+#define FLASH_STORE_HOST_FILE "flash_store.bin"
+#endif
+#ifndef FLASH_STORE_HOST_SIZE
+#define FLASH_STORE_HOST_SIZE 0xC0000  // Como la fila de partitions_povstore.csv
+#endif
+
+static uint8_t* hostFlash = nullptr;
+
+// Archivo del tamaño de la partición; lo que se añade al crearlo o agrandarlo
+// empieza borrado (0xFF), como la flash nueva
+static const uint8_t* mapPartition(uint32_t& size) {
+  if (hostFlash == nullptr) {
+    int fd = open(FLASH_STORE_HOST_FILE, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+      return nullptr;
+    }
+    off_t current = lseek(fd, 0, SEEK_END);
+    if (current != FLASH_STORE_HOST_SIZE && ftruncate(fd, FLASH_STORE_HOST_SIZE) != 0) {
+      close(fd);
+      return nullptr;
+    }
+    void* mapped = mmap(nullptr, FLASH_STORE_HOST_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+      return nullptr;
+    }
+    hostFlash = (uint8_t*)mapped;
+    if (current < FLASH_STORE_HOST_SIZE) {
+      memset(hostFlash + current, 0xFF, FLASH_STORE_HOST_SIZE - current);
+    }
+  }
+  size = FLASH_STORE_HOST_SIZE;
+  return hostFlash;
+}
+
+static bool eraseFlash(uint32_t offset, uint32_t length) {
+  memset(hostFlash + offset, 0xFF, length);
+  return true;
+}
+
+// Como en la flash NOR, escribir solo pasa bits de 1 a 0: sin borrar antes,
+// los datos salen corruptos y el hash de comprobación lo detecta
+static bool writeFlash(uint32_t offset, const uint8_t* data, uint32_t length) {
+  for (uint32_t i = 0; i < length; i++) {
+    hostFlash[offset + i] &= data[i];
+  }
+  return true;
+}
+
+static bool readFlash(uint32_t offset, uint8_t* data, uint32_t length) {
+  memcpy(data, hostFlash + offset, length);
+  return true;
+}
+
+#else
+
+static const uint8_t* mapPartition(uint32_t& size) {
+  size = 0;
+  return nullptr;
+}
+
+static bool eraseFlash(uint32_t offset, uint32_t length) {
+  return false;
+}
+
+static bool writeFlash(uint32_t offset, const uint8_t* data, uint32_t length) {
+  return false;
+}
+
+static bool readFlash(uint32_t offset, uint8_t* data, uint32_t length) {
+  return false;
+}
+
+#endif
+
+// Ruta completa en /images, como la guarda el catálogo
+static String normalizePath(const char* name) {
+  String fname = String(name);
+  if (fname.startsWith(IMAGES_DIR "/")) {
+    return fname;
+  }
+  if (fname.startsWith("/")) {
+    fname = fname.substring(1);
+  }
+  return String(IMAGES_DIR "/") + fname;
+}
+
+// Bytes que ocupa un extent: cada uno empieza en un sector
+static uint32_t sectorBytes(uint32_t length) {
+  return (length + FLASH_STORE_SECTOR - 1) / FLASH_STORE_SECTOR * FLASH_STORE_SECTOR;
+}
+
+FlashStore::FlashStore() : base(nullptr), size(0), pinnedOffset(0), pinnedLength(0) {
+#if defined(ESP32)
+  mutex = xSemaphoreCreateMutex();
+#endif
+}
+
+FlashStore::Guard::Guard(FlashStore& store) : store(store) {
+#if defined(ESP32)
+  xSemaphoreTake(store.mutex, portMAX_DELAY);
+#endif
+}
+
+FlashStore::Guard::~Guard() {
+#if defined(ESP32)
+  xSemaphoreGive(store.mutex);
+#endif
+}
+
+bool FlashStore::init() {
+  Guard guard(*this);
+  extents.clear();
+  pinnedLength = 0;
+  base = mapPartition(size);
+  if (base == nullptr || size < 2 * FLASH_STORE_SECTOR) {
+    base = nullptr;
+    Serial.println("Almacén flash no disponible: imágenes desde LittleFS");
+    return false;
+  }
+
+  bool changed = !loadTable();
+
+  // Fuera lo que ya no está en /images, ha cambiado o ahora es un alias, y
+  // lo dañado por un corte durante una escritura
+  for (size_t i = 0; i < extents.size(); ) {
+    const FlashExtent& extent = extents[i];
+    uint64_t hash;
+    if (!imageManager.getImageHash(extent.filename, hash) || hash != extent.hash ||
+        imageManager.getImagePath(extent.filename) != extent.filename ||
+        contentHash(base + extent.offset, extent.length) != hash) {
+      Serial.printf("Almacén flash: %s descartada\n", extent.filename);
+      extents.erase(extents.begin() + i);
+      changed = true;
+    } else {
+      i++;
+    }
+  }
+
+  // Copiar los .pov que falten (primer arranque con la partición, archivos
+  // subidos por fuera de la API) mientras quepan
+  for (const ImageInfo& info : imageManager.listImages()) {
+    if (info.format == 2 && findExtent(info.filename) < 0 && sectorBytes(info.fileSize) <= freeBytes() &&
+        storeImage(info.filename)) {
+      changed = true;
+    }
+  }
+
+  if (changed) {
+    saveTable();
+  }
+  Serial.printf("Almacén flash: %u imágenes, %u KB libres\n", (unsigned)extents.size(),
+                (unsigned)(freeBytes() / 1024));
+  return true;
+}
+
+bool FlashStore::isAvailable() {
+  Guard guard(*this);
+  return base != nullptr;
+}
+
+bool FlashStore::importImage(const char* filename) {
+  Guard guard(*this);
+  if (base == nullptr) {
+    return false;
+  }
+  bool ok = storeImage(filename);
+  return saveTable() && ok;
+}
+
+bool FlashStore::removeImage(const char* filename) {
+  Guard guard(*this);
+  String path = normalizePath(filename);
+  int index = findExtent(path.c_str());
+  if (base == nullptr || index < 0) {
+    return false;
+  }
+  // Los datos se quedan donde están hasta que compact() reutilice el hueco
+  extents.erase(extents.begin() + index);
+  return saveTable();
+}
+
+bool FlashStore::hasImage(const char* filename) {
+  Guard guard(*this);
+  String path = normalizePath(filename);
+  return findExtent(path.c_str()) >= 0;
+}
+
+const uint8_t* FlashStore::acquire(const char* filename, uint32_t length) {
+  Guard guard(*this);
+  String path = normalizePath(filename);
+  int index = findExtent(path.c_str());
+  if (base == nullptr || index < 0 || extents[index].length != length) {
+    return nullptr;
+  }
+  pinnedOffset = extents[index].offset;
+  pinnedLength = extents[index].length;
+  return base + pinnedOffset;
+}
+
+void FlashStore::release() {
+  Guard guard(*this);
+  pinnedLength = 0;
+}
+
+bool FlashStore::compact() {
+  Guard guard(*this);
+  return packExtents();
+}
+
+// Cada extent baja al primer sector libre, sector a sector. El destino está
+// siempre antes que el origen y a un sector o más, así que cada sector se lee
+// antes de borrar donde va. Un corte a mitad deja extents que no cuadran con
+// su hash: init() los descarta y los vuelve a copiar de LittleFS
+bool FlashStore::packExtents() {
+  if (base == nullptr) {
+    return false;
+  }
+  if (pinnedLength > 0) {
+    Serial.println("Error: Almacén flash en uso, no se puede compactar");
+    return false;
+  }
+
+  uint8_t* buffer = new uint8_t[FLASH_STORE_SECTOR];
+  if (buffer == nullptr) {
+    Serial.println("Error: Sin memoria para compactar el almacén flash");
+    return false;
+  }
+
+  bool ok = true;
+  uint32_t cursor = FLASH_STORE_SECTOR;
+  for (size_t i = 0; ok && i < extents.size(); i++) {
+    FlashExtent& extent = extents[i];
+    uint32_t bytes = sectorBytes(extent.length);
+    if (extent.offset != cursor) {
+      for (uint32_t done = 0; ok && done < bytes; done += FLASH_STORE_SECTOR) {
+        ok = readFlash(extent.offset + done, buffer, FLASH_STORE_SECTOR) &&
+             eraseFlash(cursor + done, FLASH_STORE_SECTOR) &&
+             writeFlash(cursor + done, buffer, FLASH_STORE_SECTOR);
+      }
+      if (ok) {
+        extent.offset = cursor;
+      }
+    }
+    cursor += bytes;
+  }
+  delete[] buffer;
+
+  if (!ok) {
+    Serial.println("Error: No se pudo compactar el almacén flash");
+  }
+  return saveTable() && ok;
+}
+
+size_t FlashStore::getImageCount() {
+  Guard guard(*this);
+  return extents.size();
+}
+
+size_t FlashStore::getFreeSpace() {
+  Guard guard(*this);
+  return freeBytes();
+}
+
+size_t FlashStore::getTotalSpace() {
+  Guard guard(*this);
+  return base != nullptr ? size - FLASH_STORE_SECTOR : 0;
+}
+
+// Copia (o reemplaza) un .pov sin guardar la tabla. Las columnas de BMP y
+// RGB565 no son contiguas, así que no ganan nada con el mapeo. Un alias se
+// lee del archivo con su contenido, que es el que se copia
+bool FlashStore::storeImage(const char* filename) {
+  String path = normalizePath(filename);
+  int index = findExtent(path.c_str());
+  if (imageManager.getImagePath(path.c_str()) != path) {
+    if (index >= 0) {
+      extents.erase(extents.begin() + index);
+    }
+    return false;
+  }
+
+  ImageInfo info;
+  uint64_t hash;
+  if (!path.endsWith(".pov") || !imageManager.getImageInfo(path.c_str(), info) || !imageManager.getImageHash(path.c_str(), hash)) {
+    return false;
+  }
+
+  if (index >= 0) {
+    if (extents[index].hash == hash && extents[index].length == info.fileSize) {
+      return true;
+    }
+    extents.erase(extents.begin() + index);
+  }
+
+  uint32_t needed = sectorBytes(info.fileSize);
+  uint32_t offset = dataEnd();
+  if (extents.size() < FLASH_STORE_MAX_EXTENTS && offset + needed > size && needed <= freeBytes() &&
+      packExtents()) {
+    offset = dataEnd();
+  }
+  if (extents.size() >= FLASH_STORE_MAX_EXTENTS || offset + needed > size) {
+    Serial.printf("Aviso: Almacén flash lleno, %s se leerá de LittleFS\n", path.c_str());
+    return false;
+  }
+
+  if (!copyImage(path.c_str(), info.fileSize, hash, offset)) {
+    return false;
+  }
+
+  // Va detrás de todos: la lista sigue ordenada por offset
+  FlashExtent extent;
+  memset(&extent, 0, sizeof(extent));
+  strlcpy(extent.filename, path.c_str(), sizeof(extent.filename));
+  extent.offset = offset;
+  extent.length = info.fileSize;
+  extent.hash = hash;
+  extents.push_back(extent);
+  Serial.printf("Imagen %s copiada al almacén flash\n", path.c_str());
+  return true;
+}
+
+// Por sectores, con el buffer en RAM; lo escrito se comprueba leyéndolo ya
+// mapeado, que es como lo leerá POVEngine
+bool FlashStore::copyImage(const char* path, uint32_t length, uint64_t hash, uint32_t offset) {
+  File file = LittleFS.open(path, "r");
+  if (!file || file.size() != length) {
+    Serial.printf("Error: No se pudo abrir %s\n", path);
+    return false;
+  }
+
+  uint8_t* buffer = new uint8_t[FLASH_STORE_SECTOR];
+  if (buffer == nullptr) {
+    file.close();
+    Serial.println("Error: Sin memoria para copiar al almacén flash");
+    return false;
+  }
+
+  bool ok = eraseFlash(offset, sectorBytes(length));
+  for (uint32_t done = 0; ok && done < length; ) {
+    uint32_t chunk = min(length - done, (uint32_t)FLASH_STORE_SECTOR);
+    ok = file.read(buffer, chunk) == chunk && writeFlash(offset + done, buffer, chunk);
+    done += chunk;
+  }
+  file.close();
+  delete[] buffer;
+
+  if (!ok || contentHash(base + offset, length) != hash) {
+    Serial.printf("Error: No se pudo copiar %s al almacén flash\n", path);
+    return false;
+  }
+  return true;
+}
+
+bool FlashStore::loadTable() {
+  FlashStoreHeader header;
+  memcpy(&header, base, sizeof(header));
+  if (strncmp(header.magic, "PFST", 4) != 0) {
+    Serial.println("Almacén flash vacío");
+    return false;
+  }
+
+  const uint8_t* table = base + sizeof(header);
+  bool ok = header.version == FLASH_STORE_VERSION && header.count <= FLASH_STORE_MAX_EXTENTS &&
+            (uint32_t)contentHash(table, header.count * sizeof(FlashExtent)) == header.checksum;
+
+  // Extents dentro de la partición, alineados y sin solaparse
+  uint32_t end = FLASH_STORE_SECTOR;
+  for (uint16_t i = 0; ok && i < header.count; i++) {
+    FlashExtent extent;
+    memcpy(&extent, table + i * sizeof(FlashExtent), sizeof(extent));
+    extent.filename[sizeof(extent.filename) - 1] = '\0';
+    ok = extent.offset >= end && extent.offset % FLASH_STORE_SECTOR == 0 && extent.length > 0 &&
+         (uint64_t)extent.offset + extent.length <= size;
+    end = extent.offset + sectorBytes(extent.length);
+    extents.push_back(extent);
+  }
+
+  if (!ok) {
+    Serial.println("Tabla del almacén flash inválida, se vacía");
+    extents.clear();
+  }
+  return ok;
+}
+
+// La tabla es el primer sector y se reescribe entera: un corte a mitad la
+// deja inválida y el almacén vacío, que se vuelve a llenar desde /images
+bool FlashStore::saveTable() {
+  FlashStoreHeader header;
+  memcpy(header.magic, "PFST", 4);
+  header.version = FLASH_STORE_VERSION;
+  header.count = extents.size();
+  header.checksum = (uint32_t)contentHash((const uint8_t*)extents.data(), extents.size() * sizeof(FlashExtent));
+  header.reserved = 0;
+
+  bool ok = eraseFlash(0, FLASH_STORE_SECTOR) && writeFlash(0, (const uint8_t*)&header, sizeof(header)) &&
+            (extents.empty() || writeFlash(sizeof(header), (const uint8_t*)extents.data(),
+                                           extents.size() * sizeof(FlashExtent)));
+  if (!ok) {
+    Serial.println("Error: No se pudo guardar la tabla del almacén flash");
+  }
+  return ok;
+}
+
+int FlashStore::findExtent(const char* path) {
+  for (size_t i = 0; i < extents.size(); i++) {
+    if (strcmp(extents[i].filename, path) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+// Primer byte libre tras el último extent (o tras el fijado, aunque ya no esté en la tabla)
+uint32_t FlashStore::dataEnd() {
+  uint32_t end = FLASH_STORE_SECTOR;
+  if (!extents.empty()) {
+    end = extents.back().offset + sectorBytes(extents.back().length);
+  }
+  if (pinnedLength > 0) {
+    end = max(end, pinnedOffset + sectorBytes(pinnedLength));
+  }
+  return end;
+}
+
+uint32_t FlashStore::usedBytes() {
+  uint32_t used = 0;
+  bool pinnedListed = false;
+  for (const FlashExtent& extent : extents) {
+    used += sectorBytes(extent.length);
+    pinnedListed = pinnedListed || extent.offset == pinnedOffset;
+  }
+  if (pinnedLength > 0 && !pinnedListed) {
+    used += sectorBytes(pinnedLength);
+  }
+  return used;
+}
+
+size_t FlashStore::freeBytes() {
+  return base != nullptr ? size - FLASH_STORE_SECTOR - usedBytes() : 0;
+}
+
+// Instancia global
+FlashStore flashStore;
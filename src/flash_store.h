@@ -0,0 +1,106 @@
+#ifndef FLASH_STORE_H
+#define FLASH_STORE_H
+
+#include <Arduino.h>
+#include <vector>
+#include "config.h"
+
+#if defined(ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#endif
+
+// Almacén de imágenes en una partición de datos cruda (FLASH_STORE_LABEL en
+// partitions_povstore.csv) mapeada entera con esp_partition_mmap: cada .pov queda en
+// memoria direccionable a través de la caché de flash, así que sus columnas
+// son punteros y se leen sin LittleFS ni copias. El primer sector guarda la
+// tabla de extents; cada imagen ocupa un extent contiguo que empieza en un
+// sector. Es una copia de /images, que sigue siendo el original: una tabla
+// inválida deja el almacén vacío y un extent que no cuadra con el catálogo se
+// descarta. En el PC (test/) la partición es un archivo mapeado con mmap.
+// Los handlers web (tarea async_tcp) copian, borran y compactan mientras
+// loop() consulta la tabla y fija la imagen que reproduce: en ESP32 cada
+// método público se ejecuta con el mutex del almacén tomado. Lo que lee
+// POVEngine por el puntero de acquire() no se mueve ni se borra.
+// Little-endian.
+#define FLASH_STORE_VERSION 1
+
+#pragma pack(push, 1)
+struct FlashStoreHeader {
+  char magic[4];      // "PFST"
+  uint16_t version;   // FLASH_STORE_VERSION
+  uint16_t count;     // Extents
+  uint32_t checksum;  // FNV-1a de los extents: si no cuadra, almacén vacío
+  uint32_t reserved;
+};
+
+struct FlashExtent {
+  char filename[32];
+  uint32_t offset;    // Desde el inicio de la partición, múltiplo de FLASH_STORE_SECTOR
+  uint32_t length;    // Bytes del archivo
+  uint64_t hash;      // contentHash() del archivo (el del catálogo)
+};
+#pragma pack(pop)
+
+#define FLASH_STORE_MAX_EXTENTS ((FLASH_STORE_SECTOR - sizeof(FlashStoreHeader)) / sizeof(FlashExtent))
+
+class FlashStore {
+private:
+  std::vector<FlashExtent> extents;  // Ordenados por offset
+  const uint8_t* base;               // Partición mapeada (nullptr sin almacén)
+  uint32_t size;
+  // Extent que está leyendo POVEngine: no se mueve ni se sobrescribe aunque se
+  // quite de la tabla (length 0 si no hay ninguno)
+  uint32_t pinnedOffset;
+  uint32_t pinnedLength;
+#if defined(ESP32)
+  SemaphoreHandle_t mutex;
+#endif
+
+  // Mutex tomado mientras vive (nada fuera de ESP32)
+  struct Guard {
+    FlashStore& store;
+    explicit Guard(FlashStore& store);
+    ~Guard();
+  };
+
+public:
+  FlashStore();
+
+  // Mapea la partición, carga la tabla, descarta lo que no cuadra con el
+  // catálogo de ImageManager y copia los .pov que falten mientras quepan
+  bool init();
+  bool isAvailable();
+
+  // Copia (o reemplaza) un .pov de /images; el resto de formatos no se guarda
+  bool importImage(const char* filename);
+  bool removeImage(const char* filename);
+  bool hasImage(const char* filename);
+
+  // Puntero al archivo mapeado si está en el almacén con ese tamaño; el extent
+  // queda fijado hasta release()
+  const uint8_t* acquire(const char* filename, uint32_t length);
+  void release();
+
+  // Junta los extents al principio para recuperar los huecos de los borrados
+  bool compact();
+
+  size_t getImageCount();
+  size_t getFreeSpace();
+  size_t getTotalSpace();
+
+private:
+  bool loadTable();
+  bool saveTable();
+  int findExtent(const char* path);
+  uint32_t dataEnd();
+  uint32_t usedBytes();
+  size_t freeBytes();
+  bool packExtents();
+  bool storeImage(const char* filename);
+  bool copyImage(const char* path, uint32_t length, uint64_t hash, uint32_t offset);
+};
+
+extern FlashStore flashStore;
+
+#endif
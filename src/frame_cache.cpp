@@ -0,0 +1,248 @@
+#include "frame_cache.h"
+#include "image_manager.h"
+
+// La caché solo vive en PSRAM; en el PC (test/) se usa el heap
+static bool cacheMemoryAvailable() {
+#if defined(BOARD_HAS_PSRAM)
+  return psramFound();
+#elif defined(POV_HOST_BUILD)
+  return true;
+#else
+  return false;
+#endif
+}
+
+// Ruta completa en /images, como la guarda el catálogo
+static String normalizePath(const char* name) {
+  String fname = String(name);
+  if (fname.startsWith(IMAGES_DIR "/")) {
+    return fname;
+  }
+  if (fname.startsWith("/")) {
+    fname = fname.substring(1);
+  }
+  return String(IMAGES_DIR "/") + fname;
+}
+
+FrameCache::FrameCache() : budget(0), usedBytes(0), useCounter(0), hits(0), misses(0), evictions(0) {
+#if defined(ESP32)
+  mutex = xSemaphoreCreateMutex();
+#endif
+}
+
+FrameCache::~FrameCache() {
+  for (Entry& entry : entries) {
+    free(entry.frame.pixels);
+  }
+}
+
+FrameCache::Guard::Guard(FrameCache& cache) : cache(cache) {
+#if defined(ESP32)
+  xSemaphoreTake(cache.mutex, portMAX_DELAY);
+#endif
+}
+
+FrameCache::Guard::~Guard() {
+#if defined(ESP32)
+  xSemaphoreGive(cache.mutex);
+#endif
+}
+
+void FrameCache::setBudget(size_t bytes) {
+  Guard guard(*this);
+  if (bytes > 0 && !cacheMemoryAvailable()) {
+    Serial.println("Caché de imágenes desactivada: sin PSRAM");
+    bytes = 0;
+  }
+  budget = bytes;
+  makeRoom(0);
+  if (budget > 0) {
+    Serial.printf("Caché de imágenes: %u KB\n", (unsigned)(budget / 1024));
+  }
+}
+
+size_t FrameCache::getBudget() {
+  Guard guard(*this);
+  return budget;
+}
+
+bool FrameCache::acquire(const char* filename, POVOrientation orientation, POVResampleMode resample,
+                         uint16_t numLeds, CachedFrame& frame) {
+  Guard guard(*this);
+  if (budget == 0) {
+    return false;
+  }
+
+  String path = normalizePath(filename);
+  int index = findEntry(path.c_str(), orientation, resample, numLeds);
+  uint64_t hash;
+  if (index < 0) {
+    misses++;
+    return false;
+  }
+  // Cambiada por fuera de la API (sin invalidate()): ya no sirve
+  if (!imageManager.getImageHash(path.c_str(), hash) || hash != entries[index].hash) {
+    if (entries[index].pins > 0) {
+      entries[index].stale = true;
+    } else {
+      evict(index);
+    }
+    misses++;
+    return false;
+  }
+
+  Entry& entry = entries[index];
+  entry.lastUse = ++useCounter;
+  entry.pins++;
+  frame = entry.frame;
+  hits++;
+  return true;
+}
+
+bool FrameCache::insert(const char* filename, POVOrientation orientation, POVResampleMode resample,
+                        uint16_t numLeds, const CachedFrame& frame) {
+  Guard guard(*this);
+  String path = normalizePath(filename);
+  uint64_t hash;
+  if (frame.bytes > budget || path.length() >= sizeof(Entry::filename) ||
+      !imageManager.getImageHash(path.c_str(), hash)) {
+    return false;
+  }
+
+  // Una versión anterior con la misma disposición deja de servir
+  int index = findEntry(path.c_str(), orientation, resample, numLeds);
+  if (index >= 0) {
+    if (entries[index].pins > 0) {
+      entries[index].stale = true;
+    } else {
+      evict(index);
+    }
+  }
+  if (!makeRoom(frame.bytes)) {
+    return false;
+  }
+
+  Entry entry;
+  strlcpy(entry.filename, path.c_str(), sizeof(entry.filename));
+  entry.hash = hash;
+  entry.orientation = orientation;
+  entry.resample = resample;
+  entry.numLeds = numLeds;
+  entry.frame = frame;
+  entry.lastUse = ++useCounter;
+  entry.pins = 1;
+  entry.stale = false;
+  entries.push_back(entry);
+  usedBytes += frame.bytes;
+  return true;
+}
+
+void FrameCache::release(const CRGB* pixels) {
+  Guard guard(*this);
+  for (size_t i = 0; i < entries.size(); i++) {
+    Entry& entry = entries[i];
+    if (entry.frame.pixels != pixels || entry.pins == 0) {
+      continue;
+    }
+    entry.pins--;
+    if (entry.pins == 0 && entry.stale) {
+      evict(i);
+    }
+    // Con el presupuesto reducido mientras estaba fijada
+    makeRoom(0);
+    return;
+  }
+}
+
+void FrameCache::invalidate(const char* filename) {
+  Guard guard(*this);
+  String path = normalizePath(filename);
+  for (size_t i = 0; i < entries.size(); ) {
+    if (strcmp(entries[i].filename, path.c_str()) != 0) {
+      i++;
+    } else if (entries[i].pins > 0) {
+      entries[i].stale = true;
+      i++;
+    } else {
+      evict(i);
+    }
+  }
+}
+
+size_t FrameCache::evictUnpinned() {
+  Guard guard(*this);
+  size_t freed = 0;
+  for (size_t i = 0; i < entries.size(); ) {
+    if (entries[i].pins > 0) {
+      i++;
+      continue;
+    }
+    freed += entries[i].frame.bytes;
+    evict(i);
+  }
+  return freed;
+}
+
+size_t FrameCache::getImageCount() {
+  Guard guard(*this);
+  return entries.size();
+}
+
+size_t FrameCache::getUsedBytes() {
+  Guard guard(*this);
+  return usedBytes;
+}
+
+uint32_t FrameCache::getHits() {
+  Guard guard(*this);
+  return hits;
+}
+
+uint32_t FrameCache::getMisses() {
+  Guard guard(*this);
+  return misses;
+}
+
+uint32_t FrameCache::getEvictions() {
+  Guard guard(*this);
+  return evictions;
+}
+
+int FrameCache::findEntry(const char* path, POVOrientation orientation, POVResampleMode resample,
+                          uint16_t numLeds) {
+  for (size_t i = 0; i < entries.size(); i++) {
+    const Entry& entry = entries[i];
+    if (!entry.stale && entry.orientation == orientation && entry.resample == resample &&
+        entry.numLeds == numLeds && strcmp(entry.filename, path) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+void FrameCache::evict(size_t index) {
+  usedBytes -= entries[index].frame.bytes;
+  free(entries[index].frame.pixels);
+  entries.erase(entries.begin() + index);
+  evictions++;
+}
+
+// Descarta las menos usadas (sin fijar) hasta que quepan bytes más
+bool FrameCache::makeRoom(size_t bytes) {
+  while (usedBytes + bytes > budget) {
+    int oldest = -1;
+    for (size_t i = 0; i < entries.size(); i++) {
+      if (entries[i].pins == 0 && (oldest < 0 || entries[i].lastUse < entries[oldest].lastUse)) {
+        oldest = i;
+      }
+    }
+    if (oldest < 0) {
+      return false;
+    }
+    evict(oldest);
+  }
+  return true;
+}
+
+// Instancia global
+FrameCache frameCache;
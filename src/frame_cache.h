@@ -0,0 +1,106 @@
+#ifndef FRAME_CACHE_H
+#define FRAME_CACHE_H
+
+#include <Arduino.h>
+#include <FastLED.h>
+#include <vector>
+#include "config.h"
+#include "image_parser.h"
+
+#if defined(ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#endif
+
+// Imagen decodificada tal como la usa POVEngine como frameBuffer
+struct CachedFrame {
+  CRGB* pixels;                  // Reservado con allocFrame(): se libera con free()
+  size_t bytes;
+  uint16_t lineLength;           // Píxeles por línea
+  bool resampled;                // Líneas ya remuestreadas a numLeds
+  ImageInfo info;
+  std::vector<uint16_t> delays;  // ms por fotograma (vacío en imágenes fijas)
+};
+
+// Caché LRU de imágenes ya decodificadas (PSRAM): volver a una imagen reciente
+// no abre el archivo ni decodifica nada. La clave es la imagen (ruta y hash
+// del catálogo) y todo lo que cambia el buffer: orientación, remuestreo y
+// número de LEDs. El presupuesto es en bytes; al pasarse se descartan las
+// menos usadas, nunca las que tiene fijadas POVEngine (la que se reproduce).
+// Sin PSRAM el presupuesto es 0: el heap interno es para WiFi y el servidor.
+// Los handlers web (tarea async_tcp) invalidan y cambian el presupuesto
+// mientras loop() toma y suelta imágenes: en ESP32 cada método público se
+// ejecuta con el mutex de la caché tomado.
+class FrameCache {
+private:
+  struct Entry {
+    char filename[64];
+    uint64_t hash;
+    POVOrientation orientation;
+    POVResampleMode resample;
+    uint16_t numLeds;
+    CachedFrame frame;
+    uint32_t lastUse;
+    uint8_t pins;   // acquire()/insert() sin su release()
+    bool stale;     // Imagen cambiada o borrada: fuera al soltarla
+  };
+
+  std::vector<Entry> entries;
+  size_t budget;
+  size_t usedBytes;
+  uint32_t useCounter;
+  uint32_t hits;
+  uint32_t misses;
+  uint32_t evictions;
+#if defined(ESP32)
+  SemaphoreHandle_t mutex;
+#endif
+
+  // Mutex tomado mientras vive (nada fuera de ESP32)
+  struct Guard {
+    FrameCache& cache;
+    explicit Guard(FrameCache& cache);
+    ~Guard();
+  };
+
+public:
+  FrameCache();
+  ~FrameCache();
+
+  // Bytes de PSRAM para la caché (0 la desactiva); descarta lo que sobre
+  void setBudget(size_t bytes);
+  size_t getBudget();
+
+  // Copia de la imagen decodificada si está con esa disposición y su hash
+  // sigue siendo el del catálogo; el buffer queda fijado hasta release()
+  bool acquire(const char* filename, POVOrientation orientation, POVResampleMode resample,
+               uint16_t numLeds, CachedFrame& frame);
+
+  // Entrega a la caché un buffer recién decodificado: si lo acepta pasa a ser
+  // suyo y queda fijado como con acquire()
+  bool insert(const char* filename, POVOrientation orientation, POVResampleMode resample,
+              uint16_t numLeds, const CachedFrame& frame);
+
+  void release(const CRGB* pixels);
+
+  // Imagen subida de nuevo o borrada: fuera todas sus versiones
+  void invalidate(const char* filename);
+
+  // Libera todo lo que no esté fijado (p. ej. para decodificar algo grande)
+  size_t evictUnpinned();
+
+  size_t getImageCount();
+  size_t getUsedBytes();
+  uint32_t getHits();
+  uint32_t getMisses();
+  uint32_t getEvictions();
+
+private:
+  int findEntry(const char* path, POVOrientation orientation, POVResampleMode resample, uint16_t numLeds);
+  void evict(size_t index);
+  bool makeRoom(size_t bytes);
+};
+
+extern FrameCache frameCache;
+
+#endif
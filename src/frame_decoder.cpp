@@ -0,0 +1,189 @@
+#include "frame_decoder.h"
+
+static CRGB* tryAllocFrame(size_t bytes) {
+#if defined(BOARD_HAS_PSRAM)
+  if (psramFound()) {
+    return (CRGB*)ps_malloc(bytes);
+  }
+#endif
+#if defined(POV_HOST_BUILD)
+  // En el PC (test/) no hay que guardar margen para nadie
+  return (CRGB*)malloc(bytes);
+#else
+#if defined(ESP8266) || defined(ARDUINO_ARCH_ESP8266)
+  size_t maxBlock = ESP.getMaxFreeBlockSize();
+#else
+  size_t maxBlock = ESP.getMaxAllocHeap();
+#endif
+  if (bytes + FRAME_BUFFER_HEAP_RESERVE > maxBlock) {
+    return nullptr;
+  }
+  return (CRGB*)malloc(bytes);
+#endif
+}
+
+CRGB* allocFrame(size_t pixels) {
+  size_t bytes = pixels * sizeof(CRGB);
+  CRGB* frame = tryAllocFrame(bytes);
+  // Sin memoria: las imágenes de la caché que no se reproducen ceden su sitio
+  if (frame == nullptr && frameCache.evictUnpinned() > 0) {
+    frame = tryAllocFrame(bytes);
+  }
+  return frame;
+}
+
+// Prepara la decodificación de una imagen completa con la orientación, el
+// remuestreo y los LEDs indicados: abre el archivo y reserva el buffer
+bool FrameDecode::begin(const char* path, const ImageInfo& info, POVOrientation orientation,
+                        POVResampleMode resampleMode, uint16_t numLeds) {
+  this->orientation = orientation;
+  nativeLength = (orientation == POV_VERTICAL) ? info.height : info.width;
+  // Líneas de todos los fotogramas, uno tras otro
+  size_t lineCount = (size_t)((orientation == POV_VERTICAL) ? info.width : info.height) * info.frameCount;
+
+  // El remuestreo suave se aplica aquí, una vez por imagen: las líneas quedan
+  // con exactamente numLeds píxeles y el bucle por columna es una copia directa
+  resample = (resampleMode == POV_RESAMPLE_SMOOTH && numLeds > 0 && nativeLength != numLeds &&
+              resampler->configure(nativeLength, numLeds));
+
+  // BMP/RGB565 se leen por bloques de filas; .pov columna a columna
+  rowDecode = parser->isRowMajor(info);
+  resampleColumns = resample && orientation == POV_VERTICAL && !rowDecode;
+  next = 0;
+  total = rowDecode ? info.height : (uint32_t)info.width * info.frameCount;
+  frame.info = info;
+  frame.lineLength = resampleColumns ? numLeds : nativeLength;
+  frame.resampled = resampleColumns;
+  frame.bytes = lineCount * frame.lineLength * sizeof(CRGB);
+
+  file = LittleFS.open(path, "r");
+  if (!file) {
+    return false;
+  }
+
+  frame.pixels = allocFrame(lineCount * frame.lineLength);
+  if (frame.pixels == nullptr) {
+    file.close();
+    return false;
+  }
+  return true;
+}
+
+// Decodifica hasta units columnas (.pov) o bloques de filas (BMP/RGB565)
+bool FrameDecode::step(uint32_t units) {
+  bool ok = true;
+  for (uint32_t i = 0; ok && i < units && next < total; i++) {
+    ok = rowDecode ? decodeRows() : decodeColumn();
+  }
+  return ok;
+}
+
+// Cierra el archivo y, sin remuestreo por columna, remuestrea las líneas con
+// la imagen completa
+bool FrameDecode::finish() {
+  file.close();
+  if (!resample || resampleColumns) {
+    return true;
+  }
+
+  uint16_t numLeds = resampler->getTargetLength();
+  size_t lineCount = frame.bytes / sizeof(CRGB) / nativeLength;
+  CRGB* scaled = allocFrame(lineCount * numLeds);
+  if (scaled == nullptr) {
+    Serial.println("AVISO: Sin memoria para remuestrear, usando escalado simple");
+    return true;
+  }
+  for (size_t i = 0; i < lineCount; i++) {
+    resampler->resample(frame.pixels + i * nativeLength, scaled + i * numLeds);
+  }
+  free(frame.pixels);
+  frame.pixels = scaled;
+  frame.lineLength = numLeds;
+  frame.resampled = true;
+  frame.bytes = lineCount * numLeds * sizeof(CRGB);
+  return true;
+}
+
+void FrameDecode::abort() {
+  if (file) {
+    file.close();
+  }
+  free(frame.pixels);
+  frame.pixels = nullptr;
+}
+
+// Una columna (.pov): en vertical se decodifica en su sitio (o se remuestrea a
+// numLeds); en horizontal se reparte por filas (row-major). Los fotogramas de
+// una animación van seguidos, cada uno con sus líneas
+bool FrameDecode::decodeColumn() {
+  const ImageInfo& info = frame.info;
+  uint16_t width = info.width;
+  uint16_t height = info.height;
+  uint16_t frameIndex = next / width;
+  uint16_t x = next % width;
+
+  bool inPlace = (orientation == POV_VERTICAL && !resampleColumns);
+  CRGB* column = nullptr;
+  if (!inPlace) {
+    column = new CRGB[height];
+    if (column == nullptr) {
+      return false;
+    }
+  }
+
+  CRGB* dest = inPlace ? frame.pixels + (size_t)next * height : column;
+  if (!parser->getFrameColumn(file, info, frameIndex, x, dest, height)) {
+    Serial.printf("Error: No se pudo decodificar columna %d\n", x);
+    delete[] column;
+    return false;
+  }
+  if (resampleColumns) {
+    resampler->resample(column, frame.pixels + (size_t)next * frame.lineLength);
+  } else if (orientation == POV_HORIZONTAL) {
+    CRGB* rows = frame.pixels + (size_t)frameIndex * height * width;
+    for (uint16_t y = 0; y < height; y++) {
+      rows[(size_t)y * width + x] = column[y];
+    }
+  }
+
+  delete[] column;
+  next++;
+  return true;
+}
+
+// Un bloque de filas (BMP/RGB565): en horizontal las filas van directas al
+// buffer; en vertical se trasponen a column-major
+bool FrameDecode::decodeRows() {
+  const ImageInfo& info = frame.info;
+  uint16_t width = info.width;
+  uint16_t height = info.height;
+  uint16_t y0 = next;
+  uint16_t count = min((uint16_t)(height - y0), parser->getRowBatch(info));
+
+  CRGB* rows = nullptr;
+  if (orientation == POV_VERTICAL) {
+    rows = new CRGB[(size_t)count * width];
+    if (rows == nullptr) {
+      return false;
+    }
+  }
+
+  CRGB* dest = (rows != nullptr) ? rows : frame.pixels + (size_t)y0 * width;
+  if (!parser->getRows(file, info, y0, count, dest)) {
+    Serial.printf("Error: No se pudo decodificar fila %d\n", y0);
+    delete[] rows;
+    return false;
+  }
+  if (rows != nullptr) {
+    for (uint16_t i = 0; i < count; i++) {
+      const CRGB* row = rows + (size_t)i * width;
+      for (uint16_t x = 0; x < width; x++) {
+        frame.pixels[(size_t)x * height + y0 + i] = row[x];
+      }
+    }
+  }
+
+  delete[] rows;
+  next += count;
+  return true;
+}
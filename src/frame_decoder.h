@@ -0,0 +1,54 @@
+#ifndef FRAME_DECODER_H
+#define FRAME_DECODER_H
+
+#include <Arduino.h>
+#include <FastLED.h>
+#include <LittleFS.h>
+#include "config.h"
+#include "image_parser.h"
+#include "image_scaler.h"
+#include "frame_cache.h"
+
+// Reserva memoria para una imagen decodificada: PSRAM si la placa la tiene,
+// si no heap interno dejando margen para WiFi y servidor web. Sin memoria,
+// las imágenes de la caché que no se reproducen ceden su sitio. Se libera
+// con free()
+CRGB* allocFrame(size_t pixels);
+
+// Decodificación de una imagen completa por partes: POVEngine::decodeFrame()
+// la hace de una vez y la precarga de la siguiente imagen unas columnas en
+// cada update(). Vertical: column-major, una línea por columna; horizontal:
+// row-major. Con remuestreo suave las líneas quedan con numLeds píxeles.
+// No depende del motor, así que se prueba tal cual en el PC (test/).
+struct FrameDecode {
+  File file;
+  CachedFrame frame;          // frame.pixels: el buffer que se va llenando
+  ImageParser* parser;        // Cada decodificación en curso necesita el suyo
+  LineResampler* resampler;
+  POVOrientation orientation;
+  uint16_t nativeLength;      // Píxeles por línea en la imagen
+  bool rowDecode;             // BMP/RGB565: por bloques de filas
+  bool resample;              // Remuestreo suave a numLeds
+  bool resampleColumns;       // ... columna a columna (si no, al terminar)
+  uint32_t next;              // Siguiente columna (.pov, todos los fotogramas) o fila
+  uint32_t total;
+
+  FrameDecode() : parser(nullptr), resampler(nullptr), orientation(POV_VERTICAL), nativeLength(0),
+                  rowDecode(false), resample(false), resampleColumns(false), next(0), total(0) {
+    frame.pixels = nullptr;
+    frame.bytes = 0;
+  }
+
+  bool begin(const char* path, const ImageInfo& info, POVOrientation orientation,
+             POVResampleMode resampleMode, uint16_t numLeds);
+  bool step(uint32_t units);
+  bool isDone() const { return next >= total; }
+  bool finish();
+  void abort();
+
+private:
+  bool decodeColumn();
+  bool decodeRows();
+};
+
+#endif
@@ -2,6 +2,7 @@
 #include "led_controller.h"
 #include "pov_engine.h"
 #include "effects.h"
+#include "playlist.h"
 
 extern Config config;
 
@@ -116,6 +117,7 @@ void HAIntegration::handleCommand(const char* payload) {
     // Iniciar efecto rainbow por defecto
     effects.rainbow(10);
   } else if (command == "OFF") {
+    playlist.stop();
     povEngine.stop();
     effects.stop();
   }
@@ -131,6 +133,10 @@ void HAIntegration::handleEffectCommand(const char* payload) {
   String effect = String(payload);
   effect.toLowerCase();
 
+  // "pov" sigue con la lista de reproducción si estaba activa
+  if (effect != "pov") {
+    playlist.stop();
+  }
   povEngine.stop();
 
   if (effect == "pov") {
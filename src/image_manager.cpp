@@ -1,4 +1,6 @@
 #include "image_manager.h"
+#include <algorithm>
+#include "image_scaler.h"
 
 ImageManager::ImageManager() : listLoaded(false) {
 }
@@ -16,6 +18,18 @@ static String normalizeFilename(const char* name) {
   return fname;
 }
 
+// Miniatura del archivo path (ruta completa)
+static String thumbnailPath(const char* path) {
+  return String(path) + THUMB_EXTENSION;
+}
+
+static void removeThumbnail(const char* path) {
+  String thumbPath = thumbnailPath(path);
+  if (LittleFS.exists(thumbPath)) {
+    LittleFS.remove(thumbPath);
+  }
+}
+
 bool ImageManager::init() {
 #if defined(ESP8266) || defined(ARDUINO_ARCH_ESP8266)
   if (!LittleFS.begin()) {
@@ -42,41 +56,342 @@ std::vector<ImageInfo> ImageManager::listImages() {
   if (!listLoaded) {
     loadImageList();
   }
-  return imageList;
+  std::vector<ImageInfo> images;
+  images.reserve(imageList.size());
+  for (const ImageEntry& entry : imageList) {
+    images.push_back(entry.info);
+  }
+  return images;
 }
 
 bool ImageManager::deleteImage(const char* filename) {
   String cleanName = normalizeFilename(filename);
   String fullPath = String(IMAGES_DIR) + "/" + cleanName;
 
-  if (!LittleFS.exists(fullPath)) {
+  int index = findImage(fullPath.c_str());
+  bool alias = index >= 0 && imageList[index].alias;
+  if (!alias && !LittleFS.exists(fullPath)) {
     Serial.printf("Error: Imagen %s no existe\n", filename);
     return false;
   }
 
-  if (LittleFS.remove(fullPath)) {
-    Serial.printf("Imagen %s eliminada\n", filename);
-    refreshList();
-    return true;
+  // Si otros nombres comparten el contenido, el archivo pasa al primero de
+  // ellos; un alias no tiene archivo que borrar
+  if (!alias && index >= 0 && !handOver(index)) {
+    return false;
+  }
+  if (index < 0 || !imageList[index].alias) {
+    if (!LittleFS.remove(fullPath)) {
+      Serial.printf("Error: No se pudo eliminar %s\n", filename);
+      return false;
+    }
+    removeThumbnail(fullPath.c_str());
   }
 
-  Serial.printf("Error: No se pudo eliminar %s\n", filename);
-  return false;
+  Serial.printf("Imagen %s eliminada\n", filename);
+  if (index >= 0) {
+    imageList.erase(imageList.begin() + index);
+    saveCatalog();
+  }
+  return true;
 }
 
 bool ImageManager::getImageInfo(const char* filename, ImageInfo& info) {
   String cleanName = normalizeFilename(filename);
   String fullPath = String(IMAGES_DIR) + "/" + cleanName;
 
-  if (!LittleFS.exists(fullPath)) {
+  if (!imageExists(filename)) {
     Serial.printf("Error: Imagen %s no existe\n", filename);
     info.valid = false;
     return false;
   }
 
+  // El catálogo ya tiene la disposición parseada
+  int index = listLoaded ? findImage(fullPath.c_str()) : -1;
+  if (index >= 0) {
+    info = imageList[index].info;
+    return true;
+  }
+
   return imageParser.parseImageInfo(fullPath.c_str(), info);
 }
 
+bool ImageManager::getImageHash(const char* filename, uint64_t& hash) {
+  String fullPath = String(IMAGES_DIR) + "/" + normalizeFilename(filename);
+  if (!listLoaded) {
+    loadImageList();
+  }
+  int index = findImage(fullPath.c_str());
+  if (index < 0) {
+    return false;
+  }
+  hash = imageList[index].hash;
+  return true;
+}
+
+bool ImageManager::getSourceHash(const char* filename, uint64_t& hash) {
+  String fullPath = String(IMAGES_DIR) + "/" + normalizeFilename(filename);
+  if (!listLoaded) {
+    loadImageList();
+  }
+  int index = findImage(fullPath.c_str());
+  if (index < 0) {
+    return false;
+  }
+  hash = imageList[index].sourceHash;
+  return true;
+}
+
+bool ImageManager::addImage(const char* filename) {
+  String fullPath = String(IMAGES_DIR) + "/" + normalizeFilename(filename);
+
+  // Sin lista todavía: al cargarla se contrasta con el directorio, que ya la incluye
+  if (!listLoaded) {
+    loadImageList();
+    return findImage(fullPath.c_str()) >= 0;
+  }
+
+  ImageEntry entry;
+  if (!readImage(fullPath.c_str(), entry)) {
+    removeEntry(fullPath.c_str());
+    return false;
+  }
+  return storeEntry(entry);
+}
+
+bool ImageManager::addImage(const char* filename, uint64_t hash, uint64_t sourceHash) {
+  String fullPath = String(IMAGES_DIR) + "/" + normalizeFilename(filename);
+
+  if (!listLoaded) {
+    loadImageList();
+    return findImage(fullPath.c_str()) >= 0;
+  }
+
+  // Solo el header: el hash ya se calculó mientras se escribía
+  ImageEntry entry;
+  if (!imageParser.parseImageInfo(fullPath.c_str(), entry.info)) {
+    removeEntry(fullPath.c_str());
+    return false;
+  }
+  entry.hash = hash;
+  entry.sourceHash = sourceHash;
+  entry.alias = false;
+  return storeEntry(entry);
+}
+
+bool ImageManager::linkImage(const char* filename, uint64_t hash, String& linkedPath) {
+  if (!listLoaded) {
+    loadImageList();
+  }
+  String ownerPath;
+  if (!findContent(hash, ownerPath)) {
+    Serial.printf("Error: Ninguna imagen con el contenido de %s\n", filename);
+    return false;
+  }
+
+  // Con la extensión del contenido, como al subir: un BMP queda como .pov
+  String name = normalizeFilename(filename);
+  int dot = name.lastIndexOf('.');
+  if (dot >= 0) {
+    name = name.substring(0, dot);
+  }
+  linkedPath = String(IMAGES_DIR) + "/" + name + ownerPath.substring(ownerPath.lastIndexOf('.'));
+  if (name.length() == 0 || linkedPath.length() >= sizeof(CatalogRecord::filename)) {
+    Serial.printf("Error: Nombre no válido: %s\n", filename);
+    return false;
+  }
+  if (linkedPath == ownerPath) {
+    return true;
+  }
+
+  // Lo que hubiera con ese nombre se sustituye, como al subir
+  if (!detachImage(linkedPath.c_str())) {
+    return false;
+  }
+  int index = findImage(linkedPath.c_str());
+  if ((index < 0 || !imageList[index].alias) && LittleFS.exists(linkedPath) && !LittleFS.remove(linkedPath)) {
+    Serial.printf("Error: No se pudo eliminar %s\n", linkedPath.c_str());
+    return false;
+  }
+
+  ImageEntry entry = imageList[findImage(ownerPath.c_str())];
+  strlcpy(entry.info.filename, linkedPath.c_str(), sizeof(entry.info.filename));
+  entry.alias = true;
+  Serial.printf("Imagen %s: mismo contenido que %s\n", linkedPath.c_str(), ownerPath.c_str());
+  return storeEntry(entry);
+}
+
+String ImageManager::getImagePath(const char* filename) {
+  String fullPath = String(IMAGES_DIR) + "/" + normalizeFilename(filename);
+  if (!listLoaded) {
+    loadImageList();
+  }
+  int index = findImage(fullPath.c_str());
+  if (index >= 0 && imageList[index].alias) {
+    int owner = findOwner(imageList[index].hash);
+    if (owner >= 0) {
+      return String(imageList[owner].info.filename);
+    }
+  }
+  return fullPath;
+}
+
+bool ImageManager::findContent(uint64_t hash, String& path) {
+  if (!listLoaded) {
+    loadImageList();
+  }
+  for (const ImageEntry& entry : imageList) {
+    if (!entry.alias && (entry.hash == hash || entry.sourceHash == hash)) {
+      path = entry.info.filename;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool ImageManager::detachImage(const char* filename) {
+  String fullPath = String(IMAGES_DIR) + "/" + normalizeFilename(filename);
+  if (!listLoaded) {
+    loadImageList();
+  }
+  int index = findImage(fullPath.c_str());
+  if (index < 0 || imageList[index].alias) {
+    return true;
+  }
+  if (!handOver(index)) {
+    return false;
+  }
+  // Hasta que se escriba el archivo nuevo, el nombre sigue con el contenido anterior
+  return !imageList[index].alias || saveCatalog();
+}
+
+// La imagen se recorre en su orden de almacenamiento (columnas .pov, filas
+// BMP/RGB565): cada línea se reduce con LineResampler y las que caen en la
+// misma columna o fila de la miniatura se promedian. En RAM solo hay un
+// bloque de líneas y la miniatura
+bool ImageManager::makeThumbnail(const char* filename) {
+  String path = getImagePath(filename);
+  int index = findImage(path.c_str());
+  if (index < 0) {
+    Serial.printf("Error: Imagen %s no existe\n", filename);
+    return false;
+  }
+
+  ImageInfo info = imageList[index].info;
+  // Lado mayor THUMB_MAX_SIZE con la proporción de la imagen, sin ampliar
+  uint16_t longest = max(info.width, info.height);
+  uint16_t side = min(longest, (uint16_t)THUMB_MAX_SIZE);
+  uint16_t thumbWidth = max((uint32_t)1, ((uint32_t)info.width * side + longest / 2) / longest);
+  uint16_t thumbHeight = max((uint32_t)1, ((uint32_t)info.height * side + longest / 2) / longest);
+
+  // Su propio parser: el de POVEngine conserva la tabla de la imagen en pantalla
+  ImageParser parser;
+  bool columns = !parser.isRowMajor(info);
+  uint16_t lineLength = columns ? info.height : info.width;
+  uint16_t lineCount = columns ? info.width : info.height;
+  uint16_t targetLength = columns ? thumbHeight : thumbWidth;
+  uint16_t targetCount = columns ? thumbWidth : thumbHeight;
+  uint16_t batch = columns ? 1 : parser.getRowBatch(info);
+
+  LineResampler resampler;
+  File file = LittleFS.open(path, "r");
+  CRGB* lines = new CRGB[(uint32_t)batch * lineLength];
+  CRGB* reduced = new CRGB[targetLength];
+  uint32_t* sums = new uint32_t[(uint32_t)targetLength * 3];
+  uint32_t rowBytes = ((uint32_t)thumbWidth * 3 + 3) & ~3UL;
+  uint8_t* pixels = new uint8_t[rowBytes * thumbHeight];  // Filas BMP: BGR, de abajo a arriba
+
+  bool ok = file && lines != nullptr && reduced != nullptr && sums != nullptr && pixels != nullptr &&
+            resampler.configure(lineLength, targetLength);
+  if (ok) {
+    memset(sums, 0, (uint32_t)targetLength * 3 * sizeof(uint32_t));
+    memset(pixels, 0, rowBytes * thumbHeight);
+  }
+
+  uint16_t summed = 0;
+  for (uint16_t first = 0; ok && first < lineCount; first += batch) {
+    uint16_t count = min((uint16_t)(lineCount - first), batch);
+    // Las animaciones, con su primer fotograma
+    ok = columns ? parser.getFrameColumn(file, info, 0, first, lines, lineLength)
+                 : parser.getRows(file, info, first, count, lines);
+
+    for (uint16_t i = 0; ok && i < count; i++) {
+      uint32_t line = first + i;
+      resampler.resample(lines + (uint32_t)i * lineLength, reduced);
+      for (uint16_t k = 0; k < targetLength; k++) {
+        sums[k * 3] += reduced[k].r;
+        sums[k * 3 + 1] += reduced[k].g;
+        sums[k * 3 + 2] += reduced[k].b;
+      }
+      summed++;
+
+      uint16_t target = line * targetCount / lineCount;
+      if (line + 1 < lineCount && (line + 1) * targetCount / lineCount == target) {
+        continue;
+      }
+      for (uint16_t k = 0; k < targetLength; k++) {
+        uint16_t x = columns ? target : k;
+        uint16_t y = columns ? k : target;
+        uint8_t* out = pixels + (uint32_t)(thumbHeight - 1 - y) * rowBytes + (uint32_t)x * 3;
+        out[0] = sums[k * 3 + 2] / summed;
+        out[1] = sums[k * 3 + 1] / summed;
+        out[2] = sums[k * 3] / summed;
+      }
+      memset(sums, 0, (uint32_t)targetLength * 3 * sizeof(uint32_t));
+      summed = 0;
+    }
+  }
+  if (file) {
+    file.close();
+  }
+
+  String thumbPath = thumbnailPath(path.c_str());
+  if (ok) {
+    BMPHeader header;
+    BMPInfoHeader infoHeader;
+    memset(&header, 0, sizeof(header));
+    memset(&infoHeader, 0, sizeof(infoHeader));
+    header.signature = 0x4D42;
+    header.dataOffset = sizeof(header) + sizeof(infoHeader);
+    header.fileSize = header.dataOffset + rowBytes * thumbHeight;
+    infoHeader.headerSize = sizeof(infoHeader);
+    infoHeader.width = thumbWidth;
+    infoHeader.height = thumbHeight;
+    infoHeader.planes = 1;
+    infoHeader.bitsPerPixel = 24;
+    infoHeader.imageSize = rowBytes * thumbHeight;
+
+    File thumb = LittleFS.open(thumbPath, "w");
+    ok = thumb && thumb.write((const uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+         thumb.write((const uint8_t*)&infoHeader, sizeof(infoHeader)) == sizeof(infoHeader) &&
+         thumb.write(pixels, rowBytes * thumbHeight) == rowBytes * thumbHeight;
+    if (thumb) {
+      thumb.close();
+    }
+  }
+
+  delete[] lines;
+  delete[] reduced;
+  delete[] sums;
+  delete[] pixels;
+
+  if (!ok) {
+    Serial.printf("Error: No se pudo crear la miniatura de %s\n", path.c_str());
+    removeThumbnail(path.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool ImageManager::getThumbnail(const char* filename, String& path) {
+  String imagePath = getImagePath(filename);
+  if (findImage(imagePath.c_str()) < 0) {
+    return false;
+  }
+  path = thumbnailPath(imagePath.c_str());
+  return LittleFS.exists(path) || makeThumbnail(filename);
+}
+
 size_t ImageManager::getFreeSpace() {
   size_t total = 0;
   size_t used = 0;
@@ -120,36 +435,35 @@ size_t ImageManager::getUsedSpace() {
 }
 
 bool ImageManager::imageExists(const char* filename) {
-  String cleanName = normalizeFilename(filename);
-  String fullPath = String(IMAGES_DIR) + "/" + cleanName;
-  return LittleFS.exists(fullPath);
+  return LittleFS.exists(getImagePath(filename));
 }
 
 void ImageManager::refreshList() {
   loadImageList();
 }
 
+// Lista el directorio y la contrasta con el catálogo: las imágenes con el
+// mismo nombre y tamaño se reutilizan sin abrirlas; solo se parsean (y se
+// calcula su hash) las nuevas o modificadas. Los alias siguen mientras esté
+// el archivo con su contenido
 void ImageManager::loadImageList() {
-  imageList.clear();
+  bool changed = false;
+  if (!listLoaded && !loadCatalog()) {
+    imageList.clear();
+    changed = true;
+  }
+
+  std::vector<ImageEntry> current;
+  current.reserve(imageList.size());
+  uint16_t reused = 0;
+  uint16_t parsed = 0;
+  std::vector<String> thumbnails;
 
 #if defined(ESP8266) || defined(ARDUINO_ARCH_ESP8266)
   Dir dir = LittleFS.openDir(IMAGES_DIR);
-  bool ok = true;
   while (dir.next()) {
     String name = dir.fileName();
-    if (isImageFile(name.c_str())) {
-      ImageInfo info;
-      String cleanName = normalizeFilename(name.c_str());
-      String fullPath = String(IMAGES_DIR) + "/" + cleanName;
-      if (imageParser.parseImageInfo(fullPath.c_str(), info)) {
-        imageList.push_back(info);
-      }
-    }
-  }
-  listLoaded = ok;
-  if (!ok) {
-    Serial.println("Error: No se pudo leer directorio de imágenes");
-  }
+    uint32_t size = dir.fileSize();
 #else
   File root = LittleFS.open(IMAGES_DIR);
   if (!root || !root.isDirectory()) {
@@ -158,29 +472,331 @@ void ImageManager::loadImageList() {
     return;
   }
 
-  File file = root.openNextFile();
-  while (file) {
-    if (!file.isDirectory() && isImageFile(file.name())) {
-      ImageInfo info;
-      String cleanName = normalizeFilename(file.name());
-      String fullPath = String(IMAGES_DIR) + "/" + cleanName;
+  for (File file = root.openNextFile(); file; file = root.openNextFile()) {
+    if (file.isDirectory()) {
+      continue;
+    }
+    String name = file.name();
+    uint32_t size = file.size();
+    file.close();
+#endif
+    if (isThumbnailFile(name.c_str())) {
+      thumbnails.push_back(String(IMAGES_DIR) + "/" + normalizeFilename(name.c_str()));
+      continue;
+    }
+    if (!isImageFile(name.c_str())) {
+      continue;
+    }
+    if (current.size() >= CATALOG_MAX_IMAGES) {
+      Serial.printf("Aviso: Más de %d imágenes, el resto no se lista\n", CATALOG_MAX_IMAGES);
+      break;
+    }
+
+    String fullPath = String(IMAGES_DIR) + "/" + normalizeFilename(name.c_str());
+    int index = findImage(fullPath.c_str());
+    if (index >= 0 && !imageList[index].alias && imageList[index].info.fileSize == size) {
+      current.push_back(imageList[index]);
+      reused++;
+      continue;
+    }
 
-      if (imageParser.parseImageInfo(fullPath.c_str(), info)) {
-        imageList.push_back(info);
-      }
+    // Los archivos que no son imágenes válidas no entran en el catálogo (y
+    // se vuelven a parsear en cada arranque). Uno cambiado por fuera de la
+    // API tendrá otra miniatura cuando se pida
+    removeThumbnail(fullPath.c_str());
+    ImageEntry entry;
+    if (readImage(fullPath.c_str(), entry)) {
+      current.push_back(entry);
+      changed = true;
     }
-    file = root.openNextFile();
+    parsed++;
   }
 
+  std::sort(current.begin(), current.end(), [](const ImageEntry& a, const ImageEntry& b) {
+    return strcmp(a.info.filename, b.info.filename) < 0;
+  });
+  imageList.swap(current);
   listLoaded = true;
-  Serial.printf("Imágenes cargadas: %d\n", imageList.size());
-#endif
+
+  for (const ImageEntry& entry : current) {
+    if (entry.alias && imageList.size() < CATALOG_MAX_IMAGES && findImage(entry.info.filename) < 0 &&
+        findOwner(entry.hash) >= 0) {
+      imageList.insert(imageList.begin() + lowerBound(entry.info.filename), entry);
+      reused++;
+    }
+  }
+
+  // Algún registro del catálogo ya no está en el directorio
+  if (reused != current.size()) {
+    changed = true;
+  }
+
+  // Miniaturas de archivos que ya no están
+  for (const String& thumbPath : thumbnails) {
+    String imagePath = thumbPath.substring(0, thumbPath.length() - strlen(THUMB_EXTENSION));
+    int index = findImage(imagePath.c_str());
+    if (index < 0 || imageList[index].alias) {
+      LittleFS.remove(thumbPath);
+    }
+  }
+
+  if (changed) {
+    saveCatalog();
+  }
+  Serial.printf("Imágenes cargadas: %d (%d parseadas)\n", imageList.size(), parsed);
+}
+
+size_t ImageManager::lowerBound(const char* path) {
+  auto it = std::lower_bound(imageList.begin(), imageList.end(), path,
+                             [](const ImageEntry& entry, const char* name) {
+                               return strcmp(entry.info.filename, name) < 0;
+                             });
+  return it - imageList.begin();
+}
+
+int ImageManager::findImage(const char* path) {
+  size_t index = lowerBound(path);
+  if (index < imageList.size() && strcmp(imageList[index].info.filename, path) == 0) {
+    return index;
+  }
+  return -1;
+}
+
+// Parsea el header y recorre el archivo entero para el hash del contenido
+bool ImageManager::readImage(const char* path, ImageEntry& entry) {
+  if (!imageParser.parseImageInfo(path, entry.info)) {
+    return false;
+  }
+
+  File file = LittleFS.open(path, "r");
+  if (!file) {
+    return false;
+  }
+  uint8_t buffer[512];
+  uint64_t hash = CONTENT_HASH_INIT;
+  size_t n;
+  while ((n = file.read(buffer, sizeof(buffer))) > 0) {
+    hash = contentHash(buffer, n, hash);
+  }
+  file.close();
+  entry.hash = hash;
+  entry.sourceHash = hash;
+  entry.alias = false;
+  return true;
+}
+
+// Imagen con archivo propio y ese contenido
+int ImageManager::findOwner(uint64_t hash) {
+  for (size_t i = 0; i < imageList.size(); i++) {
+    if (!imageList[i].alias && imageList[i].hash == hash) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+// El archivo de imageList[index] pasa al primer alias de su contenido, que
+// deja de serlo, e imageList[index] queda como alias. Sin alias no cambia nada
+bool ImageManager::handOver(size_t index) {
+  ImageEntry& owner = imageList[index];
+  for (ImageEntry& heir : imageList) {
+    if (!heir.alias || heir.hash != owner.hash) {
+      continue;
+    }
+    if (!LittleFS.rename(owner.info.filename, heir.info.filename)) {
+      Serial.printf("Error: No se pudo mover %s a %s\n", owner.info.filename, heir.info.filename);
+      return false;
+    }
+    // La miniatura acompaña al archivo; si no se puede mover se vuelve a crear
+    String thumbPath = thumbnailPath(owner.info.filename);
+    if (LittleFS.exists(thumbPath) &&
+        !LittleFS.rename(thumbPath, thumbnailPath(heir.info.filename))) {
+      LittleFS.remove(thumbPath);
+    }
+    heir.alias = false;
+    owner.alias = true;
+    return true;
+  }
+  return true;
+}
+
+// Entrada de una imagen recién escrita. Con el mismo contenido (hash y
+// tamaño) que otra el archivo sobra: el nombre queda como alias
+bool ImageManager::storeEntry(ImageEntry& entry) {
+  const char* path = entry.info.filename;
+  int index = findImage(path);
+  if (index < 0 && imageList.size() >= CATALOG_MAX_IMAGES) {
+    Serial.printf("Error: Catálogo lleno (%d imágenes)\n", CATALOG_MAX_IMAGES);
+    return false;
+  }
+
+  // El archivo es nuevo (o no hay): la miniatura que tuviera ya no sirve
+  removeThumbnail(path);
+
+  int owner = findOwner(entry.hash);
+  if (!entry.alias && owner >= 0 && owner != index &&
+      imageList[owner].info.fileSize == entry.info.fileSize && LittleFS.remove(path)) {
+    entry.alias = true;
+    Serial.printf("Imagen %s idéntica a %s: se guarda una vez\n", path, imageList[owner].info.filename);
+  }
+
+  if (index >= 0) {
+    imageList[index] = entry;
+  } else {
+    imageList.insert(imageList.begin() + lowerBound(path), entry);
+  }
+  return saveCatalog();
+}
+
+// El reemplazo no es una imagen válida: fuera del catálogo
+void ImageManager::removeEntry(const char* path) {
+  removeThumbnail(path);
+  int index = findImage(path);
+  if (index >= 0) {
+    imageList.erase(imageList.begin() + index);
+    saveCatalog();
+  }
+}
+
+static void fillInfo(const CatalogRecord& record, ImageInfo& info) {
+  memcpy(info.filename, record.filename, sizeof(info.filename));
+  info.filename[sizeof(info.filename) - 1] = '\0';
+  info.fileSize = record.fileSize;
+  info.width = record.width;
+  info.height = record.height;
+  info.format = record.format;
+  info.pixelFormat = record.pixelFormat;
+  info.bitsPerPixel = record.bitsPerPixel;
+  info.topDown = record.topDown != 0;
+  info.dataOffset = record.dataOffset;
+  info.rowStride = record.rowStride;
+  info.paletteOffset = record.paletteOffset;
+  info.paletteSize = record.paletteSize;
+  info.frameCount = record.frameCount;
+  info.frameOffset = record.frameOffset;
+  info.valid = true;
+}
+
+bool ImageManager::loadCatalog() {
+  imageList.clear();
+
+  File file = LittleFS.open(CATALOG_FILE, "r");
+  if (!file) {
+    Serial.println("Catálogo de imágenes no encontrado, se crea");
+    return false;
+  }
+
+  CatalogHeader header;
+  bool ok = file.read((uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+            strncmp(header.magic, "PCAT", 4) == 0 && header.version == CATALOG_VERSION &&
+            header.count <= CATALOG_MAX_IMAGES &&
+            file.size() == sizeof(header) + (size_t)header.count * sizeof(CatalogRecord);
+
+  uint64_t checksum = CONTENT_HASH_INIT;
+  if (ok) {
+    imageList.reserve(header.count);
+  }
+  for (uint16_t i = 0; ok && i < header.count; i++) {
+    CatalogRecord record;
+    if (file.read((uint8_t*)&record, sizeof(record)) != sizeof(record)) {
+      ok = false;
+      break;
+    }
+    checksum = contentHash((const uint8_t*)&record, sizeof(record), checksum);
+
+    ImageEntry entry;
+    fillInfo(record, entry.info);
+    entry.hash = record.hash;
+    entry.sourceHash = record.sourceHash;
+    entry.alias = record.alias != 0;
+
+    // Los registros se guardan ordenados por nombre
+    if (!imageList.empty() && strcmp(imageList.back().info.filename, entry.info.filename) >= 0) {
+      ok = false;
+      break;
+    }
+    imageList.push_back(entry);
+  }
+  file.close();
+
+  if (!ok || (uint32_t)checksum != header.checksum) {
+    Serial.println("Catálogo de imágenes inválido, se reconstruye");
+    imageList.clear();
+    return false;
+  }
+  return true;
+}
+
+static void fillRecord(const ImageInfo& info, uint64_t hash, uint64_t sourceHash, bool alias,
+                       CatalogRecord& record) {
+  memset(&record, 0, sizeof(record));
+  strlcpy(record.filename, info.filename, sizeof(record.filename));
+  record.fileSize = info.fileSize;
+  record.hash = hash;
+  record.sourceHash = sourceHash;
+  record.alias = alias ? 1 : 0;
+  record.width = info.width;
+  record.height = info.height;
+  record.format = info.format;
+  record.pixelFormat = info.pixelFormat;
+  record.bitsPerPixel = info.bitsPerPixel;
+  record.topDown = info.topDown ? 1 : 0;
+  record.dataOffset = info.dataOffset;
+  record.rowStride = info.rowStride;
+  record.paletteOffset = info.paletteOffset;
+  record.paletteSize = info.paletteSize;
+  record.frameCount = info.frameCount;
+  record.frameOffset = info.frameOffset;
+}
+
+// Se escribe entero en CATALOG_TEMP_FILE y se renombra: un corte a mitad deja
+// el catálogo anterior (o ninguno) y el siguiente arranque lo reconstruye.
+// Los registros se generan dos veces (checksum y escritura) para no tener el
+// catálogo serializado entero en RAM
+bool ImageManager::saveCatalog() {
+  CatalogRecord record;
+  uint64_t checksum = CONTENT_HASH_INIT;
+  for (const ImageEntry& entry : imageList) {
+    fillRecord(entry.info, entry.hash, entry.sourceHash, entry.alias, record);
+    checksum = contentHash((const uint8_t*)&record, sizeof(record), checksum);
+  }
+
+  CatalogHeader header;
+  memcpy(header.magic, "PCAT", 4);
+  header.version = CATALOG_VERSION;
+  header.count = imageList.size();
+  header.checksum = (uint32_t)checksum;
+
+  File file = LittleFS.open(CATALOG_TEMP_FILE, "w");
+  if (!file) {
+    Serial.println("Error: No se pudo crear el catálogo de imágenes");
+    return false;
+  }
+  bool ok = file.write((const uint8_t*)&header, sizeof(header)) == sizeof(header);
+  for (size_t i = 0; ok && i < imageList.size(); i++) {
+    const ImageEntry& entry = imageList[i];
+    fillRecord(entry.info, entry.hash, entry.sourceHash, entry.alias, record);
+    ok = file.write((const uint8_t*)&record, sizeof(record)) == sizeof(record);
+  }
+  file.close();
+
+  if (!ok) {
+    Serial.println("Error: No se pudo escribir el catálogo de imágenes");
+    LittleFS.remove(CATALOG_TEMP_FILE);
+    return false;
+  }
+  LittleFS.remove(CATALOG_FILE);
+  return LittleFS.rename(CATALOG_TEMP_FILE, CATALOG_FILE);
 }
 
 bool ImageManager::isImageFile(const char* filename) {
   String fn = String(filename);
   fn.toLowerCase();
-  return fn.endsWith(".bmp") || fn.endsWith(".rgb") || fn.endsWith(".565");
+  return fn.endsWith(".bmp") || fn.endsWith(".rgb") || fn.endsWith(".565") || fn.endsWith(".pov");
+}
+
+bool ImageManager::isThumbnailFile(const char* filename) {
+  return String(filename).endsWith(THUMB_EXTENSION);
 }
 
 // Instancia global
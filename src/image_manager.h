@@ -8,9 +8,71 @@
 #include "config.h"
 #include "image_parser.h"
 
+// Catálogo persistente de /images (CATALOG_FILE): un header y un registro de
+// tamaño fijo por imagen con la disposición ya parseada (ImageInfo) y el hash
+// del contenido. En el arranque solo se lista el directorio: las imágenes cuyo
+// nombre y tamaño coinciden con el catálogo no se vuelven a abrir. Subidas y
+// borrados lo actualizan sin recorrer el directorio. Little-endian.
+//
+// El contenido se guarda una sola vez: una subida idéntica (mismo hash y
+// tamaño) a otra imagen no deja archivo y su nombre queda como alias, un
+// registro sin archivo que se resuelve por hash al archivo con ese contenido.
+//
+// Cada archivo lleva al lado su miniatura (THUMB_EXTENSION): un BMP de 24 bits
+// con el lado mayor de THUMB_MAX_SIZE, que el navegador muestra sin convertir.
+// Los alias usan la del archivo con su contenido.
+#define CATALOG_VERSION 2
+
+#pragma pack(push, 1)
+struct CatalogHeader {
+  char magic[4];      // "PCAT"
+  uint16_t version;   // CATALOG_VERSION
+  uint16_t count;     // Registros
+  uint32_t checksum;  // FNV-1a de los registros: si no cuadra, se reconstruye
+};
+
+struct CatalogRecord {
+  char filename[32];
+  uint32_t fileSize;
+  uint64_t hash;      // contentHash() del archivo completo
+  uint64_t sourceHash;  // contentHash() de lo subido (antes de convertir a .pov)
+  uint16_t width;
+  uint16_t height;
+  uint8_t format;
+  uint8_t pixelFormat;
+  uint8_t bitsPerPixel;
+  uint8_t topDown;
+  uint8_t alias;      // 1: sin archivo propio, el del mismo hash
+  uint32_t dataOffset;
+  uint32_t rowStride;
+  uint32_t paletteOffset;
+  uint16_t paletteSize;
+  uint16_t frameCount;
+  uint32_t frameOffset;
+};
+#pragma pack(pop)
+
+// Hash FNV-1a de 64 bits, incremental: contentHash(b, n, contentHash(a, m))
+// es el hash de a seguido de b
+#define CONTENT_HASH_INIT 0xCBF29CE484222325ULL
+
+inline uint64_t contentHash(const uint8_t* data, size_t length, uint64_t hash = CONTENT_HASH_INIT) {
+  for (size_t i = 0; i < length; i++) {
+    hash = (hash ^ data[i]) * 0x100000001B3ULL;
+  }
+  return hash;
+}
+
 class ImageManager {
 private:
-  std::vector<ImageInfo> imageList;
+  struct ImageEntry {
+    ImageInfo info;
+    uint64_t hash;
+    uint64_t sourceHash;
+    bool alias;
+  };
+
+  std::vector<ImageEntry> imageList;  // Ordenada por nombre
   bool listLoaded;
 
 public:
@@ -20,15 +82,56 @@ public:
   std::vector<ImageInfo> listImages();
   bool deleteImage(const char* filename);
   bool getImageInfo(const char* filename, ImageInfo& info);
+  bool getImageHash(const char* filename, uint64_t& hash);
+  bool getSourceHash(const char* filename, uint64_t& hash);
   size_t getFreeSpace();
   size_t getTotalSpace();
   size_t getUsedSpace();
   bool imageExists(const char* filename);
+
+  // Imagen nueva o reemplazada (tras una subida): se parsea solo esa y se
+  // guarda el catálogo. Con los hashes calculados durante la subida no se
+  // vuelve a leer el archivo
+  bool addImage(const char* filename);
+  bool addImage(const char* filename, uint64_t hash, uint64_t sourceHash);
+
+  // Nombre nuevo para un contenido que ya está (por su hash o el de lo que se
+  // subió): el cliente se ahorra la subida. Lleva la extensión del archivo
+  // con ese contenido; linkedPath es la ruta con la que queda
+  bool linkImage(const char* filename, uint64_t hash, String& linkedPath);
+
+  // Archivo con el contenido de una imagen: el suyo, o el de su hash si es un
+  // alias. Las imágenes fuera del catálogo, su propia ruta
+  String getImagePath(const char* filename);
+
+  // Imagen (no alias) con ese hash o hash de subida
+  bool findContent(uint64_t hash, String& path);
+
+  // Antes de sobrescribir el archivo de una imagen: si otros nombres comparten
+  // su contenido, el archivo pasa al primero de ellos
+  bool detachImage(const char* filename);
+
+  // Miniatura de una imagen: se crea tras la subida (una lectura del archivo)
+  // y, si falta, al pedirla. path es la ruta del BMP
+  bool makeThumbnail(const char* filename);
+  bool getThumbnail(const char* filename, String& path);
+
+  // Contrasta el catálogo con el directorio y parsea solo lo que ha cambiado
   void refreshList();
 
 private:
   void loadImageList();
   bool isImageFile(const char* filename);
+  bool isThumbnailFile(const char* filename);
+  size_t lowerBound(const char* path);
+  int findImage(const char* path);
+  bool readImage(const char* path, ImageEntry& entry);
+  int findOwner(uint64_t hash);
+  bool handOver(size_t index);
+  bool storeEntry(ImageEntry& entry);
+  void removeEntry(const char* path);
+  bool loadCatalog();
+  bool saveCatalog();
 };
 
 extern ImageManager imageManager;
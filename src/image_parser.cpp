@@ -1,6 +1,32 @@
 #include "image_parser.h"
 
-ImageParser::ImageParser() {
+// Columna más larga posible: byte de codificación + RLE/DELTA en el peor caso (1 + 3 bytes por píxel)
+#define POV_MAX_COLUMN_BYTES (1 + MAX_IMAGE_HEIGHT * 4)
+// Columnas de un .pov contando todos los fotogramas (índices uint16)
+#define POV_MAX_COLUMNS 0xFFFF
+
+std::atomic<uint32_t> ImageParser::cacheGeneration(0);
+
+ImageParser::ImageParser() : povOffsets(nullptr), povColumns(0), povPixelFormat(0),
+                             povFileSize(0), povGeneration(0), povImage(nullptr), povTable(nullptr),
+                             columnScratch(nullptr), povPixels(nullptr),
+                             povPixelsColumn(-1), rowScratch(nullptr),
+                             rowScratchSize(0), palette(nullptr), paletteFileSize(0),
+                             paletteGeneration(0) {
+  povFile[0] = '\0';
+  paletteFile[0] = '\0';
+}
+
+ImageParser::~ImageParser() {
+  delete[] povOffsets;
+  delete[] columnScratch;
+  delete[] povPixels;
+  delete[] rowScratch;
+  delete[] palette;
+}
+
+void ImageParser::invalidateCaches() {
+  cacheGeneration++;
 }
 
 bool ImageParser::parseImageInfo(const char* filename, ImageInfo& info) {
@@ -11,8 +37,12 @@ bool ImageParser::parseImageInfo(const char* filename, ImageInfo& info) {
     return false;
   }
 
-  strncpy(info.filename, filename, sizeof(info.filename) - 1);
+  strlcpy(info.filename, filename, sizeof(info.filename));
   info.fileSize = file.size();
+  info.paletteOffset = 0;
+  info.paletteSize = 0;
+  info.frameCount = 1;
+  info.frameOffset = 0;
 
   bool result = false;
 
@@ -26,6 +56,9 @@ bool ImageParser::parseImageInfo(const char* filename, ImageInfo& info) {
   } else if (fn.endsWith(".rgb") || fn.endsWith(".565")) {
     result = parseRGB565(file, info);
     info.format = 1;
+  } else if (fn.endsWith(".pov")) {
+    result = parsePOV(file, info);
+    info.format = 2;
   } else {
     Serial.println("Error: Formato de archivo no soportado");
     info.valid = false;
@@ -51,17 +84,66 @@ bool ImageParser::parseBMP(File& file, ImageInfo& info) {
     return false;
   }
 
-  if (infoHeader.bitsPerPixel != 24) {
-    Serial.println("Error: Solo se soportan BMP de 24 bits");
+  uint16_t bpp = infoHeader.bitsPerPixel;
+  if (bpp != 24 && bpp != 8 && bpp != 4 && bpp != 2 && bpp != 1) {
+    Serial.println("Error: Solo se soportan BMP de 1, 2, 4, 8 o 24 bits");
+    info.valid = false;
+    return false;
+  }
+
+  // Info header BITMAPINFOHEADER o posterior, con los píxeles después
+  if (infoHeader.headerSize < sizeof(BMPInfoHeader) ||
+      (uint64_t)sizeof(BMPHeader) + infoHeader.headerSize > header.dataOffset) {
+    Serial.println("Error: Header BMP inválido");
     info.valid = false;
     return false;
   }
 
-  info.width = abs(infoHeader.width);
-  info.height = abs(infoHeader.height);
+  // Las dimensiones se guardan en uint16: se rechaza lo que no cabe en vez de truncarlo
+  if (infoHeader.width <= 0 || infoHeader.width > 0xFFFF || infoHeader.height == 0 ||
+      infoHeader.height < -0xFFFF || infoHeader.height > 0xFFFF) {
+    Serial.println("Error: Dimensiones BMP inválidas");
+    info.valid = false;
+    return false;
+  }
+
+  info.width = infoHeader.width;
+  info.height = infoHeader.height < 0 ? -infoHeader.height : infoHeader.height;
+
+  // Filas alineadas a 4 bytes; altura negativa = filas de arriba a abajo
+  info.dataOffset = header.dataOffset;
+  info.rowStride = (((uint32_t)bpp * info.width + 31) / 32) * 4;
+  info.topDown = infoHeader.height < 0;
+
+  // Todos los píxeles deben estar en el archivo (la última fila puede no
+  // tener padding): así ninguna lectura de columna o bloque sale de él
+  uint32_t pixelBytes = ((uint32_t)bpp * info.width + 7) / 8;
+  uint64_t dataEnd = (uint64_t)info.dataOffset + (uint64_t)(info.height - 1) * info.rowStride + pixelBytes;
+  if (dataEnd > info.fileSize) {
+    Serial.println("Error: Datos BMP incompletos");
+    info.valid = false;
+    return false;
+  }
+  info.bitsPerPixel = bpp;
+  info.pixelFormat = PIXEL_FORMAT_BGR888;
+
+  // Paleta (B, G, R, 0) tras el info header; colorsUsed = 0 significa 2^bpp
+  if (bpp <= 8) {
+    uint32_t maxColors = 1UL << bpp;
+    info.pixelFormat = PIXEL_FORMAT_INDEXED;
+    info.paletteOffset = sizeof(BMPHeader) + infoHeader.headerSize;
+    info.paletteSize = (infoHeader.colorsUsed == 0 || infoHeader.colorsUsed > maxColors)
+                       ? maxColors : infoHeader.colorsUsed;
+    if ((uint64_t)info.paletteOffset + (uint32_t)info.paletteSize * 4 > header.dataOffset) {
+      Serial.println("Error: Paleta BMP inválida");
+      info.valid = false;
+      return false;
+    }
+  }
   info.valid = true;
 
-  Serial.printf("BMP parseado: %dx%d\n", info.width, info.height);
+  Serial.printf("BMP parseado: %dx%d, %d bits%s\n", info.width, info.height, bpp,
+                info.topDown ? " (top-down)" : "");
 
   return true;
 }
@@ -83,8 +165,20 @@ bool ImageParser::parseRGB565(File& file, ImageInfo& info) {
     return false;
   }
 
+  if (header.width == 0 || header.height == 0 ||
+      sizeof(RGB565Header) + (uint64_t)header.width * header.height * 2 > info.fileSize) {
+    Serial.println("Error: Dimensiones RGB565 inválidas");
+    info.valid = false;
+    return false;
+  }
+
   info.width = header.width;
   info.height = header.height;
+  info.dataOffset = sizeof(RGB565Header);
+  info.rowStride = (uint32_t)header.width * 2;
+  info.bitsPerPixel = 16;
+  info.topDown = true;
+  info.pixelFormat = PIXEL_FORMAT_RGB565;
   info.valid = true;
 
   Serial.printf("RGB565 parseado: %dx%d\n", info.width, info.height);
@@ -92,6 +186,85 @@ bool ImageParser::parseRGB565(File& file, ImageInfo& info) {
   return true;
 }
 
+bool ImageParser::parsePOV(File& file, ImageInfo& info) {
+  POVHeader header;
+
+  file.seek(0);
+  if (file.read((uint8_t*)&header, sizeof(POVHeader)) != sizeof(POVHeader)) {
+    Serial.println("Error: No se pudo leer header POV");
+    info.valid = false;
+    return false;
+  }
+
+  if (strncmp(header.magic, "POV1", 4) != 0 || header.version != POV_FORMAT_VERSION) {
+    Serial.println("Error: Header POV inválido");
+    info.valid = false;
+    return false;
+  }
+
+  if (header.pixelFormat > POV_PIXEL_INDEXED8 || header.width == 0 || header.height == 0 ||
+      header.height > MAX_IMAGE_HEIGHT) {
+    Serial.println("Error: Formato POV no soportado");
+    info.valid = false;
+    return false;
+  }
+
+  // Formato indexado: paleta completa (2^bits entradas RGB) antes de la tabla
+  uint8_t bits = povIndexBits(header.pixelFormat);
+  uint32_t paletteBytes = bits > 0 ? (1UL << bits) * 3 : 0;
+
+  // Animación: número de fotogramas y sus retardos tras la paleta
+  if (header.flags & POV_FLAG_ANIMATED) {
+    uint16_t frames = 0;
+    file.seek(sizeof(POVHeader) + paletteBytes);
+    if (file.read((uint8_t*)&frames, sizeof(frames)) != sizeof(frames) || frames == 0 ||
+        frames > MAX_ANIMATION_FRAMES || (uint32_t)frames * header.width >= POV_MAX_COLUMNS) {
+      Serial.println("Error: Animación POV inválida");
+      info.valid = false;
+      return false;
+    }
+    info.frameCount = frames;
+    info.frameOffset = sizeof(POVHeader) + paletteBytes + sizeof(frames);
+  }
+
+  // La tabla de offsets (y antes la paleta y los retardos) debe caber en el archivo
+  uint32_t columns = (uint32_t)header.width * info.frameCount;
+  uint32_t headerEnd = info.frameOffset > 0 ? info.frameOffset + info.frameCount * sizeof(uint16_t)
+                                            : sizeof(POVHeader) + paletteBytes;
+  uint64_t tableEnd = (uint64_t)header.tableOffset + (columns + 1) * sizeof(uint32_t);
+  if (header.tableOffset < headerEnd || tableEnd > info.fileSize) {
+    Serial.println("Error: Tabla de columnas POV inválida");
+    info.valid = false;
+    return false;
+  }
+
+  info.width = header.width;
+  info.height = header.height;
+  info.dataOffset = header.tableOffset;
+  info.rowStride = 0;
+  info.topDown = true;
+  info.pixelFormat = header.pixelFormat == POV_PIXEL_RGB565 ? PIXEL_FORMAT_RGB565 : PIXEL_FORMAT_RGB888;
+  info.bitsPerPixel = header.pixelFormat == POV_PIXEL_RGB565 ? 16 : 24;
+
+  if (bits > 0) {
+    info.pixelFormat = PIXEL_FORMAT_INDEXED;
+    info.bitsPerPixel = bits;
+    info.paletteOffset = sizeof(POVHeader);
+    info.paletteSize = 1 << bits;
+  }
+  info.valid = true;
+
+  Serial.printf("POV parseado: %dx%d (%s, %d bits)", info.width, info.height,
+                bits > 0 ? "indexado" : (header.pixelFormat == POV_PIXEL_RGB565 ? "RGB565" : "RGB888"),
+                info.bitsPerPixel);
+  if (info.frameCount > 1) {
+    Serial.printf(", %d fotogramas", info.frameCount);
+  }
+  Serial.println();
+
+  return true;
+}
+
 bool ImageParser::getColumn(const char* filename, uint16_t columnIndex, CRGB* buffer, uint16_t bufferSize) {
   ImageInfo info;
   if (!parseImageInfo(filename, info)) {
@@ -117,33 +290,67 @@ bool ImageParser::getColumn(File& file, const ImageInfo& info, uint16_t columnIn
     return getColumnBMP(file, info, columnIndex, buffer, bufferSize);
   } else if (info.format == 1) {
     return getColumnRGB565(file, info, columnIndex, buffer, bufferSize);
+  } else if (info.format == 2) {
+    return getColumnPOV(file, info, columnIndex, buffer, bufferSize);
   }
   
   return false;
 }
 
-bool ImageParser::getColumnBMP(File& file, const ImageInfo& info, uint16_t columnIndex, CRGB* buffer, uint16_t bufferSize) {
-  BMPHeader header;
-  BMPInfoHeader infoHeader;
+bool ImageParser::getFrameColumn(File& file, const ImageInfo& info, uint16_t frame, uint16_t columnIndex,
+                                 CRGB* buffer, uint16_t bufferSize) {
+  if (frame == 0) {
+    return getColumn(file, info, columnIndex, buffer, bufferSize);
+  }
+  if (info.format != 2 || frame >= info.frameCount || columnIndex >= info.width) {
+    return false;
+  }
+  return getColumnPOV(file, info, frame * info.width + columnIndex, buffer, bufferSize);
+}
 
-  if (!readBMPHeader(file, header, infoHeader)) {
+bool ImageParser::getFrameDelays(File& file, const ImageInfo& info, uint16_t* delays) {
+  if (info.frameOffset == 0) {
+    delays[0] = 0;
+    return info.frameCount == 1;
+  }
+  size_t bytes = info.frameCount * sizeof(uint16_t);
+  file.seek(info.frameOffset);
+  return file.read((uint8_t*)delays, bytes) == bytes;
+}
+
+bool ImageParser::getColumnBMP(File& file, const ImageInfo& info, uint16_t columnIndex, CRGB* buffer, uint16_t bufferSize) {
+  // La disposición viene de parseBMP(); no se vuelve a leer el header
+  if (info.rowStride == 0) {
     return false;
   }
 
   uint16_t height = min((uint16_t)info.height, bufferSize);
 
-  // Calcular padding de fila (las filas BMP están alineadas a 4 bytes)
-  uint16_t rowSize = ((infoHeader.bitsPerPixel * info.width + 31) / 32) * 4;
+  // Indexado: el byte que contiene el índice de esta columna
+  bool indexed = info.pixelFormat == PIXEL_FORMAT_INDEXED;
+  if (indexed && !loadPalette(file, info)) {
+    return false;
+  }
+  uint32_t columnOffset = indexed ? ((uint32_t)columnIndex * info.bitsPerPixel) / 8 : (uint32_t)columnIndex * 3;
+  uint8_t shift = indexed ? 8 - info.bitsPerPixel - ((uint32_t)columnIndex * info.bitsPerPixel) % 8 : 0;
+  uint8_t mask = (1 << info.bitsPerPixel) - 1;
 
-  // BMP se almacena de abajo hacia arriba
   for (uint16_t y = 0; y < height; y++) {
-    // Calcular posición en el archivo
-    uint16_t bmpY = height - 1 - y;  // Invertir Y
-    uint32_t rowOffset = header.dataOffset + (bmpY * rowSize);
-    uint32_t pixelOffset = rowOffset + (columnIndex * 3);
+    // BMP se almacena de abajo hacia arriba salvo con altura negativa
+    uint16_t bmpY = info.topDown ? y : info.height - 1 - y;
+    uint32_t pixelOffset = info.dataOffset + (uint32_t)bmpY * info.rowStride + columnOffset;
 
     file.seek(pixelOffset);
 
+    if (indexed) {
+      uint8_t byte;
+      if (file.read(&byte, 1) != 1) {
+        return false;
+      }
+      buffer[y] = palette[(byte >> shift) & mask];
+      continue;
+    }
+
     uint8_t pixel[3];
     if (file.read(pixel, 3) != 3) {
       return false;
@@ -157,15 +364,15 @@ bool ImageParser::getColumnBMP(File& file, const ImageInfo& info, uint16_t colum
 }
 
 bool ImageParser::getColumnRGB565(File& file, const ImageInfo& info, uint16_t columnIndex, CRGB* buffer, uint16_t bufferSize) {
-  uint16_t height = min((uint16_t)info.height, bufferSize);
+  if (info.rowStride == 0) {
+    return false;
+  }
 
-  // Saltar header
-  file.seek(sizeof(RGB565Header));
+  uint16_t height = min((uint16_t)info.height, bufferSize);
 
   // Leer columna
   for (uint16_t y = 0; y < height; y++) {
-    // Calcular posición en el archivo
-    uint32_t pixelOffset = sizeof(RGB565Header) + ((y * info.width + columnIndex) * 2);
+    uint32_t pixelOffset = info.dataOffset + (uint32_t)y * info.rowStride + (uint32_t)columnIndex * 2;
 
     file.seek(pixelOffset);
 
@@ -182,6 +389,436 @@ bool ImageParser::getColumnRGB565(File& file, const ImageInfo& info, uint16_t co
   return true;
 }
 
+// La tabla cargada es la de esta imagen y ningún archivo ha cambiado desde entonces
+bool ImageParser::isPOVTableCached(const ImageInfo& info) {
+  return povColumns == (uint16_t)(info.width * info.frameCount) && povGeneration == cacheGeneration &&
+         povFileSize == info.fileSize && strncmp(povFile, info.filename, sizeof(povFile)) == 0;
+}
+
+// Carga la tabla de offsets si la imagen no es la misma que la última leída
+bool ImageParser::loadPOVTable(File& file, const ImageInfo& info) {
+  uint16_t columns = info.width * info.frameCount;
+  if (povOffsets != nullptr && isPOVTableCached(info)) {
+    return true;
+  }
+
+  if (povOffsets != nullptr) {
+    delete[] povOffsets;
+    povOffsets = nullptr;
+  }
+  povImage = nullptr;
+  povFile[0] = '\0';
+  povPixelsColumn = -1;
+  // Antes de leer: si el archivo cambia mientras tanto, la próxima lectura recarga
+  povGeneration = cacheGeneration;
+
+  POVHeader header;
+  file.seek(0);
+  if (file.read((uint8_t*)&header, sizeof(POVHeader)) != sizeof(POVHeader)) {
+    return false;
+  }
+
+  uint16_t count = columns + 1;
+  povOffsets = new uint32_t[count];
+  if (povOffsets == nullptr) {
+    Serial.println("Error: Sin memoria para tabla de columnas POV");
+    return false;
+  }
+
+  file.seek(header.tableOffset);
+  size_t tableBytes = count * sizeof(uint32_t);
+  if (file.read((uint8_t*)povOffsets, tableBytes) != tableBytes) {
+    delete[] povOffsets;
+    povOffsets = nullptr;
+    return false;
+  }
+
+  // Offsets crecientes, dentro del archivo y con columnas de tamaño razonable
+  for (uint16_t i = 0; i < columns; i++) {
+    uint32_t length = povOffsets[i + 1] - povOffsets[i];
+    if (povOffsets[i + 1] <= povOffsets[i] || povOffsets[i + 1] > info.fileSize ||
+        length > POV_MAX_COLUMN_BYTES) {
+      Serial.printf("Error: Offset de columna POV %d inválido\n", i);
+      delete[] povOffsets;
+      povOffsets = nullptr;
+      return false;
+    }
+  }
+
+  povColumns = columns;
+  povPixelFormat = header.pixelFormat;
+  povFileSize = info.fileSize;
+  strlcpy(povFile, info.filename, sizeof(povFile));
+  return true;
+}
+
+// Como la de File, sobre un .pov mapeado: la tabla se valida una vez y se
+// lee en su sitio, sin copiarla a RAM
+bool ImageParser::loadPOVTable(const uint8_t* image, const ImageInfo& info) {
+  uint16_t columns = info.width * info.frameCount;
+  if (povImage == image && isPOVTableCached(info)) {
+    return true;
+  }
+
+  delete[] povOffsets;
+  povOffsets = nullptr;
+  povImage = nullptr;
+  povFile[0] = '\0';
+  povPixelsColumn = -1;
+  // Antes de leer: si el archivo cambia mientras tanto, la próxima lectura recarga
+  povGeneration = cacheGeneration;
+
+  POVHeader header;
+  if (info.fileSize < sizeof(POVHeader)) {
+    return false;
+  }
+  memcpy(&header, image, sizeof(POVHeader));
+  uint64_t tableEnd = (uint64_t)header.tableOffset + ((uint32_t)columns + 1) * sizeof(uint32_t);
+  if (tableEnd > info.fileSize) {
+    return false;
+  }
+  povImage = image;
+  povTable = image + header.tableOffset;
+
+  for (uint16_t i = 0; i < columns; i++) {
+    uint32_t start = povColumnOffset(i);
+    uint32_t end = povColumnOffset(i + 1);
+    if (end <= start || end > info.fileSize || end - start > POV_MAX_COLUMN_BYTES) {
+      Serial.printf("Error: Offset de columna POV %d inválido\n", i);
+      povImage = nullptr;
+      return false;
+    }
+  }
+
+  povColumns = columns;
+  povPixelFormat = header.pixelFormat;
+  povFileSize = info.fileSize;
+  strlcpy(povFile, info.filename, sizeof(povFile));
+  return true;
+}
+
+// Offset de una columna en la tabla cargada (copiada o mapeada; en flash
+// puede no estar alineada a 4 bytes)
+uint32_t ImageParser::povColumnOffset(uint16_t column) {
+  if (povImage == nullptr) {
+    return povOffsets[column];
+  }
+  uint32_t offset;
+  memcpy(&offset, povTable + (uint32_t)column * sizeof(uint32_t), sizeof(offset));
+  return offset;
+}
+
+bool ImageParser::ensurePOVPixels() {
+  if (povPixels == nullptr) {
+    povPixels = new uint8_t[MAX_IMAGE_HEIGHT * 3];
+    if (povPixels == nullptr) {
+      Serial.println("Error: Sin memoria para columna POV");
+      return false;
+    }
+  }
+  return true;
+}
+
+// Deja en povPixels la columna columnIndex desempaquetada. REPEAT y DELTA
+// parten de la columna anterior: en orden basta con una columna; si no, se
+// decodifica desde la última columna clave. Con file cada columna se lee en
+// columnScratch; sin él (.pov mapeado) se decodifica en su sitio y, como mirar
+// la codificación no cuesta nada, se empieza en la última columna independiente
+bool ImageParser::decodePOVColumn(File* file, const ImageInfo& info, uint16_t columnIndex,
+                                  uint8_t bytesPerPixel, uint8_t bits) {
+  if (povPixelsColumn == columnIndex) {
+    return true;
+  }
+
+  uint16_t first = columnIndex - columnIndex % POV_KEYFRAME_INTERVAL;
+  if (file == nullptr) {
+    uint16_t independent = columnIndex;
+    while (independent > first && povImage[povColumnOffset(independent)] != POV_COLUMN_RAW &&
+           povImage[povColumnOffset(independent)] != POV_COLUMN_RLE) {
+      independent--;
+    }
+    first = independent;
+  }
+  if (povPixelsColumn >= first && povPixelsColumn < columnIndex) {
+    first = povPixelsColumn + 1;
+  }
+  povPixelsColumn = -1;
+
+  for (uint16_t column = first; column <= columnIndex; column++) {
+    // Un seek y un read contiguo por columna
+    uint32_t start = povColumnOffset(column);
+    uint16_t length = povColumnOffset(column + 1) - start;
+    const uint8_t* data = columnScratch;
+    if (file == nullptr) {
+      data = povImage + start;
+    } else {
+      file->seek(start);
+      if (file->read(columnScratch, length) != length) {
+        return false;
+      }
+    }
+
+    bool dependent = data[0] == POV_COLUMN_REPEAT || data[0] == POV_COLUMN_DELTA;
+    if ((dependent && povIsKeyframe(column)) ||
+        !povDecodeColumn(data, length, povPixels, info.height, bytesPerPixel, bits)) {
+      Serial.printf("Error: Columna POV %d inválida (codificación %d)\n", column, data[0]);
+      return false;
+    }
+  }
+  povPixelsColumn = columnIndex;
+  return true;
+}
+
+bool ImageParser::getColumnPOV(File& file, const ImageInfo& info, uint16_t columnIndex, CRGB* buffer, uint16_t bufferSize) {
+  if (!loadPOVTable(file, info)) {
+    return false;
+  }
+
+  if (columnScratch == nullptr) {
+    columnScratch = new uint8_t[POV_MAX_COLUMN_BYTES];
+    if (columnScratch == nullptr) {
+      Serial.println("Error: Sin memoria para columna POV");
+      return false;
+    }
+  }
+  if (!ensurePOVPixels()) {
+    return false;
+  }
+
+  uint8_t bits = povIndexBits(povPixelFormat);
+  if (bits > 0 && !loadPalette(file, info)) {
+    return false;
+  }
+
+  // Desempaquetado: un índice por byte en los formatos indexados
+  uint8_t bytesPerPixel = bits > 0 ? 1 : (povPixelFormat == POV_PIXEL_RGB565) ? 2 : 3;
+  if (!decodePOVColumn(&file, info, columnIndex, bytesPerPixel, bits)) {
+    return false;
+  }
+
+  // Una sola conversión por lotes al buffer CRGB
+  uint16_t height = min((uint16_t)info.height, bufferSize);
+  if (bits > 0) {
+    convertPixels(povPixels, buffer, height, PIXEL_FORMAT_INDEXED, 8);
+  } else {
+    convertPixels(povPixels, buffer, height, bytesPerPixel == 2 ? PIXEL_FORMAT_RGB565 : PIXEL_FORMAT_RGB888);
+  }
+  return true;
+}
+
+const CRGB* ImageParser::getMappedColumn(const uint8_t* image, const ImageInfo& info, uint16_t frame,
+                                         uint16_t columnIndex, CRGB* buffer, uint16_t bufferSize) {
+  if (info.format != 2 || frame >= info.frameCount || columnIndex >= info.width ||
+      !loadPOVTable(image, info) || !ensurePOVPixels()) {
+    return nullptr;
+  }
+
+  uint8_t bits = povIndexBits(povPixelFormat);
+  if (bits > 0 && !loadPalette(image, info)) {
+    return nullptr;
+  }
+  uint8_t bytesPerPixel = bits > 0 ? 1 : (povPixelFormat == POV_PIXEL_RGB565) ? 2 : 3;
+  uint16_t column = frame * info.width + columnIndex;
+
+  // Una columna RAW RGB888 ya es un array de CRGB (R, G, B): cero copias
+  uint32_t start = povColumnOffset(column);
+  if (bytesPerPixel == 3 && image[start] == POV_COLUMN_RAW &&
+      povColumnOffset(column + 1) - start >= 1 + (uint32_t)info.height * 3) {
+    return (const CRGB*)(image + start + 1);
+  }
+
+  if (!decodePOVColumn(nullptr, info, column, bytesPerPixel, bits)) {
+    return nullptr;
+  }
+  uint16_t height = min((uint16_t)info.height, bufferSize);
+  if (bits > 0) {
+    convertPixels(povPixels, buffer, height, PIXEL_FORMAT_INDEXED, 8);
+  } else {
+    convertPixels(povPixels, buffer, height, bytesPerPixel == 2 ? PIXEL_FORMAT_RGB565 : PIXEL_FORMAT_RGB888);
+  }
+  return buffer;
+}
+
+bool ImageParser::isRepeatColumn(File& file, const ImageInfo& info, uint16_t columnIndex) {
+  if (info.format != 2 || columnIndex == 0 || columnIndex >= (uint32_t)info.width * info.frameCount ||
+      !loadPOVTable(file, info)) {
+    return false;
+  }
+  return povOffsets[columnIndex + 1] - povOffsets[columnIndex] == 1;
+}
+
+bool ImageParser::isRepeatColumn(const uint8_t* image, const ImageInfo& info, uint16_t columnIndex) {
+  if (info.format != 2 || columnIndex == 0 || columnIndex >= (uint32_t)info.width * info.frameCount ||
+      !loadPOVTable(image, info)) {
+    return false;
+  }
+  return povColumnOffset(columnIndex + 1) - povColumnOffset(columnIndex) == 1;
+}
+
+bool ImageParser::isRowMajor(const ImageInfo& info) {
+  return (info.format == 0 || info.format == 1) && info.rowStride > 0;
+}
+
+// Filas que caben en una lectura
+uint16_t ImageParser::getRowBatch(const ImageInfo& info) {
+  if (info.rowStride == 0) {
+    return 0;
+  }
+  return max((uint32_t)1, (uint32_t)(DECODE_BLOCK_BYTES / info.rowStride));
+}
+
+bool ImageParser::getRows(File& file, const ImageInfo& info, uint16_t firstRow, uint16_t rowCount, CRGB* buffer) {
+  if (!isRowMajor(info) || (uint32_t)firstRow + rowCount > info.height || !ensureRowScratch(info)) {
+    return false;
+  }
+
+  bool indexed = info.pixelFormat == PIXEL_FORMAT_INDEXED;
+  if (indexed && !loadPalette(file, info)) {
+    return false;
+  }
+
+  uint16_t batch = getRowBatch(info);
+  uint32_t pixelBytes = ((uint32_t)info.width * info.bitsPerPixel + 7) / 8;
+
+  for (uint16_t done = 0; done < rowCount; ) {
+    uint16_t count = min((uint16_t)(rowCount - done), batch);
+    uint16_t row = firstRow + done;
+
+    // Las filas [row, row + count) son contiguas en el archivo en ambos sentidos
+    uint16_t fileRow = info.topDown ? row : info.height - row - count;
+    uint32_t length = (uint32_t)(count - 1) * info.rowStride + pixelBytes;  // Sin el padding final
+
+    file.seek(info.dataOffset + (uint32_t)fileRow * info.rowStride);
+    if (file.read(rowScratch, length) != length) {
+      return false;
+    }
+
+    for (uint16_t i = 0; i < count; i++) {
+      uint16_t blockRow = info.topDown ? i : count - 1 - i;
+      convertPixels(rowScratch + (uint32_t)blockRow * info.rowStride,
+                    buffer + (size_t)(done + i) * info.width, info.width, info.pixelFormat,
+                    info.bitsPerPixel);
+    }
+    done += count;
+  }
+
+  return true;
+}
+
+bool ImageParser::ensureRowScratch(const ImageInfo& info) {
+  uint32_t needed = max((uint32_t)DECODE_BLOCK_BYTES, info.rowStride);
+  if (rowScratch != nullptr && rowScratchSize >= needed) {
+    return true;
+  }
+
+  delete[] rowScratch;
+  rowScratchSize = 0;
+  rowScratch = new uint8_t[needed];
+  if (rowScratch == nullptr) {
+    Serial.println("Error: Sin memoria para bloque de filas");
+    return false;
+  }
+  rowScratchSize = needed;
+  return true;
+}
+
+// La paleta cargada es la de esta imagen y ningún archivo ha cambiado desde entonces
+bool ImageParser::isPaletteCached(const ImageInfo& info) {
+  return palette != nullptr && paletteGeneration == cacheGeneration && paletteFileSize == info.fileSize &&
+         strncmp(paletteFile, info.filename, sizeof(paletteFile)) == 0;
+}
+
+// Carga la paleta si la imagen no es la misma que la última leída. Los índices
+// fuera de la paleta del archivo quedan en negro
+bool ImageParser::loadPalette(File& file, const ImageInfo& info) {
+  if (isPaletteCached(info)) {
+    return true;
+  }
+
+  if (palette == nullptr) {
+    palette = new CRGB[256];
+    if (palette == nullptr) {
+      Serial.println("Error: Sin memoria para la paleta");
+      return false;
+    }
+  }
+  paletteFile[0] = '\0';
+  // Antes de leer: si el archivo cambia mientras tanto, la próxima lectura recarga
+  paletteGeneration = cacheGeneration;
+
+  // BMP: B, G, R, reservado. POV: R, G, B
+  bool bmp = info.format == 0;
+  uint8_t entryBytes = bmp ? 4 : 3;
+  uint16_t count = min(info.paletteSize, (uint16_t)256);
+
+  file.seek(info.paletteOffset);
+  for (uint16_t i = 0; i < 256; i++) {
+    uint8_t entry[4];
+    if (i >= count) {
+      palette[i] = CRGB::Black;
+    } else if (file.read(entry, entryBytes) != entryBytes) {
+      Serial.println("Error: No se pudo leer la paleta");
+      return false;
+    } else {
+      palette[i] = bmp ? CRGB(entry[2], entry[1], entry[0]) : CRGB(entry[0], entry[1], entry[2]);
+    }
+  }
+
+  paletteFileSize = info.fileSize;
+  strlcpy(paletteFile, info.filename, sizeof(paletteFile));
+  return true;
+}
+
+// Paleta de un .pov mapeado (R, G, B), con la misma caché que la de File
+bool ImageParser::loadPalette(const uint8_t* image, const ImageInfo& info) {
+  if (isPaletteCached(info)) {
+    return true;
+  }
+
+  if (palette == nullptr) {
+    palette = new CRGB[256];
+    if (palette == nullptr) {
+      Serial.println("Error: Sin memoria para la paleta");
+      return false;
+    }
+  }
+  paletteFile[0] = '\0';
+  // Antes de leer: si el archivo cambia mientras tanto, la próxima lectura recarga
+  paletteGeneration = cacheGeneration;
+
+  uint16_t count = min(info.paletteSize, (uint16_t)256);
+  if ((uint64_t)info.paletteOffset + count * 3 > info.fileSize) {
+    Serial.println("Error: No se pudo leer la paleta");
+    return false;
+  }
+  const uint8_t* entries = image + info.paletteOffset;
+  for (uint16_t i = 0; i < 256; i++) {
+    if (i < count) {
+      palette[i] = CRGB(entries[i * 3], entries[i * 3 + 1], entries[i * 3 + 2]);
+    } else {
+      palette[i] = CRGB::Black;
+    }
+  }
+
+  paletteFileSize = info.fileSize;
+  strlcpy(paletteFile, info.filename, sizeof(paletteFile));
+  return true;
+}
+
+void ImageParser::convertPixels(const uint8_t* src, CRGB* dst, uint16_t count, uint8_t pixelFormat, uint8_t bits) {
+  // CRGB es R, G, B contiguos
+  uint8_t* out = (uint8_t*)dst;
+  if (pixelFormat == PIXEL_FORMAT_INDEXED) {
+    convertIndexed(src, out, count, bits, (const uint8_t*)palette);
+  } else if (pixelFormat == PIXEL_FORMAT_BGR888) {
+    convertBGR888(src, out, count);
+  } else if (pixelFormat == PIXEL_FORMAT_RGB565) {
+    convertRGB565(src, out, count);
+  } else {
+    convertRGB888(src, out, count);
+  }
+}
+
 bool ImageParser::readBMPHeader(File& file, BMPHeader& header, BMPInfoHeader& infoHeader) {
   file.seek(0);
 
@@ -204,9 +841,9 @@ bool ImageParser::readBMPHeader(File& file, BMPHeader& header, BMPInfoHeader& in
 }
 
 void ImageParser::rgb565ToRGB(uint16_t rgb565, uint8_t& r, uint8_t& g, uint8_t& b) {
-  r = ((rgb565 >> 11) & 0x1F) * 255 / 31;
-  g = ((rgb565 >> 5) & 0x3F) * 255 / 63;
-  b = (rgb565 & 0x1F) * 255 / 31;
+  r = RGB565_LUT5[(rgb565 >> 11) & 0x1F];
+  g = RGB565_LUT6[(rgb565 >> 5) & 0x3F];
+  b = RGB565_LUT5[rgb565 & 0x1F];
 }
 
 // Instancia global
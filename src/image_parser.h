@@ -5,7 +5,10 @@
 #include <FS.h>
 #include <LittleFS.h>
 #include <FastLED.h>
+#include <atomic>
 #include "config.h"
+#include "pixel_convert.h"
+#include "pov_codec.h"
 
 // Estructura de header BMP
 #pragma pack(push, 1)
@@ -41,21 +44,130 @@ struct RGB565Header {
 };
 #pragma pack(pop)
 
+// Formato nativo .pov (column-major). Tras el header, una tabla de width + 1
+// offsets uint32 (desde el inicio del archivo): la columna i ocupa
+// [offset[i], offset[i + 1]), así que leerla es un seek y un read contiguo.
+// Cada columna empieza con un byte de codificación (POVColumnEncoding, en
+// pov_codec.h); REPEAT y DELTA dependen de la columna anterior.
+// En los formatos indexados la paleta (2^bits entradas R, G, B) va justo tras
+// el header y los índices se empaquetan como en BMP (bit más alto primero).
+// Animación (POV_FLAG_ANIMATED): tras la paleta, uint16 frameCount y un retardo
+// uint16 en ms por fotograma; la tabla tiene entonces width * frameCount + 1
+// offsets y el fotograma f ocupa las columnas [f * width, (f + 1) * width).
+// Todos los campos en little-endian. Generado por scripts/pov_convert.py.
+#define POV_FORMAT_VERSION 1
+#define POV_FLAG_ANIMATED 0x0001
+
+enum POVPixelFormat {
+  POV_PIXEL_RGB888 = 0,    // 3 bytes: R, G, B
+  POV_PIXEL_RGB565 = 1,    // 2 bytes
+  POV_PIXEL_INDEXED1 = 2,  // Índices de 1, 2, 4 u 8 bits
+  POV_PIXEL_INDEXED2 = 3,
+  POV_PIXEL_INDEXED4 = 4,
+  POV_PIXEL_INDEXED8 = 5
+};
+
+// Bits por índice de un formato indexado (0 si no lo es)
+inline uint8_t povIndexBits(uint8_t pixelFormat) {
+  return (pixelFormat >= POV_PIXEL_INDEXED1 && pixelFormat <= POV_PIXEL_INDEXED8)
+         ? (1 << (pixelFormat - POV_PIXEL_INDEXED1)) : 0;
+}
+
+#pragma pack(push, 1)
+struct POVHeader {
+  char magic[4];         // "POV1"
+  uint8_t version;       // POV_FORMAT_VERSION
+  uint8_t pixelFormat;   // POVPixelFormat
+  uint16_t width;        // Columnas
+  uint16_t height;       // Píxeles por columna
+  uint16_t flags;        // POV_FLAG_ANIMATED o 0
+  uint32_t tableOffset;  // Posición de la tabla de offsets
+};
+#pragma pack(pop)
+
 class ImageParser {
 public:
   ImageParser();
+  ~ImageParser();
 
   bool parseImageInfo(const char* filename, ImageInfo& info);
   bool parseBMP(File& file, ImageInfo& info);
   bool parseRGB565(File& file, ImageInfo& info);
+  bool parsePOV(File& file, ImageInfo& info);
 
   bool getColumn(const char* filename, uint16_t columnIndex, CRGB* buffer, uint16_t bufferSize);
   bool getColumn(File& file, const ImageInfo& info, uint16_t columnIndex, CRGB* buffer, uint16_t bufferSize);
   bool getColumnBMP(File& file, const ImageInfo& info, uint16_t columnIndex, CRGB* buffer, uint16_t bufferSize);
   bool getColumnRGB565(File& file, const ImageInfo& info, uint16_t columnIndex, CRGB* buffer, uint16_t bufferSize);
+  bool getColumnPOV(File& file, const ImageInfo& info, uint16_t columnIndex, CRGB* buffer, uint16_t bufferSize);
+
+  // Animación: columna de un fotograma y retardos (ms) de los info.frameCount fotogramas.
+  // getColumn() lee siempre el fotograma 0
+  bool getFrameColumn(File& file, const ImageInfo& info, uint16_t frame, uint16_t columnIndex,
+                      CRGB* buffer, uint16_t bufferSize);
+  bool getFrameDelays(File& file, const ImageInfo& info, uint16_t* delays);
+
+  // Columna .pov codificada como REPEAT (idéntica a la anterior); solo mira la
+  // tabla. En animaciones el índice es frame * width + columna
+  bool isRepeatColumn(File& file, const ImageInfo& info, uint16_t columnIndex);
+
+  // .pov entero en memoria (almacén flash mapeado, ver flash_store.h): las
+  // columnas RAW RGB888 se devuelven sin copiar, como puntero dentro de image;
+  // el resto se decodifica en buffer. nullptr si hay error
+  const CRGB* getMappedColumn(const uint8_t* image, const ImageInfo& info, uint16_t frame,
+                              uint16_t columnIndex, CRGB* buffer, uint16_t bufferSize);
+  bool isRepeatColumn(const uint8_t* image, const ImageInfo& info, uint16_t columnIndex);
+
+  // Decodificación por filas (BMP/RGB565): lee bloques de DECODE_BLOCK_BYTES y
+  // convierte cada fila de una pasada. buffer recibe rowCount * width píxeles,
+  // row-major y de arriba a abajo
+  bool isRowMajor(const ImageInfo& info);
+  uint16_t getRowBatch(const ImageInfo& info);
+  bool getRows(File& file, const ImageInfo& info, uint16_t firstRow, uint16_t rowCount, CRGB* buffer);
+
+  // Un archivo de imagen ha cambiado (subida, enlace o borrado): las cachés de
+  // todos los parsers dejan de valer. Un archivo reescrito puede tener el mismo
+  // nombre y tamaño, así que no basta con eso como clave. Se puede llamar
+  // desde cualquier tarea; cada parser recarga en su próxima lectura
+  static void invalidateCaches();
 
 private:
+  static std::atomic<uint32_t> cacheGeneration;
+
+  // Tabla de offsets del último .pov leído (se carga una vez por imagen)
+  uint32_t* povOffsets;
+  uint16_t povColumns;
+  uint8_t povPixelFormat;
+  char povFile[32];
+  uint32_t povFileSize;
+  uint32_t povGeneration;  // cacheGeneration al cargarla
+  const uint8_t* povImage; // .pov mapeado cuya tabla se lee en su sitio (nullptr: povOffsets)
+  const uint8_t* povTable;
+  uint8_t* columnScratch;  // Datos crudos de una columna
+  uint8_t* povPixels;      // Última columna .pov decodificada, desempaquetada
+  int32_t povPixelsColumn; // Su índice (-1 si no hay)
+  uint8_t* rowScratch;     // Bloque de filas crudas
+  uint32_t rowScratchSize;
+
+  // Paleta de la última imagen indexada leída
+  CRGB* palette;
+  char paletteFile[32];
+  uint32_t paletteFileSize;
+  uint32_t paletteGeneration;  // cacheGeneration al cargarla
+
   bool readBMPHeader(File& file, BMPHeader& header, BMPInfoHeader& infoHeader);
+  bool loadPOVTable(File& file, const ImageInfo& info);
+  bool loadPOVTable(const uint8_t* image, const ImageInfo& info);
+  bool isPOVTableCached(const ImageInfo& info);
+  uint32_t povColumnOffset(uint16_t column);
+  bool ensurePOVPixels();
+  bool decodePOVColumn(File* file, const ImageInfo& info, uint16_t columnIndex, uint8_t bytesPerPixel,
+                       uint8_t bits);
+  bool ensureRowScratch(const ImageInfo& info);
+  bool loadPalette(File& file, const ImageInfo& info);
+  bool loadPalette(const uint8_t* image, const ImageInfo& info);
+  bool isPaletteCached(const ImageInfo& info);
+  void convertPixels(const uint8_t* src, CRGB* dst, uint16_t count, uint8_t pixelFormat, uint8_t bits = 0);
   void rgb565ToRGB(uint16_t rgb565, uint8_t& r, uint8_t& g, uint8_t& b);
 };
 
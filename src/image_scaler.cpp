@@ -0,0 +1,127 @@
+#include "image_scaler.h"
+
+#define RESAMPLE_ONE 32768  // 1.0 en Q15
+
+LineResampler::LineResampler() : srcLength(0), dstLength(0), tapOffset(nullptr),
+                                 tapIndex(nullptr), tapWeight(nullptr) {
+}
+
+LineResampler::~LineResampler() {
+  release();
+}
+
+void LineResampler::release() {
+  delete[] tapOffset;
+  delete[] tapIndex;
+  delete[] tapWeight;
+  tapOffset = nullptr;
+  tapIndex = nullptr;
+  tapWeight = nullptr;
+  srcLength = 0;
+  dstLength = 0;
+}
+
+bool LineResampler::configure(uint16_t src, uint16_t dst) {
+  if (src == srcLength && dst == dstLength && tapOffset != nullptr) {
+    return true;
+  }
+
+  release();
+  if (src == 0 || dst == 0) {
+    return false;
+  }
+
+  // Cada salida toca como mucho ceil(src/dst) + 1 píxeles de origen
+  uint32_t maxTaps = (uint32_t)dst * ((src + dst - 1) / dst + 1);
+  if (maxTaps > 0xFFFF) {
+    Serial.println("Error: Remuestreo demasiado grande");
+    return false;
+  }
+
+  tapOffset = new uint16_t[dst + 1];
+  tapIndex = new uint16_t[maxTaps];
+  tapWeight = new uint16_t[maxTaps];
+  if (tapOffset == nullptr || tapIndex == nullptr || tapWeight == nullptr) {
+    Serial.println("Error: No se pudo asignar memoria para remuestreo");
+    release();
+    return false;
+  }
+
+  uint16_t taps = 0;
+  float scale = (float)src / dst;
+
+  for (uint16_t i = 0; i < dst; i++) {
+    tapOffset[i] = taps;
+
+    if (src > dst) {
+      // Filtro de caja: la salida i cubre [i*scale, (i+1)*scale) del origen.
+      // Los pesos salen de redondear la fracción acumulada, así suman exactamente 1.0
+      float start = i * scale;
+      float end = start + scale;
+      uint16_t consumed = 0;
+      for (uint16_t s = (uint16_t)start; s < src && s < end; s++) {
+        float covered = (min(end, (float)(s + 1)) - start) / scale;
+        uint16_t cumulative = (uint16_t)min(covered * RESAMPLE_ONE + 0.5f, (float)RESAMPLE_ONE);
+        if (cumulative <= consumed) continue;
+        tapIndex[taps] = s;
+        tapWeight[taps] = cumulative - consumed;
+        consumed = cumulative;
+        taps++;
+      }
+      if (consumed < RESAMPLE_ONE) {
+        tapWeight[taps - 1] += RESAMPLE_ONE - consumed;
+      }
+    } else {
+      // Interpolación lineal centrada en el píxel de salida
+      float pos = (i + 0.5f) * scale - 0.5f;
+      if (pos < 0) pos = 0;
+      uint16_t s0 = min((uint16_t)pos, (uint16_t)(src - 1));
+      uint16_t s1 = min((uint16_t)(s0 + 1), (uint16_t)(src - 1));
+      uint16_t w1 = (uint16_t)((pos - s0) * RESAMPLE_ONE + 0.5f);
+      if (s1 == s0) w1 = 0;
+      tapIndex[taps] = s0;
+      tapWeight[taps] = RESAMPLE_ONE - w1;
+      taps++;
+      if (w1 > 0) {
+        tapIndex[taps] = s1;
+        tapWeight[taps] = w1;
+        taps++;
+      }
+    }
+  }
+  tapOffset[dst] = taps;
+
+  srcLength = src;
+  dstLength = dst;
+  return true;
+}
+
+bool LineResampler::isConfigured() {
+  return tapOffset != nullptr;
+}
+
+uint16_t LineResampler::getSourceLength() {
+  return srcLength;
+}
+
+uint16_t LineResampler::getTargetLength() {
+  return dstLength;
+}
+
+void LineResampler::resample(const CRGB* src, CRGB* dst, uint16_t srcStride, uint16_t dstStride) const {
+  if (tapOffset == nullptr) {
+    return;
+  }
+
+  for (uint16_t i = 0; i < dstLength; i++) {
+    uint32_t r = RESAMPLE_ONE / 2, g = RESAMPLE_ONE / 2, b = RESAMPLE_ONE / 2;
+    for (uint16_t t = tapOffset[i]; t < tapOffset[i + 1]; t++) {
+      const CRGB& p = src[(uint32_t)tapIndex[t] * srcStride];
+      uint32_t w = tapWeight[t];
+      r += p.r * w;
+      g += p.g * w;
+      b += p.b * w;
+    }
+    dst[(uint32_t)i * dstStride] = CRGB(r >> 15, g >> 15, b >> 15);
+  }
+}
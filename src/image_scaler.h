@@ -0,0 +1,34 @@
+#ifndef IMAGE_SCALER_H
+#define IMAGE_SCALER_H
+
+#include <Arduino.h>
+#include <FastLED.h>
+
+// Remuestreo 1D de una línea de píxeles (columna o fila) en punto fijo.
+// Los índices y pesos se precalculan en configure(); resample() solo suma
+// productos enteros, sin divisiones ni coma flotante.
+//  - Reducción (src > dst): filtro de caja (media ponderada por área)
+//  - Ampliación (src < dst): interpolación lineal entre los dos vecinos
+class LineResampler {
+private:
+  uint16_t srcLength;
+  uint16_t dstLength;
+  uint16_t* tapOffset;  // dstLength + 1 entradas: rango de taps de cada salida
+  uint16_t* tapIndex;   // Índice de píxel origen de cada tap
+  uint16_t* tapWeight;  // Peso Q15 de cada tap (los de una salida suman 32768)
+
+public:
+  LineResampler();
+  ~LineResampler();
+
+  bool configure(uint16_t src, uint16_t dst);
+  void release();
+  bool isConfigured();
+
+  uint16_t getSourceLength();
+  uint16_t getTargetLength();
+
+  void resample(const CRGB* src, CRGB* dst, uint16_t srcStride = 1, uint16_t dstStride = 1) const;
+};
+
+#endif
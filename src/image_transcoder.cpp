@@ -0,0 +1,552 @@
+#include "image_transcoder.h"
+#include "image_manager.h"
+
+ImageTranscoder::ImageTranscoder() : state(TRANSCODE_IDLE), sourceHash(CONTENT_HASH_INIT),
+                                     outputHash(CONTENT_HASH_INIT), headerLength(0), headerNeeded(0),
+                                     skipRemaining(0), width(0), height(0), bytesPerPixel(0),
+                                     pixelFormat(POV_PIXEL_RGB888), indexBits(0), palette(nullptr),
+                                     paletteOffset(0), paletteSize(0), streamPosition(0), bottomUp(false),
+                                     sourceRowBytes(0), rowBuffer(nullptr), rowFill(0),
+                                     rowsReceived(0) {
+  sourceName[0] = '\0';
+  outputName[0] = '\0';
+}
+
+ImageTranscoder::~ImageTranscoder() {
+  release();
+}
+
+bool ImageTranscoder::begin(const char* filename) {
+  abort();
+
+  strlcpy(sourceName, filename, sizeof(sourceName));
+  strlcpy(outputName, filename, sizeof(outputName));
+  headerLength = 0;
+  streamPosition = 0;
+  sourceHash = CONTENT_HASH_INIT;
+  outputHash = CONTENT_HASH_INIT;
+
+  String fn = String(filename);
+  fn.toLowerCase();
+
+  if (UPLOAD_TRANSCODE && fn.endsWith(".bmp")) {
+    headerNeeded = sizeof(BMPHeader) + sizeof(BMPInfoHeader);
+  } else if (UPLOAD_TRANSCODE && (fn.endsWith(".rgb") || fn.endsWith(".565"))) {
+    headerNeeded = sizeof(RGB565Header);
+  } else if (UPLOAD_TRANSCODE && fn.endsWith(".png")) {
+    // Sin conversión un PNG no se puede reproducir: aquí no hay passthrough
+    png.begin(TRANSCODE_MAX_WIDTH, PNG_MAX_WINDOW, &ImageTranscoder::pngHeader,
+              &ImageTranscoder::pngRow, this);
+    state = TRANSCODE_PNG;
+    return true;
+  } else {
+    // .pov u otros formatos: se guardan tal cual
+    return startPassthrough();
+  }
+
+  state = TRANSCODE_HEADER;
+  return true;
+}
+
+bool ImageTranscoder::write(const uint8_t* data, size_t len) {
+  sourceHash = contentHash(data, len, sourceHash);
+
+  while (len > 0) {
+    size_t n;
+
+    switch (state) {
+      case TRANSCODE_HEADER:
+        n = min((size_t)(headerNeeded - headerLength), len);
+        memcpy(header + headerLength, data, n);
+        headerLength += n;
+        if (headerLength == headerNeeded && !parseHeader() && !startPassthrough()) {
+          return false;
+        }
+        break;
+
+      case TRANSCODE_SKIP:
+        // Entre el header y los píxeles puede estar la paleta
+        n = min((size_t)skipRemaining, len);
+        for (size_t i = 0; indexBits > 0 && i < n; i++) {
+          storePaletteByte(streamPosition + i, data[i]);
+        }
+        skipRemaining -= n;
+        if (skipRemaining == 0) {
+          state = TRANSCODE_ROWS;
+        }
+        break;
+
+      case TRANSCODE_ROWS:
+        n = min((size_t)(sourceRowBytes - rowFill), len);
+        memcpy(rowBuffer + rowFill, data, n);
+        rowFill += n;
+        if (rowFill == sourceRowBytes) {
+          storeRow();
+        }
+        break;
+
+      case TRANSCODE_TRAILER:
+        // Bytes tras la última fila (metadatos, padding del archivo)
+        return true;
+
+      case TRANSCODE_PNG:
+        if (!png.write(data, len)) {
+          Serial.printf("Error: PNG no convertible (%s)\n", png.getError());
+          abort();
+          state = TRANSCODE_FAILED;
+          return false;
+        }
+        return true;
+
+      case TRANSCODE_PASSTHROUGH:
+        if (outFile.write(data, len) != len) {
+          Serial.printf("Error: No se pudo escribir %s\n", sourceName);
+          outFile.close();
+          LittleFS.remove(String(IMAGES_DIR) + "/" + sourceName);
+          state = TRANSCODE_FAILED;
+          return false;
+        }
+        outputHash = contentHash(data, len, outputHash);
+        return true;
+
+      default:
+        return false;
+    }
+
+    data += n;
+    len -= n;
+    streamPosition += n;
+  }
+
+  return state != TRANSCODE_FAILED;
+}
+
+bool ImageTranscoder::finish() {
+  bool ok = false;
+
+  switch (state) {
+    case TRANSCODE_PASSTHROUGH:
+      outFile.close();
+      ok = true;
+      break;
+
+    case TRANSCODE_TRAILER:
+      outFile.close();
+      ok = writePOV();
+      break;
+
+    case TRANSCODE_PNG:
+      if (!png.isFinished()) {
+        Serial.printf("Error: Upload PNG incompleto (%d de %d filas)\n", png.getRowsDecoded(), png.getHeight());
+        break;
+      }
+      // La ventana de zlib se libera antes de trasponer
+      png.end();
+      outFile.close();
+      ok = writePOV();
+      break;
+
+    case TRANSCODE_HEADER:
+    case TRANSCODE_SKIP:
+    case TRANSCODE_ROWS:
+      Serial.printf("Error: Upload incompleto (%d de %d filas)\n", rowsReceived, height);
+      break;
+
+    default:
+      break;
+  }
+
+  abort();
+  return ok;
+}
+
+void ImageTranscoder::abort() {
+  if (outFile) {
+    outFile.close();
+  }
+  if (LittleFS.exists(UPLOAD_TEMP_FILE)) {
+    LittleFS.remove(UPLOAD_TEMP_FILE);
+  }
+  release();
+  state = TRANSCODE_IDLE;
+}
+
+bool ImageTranscoder::isActive() {
+  return state != TRANSCODE_IDLE && state != TRANSCODE_FAILED;
+}
+
+bool ImageTranscoder::isTranscoding() {
+  return state == TRANSCODE_HEADER || state == TRANSCODE_SKIP || state == TRANSCODE_ROWS ||
+         state == TRANSCODE_PNG || state == TRANSCODE_TRAILER;
+}
+
+const char* ImageTranscoder::getOutputName() {
+  return outputName;
+}
+
+uint64_t ImageTranscoder::getSourceHash() {
+  return sourceHash;
+}
+
+uint64_t ImageTranscoder::getOutputHash() {
+  return outputHash;
+}
+
+bool ImageTranscoder::parseHeader() {
+  uint32_t dataOffset;
+
+  if (headerNeeded == sizeof(RGB565Header)) {
+    RGB565Header rgbHeader;
+    memcpy(&rgbHeader, header, sizeof(rgbHeader));
+
+    if (strncmp(rgbHeader.magic, "R565", 4) != 0 || rgbHeader.width == 0 ||
+        rgbHeader.width > TRANSCODE_MAX_WIDTH || rgbHeader.height == 0 ||
+        rgbHeader.height > MAX_IMAGE_HEIGHT) {
+      Serial.println("Upload: RGB565 no convertible, se guarda sin convertir");
+      return false;
+    }
+
+    width = rgbHeader.width;
+    height = rgbHeader.height;
+    bytesPerPixel = 2;
+    pixelFormat = POV_PIXEL_RGB565;
+    bottomUp = false;
+    sourceRowBytes = (uint32_t)width * 2;
+    dataOffset = sizeof(RGB565Header);
+  } else {
+    BMPHeader bmpHeader;
+    BMPInfoHeader infoHeader;
+    memcpy(&bmpHeader, header, sizeof(bmpHeader));
+    memcpy(&infoHeader, header + sizeof(bmpHeader), sizeof(infoHeader));
+
+    uint16_t bpp = infoHeader.bitsPerPixel;
+    uint32_t maxColors = bpp <= 8 ? 1UL << bpp : 0;
+    uint32_t colors = (infoHeader.colorsUsed == 0 || infoHeader.colorsUsed > maxColors)
+                      ? maxColors : infoHeader.colorsUsed;
+    uint32_t paletteStart = sizeof(BMPHeader) + infoHeader.headerSize;
+
+    if (bmpHeader.signature != 0x4D42 || infoHeader.compression != 0 ||
+        (bpp != 24 && bpp != 8 && bpp != 4 && bpp != 2 && bpp != 1) ||
+        (bpp <= 8 && (paletteStart < headerNeeded || (uint64_t)paletteStart + colors * 4 > bmpHeader.dataOffset)) ||
+        infoHeader.width <= 0 ||
+        infoHeader.width > TRANSCODE_MAX_WIDTH || infoHeader.height == 0 ||
+        abs(infoHeader.height) > MAX_IMAGE_HEIGHT || bmpHeader.dataOffset < headerNeeded) {
+      Serial.println("Upload: BMP no convertible, se guarda sin convertir");
+      return false;
+    }
+
+    width = infoHeader.width;
+    height = abs(infoHeader.height);
+    bytesPerPixel = 3;
+    pixelFormat = POV_PIXEL_RGB888;
+    bottomUp = infoHeader.height > 0;  // Altura negativa = filas de arriba a abajo
+    sourceRowBytes = (((uint32_t)width * bpp + 31) / 32) * 4;
+    dataOffset = bmpHeader.dataOffset;
+
+    // Indexado: un índice por byte en el temporal; la paleta llega en el SKIP
+    if (bpp <= 8) {
+      bytesPerPixel = 1;
+      indexBits = bpp;
+      pixelFormat = POV_PIXEL_INDEXED1 + (bpp == 1 ? 0 : bpp == 2 ? 1 : bpp == 4 ? 2 : 3);
+      paletteOffset = paletteStart;
+      paletteSize = colors;
+      palette = new uint8_t[maxColors * 3];
+      if (palette == nullptr) {
+        Serial.println("Error: No se pudo asignar memoria para la paleta");
+        return false;
+      }
+      memset(palette, 0, maxColors * 3);
+    }
+  }
+
+  if (!startRows()) {
+    return false;
+  }
+
+  skipRemaining = dataOffset - headerNeeded;
+  state = skipRemaining > 0 ? TRANSCODE_SKIP : TRANSCODE_ROWS;
+  return true;
+}
+
+// Formato conocido: buffer de fila, temporal y nombre de salida
+bool ImageTranscoder::startRows() {
+  // La fila cruda y, al trasponer, un tramo de fila del temporal
+  rowBuffer = new uint8_t[max(sourceRowBytes, (uint32_t)width * bytesPerPixel)];
+  if (rowBuffer == nullptr) {
+    Serial.println("Error: No se pudo asignar memoria para transcodificar");
+    return false;
+  }
+
+  outFile = LittleFS.open(UPLOAD_TEMP_FILE, "w");
+  if (!outFile) {
+    Serial.println("Error: No se pudo crear archivo temporal");
+    release();
+    return false;
+  }
+
+  // Mismo nombre con extensión .pov
+  const char* dot = strrchr(sourceName, '.');
+  int baseLength = dot ? (int)(dot - sourceName) : (int)strlen(sourceName);
+  baseLength = min(baseLength, (int)sizeof(outputName) - 5);
+  snprintf(outputName, sizeof(outputName), "%.*s.pov", baseLength, sourceName);
+
+  rowFill = 0;
+  rowsReceived = 0;
+
+  Serial.printf("Upload: transcodificando %s a %s (%dx%d)\n", sourceName, outputName, width, height);
+  return true;
+}
+
+// PNGDecoder: IHDR, PLTE y tRNS leídos, empiezan los datos
+bool ImageTranscoder::pngHeader(void* context) {
+  ImageTranscoder* self = static_cast<ImageTranscoder*>(context);
+  PNGDecoder& png = self->png;
+
+  if (png.getHeight() > MAX_IMAGE_HEIGHT) {
+    Serial.printf("Error: PNG de %d filas, máximo %d\n", png.getHeight(), MAX_IMAGE_HEIGHT);
+    return false;
+  }
+
+  self->width = png.getWidth();
+  self->height = png.getHeight();
+  self->bytesPerPixel = png.getBytesPerPixel();
+  self->indexBits = png.getIndexBits();
+  self->bottomUp = false;
+  self->sourceRowBytes = (uint32_t)self->width * self->bytesPerPixel;
+
+  // Paleta y gris: .pov indexado con la profundidad del PNG
+  uint8_t bits = self->indexBits;
+  self->pixelFormat = bits == 0 ? POV_PIXEL_RGB888
+                      : POV_PIXEL_INDEXED1 + (bits == 1 ? 0 : bits == 2 ? 1 : bits == 4 ? 2 : 3);
+  if (bits > 0) {
+    uint32_t paletteBytes = (1UL << bits) * 3;
+    self->palette = new uint8_t[paletteBytes];
+    if (self->palette == nullptr) {
+      Serial.println("Error: No se pudo asignar memoria para la paleta");
+      return false;
+    }
+    memcpy(self->palette, png.getPalette(), paletteBytes);
+  }
+
+  return self->startRows();
+}
+
+// Fila ya normalizada (RGB o un índice por byte), de arriba a abajo
+bool ImageTranscoder::pngRow(void* context, const uint8_t* row) {
+  ImageTranscoder* self = static_cast<ImageTranscoder*>(context);
+  uint32_t pixelBytes = (uint32_t)self->width * self->bytesPerPixel;
+
+  if (self->outFile.write(row, pixelBytes) != pixelBytes) {
+    Serial.println("Error: No hay espacio para el archivo temporal");
+    return false;
+  }
+  self->rowsReceived++;
+  return true;
+}
+
+bool ImageTranscoder::startPassthrough() {
+  release();
+
+  String filepath = String(IMAGES_DIR) + "/" + sourceName;
+  // Otros nombres con el contenido que se va a sobrescribir se lo quedan
+  if (!imageManager.detachImage(sourceName)) {
+    state = TRANSCODE_FAILED;
+    return false;
+  }
+  outFile = LittleFS.open(filepath, "w");
+  if (!outFile) {
+    Serial.println("Error: No se pudo crear archivo");
+    state = TRANSCODE_FAILED;
+    return false;
+  }
+
+  // Lo ya recibido del header
+  outputHash = contentHash(header, headerLength);
+  if (headerLength > 0 && outFile.write(header, headerLength) != headerLength) {
+    Serial.printf("Error: No se pudo escribir %s\n", sourceName);
+    outFile.close();
+    LittleFS.remove(filepath);
+    state = TRANSCODE_FAILED;
+    return false;
+  }
+
+  strlcpy(outputName, sourceName, sizeof(outputName));
+  state = TRANSCODE_PASSTHROUGH;
+  return true;
+}
+
+// Paleta BMP: entradas B, G, R, reservado
+void ImageTranscoder::storePaletteByte(uint32_t position, uint8_t value) {
+  if (position < paletteOffset || position >= paletteOffset + (uint32_t)paletteSize * 4) {
+    return;
+  }
+  uint32_t offset = position - paletteOffset;
+  uint8_t component = offset % 4;
+  if (component < 3) {
+    palette[(offset / 4) * 3 + 2 - component] = value;
+  }
+}
+
+void ImageTranscoder::storeRow() {
+  uint32_t pixelBytes = (uint32_t)width * bytesPerPixel;
+
+  // Desempaquetar los índices a un byte por píxel; de atrás hacia delante el
+  // byte de origen nunca se ha sobrescrito todavía
+  if (indexBits > 0) {
+    uint8_t mask = (1 << indexBits) - 1;
+    for (int32_t x = width - 1; x >= 0; x--) {
+      uint32_t bit = (uint32_t)x * indexBits;
+      rowBuffer[x] = (rowBuffer[bit / 8] >> (8 - indexBits - bit % 8)) & mask;
+    }
+  }
+
+  // BMP guarda BGR; el .pov RGB888 va en orden R, G, B
+  if (bytesPerPixel == 3) {
+    for (uint32_t i = 0; i < pixelBytes; i += 3) {
+      uint8_t blue = rowBuffer[i];
+      rowBuffer[i] = rowBuffer[i + 2];
+      rowBuffer[i + 2] = blue;
+    }
+  }
+
+  if (outFile.write(rowBuffer, pixelBytes) != pixelBytes) {
+    Serial.println("Error: No hay espacio para el archivo temporal");
+    state = TRANSCODE_FAILED;
+    return;
+  }
+
+  rowFill = 0;
+  rowsReceived++;
+  if (rowsReceived == height) {
+    state = TRANSCODE_TRAILER;
+  }
+}
+
+bool ImageTranscoder::writePOV() {
+  String filepath = String(IMAGES_DIR) + "/" + outputName;
+  uint32_t columnBytes = (uint32_t)height * bytesPerPixel;
+  uint32_t rowBytes = (uint32_t)width * bytesPerPixel;
+  uint16_t bandColumns = max((uint32_t)1, (uint32_t)(TRANSCODE_BAND_BYTES / columnBytes));
+  uint32_t tableBytes = ((uint32_t)width + 1) * sizeof(uint32_t);
+  uint32_t paletteBytes = indexBits > 0 ? (1UL << indexBits) * 3 : 0;
+
+  if (!imageManager.detachImage(outputName)) {
+    return false;
+  }
+
+  File temp = LittleFS.open(UPLOAD_TEMP_FILE, "r");
+  File pov = LittleFS.open(filepath, "w");
+  uint8_t* band = new uint8_t[(uint32_t)bandColumns * columnBytes];
+  uint8_t* column = new uint8_t[1 + columnBytes];
+  uint8_t* previous = new uint8_t[columnBytes];  // Última columna del grupo anterior
+  uint32_t* offsets = new uint32_t[width + 1];
+
+  bool ok = temp && pov && band != nullptr && column != nullptr && previous != nullptr &&
+            offsets != nullptr;
+  if (!ok) {
+    Serial.println("Error: No se pudo preparar la conversión a .pov");
+  }
+
+  POVHeader povHeader;
+  memcpy(povHeader.magic, "POV1", 4);
+  povHeader.version = POV_FORMAT_VERSION;
+  povHeader.pixelFormat = pixelFormat;
+  povHeader.width = width;
+  povHeader.height = height;
+  povHeader.flags = 0;
+  povHeader.tableOffset = sizeof(POVHeader) + paletteBytes;
+
+  // Tabla provisional; se reescribe cuando se conocen los tamaños de columna
+  if (ok) {
+    memset(offsets, 0, tableBytes);
+    ok = pov.write((uint8_t*)&povHeader, sizeof(povHeader)) == sizeof(povHeader) &&
+         (paletteBytes == 0 || pov.write(palette, paletteBytes) == paletteBytes) &&
+         pov.write((uint8_t*)offsets, tableBytes) == tableBytes;
+  }
+
+  uint32_t position = povHeader.tableOffset + tableBytes;
+
+  for (uint16_t x0 = 0; ok && x0 < width; x0 += bandColumns) {
+    uint16_t count = min((uint16_t)(width - x0), bandColumns);
+    uint32_t segment = (uint32_t)count * bytesPerPixel;
+
+    // Trasponer: el tramo [x0, x0 + count) de cada fila a columnas contiguas
+    for (uint16_t y = 0; ok && y < height; y++) {
+      uint16_t sourceRow = bottomUp ? height - 1 - y : y;
+      ok = temp.seek((uint32_t)sourceRow * rowBytes + (uint32_t)x0 * bytesPerPixel) &&
+           temp.read(rowBuffer, segment) == segment;
+
+      for (uint16_t i = 0; ok && i < count; i++) {
+        memcpy(band + i * columnBytes + (uint32_t)y * bytesPerPixel,
+               rowBuffer + i * bytesPerPixel, bytesPerPixel);
+      }
+    }
+
+    // Raw, RLE, repetida o delta respecto a la columna anterior, la más corta
+    for (uint16_t i = 0; ok && i < count; i++) {
+      const uint8_t* last = i > 0 ? band + (i - 1) * columnBytes : previous;
+      uint16_t length = povEncodeColumn(band + i * columnBytes, povIsKeyframe(x0 + i) ? nullptr : last,
+                                        height, bytesPerPixel, indexBits, column);
+      offsets[x0 + i] = position;
+      position += length;
+      ok = pov.write(column, length) == length;
+    }
+    memcpy(previous, band + (count - 1) * columnBytes, columnBytes);
+  }
+
+  if (ok) {
+    offsets[width] = position;
+    ok = pov.seek(povHeader.tableOffset) && pov.write((uint8_t*)offsets, tableBytes) == tableBytes;
+  }
+
+  if (temp) {
+    temp.close();
+  }
+  if (pov) {
+    pov.close();
+  }
+
+  // La tabla se reescribe al final, así que el hash no puede seguir a la
+  // escritura: header, paleta y tabla salen de RAM y las columnas se releen
+  if (ok) {
+    outputHash = contentHash((const uint8_t*)&povHeader, sizeof(povHeader));
+    outputHash = contentHash(palette, paletteBytes, outputHash);
+    outputHash = contentHash((const uint8_t*)offsets, tableBytes, outputHash);
+    pov = LittleFS.open(filepath, "r");
+    ok = pov && pov.seek(povHeader.tableOffset + tableBytes);
+    for (uint32_t done = povHeader.tableOffset + tableBytes; ok && done < position; ) {
+      uint32_t n = min(position - done, columnBytes + 1);
+      ok = pov.read(column, n) == n;
+      outputHash = contentHash(column, n, outputHash);
+      done += n;
+    }
+    if (pov) {
+      pov.close();
+    }
+  }
+  delete[] band;
+  delete[] column;
+  delete[] previous;
+  delete[] offsets;
+
+  if (!ok) {
+    Serial.printf("Error: No se pudo escribir %s\n", outputName);
+    LittleFS.remove(filepath);
+    return false;
+  }
+
+  Serial.printf("Upload transcodificado: %s (%dx%d, %u bytes)\n",
+                outputName, width, height, (unsigned int)position);
+  return true;
+}
+
+void ImageTranscoder::release() {
+  png.end();
+  delete[] rowBuffer;
+  rowBuffer = nullptr;
+  delete[] palette;
+  palette = nullptr;
+  indexBits = 0;
+}
+
+ImageTranscoder imageTranscoder;
@@ -0,0 +1,90 @@
+#ifndef IMAGE_TRANSCODER_H
+#define IMAGE_TRANSCODER_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include <LittleFS.h>
+#include "config.h"
+#include "image_parser.h"
+#include "png_decoder.h"
+
+// Convierte una subida BMP/RGB565 al formato .pov mientras llegan los chunks
+// (los BMP de 1/2/4/8 bits a .pov indexado con la misma paleta). Los PNG se
+// descomprimen por streaming (PNGDecoder) y sus filas siguen el mismo camino.
+// Las filas se normalizan (RGB o un índice por byte, sin padding) y se escriben
+// a UPLOAD_TEMP_FILE; al terminar se trasponen por grupos de columnas que caben
+// en TRANSCODE_BAND_BYTES. En RAM solo hay una fila y un grupo de columnas.
+// Los archivos que no se pueden convertir se guardan tal cual.
+class ImageTranscoder {
+public:
+  ImageTranscoder();
+  ~ImageTranscoder();
+
+  bool begin(const char* filename);
+  bool write(const uint8_t* data, size_t len);
+  bool finish();
+  void abort();
+
+  bool isActive();
+  bool isTranscoding();
+  const char* getOutputName();
+
+  // contentHash() de lo recibido y del archivo que queda en /images, calculados
+  // mientras pasan los datos: el catálogo no tiene que releer la subida
+  uint64_t getSourceHash();
+  uint64_t getOutputHash();
+
+private:
+  enum State {
+    TRANSCODE_IDLE,
+    TRANSCODE_HEADER,       // Acumulando el header del origen
+    TRANSCODE_SKIP,         // Saltando hasta el inicio de los píxeles
+    TRANSCODE_ROWS,         // Recibiendo filas
+    TRANSCODE_PNG,          // PNG: el decodificador entrega las filas
+    TRANSCODE_TRAILER,      // Todas las filas recibidas; se ignora el resto
+    TRANSCODE_PASSTHROUGH,  // Se guarda sin convertir
+    TRANSCODE_FAILED
+  };
+
+  State state;
+  File outFile;
+  char sourceName[32];
+  char outputName[32];
+  uint64_t sourceHash;
+  uint64_t outputHash;
+
+  uint8_t header[sizeof(BMPHeader) + sizeof(BMPInfoHeader)];
+  uint16_t headerLength;
+  uint16_t headerNeeded;
+  uint32_t skipRemaining;
+
+  uint16_t width;
+  uint16_t height;
+  uint8_t bytesPerPixel;   // En el temporal: 3 (RGB888), 2 (RGB565) o 1 (índice)
+  uint8_t pixelFormat;     // POVPixelFormat
+  uint8_t indexBits;       // Bits por índice (0 sin paleta)
+  uint8_t* palette;        // 2^indexBits entradas R, G, B
+  uint32_t paletteOffset;
+  uint16_t paletteSize;
+  uint32_t streamPosition; // Bytes del archivo recibidos
+  bool bottomUp;           // Filas del origen de abajo a arriba (BMP)
+  uint32_t sourceRowBytes; // Fila en el origen, con padding
+  uint8_t* rowBuffer;
+  uint32_t rowFill;
+  uint16_t rowsReceived;
+  PNGDecoder png;
+
+  bool parseHeader();
+  bool startRows();
+  static bool pngHeader(void* context);
+  static bool pngRow(void* context, const uint8_t* row);
+  void storePaletteByte(uint32_t position, uint8_t value);
+  bool startPassthrough();
+  void storeRow();
+  bool writePOV();
+  void release();
+};
+
+extern ImageTranscoder imageTranscoder;
+
+#endif
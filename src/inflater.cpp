@@ -0,0 +1,479 @@
+#include "inflater.h"
+
+// Longitudes y distancias base de los símbolos 257-285 y 0-29 (RFC 1951 3.2.5)
+static const uint16_t LENGTH_BASE[29] = {
+  3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+  35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+static const uint8_t LENGTH_EXTRA[29] = {
+  0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+  3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+static const uint16_t DISTANCE_BASE[30] = {
+  1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+  257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+};
+static const uint8_t DISTANCE_EXTRA[30] = {
+  0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+  7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+// Orden de las longitudes del código de longitudes en un bloque dinámico
+static const uint8_t CODE_LENGTH_ORDER[19] = {
+  16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+};
+
+#define INFLATE_INVALID -2  // decode(): código que no existe
+
+Inflater::Inflater() : state(INFLATE_FAILED), output(nullptr), context(nullptr), maxWindow(0),
+                       error(""), inputLength(0), inputPosition(0), bitBuffer(0), bitCount(0),
+                       exhausted(false), window(nullptr), windowSize(0), windowPosition(0),
+                       pending(0), produced(0), adlerA(1), adlerB(0), lastBlock(false),
+                       storedRemaining(0) {
+  lengthCode.count = lengthCount;
+  lengthCode.symbol = lengthSymbol;
+  distanceCode.count = distanceCount;
+  distanceCode.symbol = distanceSymbol;
+}
+
+Inflater::~Inflater() {
+  end();
+}
+
+bool Inflater::begin(uint32_t maxWindowBytes, OutputFunction outputFunction, void* outputContext) {
+  end();
+  output = outputFunction;
+  context = outputContext;
+  maxWindow = maxWindowBytes;
+  error = "";
+  inputLength = 0;
+  inputPosition = 0;
+  bitBuffer = 0;
+  bitCount = 0;
+  windowPosition = 0;
+  pending = 0;
+  produced = 0;
+  adlerA = 1;
+  adlerB = 0;
+  lastBlock = false;
+  state = INFLATE_ZLIB_HEADER;
+  return true;
+}
+
+void Inflater::end() {
+  delete[] window;
+  window = nullptr;
+  windowSize = 0;
+  state = INFLATE_FAILED;
+}
+
+bool Inflater::isFinished() {
+  return state == INFLATE_DONE;
+}
+
+uint32_t Inflater::getWindowSize() {
+  return windowSize;
+}
+
+const char* Inflater::getError() {
+  return error;
+}
+
+bool Inflater::write(const uint8_t* data, uint32_t length) {
+  if (state == INFLATE_FAILED) {
+    return false;
+  }
+
+  do {
+    if (state == INFLATE_DONE) {
+      break;  // Lo que siga al checksum se ignora
+    }
+
+    // Conservar lo que quedó sin consumir y añadir lo nuevo
+    if (inputPosition > 0) {
+      memmove(input, input + inputPosition, inputLength - inputPosition);
+      inputLength -= inputPosition;
+      inputPosition = 0;
+    }
+    uint32_t n = INFLATE_INPUT_BYTES - inputLength;
+    if (n > length) {
+      n = length;
+    }
+    memcpy(input + inputLength, data, n);
+    inputLength += n;
+    data += n;
+    length -= n;
+
+    if (!run()) {
+      return false;
+    }
+    if (n == 0 && length > 0 && inputPosition == 0) {
+      return fail("bloque demasiado grande");
+    }
+  } while (length > 0);
+
+  return flush();
+}
+
+// Avanza todo lo posible. Cada paso empieza en un punto seguro: si faltan
+// datos a mitad de paso, se deshace y se reintenta con la siguiente llamada
+bool Inflater::run() {
+  for (;;) {
+    uint32_t savedPosition = inputPosition;
+    uint32_t savedBits = bitBuffer;
+    uint8_t savedCount = bitCount;
+    exhausted = false;
+
+    switch (state) {
+      case INFLATE_ZLIB_HEADER: {
+        int32_t cmf = bits(8);
+        int32_t flags = bits(8);
+        if (exhausted) {
+          break;
+        }
+        if ((cmf & 0x0F) != 8 || ((cmf << 8) | flags) % 31 != 0 || (flags & 0x20) != 0) {
+          return fail("cabecera zlib inválida");
+        }
+        windowSize = 1UL << ((cmf >> 4) + 8);
+        if ((cmf >> 4) > 7 || windowSize > maxWindow) {
+          return fail("ventana zlib demasiado grande");
+        }
+        window = new uint8_t[windowSize];
+        if (window == nullptr) {
+          return fail("sin memoria para la ventana");
+        }
+        state = INFLATE_BLOCK_HEADER;
+        break;
+      }
+
+      case INFLATE_BLOCK_HEADER: {
+        int32_t last = bits(1);
+        int32_t type = bits(2);
+        if (exhausted) {
+          break;
+        }
+        lastBlock = last == 1;
+        if (type == 0) {
+          // Sin comprimir: alinear a byte, LEN y NLEN
+          bitBuffer = 0;
+          bitCount = 0;
+          int32_t storedLength = bits(16);
+          int32_t complement = bits(16);
+          if (exhausted) {
+            break;
+          }
+          if (storedLength != (~complement & 0xFFFF)) {
+            return fail("bloque sin comprimir inválido");
+          }
+          storedRemaining = storedLength;
+          state = INFLATE_STORED;
+        } else if (type == 1) {
+          buildFixedTables();
+          state = INFLATE_CODES;
+        } else if (type == 2) {
+          if (!readDynamicTables()) {
+            if (exhausted) {
+              break;
+            }
+            return fail("tablas Huffman inválidas");
+          }
+          state = INFLATE_CODES;
+        } else {
+          return fail("tipo de bloque inválido");
+        }
+        break;
+      }
+
+      case INFLATE_STORED:
+        while (storedRemaining > 0 && inputPosition < inputLength && state == INFLATE_STORED) {
+          putByte(input[inputPosition++]);
+          storedRemaining--;
+        }
+        if (state == INFLATE_FAILED) {
+          return false;
+        }
+        if (storedRemaining == 0) {
+          state = lastBlock ? INFLATE_CHECKSUM : INFLATE_BLOCK_HEADER;
+        } else {
+          exhausted = true;
+          savedPosition = inputPosition;  // Lo copiado ya es definitivo
+        }
+        break;
+
+      case INFLATE_CODES:
+        if (!decodeSymbol() && !exhausted) {
+          return false;
+        }
+        break;
+
+      case INFLATE_CHECKSUM: {
+        bitBuffer = 0;
+        bitCount = 0;
+        uint32_t expected = 0;
+        for (uint8_t i = 0; i < 4; i++) {
+          expected = (expected << 8) | (uint32_t)bits(8);
+        }
+        if (exhausted) {
+          break;
+        }
+        if (!flush()) {
+          return false;
+        }
+        if (expected != ((adlerB << 16) | adlerA)) {
+          return fail("checksum Adler-32 incorrecto");
+        }
+        state = INFLATE_DONE;
+        return true;
+      }
+
+      case INFLATE_DONE:
+        return true;
+
+      default:
+        return false;
+    }
+
+    if (state == INFLATE_FAILED) {
+      return false;
+    }
+    if (exhausted) {
+      inputPosition = savedPosition;
+      bitBuffer = savedBits;
+      bitCount = savedCount;
+      return true;
+    }
+  }
+}
+
+// Lee need bits (LSB primero); -1 y exhausted si no hay datos suficientes
+int32_t Inflater::bits(uint8_t need) {
+  while (bitCount < need) {
+    if (inputPosition == inputLength) {
+      exhausted = true;
+      return -1;
+    }
+    bitBuffer |= (uint32_t)input[inputPosition++] << bitCount;
+    bitCount += 8;
+  }
+  int32_t value = bitBuffer & ((1UL << need) - 1);
+  bitBuffer >>= need;
+  bitCount -= need;
+  return value;
+}
+
+// Decodificación canónica bit a bit: los códigos de cada longitud son consecutivos
+int32_t Inflater::decode(const Huffman& huffman) {
+  int32_t code = 0;
+  int32_t first = 0;
+  int32_t index = 0;
+  for (uint8_t length = 1; length <= 15; length++) {
+    int32_t bit = bits(1);
+    if (bit < 0) {
+      return -1;
+    }
+    code |= bit;
+    int32_t count = huffman.count[length];
+    if (code - count < first) {
+      return huffman.symbol[index + (code - first)];
+    }
+    index += count;
+    first = (first + count) << 1;
+    code <<= 1;
+  }
+  return INFLATE_INVALID;
+}
+
+bool Inflater::buildCode(Huffman& huffman, const uint8_t* lengths, uint16_t count) {
+  int16_t offsets[16];
+  memset(huffman.count, 0, 16 * sizeof(int16_t));
+  for (uint16_t symbol = 0; symbol < count; symbol++) {
+    huffman.count[lengths[symbol]]++;
+  }
+
+  // Sobresuscrito = no es un código prefijo; incompleto se permite
+  int32_t left = 1;
+  for (uint8_t length = 1; length <= 15; length++) {
+    left = (left << 1) - huffman.count[length];
+    if (left < 0) {
+      return false;
+    }
+  }
+
+  offsets[1] = 0;
+  for (uint8_t length = 1; length < 15; length++) {
+    offsets[length + 1] = offsets[length] + huffman.count[length];
+  }
+  for (uint16_t symbol = 0; symbol < count; symbol++) {
+    if (lengths[symbol] != 0) {
+      huffman.symbol[offsets[lengths[symbol]]++] = symbol;
+    }
+  }
+  return true;
+}
+
+void Inflater::buildFixedTables() {
+  uint8_t lengths[288];
+  memset(lengths, 8, 144);
+  memset(lengths + 144, 9, 112);
+  memset(lengths + 256, 7, 24);
+  memset(lengths + 280, 8, 8);
+  buildCode(lengthCode, lengths, 288);
+  memset(lengths, 5, 30);
+  buildCode(distanceCode, lengths, 30);
+}
+
+bool Inflater::readDynamicTables() {
+  uint8_t lengths[286 + 30];
+  int32_t literals = bits(5) + 257;
+  int32_t distances = bits(5) + 1;
+  int32_t codes = bits(4) + 4;
+  if (exhausted || literals > 286 || distances > 30) {
+    return false;
+  }
+
+  // Código de las longitudes; se construye de forma provisional en lengthCode
+  memset(lengths, 0, 19);
+  for (int32_t i = 0; i < codes; i++) {
+    int32_t value = bits(3);
+    if (value < 0) {
+      return false;
+    }
+    lengths[CODE_LENGTH_ORDER[i]] = value;
+  }
+  if (!buildCode(lengthCode, lengths, 19)) {
+    return false;
+  }
+
+  int32_t index = 0;
+  while (index < literals + distances) {
+    int32_t symbol = decode(lengthCode);
+    if (symbol < 0) {
+      return false;
+    }
+    if (symbol < 16) {
+      lengths[index++] = symbol;
+      continue;
+    }
+
+    // 16: repetir la anterior 3-6 veces; 17/18: ceros 3-10 / 11-138 veces
+    uint8_t value = 0;
+    int32_t repeat;
+    if (symbol == 16) {
+      if (index == 0) {
+        return false;
+      }
+      value = lengths[index - 1];
+      repeat = 3 + bits(2);
+    } else if (symbol == 17) {
+      repeat = 3 + bits(3);
+    } else {
+      repeat = 11 + bits(7);
+    }
+    if (exhausted || index + repeat > literals + distances) {
+      return false;
+    }
+    memset(lengths + index, value, repeat);
+    index += repeat;
+  }
+
+  // Sin código de fin de bloque no se puede terminar
+  if (lengths[256] == 0) {
+    return false;
+  }
+  return buildCode(lengthCode, lengths, literals) &&
+         buildCode(distanceCode, lengths + literals, distances);
+}
+
+// Un literal, el fin de bloque o una copia (longitud, distancia) completa
+bool Inflater::decodeSymbol() {
+  int32_t symbol = decode(lengthCode);
+  if (symbol == -1) {
+    return false;
+  }
+  if (symbol == INFLATE_INVALID) {
+    return fail("código Huffman inválido");
+  }
+
+  if (symbol < 256) {
+    putByte(symbol);
+    return state != INFLATE_FAILED;
+  }
+  if (symbol == 256) {
+    state = lastBlock ? INFLATE_CHECKSUM : INFLATE_BLOCK_HEADER;
+    return true;
+  }
+
+  symbol -= 257;
+  if (symbol >= 29) {
+    return fail("longitud inválida");
+  }
+  int32_t length = LENGTH_BASE[symbol] + bits(LENGTH_EXTRA[symbol]);
+  int32_t distanceSymbol = decode(distanceCode);
+  if (exhausted) {
+    return false;
+  }
+  if (distanceSymbol < 0 || distanceSymbol >= 30) {
+    return fail("distancia inválida");
+  }
+  uint32_t distance = DISTANCE_BASE[distanceSymbol] + bits(DISTANCE_EXTRA[distanceSymbol]);
+  if (exhausted) {
+    return false;
+  }
+  if (distance > produced || distance > windowSize) {
+    return fail("distancia fuera de la ventana");
+  }
+
+  uint32_t from = (windowPosition + windowSize - distance) % windowSize;
+  while (length-- > 0 && state != INFLATE_FAILED) {
+    putByte(window[from]);
+    from = from + 1 == windowSize ? 0 : from + 1;
+  }
+  return state != INFLATE_FAILED;
+}
+
+void Inflater::putByte(uint8_t value) {
+  // Entregar antes de sobrescribir bytes que la salida aún no ha visto
+  if (pending == windowSize && !flush()) {
+    return;
+  }
+  window[windowPosition] = value;
+  windowPosition = windowPosition + 1 == windowSize ? 0 : windowPosition + 1;
+  pending++;
+  produced++;
+}
+
+bool Inflater::flush() {
+  if (pending == 0) {
+    // También antes de la cabecera zlib, sin ventana todavía
+    return state != INFLATE_FAILED;
+  }
+  uint32_t start = (windowPosition + windowSize - pending) % windowSize;
+  while (pending > 0) {
+    uint32_t n = windowSize - start < pending ? windowSize - start : pending;
+    const uint8_t* data = window + start;
+
+    // Adler-32 en tramos de 5552 bytes sin desbordar 32 bits
+    for (uint32_t done = 0; done < n; ) {
+      uint32_t chunk = n - done < 5552 ? n - done : 5552;
+      for (uint32_t i = 0; i < chunk; i++) {
+        adlerA += data[done + i];
+        adlerB += adlerA;
+      }
+      adlerA %= 65521;
+      adlerB %= 65521;
+      done += chunk;
+    }
+
+    if (!output(context, data, n)) {
+      return fail("salida cancelada");
+    }
+    pending -= n;
+    start = 0;
+  }
+  return true;
+}
+
+bool Inflater::fail(const char* reason) {
+  error = reason;
+  state = INFLATE_FAILED;
+  return false;
+}
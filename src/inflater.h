@@ -0,0 +1,92 @@
+#ifndef INFLATER_H
+#define INFLATER_H
+
+#include <stdint.h>
+#include <string.h>
+
+// Descompresor zlib/deflate por streaming (RFC 1950/1951). Los datos llegan en
+// trozos de cualquier tamaño con write(); la salida se entrega a la función
+// de salida en bloques a medida que se descomprime. En RAM solo hay la ventana
+// que declara el stream (256 B a 32 KB, limitada por maxWindow), las tablas
+// Huffman y un buffer de entrada de INFLATE_INPUT_BYTES.
+// Sin dependencias de Arduino.
+
+#define INFLATE_INPUT_BYTES 1024  // Cabe la cabecera de cualquier bloque dinámico
+
+class Inflater {
+public:
+  // Devuelve false para abortar la descompresión
+  typedef bool (*OutputFunction)(void* context, const uint8_t* data, uint32_t length);
+
+  Inflater();
+  ~Inflater();
+
+  bool begin(uint32_t maxWindow, OutputFunction output, void* context);
+  bool write(const uint8_t* data, uint32_t length);
+  void end();
+
+  bool isFinished();        // Stream completo y checksum Adler-32 correcto
+  uint32_t getWindowSize();
+  const char* getError();   // Motivo del último fallo
+
+private:
+  enum State {
+    INFLATE_ZLIB_HEADER,
+    INFLATE_BLOCK_HEADER,
+    INFLATE_STORED,
+    INFLATE_CODES,
+    INFLATE_CHECKSUM,
+    INFLATE_DONE,
+    INFLATE_FAILED
+  };
+
+  // Código Huffman canónico: cuántos códigos hay de cada longitud y los
+  // símbolos ordenados por código
+  struct Huffman {
+    int16_t* count;
+    int16_t* symbol;
+  };
+
+  State state;
+  OutputFunction output;
+  void* context;
+  uint32_t maxWindow;
+  const char* error;
+
+  uint8_t input[INFLATE_INPUT_BYTES];
+  uint32_t inputLength;
+  uint32_t inputPosition;
+  uint32_t bitBuffer;
+  uint8_t bitCount;
+  bool exhausted;           // Faltan datos: volver al último punto seguro
+
+  uint8_t* window;
+  uint32_t windowSize;
+  uint32_t windowPosition;  // Próximo byte a escribir
+  uint32_t pending;         // Bytes de la ventana aún no entregados
+  uint32_t produced;        // Total descomprimido (limita las distancias al inicio)
+  uint32_t adlerA;
+  uint32_t adlerB;
+
+  bool lastBlock;
+  uint16_t storedRemaining;
+  int16_t lengthCount[16];
+  int16_t lengthSymbol[288];
+  int16_t distanceCount[16];
+  int16_t distanceSymbol[30];
+  Huffman lengthCode;
+  Huffman distanceCode;
+
+  bool run();
+  int32_t bits(uint8_t need);
+  int32_t decode(const Huffman& huffman);
+  bool buildCode(Huffman& huffman, const uint8_t* lengths, uint16_t count);
+  bool readDynamicTables();
+  void buildFixedTables();
+  bool decodeSymbol();
+  void putByte(uint8_t value);
+  bool flush();
+  bool fail(const char* reason);
+};
+
+#endif
@@ -1,12 +1,20 @@
 #include "led_controller.h"
 
-LEDController::LEDController() : leds(nullptr), numLeds(0), brightness(DEFAULT_BRIGHTNESS), ledType(DEFAULT_LED_TYPE), initialized(false) {
+LEDController::LEDController() : leds(nullptr), wireBuffer(nullptr), numLeds(0), brightness(DEFAULT_BRIGHTNESS), ledType(DEFAULT_LED_TYPE), initialized(false)
+#ifdef LED_ASYNC_OUTPUT
+                                 , outputTask(nullptr), idleSem(nullptr)
+#endif
+{
 }
 
 LEDController::~LEDController() {
+  waitForIdle();
   if (leds != nullptr) {
     delete[] leds;
   }
+  if (wireBuffer != nullptr && wireBuffer != leds) {
+    delete[] wireBuffer;
+  }
 }
 
 bool LEDController::init(uint16_t num, LEDStripType type) {
@@ -15,10 +23,18 @@ bool LEDController::init(uint16_t num, LEDStripType type) {
     return false;
   }
 
+  // No liberar buffers mientras FastLED los está transmitiendo
+  waitForIdle();
+  initialized = false;
+
   numLeds = num;
   ledType = type;
 
   // Liberar memoria anterior si existe
+  if (wireBuffer != nullptr && wireBuffer != leds) {
+    delete[] wireBuffer;
+  }
+  wireBuffer = nullptr;
   if (leds != nullptr) {
     delete[] leds;
   }
@@ -27,32 +43,67 @@ bool LEDController::init(uint16_t num, LEDStripType type) {
   leds = new CRGB[numLeds];
   if (leds == nullptr) {
     Serial.println("Error: No se pudo asignar memoria para LEDs");
-    initialized = false;
     return false;
   }
 
+#ifdef LED_ASYNC_OUTPUT
+  // Doble buffer: FastLED transmite wireBuffer mientras se prepara el siguiente frame en leds
+#ifdef POV_RENDER_TASK
+  bool asyncOutput = true;
+#else
+  // La tarea compartiría núcleo con quien prepara las columnas: solo compensa
+  // si show() espera a un periférico (RMT), no con APA102 por SPI software
+  bool asyncOutput = ledType != LED_TYPE_APA102;
+#endif
+  if (idleSem == nullptr) {
+    idleSem = xSemaphoreCreateBinary();
+    if (idleSem != nullptr) {
+      xSemaphoreGive(idleSem);
+    }
+  }
+  if (asyncOutput && idleSem != nullptr && outputTask == nullptr) {
+    if (xTaskCreatePinnedToCore(outputTaskEntry, "led_output", LED_OUTPUT_TASK_STACK, this,
+                                LED_OUTPUT_TASK_PRIORITY, &outputTask, LED_OUTPUT_TASK_CORE) != pdPASS) {
+      outputTask = nullptr;
+    }
+  }
+  if (asyncOutput && outputTask != nullptr) {
+    wireBuffer = new CRGB[numLeds];
+  }
+  if (wireBuffer == nullptr) {
+    Serial.println("Aviso: Salida de LEDs síncrona");
+  }
+#endif
+  if (wireBuffer == nullptr) {
+    wireBuffer = leds;
+  }
+  fill_solid(leds, numLeds, CRGB::Black);
+
   // Inicializar FastLED según el tipo de tira LED
   switch (ledType) {
     case LED_TYPE_WS2811:
     case LED_TYPE_WS2812:
     case LED_TYPE_WS2812B:
       // WS281x usa solo 1 pin (DATA)
-      FastLED.addLeds<WS2811, LED_DATA_PIN, GRB>(leds, numLeds);
+      FastLED.addLeds<WS2811, LED_DATA_PIN, GRB>(wireBuffer, numLeds);
       Serial.printf("LEDs inicializados: %d x WS281x en pin DATA=%d\n", numLeds, LED_DATA_PIN);
       break;
 
     case LED_TYPE_APA102:
       // APA102 usa 2 pines (DATA + CLOCK)
-      FastLED.addLeds<APA102, LED_DATA_PIN, LED_CLOCK_PIN, BGR>(leds, numLeds);
-      Serial.printf("LEDs inicializados: %d x APA102 en pines DATA=%d, CLOCK=%d\n",
-                    numLeds, LED_DATA_PIN, LED_CLOCK_PIN);
+      FastLED.addLeds<APA102, LED_DATA_PIN, LED_CLOCK_PIN, BGR, DATA_RATE_MHZ(APA102_SPI_MHZ)>(wireBuffer, numLeds);
+      Serial.printf("LEDs inicializados: %d x APA102 en pines DATA=%d, CLOCK=%d (%d MHz)\n",
+                    numLeds, LED_DATA_PIN, LED_CLOCK_PIN, APA102_SPI_MHZ);
       break;
 
     default:
       Serial.println("Error: Tipo de LED no soportado");
+      if (wireBuffer != leds) {
+        delete[] wireBuffer;
+      }
+      wireBuffer = nullptr;
       delete[] leds;
       leds = nullptr;
-      initialized = false;
       return false;
   }
 
@@ -104,8 +155,9 @@ uint8_t LEDController::getBrightness() {
 }
 
 void LEDController::clear() {
+  // Solo el buffer de trabajo: el envío en curso no se ve afectado
   if (initialized) {
-    FastLED.clear();
+    fill_solid(leds, numLeds, CRGB::Black);
   }
 }
 
@@ -116,10 +168,52 @@ void LEDController::fill(CRGB color) {
 }
 
 void LEDController::show() {
-  if (initialized) {
+  if (!initialized) {
+    return;
+  }
+
+#ifdef LED_ASYNC_OUTPUT
+  if (wireBuffer != leds) {
+    // Esperar solo si el frame anterior aún se está transmitiendo
+    xSemaphoreTake(idleSem, portMAX_DELAY);
+    memcpy(wireBuffer, leds, numLeds * sizeof(CRGB));
+    xTaskNotifyGive(outputTask);
+    return;
+  }
+#endif
+  FastLED.show();
+}
+
+void LEDController::waitForIdle() {
+#ifdef LED_ASYNC_OUTPUT
+  if (idleSem != nullptr) {
+    xSemaphoreTake(idleSem, portMAX_DELAY);
+    xSemaphoreGive(idleSem);
+  }
+#endif
+}
+
+bool LEDController::isBusy() {
+#ifdef LED_ASYNC_OUTPUT
+  if (idleSem != nullptr) {
+    return uxSemaphoreGetCount(idleSem) == 0;
+  }
+#endif
+  return false;
+}
+
+#ifdef LED_ASYNC_OUTPUT
+// Tarea de salida: FastLED.show() bloquea hasta que el RMT/SPI termina,
+// así que se hace aquí y no en quien prepara las columnas
+void LEDController::outputTaskEntry(void* arg) {
+  LEDController* self = static_cast<LEDController*>(arg);
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
     FastLED.show();
+    xSemaphoreGive(self->idleSem);
   }
 }
+#endif
 
 CRGB* LEDController::getPixels() {
   return leds;
@@ -129,6 +223,24 @@ uint16_t LEDController::getNumLeds() {
   return numLeds;
 }
 
+uint32_t LEDController::getWireTimeUs() {
+  uint32_t wireUs;
+  if (ledType == LED_TYPE_APA102) {
+    // Start frame (32 bits) + 32 bits por LED + end frame (n/2 bits, mínimo 32)
+    uint32_t endBits = max((uint32_t)32, ((uint32_t)numLeds / 2 + 7) & ~7U);
+    uint32_t bits = 32 + (uint32_t)numLeds * 32 + endBits;
+    wireUs = (bits + APA102_SPI_MHZ - 1) / APA102_SPI_MHZ;
+  } else {
+    wireUs = (uint32_t)numLeds * WS281X_US_PER_LED + WS281X_RESET_US;
+  }
+  return wireUs + LED_SHOW_OVERHEAD_US;
+}
+
+uint16_t LEDController::getMaxColumnRate() {
+  uint32_t rate = 1000000UL / getWireTimeUs();
+  return constrain(rate, (uint32_t)MIN_POV_SPEED, (uint32_t)MAX_POV_SPEED);
+}
+
 bool LEDController::isInitialized() {
   return initialized;
 }
@@ -5,13 +5,26 @@
 #include <FastLED.h>
 #include "config.h"
 
+#ifdef LED_ASYNC_OUTPUT
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#endif
+
 class LEDController {
 private:
-  CRGB* leds;
+  CRGB* leds;        // Buffer de trabajo (getPixels/setPixel)
+  CRGB* wireBuffer;  // Buffer registrado en FastLED; solo lo toca el envío en curso
   uint16_t numLeds;
   uint8_t brightness;
   LEDStripType ledType;
   bool initialized;
+#ifdef LED_ASYNC_OUTPUT
+  TaskHandle_t outputTask;
+  SemaphoreHandle_t idleSem;  // Disponible cuando no hay ningún envío en curso
+
+  static void outputTaskEntry(void* arg);
+#endif
 
 public:
   LEDController();
@@ -27,9 +40,13 @@ public:
   uint8_t getBrightness();
   void clear();
   void fill(CRGB color);
-  void show();
+  void show();         // Asíncrono en ESP32: retorna en cuanto el frame queda encolado
+  void waitForIdle();  // Espera a que termine de transmitirse el último show()
+  bool isBusy();
   CRGB* getPixels();
   uint16_t getNumLeds();
+  uint32_t getWireTimeUs();     // Duración de un show() en el cable para el tipo y nº de LEDs actuales
+  uint16_t getMaxColumnRate();  // Columnas/segundo sostenibles (limitado a MAX_POV_SPEED)
   bool isInitialized();
 };
 
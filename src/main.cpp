@@ -13,6 +13,9 @@
 #include "effects.h"
 #include "image_manager.h"
 #include "image_parser.h"
+#include "flash_store.h"
+#include "frame_cache.h"
+#include "playlist.h"
 #include "wifi_manager.h"
 #include "web_server.h"
 #include "ha_integration.h"
@@ -213,6 +216,10 @@ void setup() {
     Serial.println("ERROR: No se pudo inicializar gestor de imágenes");
   } else {
     Serial.println("Gestor de imágenes inicializado");
+    // Copia mapeada de los .pov; necesita el catálogo para saber qué sigue al día
+    flashStore.init();
+    // Antes de la primera loadImage(): las imágenes decodificadas quedan en caché
+    frameCache.setBudget((size_t)config.frameCacheKB * 1024);
     // Si no hay imagen activa, seleccionar la primera disponible
     if (strlen(config.activeImage) == 0) {
       auto imgs = imageManager.listImages();
@@ -271,10 +278,19 @@ void setup() {
   povEngine.setSpeed(config.povSpeed);
   povEngine.setLoopMode(config.loopMode);
   povEngine.setOrientation(config.povOrientation);
+  povEngine.setResampleMode(config.povResample);
+  povEngine.setTimingMode(config.povTiming);
+  povEngine.setSweepSync(config.povSweepSync);
 
-  // Cargar imagen activa si existe
+  // La lista de reproducción activa al apagar tiene prioridad sobre la imagen activa
   bool povStarted = false;
-  if (strlen(config.activeImage) > 0) {
+  if (playlist.load() && playlist.isActive()) {
+    Serial.println("\nReanudando lista de reproducción");
+    povStarted = playlist.start();
+  }
+
+  // Cargar imagen activa si existe
+  if (!povStarted && strlen(config.activeImage) > 0) {
     Serial.printf("\nCargando imagen activa: %s\n", config.activeImage);
     if (povEngine.loadImage(config.activeImage)) {
       Serial.println("Imagen activa cargada correctamente");
@@ -395,12 +411,30 @@ void loop() {
   // Si está en modo POV (efecto 3) y hay movimiento, activar POV
   if (currentEffectIndex == 3) {
 #ifdef HAS_ACCELEROMETER
-    // Detectar dirección del movimiento para ajustar el orden de columnas
-    int8_t dir = accelerometer.getSweepDirection();
-    if (dir != 0) {
-      bool reverse = (dir < 0);  // dir negativo: invertir barrido
-      povEngine.setReverseDirection(reverse);
-      lastDirectionSign = dir;
+    if (config.povSweepSync) {
+      // En cada punto de giro: imagen desde la columna 0 y en el sentido del nuevo barrido
+      int8_t stroke = accelerometer.getSweep().pollTurnaround(ColumnScheduler::now());
+      if (stroke != 0) {
+        povEngine.syncSweep(stroke < 0);
+        lastDirectionSign = stroke;
+      }
+    } else {
+      // Detectar dirección del movimiento para ajustar el orden de columnas
+      int8_t dir = accelerometer.getSweepDirection();
+      if (dir != 0) {
+        bool reverse = (dir < 0);  // dir negativo: invertir barrido
+        povEngine.setReverseDirection(reverse);
+        lastDirectionSign = dir;
+      }
+    }
+
+    // Velocidad adaptativa: la tasa de columnas sigue la velocidad del barrido
+    // para que la imagen mantenga el mismo ancho físico
+    if (config.povAutoSpeed) {
+      uint16_t rate = accelerometer.getSweep().getColumnRate(config.columnPitchMm);
+      if (rate > 0) {
+        povEngine.setDynamicSpeed(rate);
+      }
     }
 
     if (motionDetected && !povEngine.isPlaying()) {
@@ -448,8 +482,12 @@ void loop() {
 #endif
   }
 
+  // Subida recibida: convertir y guardar aquí, no en la tarea del servidor web
+  webServer.update();
+
   // Actualizar POV engine
   povEngine.update();
+  playlist.update();
 
   // Actualizar efectos
   effects.update();
@@ -457,8 +495,12 @@ void loop() {
 #else
   // ==== MODO NORMAL ====
 
+  // Subida recibida: convertir y guardar aquí, no en la tarea del servidor web
+  webServer.update();
+
   // Actualizar POV engine
   povEngine.update();
+  playlist.update();
 
   // Actualizar efectos
   effects.update();
@@ -548,6 +590,15 @@ bool loadConfig() {
   String orientStr = doc["povOrientation"] | "vertical";
   config.povOrientation = (orientStr == "horizontal") ? POV_HORIZONTAL : POV_VERTICAL;
 
+  String resampleStr = doc["povResample"] | "nearest";
+  config.povResample = (resampleStr == "smooth") ? POV_RESAMPLE_SMOOTH : POV_RESAMPLE_NEAREST;
+  String timingStr = doc["povTiming"] | "sequential";
+  config.povTiming = (timingStr == "timed") ? POV_TIMING_TIMED : POV_TIMING_SEQUENTIAL;
+  config.povAutoSpeed = doc["povAutoSpeed"] | DEFAULT_POV_AUTO_SPEED;
+  config.povSweepSync = doc["povSweepSync"] | DEFAULT_POV_SWEEP_SYNC;
+  config.columnPitchMm = doc["columnPitchMm"] | DEFAULT_COLUMN_PITCH_MM;
+  config.frameCacheKB = constrain((int)(doc["frameCacheKB"] | DEFAULT_FRAME_CACHE_KB), 0, MAX_FRAME_CACHE_KB);
+
   if (doc.containsKey("activeImage"))
     strlcpy(config.activeImage, doc["activeImage"] | "", sizeof(config.activeImage));
 
@@ -589,6 +640,12 @@ bool saveConfig() {
   doc["povSpeed"] = config.povSpeed;
   doc["loopMode"] = config.loopMode;
   doc["povOrientation"] = (config.povOrientation == POV_VERTICAL) ? "vertical" : "horizontal";
+  doc["povResample"] = (config.povResample == POV_RESAMPLE_SMOOTH) ? "smooth" : "nearest";
+  doc["povTiming"] = (config.povTiming == POV_TIMING_TIMED) ? "timed" : "sequential";
+  doc["povAutoSpeed"] = config.povAutoSpeed;
+  doc["povSweepSync"] = config.povSweepSync;
+  doc["columnPitchMm"] = config.columnPitchMm;
+  doc["frameCacheKB"] = config.frameCacheKB;
   doc["activeImage"] = config.activeImage;
 
   doc["deviceName"] = config.deviceName;
@@ -618,6 +675,11 @@ void printConfig() {
   Serial.printf("  POV Speed: %d FPS\n", config.povSpeed);
   Serial.printf("  Loop Mode: %s\n", config.loopMode ? "ON" : "OFF");
   Serial.printf("  Orientation: %s\n", config.povOrientation == POV_VERTICAL ? "Vertical" : "Horizontal");
+  Serial.printf("  Resample: %s\n", config.povResample == POV_RESAMPLE_SMOOTH ? "Smooth" : "Nearest");
+  Serial.printf("  Timing: %s\n", config.povTiming == POV_TIMING_TIMED ? "Timed" : "Sequential");
+  Serial.printf("  Auto Speed: %s (%.1f mm/columna)\n", config.povAutoSpeed ? "ON" : "OFF", config.columnPitchMm);
+  Serial.printf("  Sweep Sync: %s\n", config.povSweepSync ? "ON" : "OFF");
+  Serial.printf("  Frame Cache: %u KB\n", config.frameCacheKB);
   Serial.printf("  WiFi: %s\n", config.wifiEnabled ? config.wifiSSID : "Disabled");
   Serial.printf("  MQTT: %s\n", config.mqttEnabled ? "Enabled" : "Disabled");
 }
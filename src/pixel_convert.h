@@ -0,0 +1,72 @@
+#ifndef PIXEL_CONVERT_H
+#define PIXEL_CONVERT_H
+
+#include <stdint.h>
+#include <string.h>
+
+// Conversión por lotes de píxeles de archivo a RGB888 (R, G, B por píxel; mismo
+// layout que CRGB). Un solo recorrido por lote, sin llamadas ni divisiones por
+// píxel. Sin dependencias de Arduino para poder medirlo en el host
+// (test/bench_decode.cpp).
+
+// Expansión de 5 y 6 bits a 8 bits: x * 255 / 31 y x * 255 / 63
+static const uint8_t RGB565_LUT5[32] = {
+  0, 8, 16, 24, 32, 41, 49, 57, 65, 74, 82, 90, 98, 106, 115, 123,
+  131, 139, 148, 156, 164, 172, 180, 189, 197, 205, 213, 222, 230, 238, 246, 255
+};
+
+static const uint8_t RGB565_LUT6[64] = {
+  0, 4, 8, 12, 16, 20, 24, 28, 32, 36, 40, 44, 48, 52, 56, 60,
+  64, 68, 72, 76, 80, 85, 89, 93, 97, 101, 105, 109, 113, 117, 121, 125,
+  129, 133, 137, 141, 145, 149, 153, 157, 161, 165, 170, 174, 178, 182, 186, 190,
+  194, 198, 202, 206, 210, 214, 218, 222, 226, 230, 234, 238, 242, 246, 250, 255
+};
+
+// BMP 24 bits: B, G, R -> R, G, B
+inline void convertBGR888(const uint8_t* src, uint8_t* dst, uint16_t count) {
+  for (uint16_t i = 0; i < count; i++, src += 3, dst += 3) {
+    dst[0] = src[2];
+    dst[1] = src[1];
+    dst[2] = src[0];
+  }
+}
+
+inline void convertRGB888(const uint8_t* src, uint8_t* dst, uint16_t count) {
+  memcpy(dst, src, (size_t)count * 3);
+}
+
+// RGB565 little-endian
+inline void convertRGB565(const uint8_t* src, uint8_t* dst, uint16_t count) {
+  for (uint16_t i = 0; i < count; i++, src += 2, dst += 3) {
+    uint16_t pixel = src[0] | (src[1] << 8);
+    dst[0] = RGB565_LUT5[pixel >> 11];
+    dst[1] = RGB565_LUT6[(pixel >> 5) & 0x3F];
+    dst[2] = RGB565_LUT5[pixel & 0x1F];
+  }
+}
+
+// Índices de 1/2/4/8 bits empaquetados (bit más alto primero, como BMP) a
+// través de una paleta de tripletes R, G, B con 2^bits entradas
+inline void convertIndexed(const uint8_t* src, uint8_t* dst, uint16_t count, uint8_t bits,
+                           const uint8_t* palette) {
+  if (bits == 8) {
+    for (uint16_t i = 0; i < count; i++, dst += 3) {
+      memcpy(dst, palette + src[i] * 3, 3);
+    }
+    return;
+  }
+
+  uint8_t mask = (1 << bits) - 1;
+  uint8_t shift = 0;
+  uint8_t byte = 0;
+  for (uint16_t i = 0; i < count; i++, dst += 3) {
+    if (shift == 0) {
+      byte = *src++;
+      shift = 8;
+    }
+    shift -= bits;
+    memcpy(dst, palette + ((byte >> shift) & mask) * 3, 3);
+  }
+}
+
+#endif
@@ -0,0 +1,297 @@
+#include "playlist.h"
+#include <LittleFS.h>
+#include "image_manager.h"
+#include "pov_engine.h"
+
+extern Config config;
+
+// Ninguna entrada en pantalla
+#define NO_ENTRY 0xFF
+
+Playlist::Playlist() : shuffle(false), active(false), position(0), current(NO_ENTRY), upcoming(NO_ENTRY),
+                       entryStartMs(0), seenSwitches(0) {
+}
+
+// Entrada de la lista en JSON: imagen y duración (ms) o vueltas
+static bool readEntry(JsonObjectConst item, PlaylistEntry& entry) {
+  const char* image = item["image"] | "";
+  if (strlen(image) == 0 || strlen(image) >= sizeof(entry.filename)) {
+    return false;
+  }
+  strlcpy(entry.filename, image, sizeof(entry.filename));
+  entry.loops = item["loops"] | 0;
+  entry.durationMs = entry.loops > 0 ? 0 : (item["duration"] | PLAYLIST_DEFAULT_DURATION_MS);
+  if (entry.loops == 0 && entry.durationMs == 0) {
+    entry.durationMs = PLAYLIST_DEFAULT_DURATION_MS;
+  }
+  return true;
+}
+
+bool Playlist::load() {
+  if (!LittleFS.exists(PLAYLIST_FILE)) {
+    return false;
+  }
+
+  File file = LittleFS.open(PLAYLIST_FILE, "r");
+  if (!file) {
+    return false;
+  }
+
+  JsonDocument doc;
+  DeserializationError error = deserializeJson(doc, file);
+  file.close();
+
+  if (error) {
+    Serial.printf("Error parseando lista de reproducción: %s\n", error.c_str());
+    return false;
+  }
+
+  // Las imágenes que falten se saltan al reproducir
+  entries.clear();
+  for (JsonObjectConst item : doc["entries"].as<JsonArrayConst>()) {
+    PlaylistEntry entry;
+    if (entries.size() < PLAYLIST_MAX_ENTRIES && readEntry(item, entry)) {
+      entries.push_back(entry);
+    }
+  }
+  shuffle = doc["shuffle"] | false;
+  // Activa al apagar: main.cpp la vuelve a empezar con start()
+  active = (doc["active"] | false) && !entries.empty();
+
+  Serial.printf("Lista de reproducción: %u imágenes%s\n", (unsigned)entries.size(), shuffle ? " (aleatoria)" : "");
+  return true;
+}
+
+bool Playlist::save() {
+  JsonDocument doc;
+  toJSON(doc.to<JsonObject>());
+  doc.remove("position");
+
+  File file = LittleFS.open(PLAYLIST_FILE, "w");
+  if (!file) {
+    Serial.println("Error abriendo lista de reproducción para escritura");
+    return false;
+  }
+
+  if (serializeJson(doc, file) == 0) {
+    Serial.println("Error escribiendo lista de reproducción");
+    file.close();
+    return false;
+  }
+
+  file.close();
+  return true;
+}
+
+bool Playlist::setEntries(JsonArrayConst list) {
+  std::vector<PlaylistEntry> parsed;
+  for (JsonObjectConst item : list) {
+    PlaylistEntry entry;
+    if (parsed.size() >= PLAYLIST_MAX_ENTRIES) {
+      Serial.printf("Error: Máximo %d imágenes en la lista\n", PLAYLIST_MAX_ENTRIES);
+      return false;
+    }
+    if (!readEntry(item, entry)) {
+      Serial.println("Error: Entrada de la lista sin imagen válida");
+      return false;
+    }
+    if (!imageManager.imageExists(entry.filename)) {
+      Serial.printf("Error: Imagen %s no existe\n", entry.filename);
+      return false;
+    }
+    parsed.push_back(entry);
+  }
+
+  entries = parsed;
+  if (active) {
+    // Se empieza de nuevo con la lista nueva
+    if (entries.empty()) {
+      stop();
+    } else {
+      start();
+    }
+  }
+  return save();
+}
+
+void Playlist::setShuffle(bool enabled) {
+  shuffle = enabled;
+  save();
+}
+
+bool Playlist::getShuffle() {
+  return shuffle;
+}
+
+size_t Playlist::getEntryCount() {
+  return entries.size();
+}
+
+void Playlist::toJSON(JsonObject obj) {
+  obj["active"] = active;
+  obj["shuffle"] = shuffle;
+  obj["position"] = getPosition();
+  JsonArray list = obj["entries"].to<JsonArray>();
+  for (const PlaylistEntry& entry : entries) {
+    JsonObject item = list.add<JsonObject>();
+    item["image"] = entry.filename;
+    if (entry.loops > 0) {
+      item["loops"] = entry.loops;
+    } else {
+      item["duration"] = entry.durationMs;
+    }
+  }
+}
+
+bool Playlist::start() {
+  if (entries.empty()) {
+    Serial.println("Error: Lista de reproducción vacía");
+    return false;
+  }
+
+  povEngine.cancelPrefetch();
+  // Al terminar cada secuencia se decide si toca cambiar; nunca se para sola
+  povEngine.setLoopMode(true);
+  current = NO_ENTRY;
+  buildOrder();
+  position = 1;
+  active = true;
+  if (!playEntry(order[0])) {
+    return false;  // playEntry() ya la ha detenido
+  }
+
+  save();
+  Serial.printf("Lista de reproducción iniciada: %u imágenes\n", (unsigned)entries.size());
+  return true;
+}
+
+void Playlist::stop() {
+  if (!active) {
+    return;
+  }
+
+  active = false;
+  current = NO_ENTRY;
+  povEngine.cancelPrefetch();
+  povEngine.setLoopMode(config.loopMode);
+  save();
+  Serial.println("Lista de reproducción detenida");
+}
+
+bool Playlist::next() {
+  if (!active || entries.size() < 2) {
+    return false;
+  }
+  if (povEngine.hasNextImage()) {
+    povEngine.switchToNext();
+    return true;
+  }
+  return playEntry(upcoming);
+}
+
+// Llamada en cada loop() tras POVEngine::update()
+void Playlist::update() {
+  if (!active || current == NO_ENTRY) {
+    return;
+  }
+
+  // POVEngine ya ha pasado a la precargada
+  if (povEngine.getImageSwitches() != seenSwitches) {
+    beginEntry(upcoming);
+    return;
+  }
+
+  if (entries.size() < 2 || !povEngine.isPlaying() || povEngine.isSwitchArmed()) {
+    return;
+  }
+
+  const PlaylistEntry& entry = entries[current];
+  bool due = (entry.loops > 0) ? povEngine.getSequenceCount() >= entry.loops
+                               : millis() - entryStartMs >= entry.durationMs;
+  if (!due) {
+    return;
+  }
+
+  // La precarga se pierde si cambia la orientación o el remuestreo: se repite
+  if (povEngine.hasNextImage() || povEngine.prefetchImage(entries[upcoming].filename)) {
+    povEngine.switchToNext();
+  } else {
+    // Sin memoria para dos imágenes: carga normal, con el barrido reiniciado
+    playEntry(upcoming);
+  }
+}
+
+bool Playlist::isActive() {
+  return active;
+}
+
+int Playlist::getPosition() {
+  return (active && current != NO_ENTRY) ? current : -1;
+}
+
+// Orden de una vuelta a la lista; barajado no repite la imagen en pantalla
+void Playlist::buildOrder() {
+  order.clear();
+  for (size_t i = 0; i < entries.size(); i++) {
+    order.push_back(i);
+  }
+  if (!shuffle) {
+    return;
+  }
+  for (size_t i = order.size(); i > 1; i--) {
+    size_t j = random(i);
+    std::swap(order[i - 1], order[j]);
+  }
+  if (order.size() > 1 && order[0] == current) {
+    std::swap(order[0], order[1]);
+  }
+}
+
+// Elige la siguiente entrada y la precarga. Las entradas por vueltas dejan el
+// cambio preparado para que ocurra justo al completar la última secuencia
+void Playlist::prepareNext() {
+  if (position >= order.size()) {
+    buildOrder();
+    position = 0;
+  }
+  upcoming = order[position++];
+
+  if (entries.size() < 2) {
+    return;
+  }
+  if (povEngine.prefetchImage(entries[upcoming].filename) && entries[current].loops > 0) {
+    povEngine.switchToNext(entries[current].loops);
+  }
+}
+
+void Playlist::beginEntry(uint8_t entry) {
+  current = entry;
+  entryStartMs = millis();
+  seenSwitches = povEngine.getImageSwitches();
+  prepareNext();
+}
+
+// Carga normal de una entrada (al empezar, o si no se pudo precargar); las
+// que no se pueden cargar se saltan
+bool Playlist::playEntry(uint8_t entry) {
+  for (size_t tries = 0; tries < entries.size(); tries++) {
+    if (povEngine.loadImage(entries[entry].filename)) {
+      povEngine.play();
+      beginEntry(entry);
+      return true;
+    }
+    Serial.printf("AVISO: %s no se puede reproducir, se salta\n", entries[entry].filename);
+    if (position >= order.size()) {
+      buildOrder();
+      position = 0;
+    }
+    entry = order[position++];
+  }
+
+  Serial.println("Error: Ninguna imagen de la lista se puede reproducir");
+  stop();
+  return false;
+}
+
+// Instancia global
+Playlist playlist;
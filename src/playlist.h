@@ -0,0 +1,64 @@
+#ifndef PLAYLIST_H
+#define PLAYLIST_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <vector>
+#include "config.h"
+
+// Una imagen de la lista: durante un tiempo o un número de secuencias
+// completas (la imagen entera, o todos los fotogramas de una animación)
+struct PlaylistEntry {
+  char filename[32];
+  uint32_t durationMs;  // Con loops 0
+  uint16_t loops;       // 0: por tiempo
+};
+
+// Lista de reproducción persistente (PLAYLIST_FILE, junto a CONFIG_FILE).
+// Mientras se muestra una imagen, POVEngine precarga la siguiente y cambia
+// entre dos columnas al terminar la secuencia, sin barrido en negro. Con
+// shuffle el orden se baraja en cada vuelta a la lista. El estado activo se
+// guarda: tras reiniciar la lista sigue en vez de la imagen activa.
+class Playlist {
+private:
+  std::vector<PlaylistEntry> entries;
+  std::vector<uint8_t> order;   // Orden de reproducción (índices de entries)
+  bool shuffle;
+  bool active;
+  size_t position;              // Posición en order de la siguiente
+  uint8_t current;              // Entrada en pantalla
+  uint8_t upcoming;             // Entrada precargada (la siguiente)
+  unsigned long entryStartMs;
+  uint32_t seenSwitches;        // POVEngine::getImageSwitches() ya atendidos
+
+public:
+  Playlist();
+
+  bool load();
+  bool save();
+
+  // Sustituye las entradas: [{"image":"a.bmp","duration":10000},{"image":"b.pov","loops":3}]
+  bool setEntries(JsonArrayConst list);
+  void setShuffle(bool enabled);
+  bool getShuffle();
+  size_t getEntryCount();
+  void toJSON(JsonObject obj);
+
+  bool start();
+  void stop();
+  bool next();   // Pasar a la siguiente al final del barrido en curso
+  void update();
+
+  bool isActive();
+  int getPosition();  // Entrada en pantalla (-1 si no está activa)
+
+private:
+  void buildOrder();
+  void prepareNext();
+  void beginEntry(uint8_t entry);
+  bool playEntry(uint8_t entry);
+};
+
+extern Playlist playlist;
+
+#endif
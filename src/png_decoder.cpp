@@ -0,0 +1,477 @@
+#include "png_decoder.h"
+#include <stdlib.h>
+
+static const uint8_t PNG_SIGNATURE_BYTES[8] = {137, 80, 78, 71, 13, 10, 26, 10};
+
+static uint32_t readBigEndian32(const uint8_t* data) {
+  return ((uint32_t)data[0] << 24) | ((uint32_t)data[1] << 16) | ((uint32_t)data[2] << 8) | data[3];
+}
+
+// Mezcla sobre negro: valor * alfa / 255 redondeado
+static uint8_t blend(uint8_t value, uint8_t alpha) {
+  return ((uint16_t)value * alpha + 127) / 255;
+}
+
+PNGDecoder::PNGDecoder() : state(PNG_FAILED), onHeader(nullptr), onRow(nullptr), context(nullptr),
+                           maxWidth(0), maxWindow(0), error(""), headerFill(0), chunkLength(0),
+                           chunkPosition(0), seenHeader(false), seenData(false), width(0), height(0),
+                           bitDepth(0), colorType(0), channels(0), indexBits(0), paletteEntries(0),
+                           alphaEntries(0), hasColorKey(false), rowBytes(0), filterBytes(0),
+                           currentRow(nullptr), previousRow(nullptr), outputRow(nullptr), rowFill(0),
+                           rowsDecoded(0) {
+  chunkType[0] = '\0';
+}
+
+PNGDecoder::~PNGDecoder() {
+  end();
+}
+
+bool PNGDecoder::begin(uint16_t maxWidthPixels, uint32_t maxWindowBytes, HeaderFunction headerFunction,
+                       RowFunction rowFunction, void* functionContext) {
+  end();
+  onHeader = headerFunction;
+  onRow = rowFunction;
+  context = functionContext;
+  maxWidth = maxWidthPixels;
+  maxWindow = maxWindowBytes;
+  error = "";
+  headerFill = 0;
+  seenHeader = false;
+  seenData = false;
+  width = 0;
+  height = 0;
+  indexBits = 0;
+  paletteEntries = 0;
+  alphaEntries = 0;
+  hasColorKey = false;
+  rowsDecoded = 0;
+  memset(palette, 0, sizeof(palette));
+  state = PNG_SIGNATURE;
+  return true;
+}
+
+void PNGDecoder::end() {
+  inflater.end();
+  releaseRows();
+  state = PNG_FAILED;
+}
+
+bool PNGDecoder::isFinished() {
+  return seenData && rowsDecoded == height && inflater.isFinished();
+}
+
+uint16_t PNGDecoder::getWidth() {
+  return width;
+}
+
+uint16_t PNGDecoder::getHeight() {
+  return height;
+}
+
+uint16_t PNGDecoder::getRowsDecoded() {
+  return rowsDecoded;
+}
+
+uint8_t PNGDecoder::getBytesPerPixel() {
+  return indexBits > 0 ? 1 : 3;
+}
+
+uint8_t PNGDecoder::getIndexBits() {
+  return indexBits;
+}
+
+const uint8_t* PNGDecoder::getPalette() {
+  return palette;
+}
+
+uint32_t PNGDecoder::getWindowSize() {
+  return inflater.getWindowSize();
+}
+
+const char* PNGDecoder::getError() {
+  return error;
+}
+
+bool PNGDecoder::write(const uint8_t* data, uint32_t length) {
+  while (length > 0) {
+    uint32_t n = 1;
+
+    switch (state) {
+      case PNG_SIGNATURE:
+        headerBytes[headerFill++] = *data;
+        if (headerFill == 8) {
+          if (memcmp(headerBytes, PNG_SIGNATURE_BYTES, 8) != 0) {
+            return fail("firma PNG inválida");
+          }
+          headerFill = 0;
+          state = PNG_CHUNK_HEADER;
+        }
+        break;
+
+      case PNG_CHUNK_HEADER:
+        headerBytes[headerFill++] = *data;
+        if (headerFill < 8) {
+          break;
+        }
+        headerFill = 0;
+        chunkLength = readBigEndian32(headerBytes);
+        chunkPosition = 0;
+        memcpy(chunkType, headerBytes + 4, 4);
+        chunkType[4] = '\0';
+
+        if (!seenHeader && (strcmp(chunkType, "IHDR") != 0 || chunkLength != 13)) {
+          return fail("falta IHDR");
+        }
+        if (seenHeader && strcmp(chunkType, "IHDR") == 0) {
+          return fail("IHDR repetido");
+        }
+        // Tras el primer IDAT solo pueden venir más IDAT e IEND: la paleta y las
+        // dimensiones ya están fijadas y las filas reservadas
+        if (seenData && strcmp(chunkType, "IDAT") != 0 && strcmp(chunkType, "IEND") != 0) {
+          return fail("chunk tras los datos de imagen");
+        }
+        if (strcmp(chunkType, "PLTE") == 0 && (chunkLength % 3 != 0 || chunkLength > 256 * 3)) {
+          return fail("PLTE inválido");
+        }
+        if (strcmp(chunkType, "tRNS") == 0 && chunkLength > transparencyLength()) {
+          return fail("tRNS inválido");
+        }
+        if (strcmp(chunkType, "IDAT") == 0 && !seenData && !startData()) {
+          return false;
+        }
+        if (strcmp(chunkType, "IEND") == 0) {
+          state = PNG_END;
+          return true;
+        }
+        state = chunkLength > 0 ? PNG_CHUNK_DATA : PNG_CHUNK_CRC;
+        break;
+
+      case PNG_CHUNK_DATA:
+        n = chunkLength - chunkPosition < length ? chunkLength - chunkPosition : length;
+        if (strcmp(chunkType, "IDAT") == 0) {
+          if (!inflater.write(data, n)) {
+            return state == PNG_FAILED ? false : fail(inflater.getError());
+          }
+          chunkPosition += n;
+        } else {
+          for (uint32_t i = 0; i < n; i++, chunkPosition++) {
+            storeChunkByte(data[i]);
+          }
+        }
+        if (chunkPosition == chunkLength) {
+          if (strcmp(chunkType, "IHDR") == 0 && !parseHeader()) {
+            return false;
+          }
+          state = PNG_CHUNK_CRC;
+        }
+        break;
+
+      case PNG_CHUNK_CRC:
+        // El CRC no se comprueba: los datos de imagen ya llevan el Adler-32 de zlib
+        if (++headerFill == 4) {
+          headerFill = 0;
+          state = PNG_CHUNK_HEADER;
+        }
+        break;
+
+      case PNG_END:
+        return true;
+
+      default:
+        return false;
+    }
+
+    data += n;
+    length -= n;
+  }
+
+  return state != PNG_FAILED;
+}
+
+bool PNGDecoder::parseHeader() {
+  uint32_t headerWidth = readBigEndian32(headerBytes);
+  uint32_t headerHeight = readBigEndian32(headerBytes + 4);
+  bitDepth = headerBytes[8];
+  colorType = headerBytes[9];
+
+  if (headerBytes[10] != 0 || headerBytes[11] != 0) {
+    return fail("compresión o filtro PNG desconocidos");
+  }
+  if (headerBytes[12] != 0) {
+    return fail("PNG entrelazado no soportado");
+  }
+  if (headerWidth == 0 || headerWidth > maxWidth || headerHeight == 0 || headerHeight > 0xFFFF) {
+    return fail("dimensiones PNG no soportadas");
+  }
+
+  // Profundidades válidas por tipo de color (PNG 11.2.2)
+  bool valid;
+  switch (colorType) {
+    case PNG_GRAY:
+      channels = 1;
+      valid = bitDepth == 1 || bitDepth == 2 || bitDepth == 4 || bitDepth == 8 || bitDepth == 16;
+      break;
+    case PNG_PALETTE:
+      channels = 1;
+      valid = bitDepth == 1 || bitDepth == 2 || bitDepth == 4 || bitDepth == 8;
+      break;
+    case PNG_RGB:
+      channels = 3;
+      valid = bitDepth == 8 || bitDepth == 16;
+      break;
+    case PNG_GRAY_ALPHA:
+      channels = 2;
+      valid = bitDepth == 8 || bitDepth == 16;
+      break;
+    case PNG_RGBA:
+      channels = 4;
+      valid = bitDepth == 8 || bitDepth == 16;
+      break;
+    default:
+      valid = false;
+      break;
+  }
+  if (!valid) {
+    return fail("tipo de color PNG inválido");
+  }
+
+  width = headerWidth;
+  height = headerHeight;
+  seenHeader = true;
+  return true;
+}
+
+// Tamaño máximo de tRNS según el tipo de color: un alfa por entrada de paleta
+// o un color transparente de 16 bits por canal; con alfa propio no se admite
+uint32_t PNGDecoder::transparencyLength() {
+  switch (colorType) {
+    case PNG_PALETTE:
+      return 256;
+    case PNG_GRAY:
+      return 2;
+    case PNG_RGB:
+      return 6;
+    default:
+      return 0;
+  }
+}
+
+// IHDR, PLTE (R, G, B) y tRNS (alfa de paleta o color transparente de 16 bits).
+// write() ya ha comprobado que caben: IHDR de 13 bytes y solo el primero, PLTE
+// de hasta 256 entradas y tRNS de hasta transparencyLength(), todos antes de IDAT
+void PNGDecoder::storeChunkByte(uint8_t value) {
+  if (strcmp(chunkType, "IHDR") == 0) {
+    headerBytes[chunkPosition] = value;
+  } else if (strcmp(chunkType, "PLTE") == 0) {
+    palette[chunkPosition] = value;
+    paletteEntries = chunkPosition / 3 + 1;
+  } else if (strcmp(chunkType, "tRNS") == 0) {
+    if (colorType == PNG_PALETTE) {
+      alpha[chunkPosition] = value;
+      alphaEntries = chunkPosition + 1;
+    } else {
+      uint16_t& key = colorKey[chunkPosition / 2];
+      key = chunkPosition % 2 == 0 ? value << 8 : key | value;
+      hasColorKey = true;
+    }
+  }
+}
+
+// Primer IDAT: fijar el formato de salida, avisar y preparar las filas
+bool PNGDecoder::startData() {
+  if (colorType == PNG_PALETTE) {
+    if (paletteEntries == 0) {
+      return fail("PNG con paleta sin PLTE");
+    }
+    indexBits = bitDepth;
+    for (uint16_t i = 0; i < alphaEntries && i < paletteEntries; i++) {
+      for (uint8_t c = 0; c < 3; c++) {
+        palette[i * 3 + c] = blend(palette[i * 3 + c], alpha[i]);
+      }
+    }
+  } else if (colorType == PNG_GRAY || colorType == PNG_GRAY_ALPHA) {
+    // Gris como paleta: rampa de 2^bits niveles (8 bits para 16 bits y gris con alfa)
+    indexBits = (colorType == PNG_GRAY && bitDepth <= 8) ? bitDepth : 8;
+    uint16_t levels = 1 << indexBits;
+    for (uint16_t i = 0; i < levels; i++) {
+      memset(palette + i * 3, i * 255 / (levels - 1), 3);
+    }
+    if (colorType == PNG_GRAY && bitDepth <= 8 && hasColorKey && colorKey[0] < levels) {
+      memset(palette + colorKey[0] * 3, 0, 3);
+    }
+  } else {
+    indexBits = 0;
+  }
+
+  rowBytes = ((uint32_t)width * channels * bitDepth + 7) / 8;
+  filterBytes = channels * bitDepth >= 8 ? channels * bitDepth / 8 : 1;
+
+  if (onHeader != nullptr && !onHeader(context)) {
+    return fail("formato rechazado");
+  }
+
+  currentRow = new uint8_t[1 + rowBytes];
+  previousRow = new uint8_t[1 + rowBytes];
+  outputRow = new uint8_t[(uint32_t)width * getBytesPerPixel()];
+  if (currentRow == nullptr || previousRow == nullptr || outputRow == nullptr) {
+    return fail("sin memoria para las filas");
+  }
+  memset(previousRow, 0, 1 + rowBytes);  // La fila anterior a la primera es cero
+  rowFill = 0;
+
+  if (!inflater.begin(maxWindow, &PNGDecoder::inflateOutput, this)) {
+    return fail("no se pudo iniciar zlib");
+  }
+  seenData = true;
+  return true;
+}
+
+bool PNGDecoder::inflateOutput(void* context, const uint8_t* data, uint32_t length) {
+  return static_cast<PNGDecoder*>(context)->consume(data, length);
+}
+
+// Datos descomprimidos: byte de filtro + fila, una tras otra
+bool PNGDecoder::consume(const uint8_t* data, uint32_t length) {
+  while (length > 0 && rowsDecoded < height) {
+    uint32_t n = 1 + rowBytes - rowFill < length ? 1 + rowBytes - rowFill : length;
+    memcpy(currentRow + rowFill, data, n);
+    rowFill += n;
+    data += n;
+    length -= n;
+    if (rowFill < 1 + rowBytes) {
+      break;
+    }
+
+    if (!unfilterRow()) {
+      return false;
+    }
+    normalizeRow();
+    if (!onRow(context, outputRow)) {
+      return fail("fila rechazada");
+    }
+
+    uint8_t* swap = previousRow;
+    previousRow = currentRow;
+    currentRow = swap;
+    rowFill = 0;
+    rowsDecoded++;
+  }
+  return true;
+}
+
+bool PNGDecoder::unfilterRow() {
+  uint8_t filter = currentRow[0];
+  uint8_t* row = currentRow + 1;
+  const uint8_t* prior = previousRow + 1;
+
+  for (uint32_t i = 0; i < rowBytes; i++) {
+    uint8_t left = i >= filterBytes ? row[i - filterBytes] : 0;
+    uint8_t up = prior[i];
+    uint8_t upLeft = i >= filterBytes ? prior[i - filterBytes] : 0;
+
+    switch (filter) {
+      case 0:
+        break;
+      case 1:
+        row[i] += left;
+        break;
+      case 2:
+        row[i] += up;
+        break;
+      case 3:
+        row[i] += (left + up) / 2;
+        break;
+      case 4: {
+        // Paeth: el vecino más cercano a left + up - upLeft
+        int16_t estimate = left + up - upLeft;
+        int16_t distanceLeft = abs(estimate - left);
+        int16_t distanceUp = abs(estimate - up);
+        int16_t distanceUpLeft = abs(estimate - upLeft);
+        if (distanceLeft <= distanceUp && distanceLeft <= distanceUpLeft) {
+          row[i] += left;
+        } else if (distanceUp <= distanceUpLeft) {
+          row[i] += up;
+        } else {
+          row[i] += upLeft;
+        }
+        break;
+      }
+      default:
+        return fail("filtro PNG inválido");
+    }
+  }
+  return true;
+}
+
+// Muestra index de la fila (bits más altos primero en profundidades < 8)
+uint16_t PNGDecoder::sample(const uint8_t* row, uint32_t index) {
+  if (bitDepth == 16) {
+    return (row[index * 2] << 8) | row[index * 2 + 1];
+  }
+  if (bitDepth == 8) {
+    return row[index];
+  }
+  uint32_t bit = index * bitDepth;
+  return (row[bit / 8] >> (8 - bitDepth - bit % 8)) & ((1 << bitDepth) - 1);
+}
+
+void PNGDecoder::normalizeRow() {
+  const uint8_t* row = currentRow + 1;
+  uint8_t* out = outputRow;
+  uint8_t shift = bitDepth == 16 ? 8 : 0;  // De 16 bits se toma el byte alto
+
+  for (uint16_t x = 0; x < width; x++) {
+    uint32_t first = (uint32_t)x * channels;
+    switch (colorType) {
+      case PNG_PALETTE:
+        *out++ = sample(row, first);
+        break;
+
+      case PNG_GRAY: {
+        uint16_t gray = sample(row, first);
+        *out++ = (bitDepth == 16 && hasColorKey && gray == colorKey[0]) ? 0 : gray >> shift;
+        break;
+      }
+
+      case PNG_GRAY_ALPHA:
+        *out++ = blend(sample(row, first) >> shift, sample(row, first + 1) >> shift);
+        break;
+
+      case PNG_RGB: {
+        uint16_t r = sample(row, first);
+        uint16_t g = sample(row, first + 1);
+        uint16_t b = sample(row, first + 2);
+        bool transparent = hasColorKey && r == colorKey[0] && g == colorKey[1] && b == colorKey[2];
+        *out++ = transparent ? 0 : r >> shift;
+        *out++ = transparent ? 0 : g >> shift;
+        *out++ = transparent ? 0 : b >> shift;
+        break;
+      }
+
+      default: {  // PNG_RGBA
+        uint8_t a = sample(row, first + 3) >> shift;
+        *out++ = blend(sample(row, first) >> shift, a);
+        *out++ = blend(sample(row, first + 1) >> shift, a);
+        *out++ = blend(sample(row, first + 2) >> shift, a);
+        break;
+      }
+    }
+  }
+}
+
+void PNGDecoder::releaseRows() {
+  delete[] currentRow;
+  delete[] previousRow;
+  delete[] outputRow;
+  currentRow = nullptr;
+  previousRow = nullptr;
+  outputRow = nullptr;
+}
+
+bool PNGDecoder::fail(const char* reason) {
+  if (state != PNG_FAILED) {
+    error = reason;
+  }
+  state = PNG_FAILED;
+  return false;
+}
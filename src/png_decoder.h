@@ -0,0 +1,109 @@
+#ifndef PNG_DECODER_H
+#define PNG_DECODER_H
+
+#include <stdint.h>
+#include <string.h>
+#include "inflater.h"
+
+// Decodificador PNG por streaming: recibe el archivo en trozos con write() y
+// entrega cada fila en cuanto se completa, ya sin filtro y normalizada:
+//   - Paleta y gris de 1-8 bits, gris de 16 bits y gris con alfa: un índice
+//     por byte y una paleta RGB de 2^getIndexBits() entradas (en gris, una rampa)
+//   - RGB y RGBA: 3 bytes R, G, B por píxel
+// La transparencia (alfa o tRNS) se mezcla sobre negro: LEDs apagados.
+// En RAM: la ventana del Inflater, dos filas del PNG y la fila normalizada.
+// No se admiten PNG entrelazados (Adam7). Sin dependencias de Arduino.
+class PNGDecoder {
+public:
+  // Cabecera lista (tras IHDR/PLTE/tRNS, al empezar los datos): false para abortar
+  typedef bool (*HeaderFunction)(void* context);
+  typedef bool (*RowFunction)(void* context, const uint8_t* row);
+
+  PNGDecoder();
+  ~PNGDecoder();
+
+  bool begin(uint16_t maxWidth, uint32_t maxWindow, HeaderFunction onHeader, RowFunction onRow,
+             void* context);
+  bool write(const uint8_t* data, uint32_t length);
+  void end();
+
+  bool isFinished();  // Todas las filas entregadas y datos zlib verificados
+  uint16_t getWidth();
+  uint16_t getHeight();
+  uint16_t getRowsDecoded();
+  uint8_t getBytesPerPixel();  // 1 (índice) o 3 (RGB)
+  uint8_t getIndexBits();      // 0 si la salida es RGB
+  const uint8_t* getPalette(); // 2^getIndexBits() entradas R, G, B
+  uint32_t getWindowSize();
+  const char* getError();
+
+private:
+  enum State {
+    PNG_SIGNATURE,
+    PNG_CHUNK_HEADER,
+    PNG_CHUNK_DATA,
+    PNG_CHUNK_CRC,
+    PNG_END,
+    PNG_FAILED
+  };
+
+  enum ColorType {
+    PNG_GRAY = 0,
+    PNG_RGB = 2,
+    PNG_PALETTE = 3,
+    PNG_GRAY_ALPHA = 4,
+    PNG_RGBA = 6
+  };
+
+  State state;
+  HeaderFunction onHeader;
+  RowFunction onRow;
+  void* context;
+  uint16_t maxWidth;
+  uint32_t maxWindow;
+  const char* error;
+  Inflater inflater;
+
+  uint8_t headerBytes[13];     // Firma, cabecera de chunk o IHDR
+  uint8_t headerFill;
+  uint32_t chunkLength;
+  uint32_t chunkPosition;
+  char chunkType[5];
+  bool seenHeader;
+  bool seenData;
+
+  uint16_t width;
+  uint16_t height;
+  uint8_t bitDepth;
+  uint8_t colorType;
+  uint8_t channels;
+  uint8_t indexBits;
+  uint8_t palette[256 * 3];
+  uint16_t paletteEntries;
+  uint8_t alpha[256];          // tRNS de paleta
+  uint16_t alphaEntries;
+  uint16_t colorKey[3];        // tRNS de gris/RGB
+  bool hasColorKey;
+
+  uint32_t rowBytes;           // Fila del PNG sin el byte de filtro
+  uint8_t filterBytes;         // Distancia al píxel anterior para los filtros
+  uint8_t* currentRow;         // Byte de filtro + fila
+  uint8_t* previousRow;
+  uint8_t* outputRow;
+  uint32_t rowFill;
+  uint16_t rowsDecoded;
+
+  bool parseHeader();
+  bool startData();
+  uint32_t transparencyLength();
+  void storeChunkByte(uint8_t value);
+  static bool inflateOutput(void* context, const uint8_t* data, uint32_t length);
+  bool consume(const uint8_t* data, uint32_t length);
+  bool unfilterRow();
+  void normalizeRow();
+  uint16_t sample(const uint8_t* row, uint32_t index);
+  void releaseRows();
+  bool fail(const char* reason);
+};
+
+#endif
@@ -0,0 +1,200 @@
+#ifndef POV_CODEC_H
+#define POV_CODEC_H
+
+#include <stdint.h>
+#include <string.h>
+
+// Codificación de columnas .pov (ver POVHeader en image_parser.h). Trabaja con
+// columnas "desempaquetadas": height píxeles de bytesPerPixel bytes (3 en
+// RGB888, 2 en RGB565, 1 índice por byte en los formatos indexados). bits es
+// la profundidad de los índices (0 si no hay paleta) y solo afecta a RAW, que
+// los guarda empaquetados. Sin dependencias de Arduino: lo usan ImageParser,
+// ImageTranscoder y test/bench_columns.cpp.
+
+enum POVColumnEncoding {
+  POV_COLUMN_RAW = 0,     // height píxeles seguidos (indexado: empaquetados)
+  POV_COLUMN_RLE = 1,     // Pares (repeticiones 1-255, píxel o índice de 1 byte) hasta completar height
+  POV_COLUMN_REPEAT = 2,  // Igual que la columna anterior; solo el byte de codificación
+  POV_COLUMN_DELTA = 3    // Como RLE, pero cada píxel es el XOR con la columna anterior
+};
+
+// Las columnas múltiplo de POV_KEYFRAME_INTERVAL son siempre RAW o RLE, así que
+// leer una columna suelta decodifica como mucho POV_KEYFRAME_INTERVAL columnas
+#define POV_KEYFRAME_INTERVAL 16
+
+inline bool povIsKeyframe(uint16_t column) {
+  return column % POV_KEYFRAME_INTERVAL == 0;
+}
+
+// Bytes de los pares RLE de una columna; con previous, del XOR con ella
+inline uint32_t povRunBytes(const uint8_t* pixels, const uint8_t* previous, uint16_t height,
+                            uint8_t bytesPerPixel) {
+  uint32_t bytes = 0;
+  uint8_t current[3];
+  uint8_t next[3];
+  uint16_t y = 0;
+  while (y < height) {
+    for (uint8_t c = 0; c < bytesPerPixel; c++) {
+      uint32_t i = (uint32_t)y * bytesPerPixel + c;
+      current[c] = previous ? pixels[i] ^ previous[i] : pixels[i];
+    }
+    uint16_t run = 1;
+    while (y + run < height && run < 255) {
+      for (uint8_t c = 0; c < bytesPerPixel; c++) {
+        uint32_t i = (uint32_t)(y + run) * bytesPerPixel + c;
+        next[c] = previous ? pixels[i] ^ previous[i] : pixels[i];
+      }
+      if (memcmp(current, next, bytesPerPixel) != 0) {
+        break;
+      }
+      run++;
+    }
+    bytes += 1 + bytesPerPixel;
+    y += run;
+  }
+  return bytes;
+}
+
+inline uint32_t povWriteRuns(const uint8_t* pixels, const uint8_t* previous, uint16_t height,
+                             uint8_t bytesPerPixel, uint8_t* out) {
+  uint8_t* start = out;
+  uint16_t y = 0;
+  while (y < height) {
+    uint8_t* pixel = out + 1;
+    for (uint8_t c = 0; c < bytesPerPixel; c++) {
+      uint32_t i = (uint32_t)y * bytesPerPixel + c;
+      pixel[c] = previous ? pixels[i] ^ previous[i] : pixels[i];
+    }
+    uint16_t run = 1;
+    while (y + run < height && run < 255) {
+      bool same = true;
+      for (uint8_t c = 0; c < bytesPerPixel && same; c++) {
+        uint32_t i = (uint32_t)(y + run) * bytesPerPixel + c;
+        same = (uint8_t)(previous ? pixels[i] ^ previous[i] : pixels[i]) == pixel[c];
+      }
+      if (!same) {
+        break;
+      }
+      run++;
+    }
+    out[0] = run;
+    out += 1 + bytesPerPixel;
+    y += run;
+  }
+  return out - start;
+}
+
+inline uint32_t povRawBytes(uint16_t height, uint8_t bytesPerPixel, uint8_t bits) {
+  return bits > 0 ? ((uint32_t)height * bits + 7) / 8 : (uint32_t)height * bytesPerPixel;
+}
+
+// Codifica una columna en out (como mucho 1 + height * bytesPerPixel bytes) con
+// la codificación más corta. previous es la columna anterior desempaquetada, o
+// nullptr en las columnas clave. Devuelve los bytes escritos
+inline uint32_t povEncodeColumn(const uint8_t* pixels, const uint8_t* previous, uint16_t height,
+                                uint8_t bytesPerPixel, uint8_t bits, uint8_t* out) {
+  uint32_t columnBytes = (uint32_t)height * bytesPerPixel;
+  if (previous != nullptr && memcmp(pixels, previous, columnBytes) == 0) {
+    out[0] = POV_COLUMN_REPEAT;
+    return 1;
+  }
+
+  uint32_t raw = povRawBytes(height, bytesPerPixel, bits);
+  uint32_t rle = povRunBytes(pixels, nullptr, height, bytesPerPixel);
+  uint32_t delta = previous != nullptr ? povRunBytes(pixels, previous, height, bytesPerPixel) : UINT32_MAX;
+
+  if (delta < rle && delta < raw) {
+    out[0] = POV_COLUMN_DELTA;
+    return 1 + povWriteRuns(pixels, previous, height, bytesPerPixel, out + 1);
+  }
+  if (rle < raw) {
+    out[0] = POV_COLUMN_RLE;
+    return 1 + povWriteRuns(pixels, nullptr, height, bytesPerPixel, out + 1);
+  }
+
+  out[0] = POV_COLUMN_RAW;
+  if (bits == 0) {
+    memcpy(out + 1, pixels, columnBytes);
+  } else {
+    // Bit más alto primero, como las filas BMP
+    memset(out + 1, 0, raw);
+    for (uint16_t y = 0; y < height; y++) {
+      uint32_t bit = (uint32_t)y * bits;
+      out[1 + bit / 8] |= pixels[y] << (8 - bits - bit % 8);
+    }
+  }
+  return 1 + raw;
+}
+
+// Decodifica una columna sobre pixels, que debe contener la columna anterior
+// para REPEAT y DELTA. Devuelve false si los datos no completan height píxeles
+inline bool povDecodeColumn(const uint8_t* data, uint32_t length, uint8_t* pixels, uint16_t height,
+                            uint8_t bytesPerPixel, uint8_t bits) {
+  if (length < 1) {
+    return false;
+  }
+  uint8_t encoding = data[0];
+  const uint8_t* end = data + length;
+  data++;
+
+  if (encoding == POV_COLUMN_REPEAT) {
+    return length == 1;
+  }
+
+  if (encoding == POV_COLUMN_RAW) {
+    if ((uint32_t)(end - data) < povRawBytes(height, bytesPerPixel, bits)) {
+      return false;
+    }
+    if (bits == 0) {
+      memcpy(pixels, data, (uint32_t)height * bytesPerPixel);
+      return true;
+    }
+    uint8_t mask = (1 << bits) - 1;
+    for (uint16_t y = 0; y < height; y++) {
+      uint32_t bit = (uint32_t)y * bits;
+      pixels[y] = (data[bit / 8] >> (8 - bits - bit % 8)) & mask;
+    }
+    return true;
+  }
+
+  if (encoding != POV_COLUMN_RLE && encoding != POV_COLUMN_DELTA) {
+    return false;
+  }
+
+  bool delta = encoding == POV_COLUMN_DELTA;
+  uint16_t y = 0;
+  while (y < height) {
+    if (end - data < 1 + bytesPerPixel) {
+      return false;
+    }
+    uint8_t run = *data++;
+    if (run == 0) {
+      return false;
+    }
+    uint16_t last = (uint16_t)(height - y < run ? height - y : run);
+    uint8_t* out = pixels + (uint32_t)y * bytesPerPixel;
+    if (!delta && bytesPerPixel == 1) {
+      memset(out, data[0], last);
+    } else if (!delta) {
+      for (uint16_t i = 0; i < last; i++, out += bytesPerPixel) {
+        out[0] = data[0];
+        out[1] = data[1];
+        if (bytesPerPixel == 3) {
+          out[2] = data[2];
+        }
+      }
+    } else if (data[0] | (bytesPerPixel > 1 ? data[1] : 0) | (bytesPerPixel > 2 ? data[2] : 0)) {
+      // Los tramos sin cambios (XOR 0) no tocan la columna
+      for (uint16_t i = 0; i < last; i++, out += bytesPerPixel) {
+        for (uint8_t c = 0; c < bytesPerPixel; c++) {
+          out[c] ^= data[c];
+        }
+      }
+    }
+    data += bytesPerPixel;
+    y += last;
+  }
+  return true;
+}
+
+#endif
@@ -1,17 +1,45 @@
 #include "pov_engine.h"
+#include "image_manager.h"
 
-POVEngine::POVEngine() : currentColumn(0), speed(DEFAULT_POV_SPEED), lastUpdate(0),
-                         columnDelay(0), framesThisSecond(0), measuredFps(0), lastFpsTick(0),
+// Ninguna línea conocida en los LEDs
+#define POV_NO_LINE 0xFFFF
+
+POVEngine::POVEngine() : currentColumn(0), speed(DEFAULT_POV_SPEED),
+                         framesThisSecond(0), measuredFps(0), lastFpsTick(0),
                          loopMode(DEFAULT_LOOP_MODE), orientation(DEFAULT_POV_ORIENTATION), reverseDirection(false),
-                         playing(false), paused(false), imageLoaded(false), columnBuffer(nullptr) {
+                         playing(false), paused(false), imageLoaded(false), columnBuffer(nullptr),
+                         frameBuffer(nullptr), frameLineLength(0), frameResampled(false), frameCached(false),
+                         mappedImage(nullptr),
+                         resampleMode(DEFAULT_POV_RESAMPLE), timingMode(DEFAULT_POV_TIMING),
+                         droppedColumns(0), lateColumns(0), skippedShows(0), shownLine(POV_NO_LINE),
+                         currentFrame(0), frameDelays(nullptr), frameStartMs(0),
+                         sweepSync(false), holding(false),
+                         mappedLeds(0), identityMap(false), nextState(NEXT_NONE), nextCached(false),
+                         nextMapped(false), nextLeds(0), prefetchInvalid(false), switchArmed(false), switchAfter(0),
+                         sequenceCount(0), imageSwitches(0)
+#ifdef POV_RENDER_TASK
+                         , renderTask(nullptr), wakeTimer(nullptr), epoch(0), renderActive(false),
+                         renderBusy(false), renderFinished(false), displayedColumn(0), displayedFrame(0),
+                         requestedRate(DEFAULT_POV_SPEED), underruns(0), skipDebt(0), producerEpoch(0),
+                         producerColumn(0), producerLine(POV_NO_LINE), producerLeds(0), producerDone(false)
+#endif
+{
   currentImageFile[0] = '\0';
-  updateColumnDelay();
+  currentImageName[0] = '\0';
+  nextImageFile[0] = '\0';
+  nextImageName[0] = '\0';
+  nextJob.parser = &prefetchParser;
+  nextJob.resampler = &prefetchResampler;
+  scheduler.setRate(speed, 0);
 }
 
 POVEngine::~POVEngine() {
+  cancelPrefetch();
+  releaseFrame();
   if (columnBuffer != nullptr) {
     delete[] columnBuffer;
   }
+  delete[] frameDelays;
 }
 
 // Normaliza el nombre recibido evitando prefijos absolutos como /images/
@@ -26,53 +54,358 @@ static String normalizeImageName(const char* name) {
 }
 
 bool POVEngine::loadImage(const char* filename) {
-  // Construir path completo
+  // Construir path completo; un alias se lee del archivo con su contenido
   String cleanName = normalizeImageName(filename);
-  String fullPath = String(IMAGES_DIR) + "/" + cleanName;
+  String fullPath = imageManager.getImagePath(cleanName.c_str());
+
+  // Ya decodificada con esta disposición: sin abrir el archivo
+  CachedFrame cached;
+  bool fromCache = frameCache.acquire(fullPath.c_str(), orientation, resampleMode,
+                                      ledController.getNumLeds(), cached);
+  if (fromCache) {
+    currentImage = cached.info;
+  } else {
+    // Parsear información de la imagen
+    if (!imageParser.parseImageInfo(fullPath.c_str(), currentImage)) {
+      Serial.printf("Error: No se pudo cargar imagen %s\n", filename);
+      imageLoaded = false;
+      return false;
+    }
 
-  // Parsear información de la imagen
-  if (!imageParser.parseImageInfo(fullPath.c_str(), currentImage)) {
-    Serial.printf("Error: No se pudo cargar imagen %s\n", filename);
+    // Validar dimensiones
+    if (currentImage.width == 0 || currentImage.height == 0) {
+      Serial.printf("Error: Imagen %s sin dimensiones válidas\n", filename);
+      imageLoaded = false;
+      return false;
+    }
+
+    // Sin remuestreo suave la imagen no puede ser más alta que la tira
+    if (resampleMode == POV_RESAMPLE_NEAREST && currentImage.height > ledController.getNumLeds()) {
+      Serial.printf("Error: Imagen muy alta (%d LEDs configurados, imagen tiene %d)\n",
+                    ledController.getNumLeds(), currentImage.height);
+      imageLoaded = false;
+      return false;
+    }
+  }
+
+  // Buffer de columna: siempre de MAX_LEDS, se reutiliza entre imágenes
+  if (columnBuffer == nullptr) {
+    columnBuffer = new CRGB[MAX_LEDS];
+  }
+  if (columnBuffer == nullptr) {
+    Serial.println("Error: No se pudo asignar memoria para buffer de columna");
+    if (fromCache) {
+      frameCache.release(cached.pixels);
+    }
     imageLoaded = false;
     return false;
   }
 
-  // Validar dimensiones
-  if (currentImage.height > ledController.getNumLeds()) {
-    Serial.printf("Error: Imagen muy alta (%d LEDs configurados, imagen tiene %d)\n",
-                  ledController.getNumLeds(), currentImage.height);
-    imageLoaded = false;
+  strncpy(currentImageFile, fullPath.c_str(), sizeof(currentImageFile) - 1);
+  currentImageFile[sizeof(currentImageFile) - 1] = '\0';
+  snprintf(currentImageName, sizeof(currentImageName), "%s/%s", IMAGES_DIR, cleanName.c_str());
+
+  if (fromCache) {
+    useCachedFrame(cached);
+    delete[] frameDelays;
+    frameDelays = nullptr;
+    currentFrame = 0;
+    if (!cached.delays.empty()) {
+      frameDelays = new uint16_t[cached.delays.size()];
+      if (frameDelays != nullptr) {
+        memcpy(frameDelays, cached.delays.data(), cached.delays.size() * sizeof(uint16_t));
+      }
+    }
+  } else {
+    if (!loadFrameDelays()) {
+      currentImageFile[0] = '\0';
+      imageLoaded = false;
+      return false;
+    }
+
+    // Todos los fotogramas se decodifican aquí: cambiar de fotograma no lee
+    // el archivo. La caché ya se ha mirado arriba
+    if (!rebuildFrame(false)) {
+      currentImageFile[0] = '\0';
+      return false;
+    }
+  }
+
+  restartSweep();
+  sequenceCount = 0;
+  imageLoaded = true;
+
+  Serial.printf("Imagen cargada%s: %s (%dx%d", fromCache ? " desde la caché" : "", filename,
+                currentImage.width, currentImage.height);
+  if (currentImage.frameCount > 1) {
+    Serial.printf(", %d fotogramas", currentImage.frameCount);
+  }
+  Serial.println(")");
+
+  return true;
+}
+
+// Retardos de los fotogramas de una animación; nada que leer en imágenes fijas
+bool POVEngine::loadFrameDelays() {
+  delete[] frameDelays;
+  frameDelays = nullptr;
+  currentFrame = 0;
+  if (currentImage.frameCount <= 1) {
+    return true;
+  }
+
+  frameDelays = new uint16_t[currentImage.frameCount];
+  if (frameDelays == nullptr) {
+    Serial.println("Error: No se pudo asignar memoria para la animación");
     return false;
   }
 
-  // Asignar buffer de columna
-  if (columnBuffer != nullptr) {
-    delete[] columnBuffer;
+  File file = LittleFS.open(currentImageFile, "r");
+  bool ok = file && imageParser.getFrameDelays(file, currentImage, frameDelays);
+  if (file) {
+    file.close();
   }
+  if (!ok) {
+    Serial.printf("Error: No se pudieron leer los fotogramas de %s\n", currentImageFile);
+    delete[] frameDelays;
+    frameDelays = nullptr;
+  }
+  return ok;
+}
 
-  columnBuffer = new CRGB[MAX_LEDS];
-  if (columnBuffer == nullptr) {
-    Serial.println("Error: No se pudo asignar memoria para buffer de columna");
+// Lee las columnas del almacén flash si la imagen está allí; si no, la toma
+// de la caché o la decodifica completa una sola vez y, si no cabe en memoria,
+// deja el archivo abierto y lee cada columna bajo demanda
+bool POVEngine::rebuildFrame(bool useCache) {
+  releaseFrame();
+  if (mapFrame() || (useCache && loadCachedFrame()) || decodeFrame()) {
+    return true;
+  }
+
+  imageFile = LittleFS.open(currentImageFile, "r");
+  if (!imageFile) {
+    Serial.printf("Error: No se pudo abrir %s\n", currentImageFile);
     imageLoaded = false;
+    playing = false;
     return false;
   }
 
-  strncpy(currentImageFile, fullPath.c_str(), sizeof(currentImageFile) - 1);
-  currentColumn = 0;
-  imageLoaded = true;
+  uint16_t nativeLength = (orientation == POV_VERTICAL) ? currentImage.height : currentImage.width;
+  frameLineLength = min(nativeLength, (uint16_t)MAX_LEDS);
+  buildLedMap(ledController.getNumLeds());
+  Serial.println("AVISO: Imagen sin buffer en RAM, leyendo columnas desde LittleFS");
+  return true;
+}
 
-  Serial.printf("Imagen cargada: %s (%dx%d)\n", filename, currentImage.width, currentImage.height);
+// .pov en vertical sin remuestreo suave: cada columna es un puntero a la flash
+// mapeada (RAW RGB888) o se decodifica de ahí sin pasar por LittleFS. Lo
+// demás necesita la imagen completa en RAM
+bool POVEngine::mapFrame() {
+  uint16_t numLeds = ledController.getNumLeds();
+  if (currentImage.format != 2 || orientation != POV_VERTICAL ||
+      (resampleMode == POV_RESAMPLE_SMOOTH && currentImage.height != numLeds)) {
+    return false;
+  }
+
+  mappedImage = flashStore.acquire(currentImageFile, currentImage.fileSize);
+  if (mappedImage == nullptr) {
+    return false;
+  }
+
+  frameLineLength = min(currentImage.height, (uint16_t)MAX_LEDS);
+  buildLedMap(numLeds);
+  Serial.println("Imagen leída del almacén flash, sin buffer en RAM");
+  return true;
+}
+
+// La imagen actual ya decodificada con la disposición actual (p. ej. al
+// volver a una orientación o remuestreo anteriores)
+bool POVEngine::loadCachedFrame() {
+  CachedFrame cached;
+  if (!frameCache.acquire(currentImageFile, orientation, resampleMode, ledController.getNumLeds(), cached)) {
+    return false;
+  }
+  useCachedFrame(cached);
+  return true;
+}
+
+// Sustituye el buffer actual por uno de la caché, ya fijado por acquire()
+void POVEngine::useCachedFrame(const CachedFrame& cached) {
+  releaseFrame();
+  frameBuffer = cached.pixels;
+  frameLineLength = cached.lineLength;
+  frameResampled = cached.resampled;
+  frameCached = true;
+  buildLedMap(ledController.getNumLeds());
+}
+
+// Ofrece el buffer recién decodificado a la caché; si lo acepta deja de ser
+// del motor y se suelta en vez de liberarse
+void POVEngine::cacheFrame() {
+  if (frameBuffer == nullptr || frameCached || frameCache.getBudget() == 0) {
+    return;
+  }
+
+  size_t lineCount = (size_t)((orientation == POV_VERTICAL) ? currentImage.width : currentImage.height) *
+                     currentImage.frameCount;
+  CachedFrame frame;
+  frame.pixels = frameBuffer;
+  frame.bytes = lineCount * frameLineLength * sizeof(CRGB);
+  frame.lineLength = frameLineLength;
+  frame.resampled = frameResampled;
+  frame.info = currentImage;
+  if (frameDelays != nullptr) {
+    frame.delays.assign(frameDelays, frameDelays + currentImage.frameCount);
+  }
+  frameCached = frameCache.insert(currentImageFile, orientation, resampleMode, ledController.getNumLeds(), frame);
+}
+
+void POVEngine::freeFrameBuffer(CRGB* buffer, bool cached) {
+  if (cached) {
+    frameCache.release(buffer);
+  } else {
+    free(buffer);
+  }
+}
+
+bool POVEngine::decodeFrame() {
+  FrameDecode job;
+  job.parser = &imageParser;
+  job.resampler = &resampler;
+  if (!job.begin(currentImageFile, currentImage, orientation, resampleMode, ledController.getNumLeds())) {
+    return false;
+  }
+
+  unsigned long start = millis();
+  if (!job.step(job.total) || !job.finish()) {
+    job.abort();
+    return false;
+  }
+
+  frameBuffer = job.frame.pixels;
+  frameLineLength = job.frame.lineLength;
+  frameResampled = job.frame.resampled;
+  buildLedMap(ledController.getNumLeds());
+
+  Serial.printf("Imagen decodificada en RAM: %u bytes en %lu ms%s\n", (unsigned)job.frame.bytes,
+                millis() - start, frameResampled ? " (remuestreada)" : "");
+  cacheFrame();
+  return true;
+}
+
+// Reordena el buffer al cambiar de orientación: column-major para vertical,
+// row-major (traspuesto) para horizontal
+bool POVEngine::transposeFrame() {
+  if (frameBuffer == nullptr) {
+    return false;
+  }
+
+  // La otra disposición puede estar ya en la caché
+  if (loadCachedFrame()) {
+    return true;
+  }
+
+  // Un buffer remuestreado ya no tiene la resolución original: volver a decodificar
+  if (frameResampled || resampleMode == POV_RESAMPLE_SMOOTH) {
+    releaseFrame();
+    return decodeFrame();
+  }
+
+  uint16_t width = currentImage.width;
+  uint16_t height = currentImage.height;
+  size_t framePixels = (size_t)width * height;
+  CRGB* transposed = allocFrame(framePixels * currentImage.frameCount);
+  if (transposed == nullptr) {
+    // Sin memoria para la copia: liberar y volver a decodificar con la nueva disposición
+    releaseFrame();
+    return decodeFrame();
+  }
+
+  // Cada fotograma se traspone por separado
+  for (uint16_t frame = 0; frame < currentImage.frameCount; frame++) {
+    const CRGB* src = frameBuffer + frame * framePixels;
+    CRGB* dst = transposed + frame * framePixels;
+    for (uint16_t x = 0; x < width; x++) {
+      for (uint16_t y = 0; y < height; y++) {
+        if (orientation == POV_HORIZONTAL) {
+          dst[(size_t)y * width + x] = src[(size_t)x * height + y];
+        } else {
+          dst[(size_t)x * height + y] = src[(size_t)y * width + x];
+        }
+      }
+    }
+  }
 
+  freeFrameBuffer(frameBuffer, frameCached);
+  frameBuffer = transposed;
+  frameCached = false;
+  frameLineLength = (orientation == POV_VERTICAL) ? height : width;
+  buildLedMap(ledController.getNumLeds());
+  cacheFrame();
   return true;
 }
 
+// Tabla LED -> píxel de la línea, recalculada solo al cargar la imagen o
+// cuando cambia el número de LEDs. Escalado lineal si hay más LEDs que píxeles
+// en la línea; si hay menos, se recorta.
+void POVEngine::buildLedMap(uint16_t numLeds) {
+  numLeds = min(numLeds, (uint16_t)MAX_LEDS);
+  uint16_t length = frameLineLength;
+  identityMap = (length == numLeds);
+
+  for (uint16_t i = 0; i < numLeds; i++) {
+    if (length <= 1) {
+      ledMap[i] = 0;
+    } else if (numLeds <= length) {
+      ledMap[i] = i;
+    } else {
+      ledMap[i] = (uint32_t)i * (length - 1) / (numLeds - 1);
+    }
+  }
+  mappedLeds = numLeds;
+}
+
+void POVEngine::releaseFrame() {
+  if (frameBuffer != nullptr) {
+    freeFrameBuffer(frameBuffer, frameCached);
+    frameBuffer = nullptr;
+  }
+  frameCached = false;
+  frameResampled = false;
+  shownLine = POV_NO_LINE;
+  if (mappedImage != nullptr) {
+    flashStore.release();
+    mappedImage = nullptr;
+  }
+  if (imageFile) {
+    imageFile.close();
+  }
+}
+
+bool POVEngine::isFrameBuffered() {
+  return imageLoaded && frameBuffer != nullptr;
+}
+
+bool POVEngine::isFlashMapped() {
+  return imageLoaded && mappedImage != nullptr;
+}
+
 void POVEngine::unloadImage() {
+#ifdef POV_RENDER_TASK
+  haltRenderTask();
+#endif
   imageLoaded = false;
   playing = false;
   paused = false;
   currentColumn = 0;
   currentImageFile[0] = '\0';
+  currentImageName[0] = '\0';
 
+  cancelPrefetch();
+  releaseFrame();
+  delete[] frameDelays;
+  frameDelays = nullptr;
+  currentFrame = 0;
   if (columnBuffer != nullptr) {
     delete[] columnBuffer;
     columnBuffer = nullptr;
@@ -94,8 +427,33 @@ void POVEngine::play() {
 
   playing = true;
   paused = false;
-  currentColumn = 0;
-  lastUpdate = millis();
+  restartSweep();
+  currentFrame = 0;
+  frameStartMs = millis();
+  sequenceCount = 0;
+  droppedColumns = 0;
+  lateColumns = 0;
+  skippedShows = 0;
+  shownLine = POV_NO_LINE;
+  holding = false;
+#ifdef POV_RENDER_TASK
+  // La tarea de render arranca el planificador al ver la primera columna en cola.
+  // Si no se pudo crear, se sigue en modo cooperativo desde update().
+  startRenderTask();
+  if (renderTask != nullptr) {
+    haltRenderTask();
+    renderFinished = false;
+    renderActive = true;
+    xTaskNotifyGive(renderTask);
+    Serial.println("POV iniciado");
+    return;
+  }
+#endif
+  uint64_t now = ColumnScheduler::now();
+  scheduler.start(now);
+  scheduler.resetStats();
+  lastFpsTick = now;
+  framesThisSecond = 0;
 
   Serial.println("POV iniciado");
 }
@@ -103,17 +461,27 @@ void POVEngine::play() {
 void POVEngine::pause() {
   if (playing) {
     paused = true;
+#ifdef POV_RENDER_TASK
+    haltRenderTask();
+#endif
+    scheduler.stop();
     Serial.println("POV pausado");
   }
 }
 
 void POVEngine::stop() {
+#ifdef POV_RENDER_TASK
+  haltRenderTask();
+#endif
+  scheduler.stop();
   playing = false;
   paused = false;
-  currentColumn = 0;
+  restartSweep();
+  currentFrame = 0;
 
   ledController.clear();
   ledController.show();
+  shownLine = POV_NO_LINE;
 
   Serial.println("POV detenido");
 }
@@ -121,7 +489,15 @@ void POVEngine::stop() {
 void POVEngine::resume() {
   if (paused && imageLoaded) {
     paused = false;
-    lastUpdate = millis();
+#ifdef POV_RENDER_TASK
+    if (renderTask != nullptr) {
+      renderActive = true;
+      xTaskNotifyGive(renderTask);
+      Serial.println("POV reanudado");
+      return;
+    }
+#endif
+    scheduler.start(ColumnScheduler::now());
     Serial.println("POV reanudado");
   }
 }
@@ -135,19 +511,56 @@ bool POVEngine::isPaused() {
 }
 
 void POVEngine::setSpeed(uint16_t fps) {
-  speed = constrain(fps, MIN_POV_SPEED, MAX_POV_SPEED);
-  updateColumnDelay();
+  // El techo depende del tiempo de transmisión de la tira configurada
+  uint16_t maxSpeed = getMaxSpeed();
+  speed = constrain(fps, MIN_POV_SPEED, maxSpeed);
+  if (fps > maxSpeed) {
+    Serial.printf("Aviso: %d FPS supera el máximo de la tira (%d)\n", fps, maxSpeed);
+  }
+  applyRate();
   Serial.printf("Velocidad POV: %d FPS\n", speed);
 }
 
+void POVEngine::setDynamicSpeed(uint16_t fps) {
+  uint16_t target = constrain(fps, MIN_POV_SPEED, getMaxSpeed());
+  if (target != speed) {
+    speed = target;
+    applyRate();
+  }
+}
+
+void POVEngine::applyRate() {
+#ifdef POV_RENDER_TASK
+  // Con tarea de render, es ella quien aplica el cambio de ritmo a su planificador
+  requestedRate = speed;
+  if (renderTask == nullptr) {
+    scheduler.setRate(speed, ColumnScheduler::now());
+  }
+#else
+  scheduler.setRate(speed, ColumnScheduler::now());
+#endif
+}
+
 uint16_t POVEngine::getSpeed() {
   return speed;
 }
 
+uint16_t POVEngine::getMaxSpeed() {
+  return ledController.getMaxColumnRate();
+}
+
 uint16_t POVEngine::getMeasuredFps() {
   return measuredFps;
 }
 
+uint32_t POVEngine::getJitterUs() {
+  return scheduler.getAvgJitterUs();
+}
+
+uint32_t POVEngine::getMaxJitterUs() {
+  return scheduler.getMaxJitterUs();
+}
+
 void POVEngine::setLoopMode(bool loop) {
   loopMode = loop;
   Serial.printf("Modo loop: %s\n", loop ? "ON" : "OFF");
@@ -158,18 +571,88 @@ bool POVEngine::getLoopMode() {
 }
 
 void POVEngine::setOrientation(POVOrientation orient) {
+  if (orient == orientation) {
+    return;
+  }
+
   orientation = orient;
+  restartSweep();
+  shownLine = POV_NO_LINE;
+  cancelPrefetch();  // Decodificada con la otra disposición
+  if (imageLoaded && (frameBuffer == nullptr || !transposeFrame())) {
+    // Sin buffer o no se pudo reordenar: reconstruir (o seguir leyendo desde el archivo)
+    rebuildFrame();
+  }
   Serial.printf("Orientación POV: %s\n", orient == POV_VERTICAL ? "VERTICAL" : "HORIZONTAL");
 }
 
 void POVEngine::setReverseDirection(bool reverse) {
   if (reverseDirection != reverse) {
     reverseDirection = reverse;
-    currentColumn = 0;  // reiniciar barrido al cambiar de dirección
+    restartSweep();  // reiniciar barrido al cambiar de dirección
     Serial.printf("Dirección POV: %s\n", reverse ? "RIGHT->LEFT" : "LEFT->RIGHT");
   }
 }
 
+void POVEngine::setSweepSync(bool enabled) {
+  sweepSync = enabled;
+  holding = false;
+  Serial.printf("Sincronía con el barrido: %s\n", enabled ? "ON" : "OFF");
+}
+
+bool POVEngine::getSweepSync() {
+  return sweepSync;
+}
+
+// Llamada en cada punto de giro detectado por el acelerómetro: la imagen
+// empieza siempre en el mismo sitio y en el sentido del barrido, así que no se desplaza
+void POVEngine::syncSweep(bool reverse) {
+  if (!playing || paused) {
+    return;
+  }
+
+  reverseDirection = reverse;
+  if (advanceFrame()) {
+    endSequence();
+  }
+  restartSweep();
+  holding = false;
+#ifdef POV_RENDER_TASK
+  if (renderTask != nullptr) {
+    // La tarea de render re-arranca su reloj con la primera columna de la nueva época
+    xTaskNotifyGive(renderTask);
+    return;
+  }
+#endif
+  scheduler.start(ColumnScheduler::now());
+}
+
+void POVEngine::setResampleMode(POVResampleMode mode) {
+  if (mode == resampleMode) {
+    return;
+  }
+
+  resampleMode = mode;
+  cancelPrefetch();
+  if (imageLoaded) {
+    rebuildFrame();
+  }
+  Serial.printf("Remuestreo POV: %s\n", mode == POV_RESAMPLE_SMOOTH ? "SUAVE" : "SIMPLE");
+}
+
+POVResampleMode POVEngine::getResampleMode() {
+  return resampleMode;
+}
+
+void POVEngine::setTimingMode(POVTimingMode mode) {
+  timingMode = mode;
+  Serial.printf("Sincronía POV: %s\n", mode == POV_TIMING_TIMED ? "por tiempo" : "secuencial");
+}
+
+POVTimingMode POVEngine::getTimingMode() {
+  return timingMode;
+}
+
 bool POVEngine::isReverse() {
   return reverseDirection;
 }
@@ -179,15 +662,66 @@ POVOrientation POVEngine::getOrientation() {
 }
 
 void POVEngine::update() {
+  if (prefetchInvalid.exchange(false)) {
+    cancelPrefetch();
+  }
+
   if (!playing || paused || !imageLoaded) {
+    stepPrefetch();
+    return;
+  }
+
+#ifdef POV_RENDER_TASK
+  // La tarea de render muestra las columnas; aquí solo se decodifican por adelantado
+  if (renderTask != nullptr) {
+    if (renderFinished) {
+      stop();
+      Serial.println("POV finalizado");
+      return;
+    }
+    fillQueue();
+    stepPrefetch();
     return;
   }
+#endif
+
+  if (holding) {
+    stepPrefetch();
+    return;  // Esperando al próximo punto de giro
+  }
 
-  unsigned long currentTime = millis();
-  if (currentTime - lastUpdate < columnDelay) {
+  // Deadline absoluto en microsegundos: un retraso no desplaza las columnas siguientes
+  uint64_t currentTime = ColumnScheduler::now();
+  uint32_t steps = pollSchedule(currentTime);
+  if (steps == 0) {
+    // Tiempo libre hasta la próxima columna: avanzar la siguiente imagen
+    stepPrefetch();
     return;
   }
 
+  uint16_t maxColumns = getTotalColumns();
+  if (steps > 1) {
+    // Modo por tiempo: saltar las columnas cuyo instante ya pasó. En 32 bits:
+    // tras un parón largo (escritura en LittleFS, reconexión WiFi) pueden
+    // haber pasado varios barridos enteros
+    uint32_t column = (uint32_t)currentColumn + steps - 1;
+    if (column >= maxColumns) {
+      // Los barridos saltados cuentan como uno solo: un finishSweep() (un
+      // fotograma, una secuencia para la lista) y se sigue en la columna que
+      // toca dentro del barrido actual. Los fotogramas van por su retardo en
+      // ms, así que una animación no se queda atrás
+      uint16_t carry = column % maxColumns;
+      if (!finishSweep()) {
+        return;
+      }
+      // Puede haber pasado a la siguiente imagen
+      maxColumns = getTotalColumns();
+      currentColumn = (maxColumns > 0) ? carry % maxColumns : 0;
+    } else {
+      currentColumn = column;
+    }
+  }
+
   // Mostrar columna actual
   displayColumn(currentColumn);
 
@@ -196,32 +730,28 @@ void POVEngine::update() {
 
   // Medir FPS real (cuenta de columnas mostradas por segundo)
   framesThisSecond++;
-  if (currentTime - lastFpsTick >= 1000) {
+  if (currentTime - lastFpsTick >= 1000000ULL) {
     measuredFps = framesThisSecond;
     framesThisSecond = 0;
     lastFpsTick = currentTime;
   }
 
   // Verificar fin de imagen (depende de la orientación)
-  uint16_t maxColumns = (orientation == POV_VERTICAL) ? currentImage.width : currentImage.height;
   if (currentColumn >= maxColumns) {
-    if (loopMode) {
-      currentColumn = 0;
-    } else {
-      stop();
-      Serial.println("POV finalizado");
-      return;
-    }
+    finishSweep();
   }
-
-  lastUpdate = currentTime;
 }
 
 const char* POVEngine::getCurrentImageName() {
-  return imageLoaded ? currentImageFile : "";
+  return imageLoaded ? currentImageName : "";
 }
 
 uint16_t POVEngine::getCurrentColumn() {
+#ifdef POV_RENDER_TASK
+  if (renderTask != nullptr) {
+    return displayedColumn;
+  }
+#endif
   return currentColumn;
 }
 
@@ -230,102 +760,699 @@ uint16_t POVEngine::getTotalColumns() {
   return (orientation == POV_VERTICAL) ? currentImage.width : currentImage.height;
 }
 
-void POVEngine::updateColumnDelay() {
-  if (speed > 0) {
-    columnDelay = 1000 / speed;
+uint16_t POVEngine::getFrameCount() {
+  return imageLoaded ? currentImage.frameCount : 0;
+}
+
+uint16_t POVEngine::getCurrentFrame() {
+#ifdef POV_RENDER_TASK
+  if (renderTask != nullptr) {
+    return displayedFrame;
+  }
+#endif
+  return currentFrame;
+}
+
+// Línea de la imagen que toca en la columna indicada: columna X en vertical
+// (invertida si el barrido va al revés), fila Y en horizontal. Las líneas de
+// los fotogramas van seguidas: el fotograma f empieza en f * getTotalColumns()
+uint16_t POVEngine::lineForColumn(uint16_t column) {
+  uint16_t maxColumns = getTotalColumns();
+  if (column >= maxColumns) {
+    return POV_NO_LINE;
+  }
+  if (orientation == POV_VERTICAL && reverseDirection) {
+    column = maxColumns - 1 - column;
+  }
+  return currentFrame * maxColumns + column;
+}
+
+// Dos líneas con los mismos píxeles. Con la imagen en RAM se comparan; leyendo
+// del archivo o del almacén flash solo se sabe de columnas .pov marcadas como
+// repetidas
+bool POVEngine::sameLine(uint16_t a, uint16_t b) {
+  if (a == POV_NO_LINE || b == POV_NO_LINE) {
+    return false;
+  }
+  if (a == b) {
+    return true;
+  }
+  if (frameBuffer != nullptr) {
+    return memcmp(frameBuffer + (size_t)a * frameLineLength, frameBuffer + (size_t)b * frameLineLength,
+                  frameLineLength * sizeof(CRGB)) == 0;
+  }
+  if (orientation == POV_VERTICAL && (a == b + 1 || b == a + 1)) {
+    if (mappedImage != nullptr) {
+      return imageParser.isRepeatColumn(mappedImage, currentImage, max(a, b));
+    }
+    return imageParser.isRepeatColumn(imageFile, currentImage, max(a, b));
+  }
+  return false;
+}
+
+// Genera en dest los numLeds píxeles de la columna/fila indicada, ya escalados
+bool POVEngine::renderLine(uint16_t column, CRGB* dest) {
+  if (!imageLoaded || columnBuffer == nullptr || dest == nullptr) {
+    return false;
+  }
+
+  uint16_t numLeds = ledController.getNumLeds();
+  uint16_t lineIndex = lineForColumn(column);
+  if (lineIndex == POV_NO_LINE) {
+    return false;
+  }
+
+  // Si cambió el número de LEDs, rehacer la tabla (o el buffer remuestreado)
+  if (numLeds != mappedLeds) {
+    if (frameResampled || (mappedImage != nullptr && resampleMode == POV_RESAMPLE_SMOOTH)) {
+      if (!rebuildFrame()) return false;
+    } else {
+      buildLedMap(numLeds);
+    }
+  }
+
+  const CRGB* line;
+  if (frameBuffer != nullptr) {
+    // Camino rápido: la línea ya está decodificada y es contigua en RAM
+    line = frameBuffer + (size_t)lineIndex * frameLineLength;
+  } else if (mappedImage != nullptr) {
+    // Almacén flash: la columna RAW se lee en su sitio; las demás se decodifican
+    // desde la flash mapeada, sin seek ni read
+    uint16_t frame = lineIndex / currentImage.width;
+    uint16_t x = lineIndex % currentImage.width;
+    line = imageParser.getMappedColumn(mappedImage, currentImage, frame, x, columnBuffer, MAX_LEDS);
+    if (line == nullptr) {
+      Serial.printf("Error: No se pudo leer columna %d\n", x);
+      return false;
+    }
+  } else if (orientation == POV_VERTICAL) {
+    // Respaldo: leer la columna del archivo abierto
+    uint16_t frame = lineIndex / currentImage.width;
+    uint16_t x = lineIndex % currentImage.width;
+    if (!imageParser.getFrameColumn(imageFile, currentImage, frame, x, columnBuffer, MAX_LEDS)) {
+      Serial.printf("Error: No se pudo leer columna %d\n", x);
+      return false;
+    }
+    line = columnBuffer;
   } else {
-    columnDelay = 1000 / DEFAULT_POV_SPEED;
+    // Respaldo horizontal: leer cada columna y tomar el píxel de la fila
+    CRGB tempBuffer[MAX_LEDS];
+    uint16_t frame = lineIndex / currentImage.height;
+    uint16_t y = lineIndex % currentImage.height;
+    for (uint16_t x = 0; x < frameLineLength; x++) {
+      if (y < MAX_LEDS && imageParser.getFrameColumn(imageFile, currentImage, frame, x, tempBuffer, MAX_LEDS)) {
+        columnBuffer[x] = tempBuffer[y];
+      } else {
+        columnBuffer[x] = CRGB::Black;
+      }
+    }
+    line = columnBuffer;
   }
+
+  if (identityMap) {
+    // Una sola copia contigua
+    memcpy(dest, line, numLeds * sizeof(CRGB));
+  } else {
+    for (uint16_t i = 0; i < numLeds; i++) {
+      dest[i] = line[ledMap[i]];
+    }
+  }
+  return true;
 }
 
 void POVEngine::displayColumn(uint16_t column) {
-  if (!imageLoaded || columnBuffer == nullptr) {
+  // Los LEDs ya tienen esta línea: no hace falta volver a enviarla
+  uint16_t line = lineForColumn(column);
+  if (ledController.getNumLeds() == mappedLeds && sameLine(shownLine, line)) {
+    shownLine = line;
+    skippedShows++;
     return;
   }
 
+  shownLine = POV_NO_LINE;
+  if (renderLine(column, ledController.getPixels())) {
+    ledController.show();
+    shownLine = line;
+  }
+}
+
+void POVEngine::restartSweep() {
+  currentColumn = 0;
+#ifdef POV_RENDER_TASK
+  skipDebt = 0;
+  epoch++;
+#endif
+}
+
+// Cuántas columnas avanzar en este instante: 0 si aún no vence, 1 normalmente,
+// más de 1 en modo por tiempo cuando hay que saltar columnas atrasadas
+uint32_t POVEngine::pollSchedule(uint64_t nowUs) {
+  uint32_t steps;
+  if (timingMode == POV_TIMING_TIMED) {
+    steps = scheduler.advance(nowUs);
+  } else {
+    steps = scheduler.poll(nowUs) ? 1 : 0;
+  }
+  if (steps == 0) {
+    return 0;
+  }
+
+  droppedColumns += steps - 1;
+  if (scheduler.getLastJitterUs() >= scheduler.getPeriodUs() / 2) {
+    lateColumns++;
+  }
+  return steps;
+}
+
+// Fin de un barrido en una animación: pasa al siguiente fotograma si el actual
+// ya se mostró durante su retardo (0: uno por barrido). true al completar la
+// secuencia, y siempre en imágenes fijas, para que sin loop la reproducción termine
+bool POVEngine::advanceFrame() {
+  if (currentImage.frameCount <= 1 || frameDelays == nullptr) {
+    return true;
+  }
+
+  unsigned long now = millis();
+  if (now - frameStartMs < frameDelays[currentFrame]) {
+    return false;
+  }
+  currentFrame = (currentFrame + 1) % currentImage.frameCount;
+  frameStartMs = now;
+  return currentFrame == 0;
+}
+
+// Fin de la imagen: esperar al giro (sincronía), volver a la columna 0 con el
+// fotograma que toque, o terminar. false si no hay que seguir mostrando columnas
+bool POVEngine::finishSweep() {
+  if (sweepSync) {
+    holdSweep();
+    return false;
+  }
+
+  bool sequenceDone = advanceFrame();
+  // Con un cambio pendiente, la siguiente imagen sigue en la columna 0
+  bool switched = sequenceDone && endSequence();
+  if (loopMode || !sequenceDone || switched) {
+    currentColumn = 0;
+    return true;
+  }
+
+  stop();
+  Serial.println("POV finalizado");
+  return false;
+}
+
+// Fin de la imagen en modo sincronizado: apagar hasta el próximo giro
+void POVEngine::holdSweep() {
+  holding = true;
+  currentColumn = 0;
+  ledController.clear();
+  ledController.show();
+  shownLine = POV_NO_LINE;
+}
+
+// Prepara la siguiente imagen sin tocar la actual. La decodificación sigue
+// en update(), PREFETCH_STEP_COLUMNS columnas (o un bloque de filas) cada vez
+bool POVEngine::prefetchImage(const char* filename) {
+  cancelPrefetch();
+
+  String cleanName = normalizeImageName(filename);
+  String fullPath = imageManager.getImagePath(cleanName.c_str());
   uint16_t numLeds = ledController.getNumLeds();
-  uint16_t maxColumns = (orientation == POV_VERTICAL) ? currentImage.width : currentImage.height;
-  uint16_t displayCol = column;
-  if (reverseDirection && column < maxColumns) {
-    displayCol = maxColumns - 1 - column;
+  strlcpy(nextImageFile, fullPath.c_str(), sizeof(nextImageFile));
+  snprintf(nextImageName, sizeof(nextImageName), "%s/%s", IMAGES_DIR, cleanName.c_str());
+  nextLeds = numLeds;
+
+  if (frameCache.acquire(nextImageFile, orientation, resampleMode, numLeds, nextJob.frame)) {
+    nextCached = true;
+    nextState = NEXT_READY;
+    return true;
   }
 
-  // Abrir archivo una sola vez para toda la columna/fila
-  File file = LittleFS.open(currentImageFile, "r");
-  if (!file) {
-    Serial.printf("Error: No se pudo abrir %s para visualización\n", currentImageFile);
-    return;
+  ImageInfo info;
+  if (!prefetchParser.parseImageInfo(nextImageFile, info) || info.width == 0 || info.height == 0) {
+    Serial.printf("Error: No se pudo precargar %s\n", filename);
+    return false;
+  }
+  if (resampleMode == POV_RESAMPLE_NEAREST && info.height > numLeds) {
+    Serial.printf("Error: Imagen muy alta (%d LEDs configurados, imagen tiene %d)\n", numLeds, info.height);
+    return false;
   }
 
-  if (orientation == POV_VERTICAL) {
-    // Modo vertical: leer columna vertical de la imagen
-    if (!imageParser.getColumn(file, currentImage, displayCol, columnBuffer, MAX_LEDS)) {
-      Serial.printf("Error: No se pudo leer columna %d\n", displayCol);
+  nextJob.frame.info = info;
+  nextJob.frame.delays.clear();
+  if (info.frameCount > 1) {
+    nextJob.frame.delays.resize(info.frameCount);
+    File file = LittleFS.open(nextImageFile, "r");
+    bool ok = file && prefetchParser.getFrameDelays(file, info, nextJob.frame.delays.data());
+    if (file) {
       file.close();
-      return;
     }
+    if (!ok) {
+      Serial.printf("Error: No se pudieron leer los fotogramas de %s\n", nextImageFile);
+      nextJob.frame.delays.clear();
+      return false;
+    }
+  }
 
-    // Mostrar en LEDs verticalmente, escalando si hay más LEDs que alto de imagen
-    for (uint16_t i = 0; i < numLeds; i++) {
-      uint16_t srcIndex;
-      if (currentImage.height <= 1) {
-        srcIndex = 0;
-      } else if (numLeds <= currentImage.height) {
-        srcIndex = i;  // cabe sin escalar
+  // Lo que mapFrame() leería del almacén flash no hace falta decodificarlo
+  if (info.format == 2 && orientation == POV_VERTICAL &&
+      (resampleMode != POV_RESAMPLE_SMOOTH || info.height == numLeds) && flashStore.hasImage(nextImageFile)) {
+    nextMapped = true;
+    nextState = NEXT_READY;
+    return true;
+  }
+
+  if (!nextJob.begin(nextImageFile, info, orientation, resampleMode, numLeds)) {
+    Serial.printf("AVISO: Sin memoria para precargar %s\n", filename);
+    nextJob.frame.delays.clear();
+    return false;
+  }
+  nextState = NEXT_DECODING;
+  return true;
+}
+
+void POVEngine::cancelPrefetch() {
+  if (nextCached) {
+    frameCache.release(nextJob.frame.pixels);
+    nextJob.frame.pixels = nullptr;
+  } else {
+    nextJob.abort();
+  }
+  nextJob.frame.delays.clear();
+  nextState = NEXT_NONE;
+  nextCached = false;
+  nextMapped = false;
+  switchArmed = false;
+  nextImageFile[0] = '\0';
+  nextImageName[0] = '\0';
+}
+
+void POVEngine::invalidatePrefetch() {
+  prefetchInvalid = true;
+}
+
+bool POVEngine::hasNextImage() {
+  return nextState != NEXT_NONE;
+}
+
+bool POVEngine::isNextImageReady() {
+  return nextState == NEXT_READY;
+}
+
+void POVEngine::switchToNext(uint16_t sequences) {
+  if (nextState == NEXT_NONE) {
+    return;
+  }
+  switchArmed = true;
+  switchAfter = sequences;
+}
+
+bool POVEngine::isSwitchArmed() {
+  return switchArmed;
+}
+
+uint32_t POVEngine::getSequenceCount() {
+  return sequenceCount;
+}
+
+uint32_t POVEngine::getImageSwitches() {
+  return imageSwitches;
+}
+
+void POVEngine::stepPrefetch() {
+  if (nextState != NEXT_DECODING) {
+    return;
+  }
+
+  uint32_t units = nextJob.rowDecode ? 1 : PREFETCH_STEP_COLUMNS;
+  if (!nextJob.step(units)) {
+    Serial.printf("Error: No se pudo precargar %s\n", nextImageFile);
+    cancelPrefetch();
+    return;
+  }
+  if (nextJob.isDone() && nextJob.finish()) {
+    nextState = NEXT_READY;
+    Serial.printf("Siguiente imagen lista: %s\n", nextImageFile);
+  }
+}
+
+// Secuencia completa de la imagen actual; si toca, pasa a la siguiente.
+// true si ha cambiado de imagen
+bool POVEngine::endSequence() {
+  sequenceCount++;
+  if (!switchArmed || nextState != NEXT_READY || sequenceCount < switchAfter) {
+    return false;
+  }
+  swapToNext();
+  return true;
+}
+
+// La siguiente imagen pasa a ser la actual sin reiniciar el barrido: la
+// columna 0 sigue a la última de la anterior como en una vuelta en loop
+void POVEngine::swapToNext() {
+  releaseFrame();
+  currentImage = nextJob.frame.info;
+  strlcpy(currentImageFile, nextImageFile, sizeof(currentImageFile));
+  strlcpy(currentImageName, nextImageName, sizeof(currentImageName));
+
+  delete[] frameDelays;
+  frameDelays = nullptr;
+  if (!nextJob.frame.delays.empty()) {
+    frameDelays = new uint16_t[nextJob.frame.delays.size()];
+    if (frameDelays != nullptr) {
+      memcpy(frameDelays, nextJob.frame.delays.data(), nextJob.frame.delays.size() * sizeof(uint16_t));
+    }
+  }
+  currentFrame = 0;
+  frameStartMs = millis();
+  sequenceCount = 0;
+
+  if (nextMapped || nextLeds != ledController.getNumLeds()) {
+    // Del almacén flash, o decodificada para otra tira: como al cargarla
+    if (nextCached) {
+      frameCache.release(nextJob.frame.pixels);
+    } else {
+      free(nextJob.frame.pixels);
+    }
+    rebuildFrame();
+  } else {
+    frameBuffer = nextJob.frame.pixels;
+    frameLineLength = nextJob.frame.lineLength;
+    frameResampled = nextJob.frame.resampled;
+    frameCached = nextCached;
+    buildLedMap(nextLeds);
+    cacheFrame();
+  }
+  nextJob.frame.pixels = nullptr;
+  nextJob.frame.delays.clear();
+  nextState = NEXT_NONE;
+  nextCached = false;
+  nextMapped = false;
+  switchArmed = false;
+  nextImageFile[0] = '\0';
+  nextImageName[0] = '\0';
+
+  shownLine = POV_NO_LINE;
+#ifdef POV_RENDER_TASK
+  producerLine = POV_NO_LINE;
+#endif
+  imageSwitches++;
+  Serial.printf("Siguiente imagen: %s\n", currentImageName);
+}
+
+uint32_t POVEngine::getDroppedColumns() {
+  return droppedColumns;
+}
+
+uint32_t POVEngine::getLateColumns() {
+  return lateColumns;
+}
+
+uint32_t POVEngine::getSkippedShows() {
+  return skippedShows;
+}
+
+uint32_t POVEngine::getUnderruns() {
+#ifdef POV_RENDER_TASK
+  return underruns;
+#else
+  return 0;
+#endif
+}
+
+#ifdef POV_RENDER_TASK
+void POVEngine::startRenderTask() {
+  if (renderTask != nullptr) {
+    return;
+  }
+
+  esp_timer_create_args_t timerArgs = {};
+  timerArgs.callback = &POVEngine::wakeTimerCallback;
+  timerArgs.arg = this;
+  timerArgs.name = "pov_wake";
+  if (esp_timer_create(&timerArgs, &wakeTimer) != ESP_OK) {
+    Serial.println("Error: No se pudo crear timer de render");
+    return;
+  }
+
+  if (xTaskCreatePinnedToCore(renderTaskEntry, "pov_render", RENDER_TASK_STACK, this,
+                              RENDER_TASK_PRIORITY, &renderTask, RENDER_TASK_CORE) != pdPASS) {
+    Serial.println("Error: No se pudo crear tarea de render");
+    renderTask = nullptr;
+    return;
+  }
+  Serial.printf("Tarea de render POV en core %d\n", RENDER_TASK_CORE);
+}
+
+// Desactiva la tarea de render y espera a que termine la columna en curso,
+// para que quien llama pueda usar el controlador de LEDs sin competir con ella
+void POVEngine::haltRenderTask() {
+  renderActive = false;
+  while (renderBusy) {
+    vTaskDelay(1);
+  }
+}
+
+// Etapa de decodificación: llena la cola con las próximas columnas ya escaladas
+void POVEngine::fillQueue() {
+  uint32_t current = epoch;
+  if (producerEpoch != current) {
+    producerEpoch = current;
+    producerColumn = 0;
+    producerLine = POV_NO_LINE;
+    producerDone = false;
+  }
+  if (producerDone) {
+    return;
+  }
+
+  uint16_t maxColumns = getTotalColumns();
+  uint32_t skip = skipDebt.exchange(0);
+  if (skip > 0) {
+    // La tarea de render saltó columnas que aún no se habían encolado
+    uint32_t next = producerColumn + skip;
+    if (sweepSync) {
+      producerColumn = min(next, (uint32_t)maxColumns);
+    } else if (next < maxColumns) {
+      producerColumn = next;
+    } else {
+      bool sequenceDone = advanceFrame();
+      if (sequenceDone && endSequence()) {
+        maxColumns = getTotalColumns();
+        producerColumn = 0;
+      } else if (sequenceDone && !loopMode) {
+        producerDone = true;
+        renderFinished = true;
+        return;
       } else {
-        // Escalado lineal: mapear 0..numLeds-1 a 0..height-1
-        srcIndex = (uint32_t)i * (currentImage.height - 1) / (numLeds - 1);
+        producerColumn = next % maxColumns;
       }
-      srcIndex = min(srcIndex, (uint16_t)(MAX_LEDS - 1));
-      ledController.setPixel(i, columnBuffer[srcIndex]);
     }
-  } else {
-    // Modo horizontal: leer fila horizontal de la imagen
-    // La "columna" actual es realmente el índice de fila (Y)
-    uint16_t rowIndex = column;
-    uint16_t displayWidth = numLeds;
+  }
 
-    // Buffer temporal
-    CRGB tempBuffer[MAX_LEDS];
+  ColumnSlot* slot;
+  while ((slot = columnQueue.beginPush()) != nullptr) {
+    slot->epoch = current;
+    slot->frame = currentFrame;
+    slot->count = ledController.getNumLeds();
+    slot->last = false;
+    slot->hold = false;
+    slot->repeat = false;
+
+    if (producerColumn >= maxColumns) {
+      // Modo sincronizado: tras la imagen, una columna en negro y esperar al giro
+      fill_solid(slot->pixels, slot->count, CRGB::Black);
+      slot->column = maxColumns - 1;
+      slot->hold = true;
+      producerLine = POV_NO_LINE;
+      producerDone = true;
+      columnQueue.commitPush();
+      break;
+    }
+
+    if (!renderLine(producerColumn, slot->pixels)) {
+      return;
+    }
+    slot->column = producerColumn;
+
+    // Solo se puede saltar el show() si la columna anterior de la cola se mostró
+    // (la tarea de render lo sabe); aquí se marca si los píxeles coinciden
+    uint16_t line = lineForColumn(producerColumn);
+    slot->repeat = slot->count == producerLeds && sameLine(producerLine, line);
+    producerLine = line;
+    producerLeds = slot->count;
 
-    // Leer píxeles de la fila horizontal, escalando si es necesario
-    for (uint16_t x = 0; x < displayWidth; x++) {
-      // Para leer una fila horizontal, leemos el píxel en (x, rowIndex)
-      // Necesitamos leer la columna X y tomar el píxel en la posición rowIndex
-      
-      // Calcular columna origen (posible escalado si hay más LEDs que ancho)
-      uint16_t srcX;
-      if (currentImage.width <= 1) {
-        srcX = 0;
-      } else if (displayWidth <= currentImage.width) {
-        srcX = x;
+    producerColumn++;
+    if (producerColumn >= maxColumns && !sweepSync) {
+      // Vuelta completa: siguiente fotograma antes de la próxima columna
+      bool sequenceDone = advanceFrame();
+      if (sequenceDone && endSequence()) {
+        // Siguiente imagen en la misma época: la cola sigue sin hueco
+        maxColumns = getTotalColumns();
+        producerColumn = 0;
+      } else if (loopMode || !sequenceDone) {
+        producerColumn = 0;
       } else {
-        srcX = (uint32_t)x * (currentImage.width - 1) / (displayWidth - 1);
+        slot->last = true;
+        producerDone = true;
       }
+    }
+    columnQueue.commitPush();
+    if (producerDone) {
+      break;
+    }
+  }
+}
+
+void POVEngine::renderTaskEntry(void* arg) {
+  static_cast<POVEngine*>(arg)->renderLoop();
+}
+
+void POVEngine::wakeTimerCallback(void* arg) {
+  POVEngine* engine = static_cast<POVEngine*>(arg);
+  if (engine->renderTask != nullptr) {
+    xTaskNotifyGive(engine->renderTask);
+  }
+}
+
+// Tarea de render: espera cada deadline con un timer one-shot (sin busy-wait)
+// y envía la columna que ya está en cola. No toca el archivo ni el frameBuffer.
+void POVEngine::renderLoop() {
+  bool wasActive = false;
+  uint32_t runEpoch = 0;    // Barrido para el que corre el reloj
+  bool holdingSweep = false;
+  bool previousShown = false;  // La última columna sacada de la cola está en los LEDs
+
+  for (;;) {
+    renderBusy = true;
+    if (!renderActive) {
+      renderBusy = false;
+      wasActive = false;
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+      continue;
+    }
 
-      // Usamos la versión optimizada que recibe el archivo abierto
-      if (!imageParser.getColumn(file, currentImage, srcX, tempBuffer, MAX_LEDS)) {
-        ledController.setPixel(x, CRGB::Black);
+    uint32_t current = epoch;
+    if (holdingSweep && current == runEpoch) {
+      // Imagen terminada: esperar a que syncSweep() empiece otro barrido
+      renderBusy = false;
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+      continue;
+    }
+    holdingSweep = false;
+
+    // Descartar columnas de un barrido anterior
+    ColumnSlot* slot;
+    while ((slot = columnQueue.front()) != nullptr && slot->epoch != current) {
+      columnQueue.pop();
+      previousShown = false;
+    }
+
+    uint64_t now = ColumnScheduler::now();
+    if (!wasActive || current != runEpoch) {
+      // No arrancar el reloj hasta que la etapa de decodificación haya llenado la cola;
+      // cada barrido nuevo empieza su columna 0 en este instante
+      if (slot == nullptr) {
+        renderBusy = false;
+        vTaskDelay(1);
         continue;
       }
+      scheduler.start(now);
+      if (!wasActive) {
+        previousShown = false;
+        scheduler.resetStats();
+        lastFpsTick = now;
+        framesThisSecond = 0;
+      }
+      runEpoch = current;
+      wasActive = true;
+    }
 
-      // Tomar el píxel en la fila rowIndex
-      if (rowIndex < currentImage.height) {
-        ledController.setPixel(x, tempBuffer[rowIndex]);
-      } else {
-        ledController.setPixel(x, CRGB::Black);
+    uint32_t rate = requestedRate;
+    if (rate != scheduler.getRate()) {
+      scheduler.setRate(rate, now);
+    }
+
+    uint32_t steps = pollSchedule(now);
+    if (steps == 0) {
+      renderBusy = false;
+      uint64_t due = scheduler.getNextDeadline();
+      if (due > now) {
+        esp_timer_stop(wakeTimer);
+        esp_timer_start_once(wakeTimer, due - now);
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
       }
+      continue;
     }
 
-    // Apagar LEDs restantes
-    for (uint16_t i = displayWidth; i < numLeds; i++) {
-      ledController.setPixel(i, CRGB::Black);
+    // Modo por tiempo: descartar las columnas atrasadas; las que aún no
+    // estaban en cola las salta la etapa de decodificación
+    bool skippedLast = false;
+    uint32_t skip = steps - 1;
+    while (skip > 0 && slot != nullptr && !slot->hold) {
+      skippedLast = slot->last;
+      columnQueue.pop();
+      previousShown = false;
+      skip--;
+      if (skippedLast) {
+        break;
+      }
+      slot = columnQueue.front();
+    }
+    if (skippedLast) {
+      renderFinished = true;
+      renderActive = false;
+      renderBusy = false;
+      continue;
+    }
+    if (skip > 0) {
+      skipDebt += skip;
     }
-  }
 
-  file.close();
-  ledController.show();
+    if (slot == nullptr) {
+      // La decodificación no llegó a tiempo: se pierde esta columna
+      underruns++;
+      if (timingMode == POV_TIMING_TIMED) {
+        droppedColumns++;
+        skipDebt++;
+      }
+      renderBusy = false;
+      continue;
+    }
+
+    CRGB* pixels = ledController.getPixels();
+    uint16_t count = min(slot->count, ledController.getNumLeds());
+    if (slot->repeat && previousShown) {
+      // Misma línea que la anterior, que sigue en los LEDs
+      skippedShows++;
+    } else if (pixels != nullptr) {
+      memcpy(pixels, slot->pixels, count * sizeof(CRGB));
+      ledController.show();
+    }
+    previousShown = pixels != nullptr;
+    displayedColumn = slot->column;
+    displayedFrame = slot->frame;
+    bool last = slot->last;
+    holdingSweep = slot->hold;
+    columnQueue.pop();
+
+    framesThisSecond++;
+    if (now - lastFpsTick >= 1000000ULL) {
+      measuredFps = framesThisSecond;
+      framesThisSecond = 0;
+      lastFpsTick = now;
+    }
+
+    if (last) {
+      renderFinished = true;
+      renderActive = false;
+    }
+    renderBusy = false;
+  }
 }
+#endif
+
 
 // Instancia global
 POVEngine povEngine;
@@ -6,19 +6,51 @@
 #include "config.h"
 #include "led_controller.h"
 #include "image_parser.h"
+#include "image_scaler.h"
+#include "column_scheduler.h"
+#include "flash_store.h"
+#include "frame_cache.h"
+#include "frame_decoder.h"
+#include <atomic>
+
+#ifdef POV_RENDER_TASK
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <esp_timer.h>
+#include "column_queue.h"
+
+// Columna ya decodificada y escalada a la tira, lista para enviar
+struct ColumnSlot {
+  uint32_t epoch;    // Reproducción a la que pertenece (ver POVEngine::epoch)
+  uint16_t column;
+  uint16_t frame;    // Fotograma de la animación
+  uint16_t count;
+  bool last;         // Última columna de una reproducción sin loop
+  bool hold;         // Columna en negro tras la imagen: esperar al próximo syncSweep()
+  bool repeat;       // Misma línea que la columna anterior de la cola: no hace falta show()
+  CRGB pixels[MAX_LEDS];
+};
+#endif
+
+// Estado de la siguiente imagen precargada
+enum NextImageState {
+  NEXT_NONE,
+  NEXT_DECODING,
+  NEXT_READY
+};
 
 class POVEngine {
 private:
-  char currentImageFile[64];
+  char currentImageFile[64];   // Archivo que se lee (el del contenido si es un alias)
+  char currentImageName[64];   // Nombre con el que se cargó
   ImageInfo currentImage;
   uint16_t currentColumn;
   uint16_t speed;  // FPS de columnas/filas
-  unsigned long lastUpdate;
-  unsigned long columnDelay;
+  ColumnScheduler scheduler;
   // Medición de FPS real
   uint16_t framesThisSecond;
   uint16_t measuredFps;
-  unsigned long lastFpsTick;
+  uint64_t lastFpsTick;
   bool loopMode;
   POVOrientation orientation;
   bool reverseDirection;
@@ -26,6 +58,72 @@ private:
   bool paused;
   bool imageLoaded;
   CRGB* columnBuffer;
+  // Imagen decodificada completa: column-major en vertical, row-major en horizontal
+  CRGB* frameBuffer;
+  uint16_t frameLineLength;  // Píxeles por línea en frameBuffer (nativo o remuestreado)
+  bool frameResampled;       // Las líneas ya tienen exactamente numLeds píxeles
+  bool frameCached;          // frameBuffer es de frameCache (fijado): se suelta, no se libera
+  // Imagen en el almacén flash (mmap): columnas leídas en su sitio, sin buffer en RAM
+  const uint8_t* mappedImage;
+  // Modo de respaldo si la imagen no cabe en RAM: archivo abierto una sola vez
+  File imageFile;
+  // Escalado precalculado: índice de píxel origen para cada LED
+  POVResampleMode resampleMode;
+  POVTimingMode timingMode;
+  // Contadores de /api/status: los suma la tarea de render (o loop() sin ella)
+  // y play() los pone a 0 desde loop()
+  std::atomic<uint32_t> droppedColumns;  // Columnas saltadas por llegar tarde (modo por tiempo)
+  std::atomic<uint32_t> lateColumns;     // Columnas mostradas con retraso >= medio periodo
+  std::atomic<uint32_t> skippedShows;    // Columnas iguales a la anterior: sin show()
+  uint16_t shownLine;       // Línea en los LEDs (POV_NO_LINE si no se sabe), modo cooperativo
+  // Animación: cada barrido (o vuelta en loop) pasa al siguiente fotograma
+  // cuando vence su retardo; todos los fotogramas van en frameBuffer
+  uint16_t currentFrame;
+  uint16_t* frameDelays;    // ms por fotograma (nullptr en imágenes fijas)
+  unsigned long frameStartMs;
+  bool sweepSync;           // Barrido sincronizado con el movimiento (syncSweep)
+  bool holding;             // Imagen terminada, LEDs apagados hasta el próximo giro
+  LineResampler resampler;
+  uint16_t ledMap[MAX_LEDS];
+  uint16_t mappedLeds;
+  bool identityMap;
+  // Siguiente imagen (lista de reproducción): se decodifica poco a poco en
+  // update() con su propio parser y se cambia entre dos columnas al terminar
+  // la secuencia de la actual, sin reiniciar el barrido
+  char nextImageFile[64];
+  char nextImageName[64];
+  NextImageState nextState;
+  FrameDecode nextJob;      // nextJob.frame: buffer, info y retardos de la siguiente
+  bool nextCached;          // nextJob.frame viene de frameCache (fijado)
+  bool nextMapped;          // Se leerá del almacén flash: nada que decodificar
+  uint16_t nextLeds;        // LEDs con los que se decodificó
+  std::atomic<bool> prefetchInvalid;  // invalidatePrefetch(): update() cancela la precarga
+  ImageParser prefetchParser;
+  LineResampler prefetchResampler;
+  bool switchArmed;
+  uint32_t switchAfter;     // Secuencias completas antes del cambio
+  uint32_t sequenceCount;   // Secuencias completas de la imagen actual
+  uint32_t imageSwitches;
+#ifdef POV_RENDER_TASK
+  // Etapa de decodificación (loop) -> cola SPSC -> tarea de render (core RENDER_TASK_CORE)
+  ColumnQueue<ColumnSlot, COLUMN_QUEUE_DEPTH> columnQueue;
+  TaskHandle_t renderTask;
+  esp_timer_handle_t wakeTimer;
+  std::atomic<uint32_t> epoch;         // Cambia al reiniciar el barrido: invalida la cola
+  std::atomic<bool> renderActive;
+  std::atomic<bool> renderBusy;
+  std::atomic<bool> renderFinished;
+  std::atomic<uint16_t> displayedColumn;
+  std::atomic<uint16_t> displayedFrame;
+  std::atomic<uint32_t> requestedRate;
+  std::atomic<uint32_t> underruns;
+  std::atomic<uint32_t> skipDebt;      // Columnas a saltar que aún no estaban en cola
+  uint32_t producerEpoch;
+  uint16_t producerColumn;
+  uint16_t producerLine;               // Línea de la última columna encolada
+  uint16_t producerLeds;
+  bool producerDone;
+#endif
 
 public:
   POVEngine();
@@ -45,25 +143,92 @@ public:
 
   void setSpeed(uint16_t fps);
   uint16_t getSpeed();
+  void setDynamicSpeed(uint16_t fps);  // Ajuste continuo (acelerómetro): sin log
+  uint16_t getMaxSpeed();  // Tasa máxima de columnas según el tiempo de transmisión de la tira
   uint16_t getMeasuredFps();
+  uint32_t getJitterUs();     // Retraso medio respecto al deadline (us)
+  uint32_t getMaxJitterUs();  // Retraso máximo desde play()
 
   void setLoopMode(bool loop);
   bool getLoopMode();
 
   void setOrientation(POVOrientation orient);
   POVOrientation getOrientation();
+  void setResampleMode(POVResampleMode mode);
+  POVResampleMode getResampleMode();
+  void setTimingMode(POVTimingMode mode);
+  POVTimingMode getTimingMode();
   void setReverseDirection(bool reverse);
   bool isReverse();
+  void setSweepSync(bool enabled);
+  bool getSweepSync();
+  void syncSweep(bool reverse);  // Punto de giro: volver a la columna 0 en el nuevo sentido
 
   void update();
 
   const char* getCurrentImageName();
   uint16_t getCurrentColumn();
-  uint16_t getTotalColumns();
+  uint16_t getTotalColumns();  // Columnas (o filas) de un fotograma
+  uint16_t getFrameCount();    // 1 en imágenes fijas
+  uint16_t getCurrentFrame();
+
+  bool isFrameBuffered();
+  bool isFlashMapped();  // Columnas leídas del almacén flash mapeado
+  uint32_t getDroppedColumns();
+  uint32_t getLateColumns();
+  uint32_t getUnderruns();  // Columnas sin dato listo en la cola al vencer su deadline
+  uint32_t getSkippedShows();  // Columnas idénticas a la anterior que no se enviaron a la tira
+
+  // Siguiente imagen sin hueco en negro: prefetchImage() la prepara (de la
+  // caché, del almacén flash o decodificándola poco a poco en update()) y
+  // switchToNext() la pone en cuanto la actual haya completado sequences
+  // secuencias (0: al final de la que se está mostrando) y esté lista
+  bool prefetchImage(const char* filename);
+  void cancelPrefetch();
+  // Desde los handlers web (otra tarea en ESP32): la precarga puede haber
+  // leído un archivo que ya ha cambiado. Solo marca; update() la cancela en
+  // el loop, que es quien escribe en los buffers de nextJob
+  void invalidatePrefetch();
+  bool hasNextImage();
+  bool isNextImageReady();
+  void switchToNext(uint16_t sequences = 0);
+  bool isSwitchArmed();
+  uint32_t getSequenceCount();  // Secuencias completas de la imagen actual
+  uint32_t getImageSwitches();  // Cambios hechos por switchToNext()
 
 private:
-  void updateColumnDelay();
+  bool rebuildFrame(bool useCache = true);
+  bool mapFrame();
+  bool loadCachedFrame();
+  void useCachedFrame(const CachedFrame& cached);
+  void cacheFrame();
+  void freeFrameBuffer(CRGB* buffer, bool cached);
+  bool decodeFrame();
+  void stepPrefetch();
+  bool endSequence();
+  void swapToNext();
+  bool transposeFrame();
+  void buildLedMap(uint16_t numLeds);
+  void releaseFrame();
+  void restartSweep();
+  bool loadFrameDelays();
+  bool advanceFrame();
+  bool finishSweep();
+  uint16_t lineForColumn(uint16_t column);
+  bool sameLine(uint16_t a, uint16_t b);
+  bool renderLine(uint16_t column, CRGB* dest);
   void displayColumn(uint16_t column);
+  uint32_t pollSchedule(uint64_t nowUs);
+  void applyRate();
+  void holdSweep();
+#ifdef POV_RENDER_TASK
+  void startRenderTask();
+  void haltRenderTask();
+  void fillQueue();
+  void renderLoop();
+  static void renderTaskEntry(void* arg);
+  static void wakeTimerCallback(void* arg);
+#endif
 };
 
 extern POVEngine povEngine;
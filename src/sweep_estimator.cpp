@@ -0,0 +1,176 @@
+#include "sweep_estimator.h"
+
+SweepEstimator::SweepEstimator() {
+  reset();
+}
+
+void SweepEstimator::reset() {
+  filtered = 0;
+  sign = 0;
+  lastCrossUs = 0;
+  lastSampleUs = 0;
+  halfPeakAccel = 0;
+  peakAccel = 0;
+  halfPeriodUs = 0;
+  validHalves = 0;
+  sweeps = 0;
+  turnaroundUs = 0;
+  turnaroundPending = false;
+  strokeDir = 0;
+}
+
+void SweepEstimator::addSample(uint64_t timeUs, float accel) {
+  // Sin muestras durante más de un barrido lento: el periodo anterior ya no vale
+  if (lastSampleUs != 0 && timeUs - lastSampleUs > SWEEP_MAX_HALF_MS * 1000ULL) {
+    reset();
+  }
+  uint64_t prevSampleUs = lastSampleUs;
+  float prevFiltered = filtered;
+  lastSampleUs = timeUs;
+
+  filtered += SWEEP_FILTER_ALPHA * (accel - filtered);
+  float magnitude = fabsf(filtered);
+  if (magnitude > halfPeakAccel) {
+    halfPeakAccel = magnitude;
+  }
+
+  // Cruce por cero con histéresis: el signo solo cambia al superar el umbral opuesto
+  int8_t newSign = sign;
+  if (filtered > SWEEP_HYSTERESIS) {
+    newSign = 1;
+  } else if (filtered < -SWEEP_HYSTERESIS) {
+    newSign = -1;
+  }
+
+  if (newSign == sign) {
+    if (validHalves > 0 && timeUs - lastCrossUs > SWEEP_MAX_HALF_MS * 1000ULL) {
+      validHalves = 0;  // Movimiento detenido
+    }
+    return;
+  }
+
+  // Instante en que se superó el umbral, interpolado entre las dos muestras
+  uint64_t crossUs = timeUs;
+  float threshold = newSign * SWEEP_HYSTERESIS;
+  if (prevSampleUs != 0 && filtered != prevFiltered) {
+    float fraction = (threshold - prevFiltered) / (filtered - prevFiltered);
+    if (fraction > 0 && fraction < 1) {
+      crossUs = prevSampleUs + (uint64_t)((timeUs - prevSampleUs) * fraction);
+    }
+  }
+
+  if (sign != 0 && lastCrossUs != 0) {
+    uint64_t half = crossUs - lastCrossUs;
+    if (half >= SWEEP_MIN_HALF_MS * 1000ULL && half <= SWEEP_MAX_HALF_MS * 1000ULL) {
+      if (validHalves == 0) {
+        halfPeriodUs = (uint32_t)half;
+        peakAccel = halfPeakAccel;
+      } else {
+        halfPeriodUs = (halfPeriodUs + (uint32_t)half) / 2;
+        peakAccel = (peakAccel + halfPeakAccel) * 0.5f;
+      }
+      if (validHalves < 255) {
+        validHalves++;
+      }
+      sweeps++;
+    } else {
+      validHalves = 0;
+    }
+  }
+
+  sign = newSign;
+  lastCrossUs = crossUs;
+  halfPeakAccel = magnitude;
+
+  // El giro llega un cuarto de periodo después del cruce real, que ocurrió
+  // antes de detectarlo (retardo del filtro y de la histéresis). La aceleración
+  // apunta hacia el centro, así que su signo es el sentido del próximo barrido.
+  if (isLocked()) {
+    turnaroundUs = crossUs - crossingDelayUs() + halfPeriodUs / 2;
+    turnaroundPending = true;
+    strokeDir = newSign;
+  } else {
+    turnaroundPending = false;
+  }
+}
+
+// Ganancia del paso bajo exponencial a la frecuencia angular omega
+float SweepEstimator::filterGain(float omega) {
+  float phase = omega * (ACCEL_SAMPLE_PERIOD_US / 1000000.0f);
+  float keep = 1.0f - SWEEP_FILTER_ALPHA;
+  return SWEEP_FILTER_ALPHA / sqrtf(1.0f - 2.0f * keep * cosf(phase) + keep * keep);
+}
+
+// Tiempo entre el cruce por cero real y su detección
+uint32_t SweepEstimator::crossingDelayUs() {
+  if (halfPeriodUs == 0) {
+    return 0;
+  }
+  float omega = PI / (halfPeriodUs / 1000000.0f);
+  float phase = omega * (ACCEL_SAMPLE_PERIOD_US / 1000000.0f);
+  float keep = 1.0f - SWEEP_FILTER_ALPHA;
+
+  // Retardo de fase del filtro
+  float lag = atan2f(keep * sinf(phase), 1.0f - keep * cosf(phase));
+
+  // La señal filtrada tarda asin(h / pico) en superar la histéresis
+  float filteredPeak = peakAccel;
+  if (filteredPeak > SWEEP_HYSTERESIS) {
+    lag += asinf(SWEEP_HYSTERESIS / filteredPeak);
+  }
+  return (uint32_t)(lag / omega * 1000000.0f);
+}
+
+bool SweepEstimator::isLocked() {
+  return validHalves >= 2;
+}
+
+uint32_t SweepEstimator::getHalfPeriodUs() {
+  return halfPeriodUs;
+}
+
+float SweepEstimator::getPeakAccel() {
+  return peakAccel;
+}
+
+// Con x = A sin(wt) el pico de aceleración es A*w², y w = pi / medio periodo.
+// El pico se mide tras el paso bajo, así que se corrige por su ganancia a esa frecuencia.
+float SweepEstimator::getAmplitudeMm() {
+  if (halfPeriodUs == 0) {
+    return 0;
+  }
+  float halfSeconds = halfPeriodUs / 1000000.0f;
+  float omega = PI / halfSeconds;
+  return peakAccel / filterGain(omega) * 1000.0f / (omega * omega);
+}
+
+// Recorre 2A en medio periodo
+float SweepEstimator::getMeanSpeedMmS() {
+  if (halfPeriodUs == 0) {
+    return 0;
+  }
+  return 2.0f * getAmplitudeMm() * 1000000.0f / halfPeriodUs;
+}
+
+uint16_t SweepEstimator::getColumnRate(float pitchMm) {
+  if (!isLocked() || pitchMm <= 0) {
+    return 0;
+  }
+  float rate = getMeanSpeedMmS() / pitchMm;
+  if (rate > 65535.0f) {
+    rate = 65535.0f;
+  }
+  return (uint16_t)(rate + 0.5f);
+}
+
+uint32_t SweepEstimator::getSweepCount() {
+  return sweeps;
+}
+
+int8_t SweepEstimator::pollTurnaround(uint64_t nowUs) {
+  if (!turnaroundPending || !isLocked() || nowUs < turnaroundUs) {
+    return 0;
+  }
+  turnaroundPending = false;
+  return strokeDir;
+}
@@ -0,0 +1,52 @@
+#ifndef SWEEP_ESTIMATOR_H
+#define SWEEP_ESTIMATOR_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// Estimador del barrido a partir de la aceleración en el eje del movimiento.
+// Modela el vaivén como x(t) = A sin(wt): la aceleración cruza por cero a mitad
+// de cada barrido (velocidad máxima) y tiene sus picos en los extremos.
+// Del tiempo entre cruces sale el periodo y del pico la amplitud, y con ambos
+// la velocidad media del barrido. El punto de giro (velocidad cero) cae un
+// cuarto de periodo después de cada cruce, así que se predice a partir del
+// cruce en lugar de buscar el pico ruidoso. No accede al sensor: recibe muestras con su
+// instante, así que se puede alimentar con trazas grabadas.
+class SweepEstimator {
+private:
+  float filtered;          // Aceleración filtrada (m/s²)
+  int8_t sign;             // Signo actual de la aceleración (0 = sin determinar)
+  uint64_t lastCrossUs;    // Instante del último cruce por cero
+  uint64_t lastSampleUs;
+  float halfPeakAccel;     // Pico |a| del medio barrido en curso
+  float peakAccel;         // Pico medio de los últimos barridos (m/s²)
+  uint32_t halfPeriodUs;   // Duración media de medio barrido
+  uint8_t validHalves;     // Medios barridos consecutivos aceptados
+  uint32_t sweeps;         // Medios barridos detectados desde reset()
+  uint64_t turnaroundUs;   // Instante previsto del próximo punto de giro
+  bool turnaroundPending;
+  int8_t strokeDir;        // Sentido del barrido que empieza en ese giro
+
+  uint32_t crossingDelayUs();
+  float filterGain(float omega);
+
+public:
+  SweepEstimator();
+
+  void reset();
+  void addSample(uint64_t timeUs, float accel);
+
+  bool isLocked();                 // Hay un periodo estable
+  uint32_t getHalfPeriodUs();      // Duración de un barrido (un sentido)
+  float getPeakAccel();
+  float getAmplitudeMm();          // Semiamplitud A del vaivén
+  float getMeanSpeedMmS();         // Velocidad media durante un barrido
+  uint16_t getColumnRate(float pitchMm);  // Columnas/s para que cada una mida pitchMm
+  uint32_t getSweepCount();
+
+  // Devuelve el sentido (+1/-1) del nuevo barrido una vez pasado el punto de
+  // giro previsto, 0 si aún no ha llegado o ya se notificó
+  int8_t pollTurnaround(uint64_t nowUs);
+};
+
+#endif
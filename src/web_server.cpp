@@ -2,7 +2,8 @@
 
 extern Config config;
 
-WebServer::WebServer() : server(nullptr) {
+WebServer::WebServer() : server(nullptr), uploadState(UPLOAD_IDLE), uploadRequest(nullptr), uploadBytes(0) {
+  uploadName[0] = '\0';
 }
 
 WebServer::~WebServer() {
@@ -70,21 +71,56 @@ void WebServer::setupRoutes() {
     this->handleConfigSave(request);
   });
 
+  // Lista de reproducción
+  server->on("/api/playlist", HTTP_GET, [this](AsyncWebServerRequest *request) {
+    this->handlePlaylist(request);
+  });
+
+  server->on("/api/playlist", HTTP_POST, [this](AsyncWebServerRequest *request) {
+    this->handlePlaylistSave(request);
+  });
+
+  server->on("/api/playlist/play", HTTP_POST, [this](AsyncWebServerRequest *request) {
+    this->handlePlaylistPlay(request);
+  });
+
+  server->on("/api/playlist/stop", HTTP_POST, [this](AsyncWebServerRequest *request) {
+    this->handlePlaylistStop(request);
+  });
+
+  server->on("/api/playlist/next", HTTP_POST, [this](AsyncWebServerRequest *request) {
+    this->handlePlaylistNext(request);
+  });
+
   // Upload endpoint
   server->on("/api/upload", HTTP_POST,
-    [](AsyncWebServerRequest *request) {
-      request->send(200, "application/json", "{\"success\":true}");
+    [this](AsyncWebServerRequest *request) {
+      this->handleUploadDone(request);
     },
     [this](AsyncWebServerRequest *request, String filename, size_t index, uint8_t *data, size_t len, bool final) {
       this->handleUpload(request, filename, index, data, len, final);
     }
   );
 
+  server->on("/api/upload/status", HTTP_GET, [this](AsyncWebServerRequest *request) {
+    this->handleUploadStatus(request);
+  });
+
   // Delete image endpoint
   server->on("/api/image/delete", HTTP_POST, [this](AsyncWebServerRequest *request) {
     this->handleDeleteImage(request);
   });
 
+  // Nombre nuevo para un contenido que ya está (por hash), sin subirlo
+  server->on("/api/image/link", HTTP_POST, [this](AsyncWebServerRequest *request) {
+    this->handleLinkImage(request);
+  });
+
+  // Miniatura BMP de una imagen, con ETag del hash de su contenido
+  server->on("/api/image/thumb", HTTP_GET, [this](AsyncWebServerRequest *request) {
+    this->handleThumbnail(request);
+  });
+
   // 404 handler
   server->onNotFound([this](AsyncWebServerRequest *request) {
     this->handleNotFound(request);
@@ -109,6 +145,8 @@ void WebServer::handlePlay(AsyncWebServerRequest *request) {
 
   String imageName = request->getParam("image", true)->value();
 
+  // Una imagen elegida a mano sustituye a la lista de reproducción
+  playlist.stop();
   if (povEngine.loadImage(imageName.c_str())) {
     // Asegurar que no quede ningún efecto activo solapando
     effects.stop();
@@ -125,6 +163,7 @@ void WebServer::handlePause(AsyncWebServerRequest *request) {
 }
 
 void WebServer::handleStop(AsyncWebServerRequest *request) {
+  playlist.stop();
   povEngine.stop();
   effects.stop();
   request->send(200, "application/json", "{\"success\":true}");
@@ -135,8 +174,8 @@ void WebServer::handleSettings(AsyncWebServerRequest *request) {
 
   if (request->hasParam("speed", true)) {
     uint16_t speed = request->getParam("speed", true)->value().toInt();
-    povEngine.setSpeed(speed);
-    config.povSpeed = speed;
+    config.povSpeed = constrain(speed, MIN_POV_SPEED, MAX_POV_SPEED);
+    povEngine.setSpeed(config.povSpeed);
     updated = true;
   }
 
@@ -162,6 +201,22 @@ void WebServer::handleSettings(AsyncWebServerRequest *request) {
     updated = true;
   }
 
+  if (request->hasParam("resample", true)) {
+    String mode = request->getParam("resample", true)->value();
+    POVResampleMode resample = (mode == "smooth") ? POV_RESAMPLE_SMOOTH : POV_RESAMPLE_NEAREST;
+    povEngine.setResampleMode(resample);
+    config.povResample = resample;
+    updated = true;
+  }
+
+  if (request->hasParam("timing", true)) {
+    String mode = request->getParam("timing", true)->value();
+    POVTimingMode timing = (mode == "timed") ? POV_TIMING_TIMED : POV_TIMING_SEQUENTIAL;
+    povEngine.setTimingMode(timing);
+    config.povTiming = timing;
+    updated = true;
+  }
+
   if (request->hasParam("ledType", true)) {
     String ledTypeStr = request->getParam("ledType", true)->value();
     LEDStripType newType = LED_TYPE_WS2811;
@@ -175,6 +230,7 @@ void WebServer::handleSettings(AsyncWebServerRequest *request) {
     if (newType != config.ledType) {
       config.ledType = newType;
       ledController.setLEDType(newType);
+      povEngine.setSpeed(config.povSpeed);  // El máximo depende del tipo de tira
       updated = true;
     }
   }
@@ -184,6 +240,7 @@ void WebServer::handleSettings(AsyncWebServerRequest *request) {
     if (numLeds >= MIN_LEDS && numLeds <= MAX_LEDS && numLeds != config.numLeds) {
       config.numLeds = numLeds;
       ledController.setNumLeds(numLeds);
+      povEngine.setSpeed(config.povSpeed);  // El máximo depende del nº de LEDs
       updated = true;
     }
   }
@@ -210,6 +267,7 @@ void WebServer::handleEffect(AsyncWebServerRequest *request) {
   String effectName = request->getParam("effect", true)->value();
 
   // Detener POV si está activo
+  playlist.stop();
   povEngine.stop();
 
   if (effectName == "rainbow") {
@@ -244,13 +302,132 @@ void WebServer::handleDeleteImage(AsyncWebServerRequest *request) {
 
   String imageName = request->getParam("image", true)->value();
 
+  // El archivo con el contenido: si otros nombres lo comparten pasa al primero
+  // de ellos, y el almacén flash y la caché lo tienen con la ruta anterior
+  String stored = imageManager.getImagePath(imageName.c_str());
+  uint64_t hash = 0;
+  bool known = imageManager.getImageHash(imageName.c_str(), hash);
+
   if (imageManager.deleteImage(imageName.c_str())) {
+    String moved;
+    if (!known || !imageManager.findContent(hash, moved) || moved != stored) {
+      flashStore.removeImage(stored.c_str());
+      frameCache.invalidate(stored.c_str());
+      if (moved.length() > 0) {
+        flashStore.importImage(moved.c_str());
+      }
+    }
+    ImageParser::invalidateCaches();
+    povEngine.invalidatePrefetch();
     request->send(200, "application/json", "{\"success\":true}");
   } else {
     request->send(500, "application/json", "{\"error\":\"Failed to delete image\"}");
   }
 }
 
+// Hash de contenido (contentHash()) en 16 dígitos hexadecimales
+static String formatHash(uint64_t hash) {
+  char text[17];
+  snprintf(text, sizeof(text), "%08lx%08lx", (unsigned long)(hash >> 32), (unsigned long)(hash & 0xFFFFFFFF));
+  return String(text);
+}
+
+static bool parseHash(const String& text, uint64_t& hash) {
+  if (text.length() != 16) {
+    return false;
+  }
+  hash = 0;
+  for (unsigned int i = 0; i < text.length(); i++) {
+    char c = tolower(text[i]);
+    if (!isxdigit(c)) {
+      return false;
+    }
+    hash = (hash << 4) | (uint64_t)(isdigit(c) ? c - '0' : c - 'a' + 10);
+  }
+  return true;
+}
+
+void WebServer::handleLinkImage(AsyncWebServerRequest *request) {
+  if (!request->hasParam("image", true) || !request->hasParam("hash", true)) {
+    request->send(400, "application/json", "{\"error\":\"Missing image or hash parameter\"}");
+    return;
+  }
+
+  uint64_t hash;
+  if (!parseHash(request->getParam("hash", true)->value(), hash)) {
+    request->send(400, "application/json", "{\"error\":\"Invalid hash\"}");
+    return;
+  }
+
+  // Contenido desconocido: el cliente tiene que subirlo
+  String stored;
+  if (!imageManager.findContent(hash, stored)) {
+    request->send(404, "application/json", "{\"error\":\"Content not found\"}");
+    return;
+  }
+
+  String imageName = request->getParam("image", true)->value();
+  String linked;
+  if (!imageManager.linkImage(imageName.c_str(), hash, linked)) {
+    request->send(500, "application/json", "{\"error\":\"Failed to link image\"}");
+    return;
+  }
+
+  // Como tras una subida: lo que hubiera con ese nombre deja de servir
+  flashStore.importImage(linked.c_str());
+  frameCache.invalidate(linked.c_str());
+  ImageParser::invalidateCaches();
+  povEngine.invalidatePrefetch();
+
+  JsonDocument doc;
+  doc["success"] = true;
+  doc["name"] = linked;
+  String json;
+  serializeJson(doc, json);
+  request->send(200, "application/json", json);
+}
+
+// ?image=<nombre>[&v=<hash>]. El ETag (fuerte) es el hash del contenido y el
+// tamaño de miniatura: con la misma imagen la respuesta es un 304 sin cuerpo.
+// Con v igual al hash de /api/images el navegador la guarda sin revalidar
+void WebServer::handleThumbnail(AsyncWebServerRequest *request) {
+  if (!request->hasParam("image")) {
+    request->send(400, "application/json", "{\"error\":\"Missing image parameter\"}");
+    return;
+  }
+
+  String imageName = request->getParam("image")->value();
+  uint64_t hash;
+  if (!imageManager.getImageHash(imageName.c_str(), hash)) {
+    request->send(404, "application/json", "{\"error\":\"Image not found\"}");
+    return;
+  }
+
+  String etag = "\"" + formatHash(hash) + "-" + String(THUMB_MAX_SIZE) + "\"";
+  bool versioned = request->hasParam("v") && request->getParam("v")->value() == formatHash(hash);
+  const char* cacheControl = versioned ? "public, max-age=31536000, immutable" : "no-cache";
+
+  if (request->hasHeader("If-None-Match") && request->header("If-None-Match").indexOf(etag) >= 0) {
+    AsyncWebServerResponse *response = request->beginResponse(304);
+    response->addHeader("ETag", etag);
+    response->addHeader("Cache-Control", cacheControl);
+    request->send(response);
+    return;
+  }
+
+  // Las imágenes de antes de las miniaturas la crean ahora
+  String thumbPath;
+  if (!imageManager.getThumbnail(imageName.c_str(), thumbPath)) {
+    request->send(500, "application/json", "{\"error\":\"Failed to create thumbnail\"}");
+    return;
+  }
+
+  AsyncWebServerResponse *response = request->beginResponse(LittleFS, thumbPath, "image/bmp");
+  response->addHeader("ETag", etag);
+  response->addHeader("Cache-Control", cacheControl);
+  request->send(response);
+}
+
 void WebServer::handleConfig(AsyncWebServerRequest *request) {
   JsonDocument doc;
 
@@ -260,6 +437,12 @@ void WebServer::handleConfig(AsyncWebServerRequest *request) {
   doc["povSpeed"] = config.povSpeed;
   doc["loopMode"] = config.loopMode;
   doc["povOrientation"] = (config.povOrientation == POV_VERTICAL) ? "vertical" : "horizontal";
+  doc["povResample"] = (config.povResample == POV_RESAMPLE_SMOOTH) ? "smooth" : "nearest";
+  doc["povTiming"] = (config.povTiming == POV_TIMING_TIMED) ? "timed" : "sequential";
+  doc["povAutoSpeed"] = config.povAutoSpeed;
+  doc["povSweepSync"] = config.povSweepSync;
+  doc["columnPitchMm"] = config.columnPitchMm;
+  doc["frameCacheKB"] = config.frameCacheKB;
   doc["wifiSSID"] = config.wifiSSID;
   doc["wifiEnabled"] = config.wifiEnabled;
   doc["mqttEnabled"] = config.mqttEnabled;
@@ -285,6 +468,7 @@ void WebServer::handleConfigSave(AsyncWebServerRequest *request) {
     if (num >= MIN_LEDS && num <= MAX_LEDS) {
       config.numLeds = num;
       ledController.setNumLeds(num);
+      povEngine.setSpeed(config.povSpeed);
       updated = true;
     }
   }
@@ -317,6 +501,53 @@ void WebServer::handleConfigSave(AsyncWebServerRequest *request) {
     updated = true;
   }
 
+  if (request->hasParam("povResample", true)) {
+    String mode = request->getParam("povResample", true)->value();
+    config.povResample = (mode == "smooth") ? POV_RESAMPLE_SMOOTH : POV_RESAMPLE_NEAREST;
+    povEngine.setResampleMode(config.povResample);
+    updated = true;
+  }
+
+  if (request->hasParam("povAutoSpeed", true)) {
+    String autoSpeed = request->getParam("povAutoSpeed", true)->value();
+    config.povAutoSpeed = (autoSpeed == "true" || autoSpeed == "1");
+    if (!config.povAutoSpeed) {
+      povEngine.setSpeed(config.povSpeed);  // Volver a la velocidad fija
+    }
+    updated = true;
+  }
+
+  if (request->hasParam("povSweepSync", true)) {
+    String sync = request->getParam("povSweepSync", true)->value();
+    config.povSweepSync = (sync == "true" || sync == "1");
+    povEngine.setSweepSync(config.povSweepSync);
+    updated = true;
+  }
+
+  if (request->hasParam("columnPitchMm", true)) {
+    float pitch = request->getParam("columnPitchMm", true)->value().toFloat();
+    if (pitch > 0) {
+      config.columnPitchMm = pitch;
+      updated = true;
+    }
+  }
+
+  if (request->hasParam("frameCacheKB", true)) {
+    int kb = request->getParam("frameCacheKB", true)->value().toInt();
+    if (kb >= 0 && kb <= MAX_FRAME_CACHE_KB) {
+      config.frameCacheKB = kb;
+      frameCache.setBudget((size_t)config.frameCacheKB * 1024);
+      updated = true;
+    }
+  }
+
+  if (request->hasParam("povTiming", true)) {
+    String mode = request->getParam("povTiming", true)->value();
+    config.povTiming = (mode == "timed") ? POV_TIMING_TIMED : POV_TIMING_SEQUENTIAL;
+    povEngine.setTimingMode(config.povTiming);
+    updated = true;
+  }
+
   if (request->hasParam("wifiSSID", true)) {
     String ssid = request->getParam("wifiSSID", true)->value();
     strlcpy(config.wifiSSID, ssid.c_str(), sizeof(config.wifiSSID));
@@ -358,39 +589,177 @@ void WebServer::handleConfigSave(AsyncWebServerRequest *request) {
   }
 }
 
+void WebServer::handlePlaylist(AsyncWebServerRequest *request) {
+  JsonDocument doc;
+  playlist.toJSON(doc.to<JsonObject>());
+
+  String json;
+  serializeJson(doc, json);
+  request->send(200, "application/json", json);
+}
+
+// entries: array JSON [{"image":"a.bmp","duration":10000},{"image":"b.pov","loops":3}]
+void WebServer::handlePlaylistSave(AsyncWebServerRequest *request) {
+  bool updated = false;
+
+  if (request->hasParam("shuffle", true)) {
+    String shuffle = request->getParam("shuffle", true)->value();
+    playlist.setShuffle(shuffle == "true" || shuffle == "1");
+    updated = true;
+  }
+
+  if (request->hasParam("entries", true)) {
+    JsonDocument doc;
+    String entries = request->getParam("entries", true)->value();
+    if (deserializeJson(doc, entries) || !doc.is<JsonArray>()) {
+      request->send(400, "application/json", "{\"error\":\"Invalid entries\"}");
+      return;
+    }
+    if (!playlist.setEntries(doc.as<JsonArrayConst>())) {
+      request->send(400, "application/json", "{\"error\":\"Invalid playlist\"}");
+      return;
+    }
+    updated = true;
+  }
+
+  if (updated) {
+    request->send(200, "application/json", "{\"success\":true}");
+  } else {
+    request->send(400, "application/json", "{\"error\":\"No parameters provided\"}");
+  }
+}
+
+void WebServer::handlePlaylistPlay(AsyncWebServerRequest *request) {
+  if (playlist.start()) {
+    effects.stop();
+    request->send(200, "application/json", "{\"success\":true}");
+  } else {
+    request->send(500, "application/json", "{\"error\":\"Failed to start playlist\"}");
+  }
+}
+
+void WebServer::handlePlaylistStop(AsyncWebServerRequest *request) {
+  playlist.stop();
+  request->send(200, "application/json", "{\"success\":true}");
+}
+
+void WebServer::handlePlaylistNext(AsyncWebServerRequest *request) {
+  if (playlist.next()) {
+    request->send(200, "application/json", "{\"success\":true}");
+  } else {
+    request->send(400, "application/json", "{\"error\":\"Playlist not active\"}");
+  }
+}
+
 void WebServer::handleUpload(AsyncWebServerRequest *request, String filename, size_t index, uint8_t *data, size_t len, bool final) {
   if (!index) {
+    // La anterior aún se está guardando en loop(): el transcodificador es suyo
+    uint8_t state = uploadState;
+    if (state == UPLOAD_QUEUED || state == UPLOAD_PROCESSING) {
+      Serial.printf("Error: Upload de %s rechazado, hay otro en proceso\n", filename.c_str());
+      return;
+    }
+    uploadRequest = request;
+    uploadState = UPLOAD_RECEIVING;
     Serial.printf("Upload iniciado: %s\n", filename.c_str());
 
     // Validar espacio disponible
     if (imageManager.getFreeSpace() < MAX_IMAGE_SIZE) {
       Serial.println("Error: No hay espacio suficiente");
+      imageTranscoder.abort();
+      uploadState = UPLOAD_FAILED;
       return;
     }
 
-    // Crear archivo en directorio de imágenes
-    String filepath = String(IMAGES_DIR) + "/" + filename;
-    uploadFile = LittleFS.open(filepath, "w");
-
-    if (!uploadFile) {
-      Serial.println("Error: No se pudo crear archivo");
+    // BMP/RGB565/PNG se convierten a .pov mientras llegan; el resto se guarda tal cual
+    if (!imageTranscoder.begin(filename.c_str())) {
+      uploadState = UPLOAD_FAILED;
       return;
     }
   }
 
-  if (uploadFile && len) {
-    uploadFile.write(data, len);
+  if (request != uploadRequest || uploadState != UPLOAD_RECEIVING) {
+    return;
+  }
+
+  if (imageTranscoder.isActive() && len) {
+    imageTranscoder.write(data, len);
   }
 
   if (final) {
-    if (uploadFile) {
-      uploadFile.close();
-      Serial.printf("Upload completado: %s (%d bytes)\n", filename.c_str(), index + len);
+    // El resto (trasponer, catálogo, miniatura, almacén flash) tarda y toca
+    // lo que usa loop(): se hace en update()
+    uploadBytes = index + len;
+    uploadState = imageTranscoder.isActive() ? UPLOAD_QUEUED : UPLOAD_FAILED;
+  }
+}
 
-      // Refrescar lista de imágenes
-      imageManager.refreshList();
+// Fin de la petición: la imagen aún se está guardando, el cliente consulta
+// /api/upload/status
+void WebServer::handleUploadDone(AsyncWebServerRequest *request) {
+  uint8_t state = uploadState;
+  if (request != uploadRequest) {
+    if (state == UPLOAD_QUEUED || state == UPLOAD_PROCESSING) {
+      request->send(409, "application/json", "{\"error\":\"Upload in progress\"}");
+    } else {
+      request->send(500, "application/json", "{\"error\":\"Upload failed\"}");
     }
+    return;
+  }
+
+  uploadRequest = nullptr;
+  if (state == UPLOAD_QUEUED || state == UPLOAD_PROCESSING || state == UPLOAD_DONE) {
+    request->send(202, "application/json", "{\"success\":true,\"pending\":true}");
+  } else {
+    request->send(500, "application/json", "{\"error\":\"Upload failed\"}");
+  }
+}
+
+void WebServer::handleUploadStatus(AsyncWebServerRequest *request) {
+  static const char* const names[] = {"idle", "receiving", "processing", "processing", "done", "failed"};
+  uint8_t state = uploadState;
+
+  JsonDocument doc;
+  doc["state"] = names[state];
+  if (state == UPLOAD_DONE) {
+    doc["name"] = uploadName;
+  }
+  String json;
+  serializeJson(doc, json);
+  request->send(200, "application/json", json);
+}
+
+void WebServer::update() {
+  if (uploadState != UPLOAD_QUEUED) {
+    return;
   }
+  uploadState = UPLOAD_PROCESSING;
+  uploadState = finishUpload() ? UPLOAD_DONE : UPLOAD_FAILED;
+}
+
+// En loop(): nada de esto compite con la precarga ni con la imagen en pantalla
+bool WebServer::finishUpload() {
+  if (!imageTranscoder.finish()) {
+    return false;
+  }
+  const char* name = imageTranscoder.getOutputName();
+  Serial.printf("Upload completado: %s (%u bytes)\n", name, (unsigned)uploadBytes);
+
+  // Solo la imagen subida entra en el catálogo, con los hashes calculados
+  // durante la subida; si su contenido ya estaba queda como alias
+  imageManager.addImage(name, imageTranscoder.getOutputHash(), imageTranscoder.getSourceHash());
+  // La galería pide la miniatura en vez de la imagen; un alias ya la tiene.
+  // Relee la imagen entera: aquí y no en la petición de la galería
+  String thumbPath;
+  imageManager.getThumbnail(name, thumbPath);
+  flashStore.importImage(name);
+  frameCache.invalidate(name);
+  // Mismo nombre y tamaño no es el mismo contenido: paleta y tabla se releen
+  ImageParser::invalidateCaches();
+  // La siguiente de la lista se vuelve a preparar con lo que haya ahora
+  povEngine.cancelPrefetch();
+  strlcpy(uploadName, name, sizeof(uploadName));
+  return true;
 }
 
 void WebServer::handleNotFound(AsyncWebServerRequest *request) {
@@ -404,12 +773,23 @@ String WebServer::getStatusJSON() {
   doc["image"] = povEngine.getCurrentImageName();
   doc["column"] = povEngine.getCurrentColumn();
   doc["totalColumns"] = povEngine.getTotalColumns();
+  doc["frames"] = povEngine.getFrameCount();
+  doc["frame"] = povEngine.getCurrentFrame();
   doc["speed"] = povEngine.getSpeed();
+  doc["maxSpeed"] = povEngine.getMaxSpeed();
   doc["measuredFps"] = povEngine.getMeasuredFps();
+  doc["jitterUs"] = povEngine.getJitterUs();
+  doc["maxJitterUs"] = povEngine.getMaxJitterUs();
+  doc["underruns"] = povEngine.getUnderruns();
+  doc["skippedShows"] = povEngine.getSkippedShows();
+  doc["droppedColumns"] = povEngine.getDroppedColumns();
+  doc["lateColumns"] = povEngine.getLateColumns();
   doc["brightness"] = ledController.getBrightness();
   doc["loopMode"] = povEngine.getLoopMode();
   doc["orientation"] = (povEngine.getOrientation() == POV_VERTICAL) ? "vertical" : "horizontal";
   doc["direction"] = povEngine.isReverse() ? "right_to_left" : "left_to_right";
+  doc["resample"] = (povEngine.getResampleMode() == POV_RESAMPLE_SMOOTH) ? "smooth" : "nearest";
+  doc["timing"] = (povEngine.getTimingMode() == POV_TIMING_TIMED) ? "timed" : "sequential";
 
   // LED configuration
   String ledTypeStr = "WS2811";
@@ -432,6 +812,19 @@ String WebServer::getStatusJSON() {
   doc["wifiSSID"] = wifiManager.getSSID();
   doc["wifiIP"] = wifiManager.getIP();
   doc["freeSpace"] = imageManager.getFreeSpace();
+  doc["flashMapped"] = povEngine.isFlashMapped();
+  doc["flashStoreImages"] = flashStore.getImageCount();
+  doc["flashStoreFree"] = flashStore.getFreeSpace();
+  doc["cacheHits"] = frameCache.getHits();
+  doc["cacheMisses"] = frameCache.getMisses();
+  doc["cacheEvictions"] = frameCache.getEvictions();
+  doc["cacheImages"] = frameCache.getImageCount();
+  doc["cacheBytes"] = frameCache.getUsedBytes();
+  doc["cacheBudget"] = frameCache.getBudget();
+  doc["playlistActive"] = playlist.isActive();
+  doc["playlistPosition"] = playlist.getPosition();
+  doc["nextImageReady"] = povEngine.isNextImageReady();
+  doc["imageSwitches"] = povEngine.getImageSwitches();
 
   String json;
   serializeJson(doc, json);
@@ -450,7 +843,22 @@ String WebServer::getImagesJSON() {
     imgObj["width"] = img.width;
     imgObj["height"] = img.height;
     imgObj["size"] = img.fileSize;
-    imgObj["format"] = (img.format == 0) ? "BMP" : "RGB565";
+    imgObj["format"] = (img.format == 0) ? "BMP" : (img.format == 1) ? "RGB565" : "POV";
+    imgObj["frames"] = img.frameCount;
+
+    // Con el hash el cliente sabe si ya está lo que va a subir (/api/image/link)
+    uint64_t hash = 0;
+    if (imageManager.getImageHash(img.filename, hash)) {
+      imgObj["hash"] = formatHash(hash);
+    }
+    uint64_t sourceHash;
+    if (imageManager.getSourceHash(img.filename, sourceHash) && sourceHash != hash) {
+      imgObj["sourceHash"] = formatHash(sourceHash);
+    }
+    String stored = imageManager.getImagePath(img.filename);
+    if (stored != img.filename) {
+      imgObj["storedAs"] = stored;
+    }
   }
 
   doc["freeSpace"] = imageManager.getFreeSpace();
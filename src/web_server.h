@@ -10,17 +10,38 @@
 #endif
 #include <LittleFS.h>
 #include <ArduinoJson.h>
+#include <atomic>
 #include "config.h"
 #include "led_controller.h"
 #include "pov_engine.h"
 #include "effects.h"
 #include "image_manager.h"
+#include "image_transcoder.h"
+#include "flash_store.h"
+#include "frame_cache.h"
+#include "playlist.h"
 #include "wifi_manager.h"
 
 class WebServer {
 private:
   AsyncWebServer* server;
-  File uploadFile;
+
+  // Subida: los chunks se escriben desde la tarea async_tcp, pero la
+  // trasposición a .pov, el catálogo, el almacén flash y las cachés se hacen
+  // en update(), desde loop(). /api/upload responde 202 y el cliente consulta
+  // /api/upload/status. No se acepta otra subida hasta terminar la anterior
+  enum UploadState : uint8_t {
+    UPLOAD_IDLE,
+    UPLOAD_RECEIVING,
+    UPLOAD_QUEUED,      // Recibida entera; update() la termina
+    UPLOAD_PROCESSING,
+    UPLOAD_DONE,
+    UPLOAD_FAILED
+  };
+  std::atomic<uint8_t> uploadState;
+  AsyncWebServerRequest* uploadRequest;  // Petición de la subida aceptada (solo la tarea web)
+  size_t uploadBytes;
+  char uploadName[32];                   // Imagen guardada (válido en UPLOAD_DONE)
 
 public:
   WebServer();
@@ -28,6 +49,7 @@ public:
 
   void init();
   void setupRoutes();
+  void update();  // Llamar en cada loop(): termina la subida recibida
 
 private:
   // Handlers para servir archivos estáticos
@@ -44,11 +66,21 @@ private:
   void handleEffects(AsyncWebServerRequest *request);
   void handleEffect(AsyncWebServerRequest *request);
   void handleDeleteImage(AsyncWebServerRequest *request);
+  void handleLinkImage(AsyncWebServerRequest *request);
+  void handleThumbnail(AsyncWebServerRequest *request);
   void handleConfig(AsyncWebServerRequest *request);
   void handleConfigSave(AsyncWebServerRequest *request);
+  void handlePlaylist(AsyncWebServerRequest *request);
+  void handlePlaylistSave(AsyncWebServerRequest *request);
+  void handlePlaylistPlay(AsyncWebServerRequest *request);
+  void handlePlaylistStop(AsyncWebServerRequest *request);
+  void handlePlaylistNext(AsyncWebServerRequest *request);
 
   // Upload handlers
   void handleUpload(AsyncWebServerRequest *request, String filename, size_t index, uint8_t *data, size_t len, bool final);
+  void handleUploadDone(AsyncWebServerRequest *request);
+  void handleUploadStatus(AsyncWebServerRequest *request);
+  bool finishUpload();
 
   // Utilidades
   String getStatusJSON();
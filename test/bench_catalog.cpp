@@ -0,0 +1,187 @@
+/**
+ * @file bench_catalog.cpp
+ * @brief Benchmark de host: catálogo de imágenes frente a parsear /images entero
+ *
+ * Crea 500 imágenes (BMP, RGB565 y .pov de varios tamaños) en el LittleFS en
+ * memoria de test/host/ y mide, con el ImageManager real:
+ *   - el listado antiguo, que abre y parsea cada archivo en cada init() y en
+ *     cada refreshList() (también tras cada subida y cada borrado)
+ *   - el primer arranque, que construye el catálogo (parseo + hash de todo)
+ *   - el arranque con el catálogo al día, que solo lista el directorio
+ *   - una subida (addImage()) y un borrado (deleteImage()) incrementales
+ *   - el arranque con el catálogo corrupto y con una imagen cambiada por fuera
+ * Para cada caso muestra el tiempo, los archivos abiertos y los bytes leídos y
+ * escritos: en flash real el coste lo marcan las aperturas y las lecturas.
+ *
+ * Compilar y ejecutar en el PC:
+ *   g++ -std=gnu++17 -O2 -Itest/host -Isrc test/bench_catalog.cpp \
+ *     src/image_manager.cpp src/image_parser.cpp src/image_scaler.cpp \
+ *     -o bench_catalog && ./bench_catalog
+ */
+
+#include "bench_util.h"
+#include "image_manager.h"
+
+static const int IMAGE_COUNT = 500;
+
+// .pov de columnas RLE de un solo tramo
+static std::vector<uint8_t> makePOV(uint16_t width, uint16_t height, uint8_t seed) {
+  std::vector<uint8_t> out;
+  putPOVHeader(out, width, height, POV_PIXEL_RGB888, sizeof(POVHeader));
+
+  uint32_t runs = (height + 254) / 255;
+  uint32_t columnBytes = 1 + runs * 4;
+  uint32_t start = sizeof(POVHeader) + (width + 1) * 4;
+  for (uint32_t x = 0; x <= width; x++) {
+    put32(out, start + x * columnBytes);
+  }
+  for (uint16_t x = 0; x < width; x++) {
+    out.push_back(POV_COLUMN_RLE);
+    for (uint32_t r = 0, left = height; r < runs; r++, left -= 255) {
+      out.push_back(min(left, (uint32_t)255));
+      out.push_back(x + seed);
+      out.push_back(x * 3);
+      out.push_back(seed);
+    }
+  }
+  return out;
+}
+
+static std::vector<uint8_t> makeImage(int i, char* path, size_t pathSize) {
+  static const uint16_t widths[] = {32, 64, 128};
+  static const uint16_t heights[] = {16, 144, 300};
+  uint16_t width = widths[i % 3];
+  uint16_t height = heights[(i / 3) % 3];
+  uint8_t seed = i;
+  switch (i % 4) {
+    case 0:
+      snprintf(path, pathSize, IMAGES_DIR "/img%03d.bmp", i);
+      return makeBMP(width, height, [=](uint32_t n) { return (uint8_t)(n * 7 + seed); });
+    case 1:
+      snprintf(path, pathSize, IMAGES_DIR "/img%03d.rgb", i);
+      return makeRGB565(width, height, [=](uint16_t x, uint16_t y) {
+        return (uint16_t)(((uint32_t)y * width + x) * 31 + seed);
+      });
+    default:
+      snprintf(path, pathSize, IMAGES_DIR "/img%03d.pov", i);
+      return makePOV(width, height, seed);
+  }
+}
+
+static void addImage(int i, char* path, size_t pathSize) {
+  std::vector<uint8_t> data = makeImage(i, path, pathSize);
+  LittleFS.addFile(path, data.data(), data.size());
+}
+
+// Listado anterior al catálogo: abrir y parsear cada archivo del directorio
+static size_t legacyScan() {
+  std::vector<ImageInfo> images;
+  File root = LittleFS.open(IMAGES_DIR);
+  for (File file = root.openNextFile(); file; file = root.openNextFile()) {
+    String fullPath = String(IMAGES_DIR "/") + file.name();
+    ImageInfo info;
+    if (imageParser.parseImageInfo(fullPath.c_str(), info)) {
+      images.push_back(info);
+    }
+  }
+  return images.size();
+}
+
+static void report(const char* name, double start, size_t images) {
+  double ms = (now() - start) * 1000;
+  printf("%-36s %9.2f %7u %11.1f %11.1f %8zu\n", name, ms, LittleFS.opens,
+         LittleFS.bytesRead / 1024.0, LittleFS.bytesWritten / 1024.0, images);
+  LittleFS.resetCounters();
+}
+
+static bool sameList(const std::vector<ImageInfo>& a, const std::vector<ImageInfo>& b) {
+  if (a.size() != b.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < a.size(); i++) {
+    if (strcmp(a[i].filename, b[i].filename) != 0 || a[i].width != b[i].width ||
+        a[i].height != b[i].height || a[i].fileSize != b[i].fileSize || a[i].format != b[i].format ||
+        a[i].dataOffset != b[i].dataOffset || a[i].rowStride != b[i].rowStride ||
+        a[i].pixelFormat != b[i].pixelFormat || a[i].frameCount != b[i].frameCount) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int main() {
+  Serial.quiet = true;
+  char path[32];
+  LittleFS.mkdir(IMAGES_DIR);
+  for (int i = 0; i < IMAGE_COUNT; i++) {
+    addImage(i, path, sizeof(path));
+  }
+  LittleFS.resetCounters();
+
+  printf("%d imágenes, %.1f KB\n\n", IMAGE_COUNT, LittleFS.usedBytes() / 1024.0);
+  printf("%-36s %9s %7s %11s %11s %8s\n", "Caso", "ms", "Aperturas", "KB leídos", "KB escritos", "Imágenes");
+
+  double start = now();
+  size_t count = legacyScan();
+  report("Sin catálogo: parsear todo", start, count);
+
+  start = now();
+  ImageManager first;
+  first.init();
+  std::vector<ImageInfo> built = first.listImages();
+  report("Primer arranque: crear catálogo", start, built.size());
+
+  start = now();
+  ImageManager boot;
+  boot.init();
+  std::vector<ImageInfo> cached = boot.listImages();
+  report("Arranque con catálogo", start, cached.size());
+
+  // Subida: antes refreshList() volvía a parsear todo
+  addImage(IMAGE_COUNT, path, sizeof(path));
+  LittleFS.resetCounters();
+  start = now();
+  count = legacyScan();
+  report("Subida sin catálogo (refreshList)", start, count);
+
+  start = now();
+  boot.addImage(path);
+  report("Subida con catálogo (addImage)", start, boot.listImages().size());
+
+  start = now();
+  boot.deleteImage(path);
+  report("Borrado con catálogo", start, boot.listImages().size());
+
+  // Cambios por fuera de la API: imagen reemplazada (otro tamaño) y catálogo corrupto
+  std::vector<uint8_t> replaced = makeImage(7, path, sizeof(path));
+  replaced.resize(replaced.size() + 64);
+  LittleFS.addFile(path, replaced.data(), replaced.size());
+  LittleFS.resetCounters();
+  start = now();
+  ImageManager changed;
+  changed.init();
+  report("Arranque con 1 imagen cambiada", start, changed.listImages().size());
+
+  File catalog = LittleFS.open(CATALOG_FILE, "r");
+  std::vector<uint8_t> bytes(catalog.size());
+  catalog.read(bytes.data(), bytes.size());
+  catalog.close();
+  bytes[sizeof(CatalogHeader) + 40] ^= 0xFF;
+  LittleFS.addFile(CATALOG_FILE, bytes.data(), bytes.size());
+  LittleFS.resetCounters();
+  start = now();
+  ImageManager corrupt;
+  corrupt.init();
+  std::vector<ImageInfo> rebuilt = corrupt.listImages();
+  report("Arranque con catálogo corrupto", start, rebuilt.size());
+
+  // El catálogo debe dar lo mismo que parsear cada archivo
+  bool ok = sameList(built, cached) && built.size() == IMAGE_COUNT && rebuilt.size() == IMAGE_COUNT;
+  for (const ImageInfo& info : rebuilt) {
+    ImageInfo parsed;
+    ok = ok && imageParser.parseImageInfo(info.filename, parsed) &&
+         sameList(std::vector<ImageInfo>{info}, std::vector<ImageInfo>{parsed});
+  }
+  printf("\nCatálogo coherente con el parseo: %s\n", ok ? "sí" : "NO");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,189 @@
+/**
+ * @file bench_column_queue.cpp
+ * @brief Prueba de estrés de host de la cola de columnas (src/column_queue.h)
+ *
+ * Un hilo productor y un hilo consumidor (std::thread, como la tarea de
+ * render y el loop() en el ESP32) se pasan millones de columnas por la
+ * ColumnQueue real con varias profundidades: la de config.h, la mínima (un
+ * solo hueco útil, productor y consumidor siempre pisándose) y una grande.
+ * Cada columna lleva su número de secuencia y unos píxeles derivados de él, y
+ * el consumidor comprueba que llegan en orden, sin pérdidas ni duplicados y
+ * sin píxeles a medio escribir. Muestra columnas/segundo y cuántas veces se
+ * encontró la cola llena o vacía.
+ *
+ * Compilar y ejecutar en el PC (no necesita Arduino ni PlatformIO):
+ *   g++ -std=gnu++17 -O2 -pthread -Itest/host -Isrc test/bench_column_queue.cpp \
+ *     -o bench_column_queue && ./bench_column_queue
+ *
+ * Con ThreadSanitizer (más lento, conviene bajar las columnas con el
+ * argumento: ./bench_column_queue 200000):
+ *   g++ -std=gnu++17 -O1 -g -fsanitize=thread -Itest/host -Isrc \
+ *     test/bench_column_queue.cpp -o bench_column_queue
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include "bench_util.h"
+#include "config.h"
+#include "column_queue.h"
+
+static const uint32_t DEFAULT_COLUMNS = 4000000;
+static const uint16_t STRIP_BYTES = MAX_LEDS * 3;
+
+// Como ColumnSlot de pov_engine.h: cabecera y una línea de píxeles
+struct Slot {
+  uint32_t seq;
+  uint16_t column;
+  uint16_t count;
+  uint8_t pixels[STRIP_BYTES];
+};
+
+struct Result {
+  double seconds = 0;
+  uint64_t received = 0;
+  uint64_t outOfOrder = 0;
+  uint64_t lost = 0;
+  uint64_t duplicated = 0;
+  uint64_t torn = 0;       // Píxeles que no corresponden a la secuencia
+  uint64_t fullSpins = 0;  // beginPush() == nullptr
+  uint64_t emptySpins = 0; // front() == nullptr
+  bool emptyAtEnd = false;
+};
+
+static uint8_t pixelFor(uint32_t seq, uint16_t i) {
+  return (uint8_t)(seq * 131u + i * 7u + (seq >> 8));
+}
+
+static void fillSlot(Slot* slot, uint32_t seq) {
+  slot->seq = seq;
+  slot->column = (uint16_t)(seq % 360);
+  slot->count = STRIP_BYTES / 3;
+  for (uint16_t i = 0; i < STRIP_BYTES; i++) {
+    slot->pixels[i] = pixelFor(seq, i);
+  }
+}
+
+static bool slotIntact(const Slot* slot) {
+  if (slot->column != slot->seq % 360 || slot->count != STRIP_BYTES / 3) {
+    return false;
+  }
+  for (uint16_t i = 0; i < STRIP_BYTES; i++) {
+    if (slot->pixels[i] != pixelFor(slot->seq, i)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <uint16_t Capacity>
+static Result run(uint32_t columns) {
+  // En el heap: con Capacity grande no cabe en la pila
+  ColumnQueue<Slot, Capacity>* queue = new ColumnQueue<Slot, Capacity>();
+  std::vector<uint8_t> seen(columns, 0);
+  Result r;
+
+  double start = now();
+  std::thread producer([&]() {
+    for (uint32_t seq = 0; seq < columns; seq++) {
+      Slot* slot;
+      while ((slot = queue->beginPush()) == nullptr) {
+        r.fullSpins++;
+        std::this_thread::yield();
+      }
+      fillSlot(slot, seq);
+      queue->commitPush();
+    }
+  });
+
+  std::thread consumer([&]() {
+    uint32_t expected = 0;
+    while (r.received < columns) {
+      Slot* slot = queue->front();
+      if (slot == nullptr) {
+        r.emptySpins++;
+        std::this_thread::yield();
+        continue;
+      }
+      uint32_t seq = slot->seq;
+      if (!slotIntact(slot)) {
+        r.torn++;
+      }
+      if (seq >= columns || seen[seq]) {
+        r.duplicated++;
+      } else {
+        seen[seq] = 1;
+      }
+      if (seq != expected) {
+        r.outOfOrder++;
+      }
+      expected = seq + 1;
+      r.received++;
+      queue->pop();
+    }
+  });
+
+  producer.join();
+  consumer.join();
+  r.seconds = now() - start;
+
+  for (uint32_t seq = 0; seq < columns; seq++) {
+    if (!seen[seq]) {
+      r.lost++;
+    }
+  }
+  r.emptyAtEnd = queue->empty() && queue->front() == nullptr;
+  delete queue;
+  return r;
+}
+
+static void printRow(uint16_t depth, uint32_t columns, const Result& r) {
+  printf("%6u %10u %8.3f %10.2f %10llu %10llu %8llu %8llu %8llu %8llu\n", depth, columns,
+         r.seconds, r.received / r.seconds / 1e6, (unsigned long long)r.fullSpins,
+         (unsigned long long)r.emptySpins, (unsigned long long)r.outOfOrder,
+         (unsigned long long)r.lost, (unsigned long long)r.duplicated,
+         (unsigned long long)r.torn);
+}
+
+int main(int argc, char** argv) {
+  uint32_t columns = argc > 1 ? (uint32_t)strtoul(argv[1], nullptr, 10) : DEFAULT_COLUMNS;
+  if (columns == 0) {
+    columns = DEFAULT_COLUMNS;
+  }
+
+  printf("Columna de %u bytes, %u hilos hardware\n\n", (unsigned)sizeof(Slot),
+         std::thread::hardware_concurrency());
+  printf("%6s %10s %8s %10s %10s %10s %8s %8s %8s %8s\n", "huecos", "columnas", "s", "Mcol/s",
+         "llena", "vacía", "orden", "perdidas", "dupl.", "rotas");
+
+  Result results[3];
+  results[0] = run<COLUMN_QUEUE_DEPTH>(columns);
+  printRow(COLUMN_QUEUE_DEPTH, columns, results[0]);
+  results[1] = run<2>(columns);
+  printRow(2, columns, results[1]);
+  results[2] = run<1024>(columns);
+  printRow(1024, columns, results[2]);
+
+  bool orderOk = true;
+  bool lostOk = true;
+  bool duplicatedOk = true;
+  bool tornOk = true;
+  bool emptyOk = true;
+  for (const Result& r : results) {
+    orderOk = orderOk && r.outOfOrder == 0;
+    lostOk = lostOk && r.lost == 0 && r.received == columns;
+    duplicatedOk = duplicatedOk && r.duplicated == 0;
+    tornOk = tornOk && r.torn == 0;
+    emptyOk = emptyOk && r.emptyAtEnd;
+  }
+
+  printf("\nComprobaciones:\n");
+  bool allOk = true;
+  check("columnas en el orden en que se publicaron", orderOk, allOk);
+  check("ninguna columna perdida", lostOk, allOk);
+  check("ninguna columna duplicada", duplicatedOk, allOk);
+  check("píxeles completos al leer (sin columnas rotas)", tornOk, allOk);
+  check("cola vacía al terminar", emptyOk, allOk);
+  printf("\n%s\n", allOk ? "Todo correcto" : "ERRORES");
+  return allOk ? 0 : 1;
+}
@@ -0,0 +1,352 @@
+/**
+ * @file bench_columns.cpp
+ * @brief Benchmark de host: compresión y decodificación de columnas .pov
+ *
+ * Codifica un corpus de imágenes de prueba típicas de POV (texto, logo,
+ * franjas, degradado, foto) con src/pov_codec.h en tres modos: solo raw,
+ * raw + RLE, y raw + RLE + repetida/delta. Para cada uno muestra el tamaño de
+ * las columnas respecto a raw y los píxeles/segundo al decodificar la imagen
+ * completa columna a columna hasta RGB (pov_codec.h + pixel_convert.h, como
+ * ImageParser::getColumnPOV()). Se cuentan también las columnas repetidas,
+ * que el motor muestra sin llamar a LEDController::show().
+ *
+ * Compilar y ejecutar en el PC (no necesita Arduino ni PlatformIO):
+ *   g++ -O2 -Isrc test/bench_columns.cpp -o bench_columns && ./bench_columns
+ *
+ * Con archivos .pov como argumentos (p. ej. generados con
+ * scripts/pov_convert.py) se miden esos archivos en lugar del corpus.
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "pixel_convert.h"
+#include "pov_codec.h"
+
+static const uint16_t WIDTH = 256;
+static const uint16_t HEIGHT = 144;
+static const int REPEAT = 50;
+
+enum Mode { MODE_RAW, MODE_RLE, MODE_DELTA };
+
+// Imagen desempaquetada column-major: width columnas de height píxeles
+struct Image {
+  const char* name;
+  uint16_t width;
+  uint16_t height;
+  uint8_t bytesPerPixel;  // 3 (RGB888), 2 (RGB565) o 1 (índice)
+  uint8_t bits;           // Bits por índice (0 sin paleta)
+  std::vector<uint8_t> pixels;
+  std::vector<uint8_t> palette;
+};
+
+// Columnas codificadas como en un .pov: offsets[i]..offsets[i + 1]
+struct Encoded {
+  std::vector<uint8_t> data;
+  std::vector<uint32_t> offsets;
+};
+
+static volatile uint32_t sink;
+
+static double now() {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static Image makeImage(const char* name, uint8_t bytesPerPixel, uint8_t bits) {
+  Image image;
+  image.name = name;
+  image.width = WIDTH;
+  image.height = HEIGHT;
+  image.bytesPerPixel = bytesPerPixel;
+  image.bits = bits;
+  image.pixels.assign((size_t)WIDTH * HEIGHT * bytesPerPixel, 0);
+  if (bits > 0) {
+    for (int i = 0; i < (1 << bits); i++) {
+      image.palette.push_back((uint8_t)(i * 97));
+      image.palette.push_back((uint8_t)(i * 57));
+      image.palette.push_back((uint8_t)(i * 31));
+    }
+  }
+  return image;
+}
+
+static uint8_t* pixelAt(Image& image, uint16_t x, uint16_t y) {
+  return &image.pixels[((size_t)x * image.height + y) * image.bytesPerPixel];
+}
+
+static void setRGB(Image& image, uint16_t x, uint16_t y, uint8_t r, uint8_t g, uint8_t b) {
+  uint8_t* pixel = pixelAt(image, x, y);
+  if (image.bytesPerPixel == 2) {
+    uint16_t value = ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3);
+    pixel[0] = value & 0xFF;
+    pixel[1] = value >> 8;
+  } else {
+    pixel[0] = r;
+    pixel[1] = g;
+    pixel[2] = b;
+  }
+}
+
+// Texto: trazos de 1 bit con letras de 5 columnas separadas por huecos
+static Image makeText() {
+  Image image = makeImage("texto 1 bit", 1, 1);
+  srand(1);
+  for (uint16_t x = 0; x < WIDTH; x++) {
+    if (x % 7 >= 5) {
+      continue;
+    }
+    uint32_t glyph = rand();
+    for (uint16_t y = 40; y < 104; y++) {
+      *pixelAt(image, x, y) = (glyph >> ((y - 40) / 8)) & 1;
+    }
+  }
+  return image;
+}
+
+// Logo: círculos de colores planos sobre negro, paleta de 4 bits
+static Image makeLogo() {
+  Image image = makeImage("logo 4 bits", 1, 4);
+  for (uint16_t x = 0; x < WIDTH; x++) {
+    for (uint16_t y = 0; y < HEIGHT; y++) {
+      for (int c = 0; c < 3; c++) {
+        int dx = x - (48 + c * 80);
+        int dy = y - 72;
+        if (dx * dx + dy * dy < (50 - c * 8) * (50 - c * 8)) {
+          *pixelAt(image, x, y) = 1 + c * 4 + (dx * dx + dy * dy < 400 ? 1 : 0);
+        }
+      }
+    }
+  }
+  return image;
+}
+
+// Franjas verticales anchas: muchas columnas idénticas a la anterior
+static Image makeStripes() {
+  Image image = makeImage("franjas RGB", 3, 0);
+  for (uint16_t x = 0; x < WIDTH; x++) {
+    uint8_t band = x / 24;
+    for (uint16_t y = 0; y < HEIGHT; y++) {
+      setRGB(image, x, y, band * 40, 255 - band * 20, y < 72 ? 0 : 128);
+    }
+  }
+  return image;
+}
+
+// Degradado horizontal con un objeto que se mueve poco entre columnas
+static Image makeGradient(uint8_t bytesPerPixel, const char* name) {
+  Image image = makeImage(name, bytesPerPixel, 0);
+  for (uint16_t x = 0; x < WIDTH; x++) {
+    for (uint16_t y = 0; y < HEIGHT; y++) {
+      bool ball = abs((int)y - 72) < 20 && abs((int)x - 128) < 60;
+      setRGB(image, x, y, ball ? 255 : x, ball ? 255 : 0, ball ? 255 : 255 - x);
+    }
+  }
+  return image;
+}
+
+// Foto: ruido suave, el peor caso para RLE
+static Image makePhoto() {
+  Image image = makeImage("foto RGB", 3, 0);
+  srand(2);
+  for (uint16_t x = 0; x < WIDTH; x++) {
+    for (uint16_t y = 0; y < HEIGHT; y++) {
+      uint8_t base = (uint8_t)(128 + 100 * sin(x * 0.05) * cos(y * 0.07));
+      setRGB(image, x, y, base + rand() % 8, base / 2 + rand() % 8, 255 - base + rand() % 8);
+    }
+  }
+  return image;
+}
+
+static Encoded encode(const Image& image, Mode mode) {
+  Encoded encoded;
+  uint32_t columnBytes = (uint32_t)image.height * image.bytesPerPixel;
+  std::vector<uint8_t> column(1 + columnBytes);
+  for (uint16_t x = 0; x < image.width; x++) {
+    const uint8_t* pixels = &image.pixels[(size_t)x * columnBytes];
+    uint32_t length;
+    if (mode == MODE_RAW) {
+      // Sin RLE: la columna empaquetada tal cual
+      column[0] = POV_COLUMN_RAW;
+      memset(&column[1], 0, columnBytes);
+      uint32_t raw = povRawBytes(image.height, image.bytesPerPixel, image.bits);
+      if (image.bits == 0) {
+        memcpy(&column[1], pixels, columnBytes);
+      } else {
+        for (uint16_t y = 0; y < image.height; y++) {
+          uint32_t bit = (uint32_t)y * image.bits;
+          column[1 + bit / 8] |= pixels[y] << (8 - image.bits - bit % 8);
+        }
+      }
+      length = 1 + raw;
+    } else {
+      const uint8_t* previous = (mode == MODE_DELTA && !povIsKeyframe(x)) ? pixels - columnBytes : nullptr;
+      length = povEncodeColumn(pixels, previous, image.height, image.bytesPerPixel, image.bits, column.data());
+    }
+    encoded.offsets.push_back(encoded.data.size());
+    encoded.data.insert(encoded.data.end(), column.begin(), column.begin() + length);
+  }
+  encoded.offsets.push_back(encoded.data.size());
+  return encoded;
+}
+
+// Decodifica todas las columnas en orden hasta RGB888; devuelve false si algo falla
+static bool decodeAll(const Image& image, const Encoded& encoded, uint8_t* state, uint8_t* rgb) {
+  for (uint16_t x = 0; x < image.width; x++) {
+    uint32_t start = encoded.offsets[x];
+    if (!povDecodeColumn(&encoded.data[start], encoded.offsets[x + 1] - start, state, image.height,
+                         image.bytesPerPixel, image.bits)) {
+      return false;
+    }
+    uint8_t* out = rgb + (size_t)x * image.height * 3;
+    if (image.bits > 0) {
+      convertIndexed(state, out, image.height, 8, image.palette.data());
+    } else if (image.bytesPerPixel == 2) {
+      convertRGB565(state, out, image.height);
+    } else {
+      convertRGB888(state, out, image.height);
+    }
+  }
+  return true;
+}
+
+static void measure(const Image& image, uint32_t rawTotal) {
+  const char* modes[] = {"raw", "+RLE", "+delta"};
+  std::vector<uint8_t> state((size_t)image.height * 3);
+  std::vector<uint8_t> reference((size_t)image.width * image.height * 3);
+  std::vector<uint8_t> rgb(reference.size());
+
+  for (int mode = MODE_RAW; mode <= MODE_DELTA; mode++) {
+    Encoded encoded = encode(image, (Mode)mode);
+    uint16_t repeats = 0;
+    for (uint16_t x = 0; x < image.width; x++) {
+      repeats += encoded.offsets[x + 1] - encoded.offsets[x] == 1;
+    }
+
+    double start = now();
+    for (int i = 0; i < REPEAT; i++) {
+      if (!decodeAll(image, encoded, state.data(), rgb.data())) {
+        printf("Error: %s (%s) no se pudo decodificar\n", image.name, modes[mode]);
+        exit(1);
+      }
+      sink = rgb[i % rgb.size()];
+    }
+    double elapsed = now() - start;
+
+    // Los tres modos deben dar los mismos píxeles
+    if (mode == MODE_RAW) {
+      reference = rgb;
+    } else if (rgb != reference) {
+      printf("Error: %s (%s) decodifica píxeles distintos\n", image.name, modes[mode]);
+      exit(1);
+    }
+
+    printf("%-14s %-7s %8u %7.1f%% %6.1fx %5u %14.0f\n", mode == MODE_RAW ? image.name : "",
+           modes[mode], (unsigned)encoded.data.size(), 100.0 * encoded.data.size() / rawTotal,
+           (double)image.width * image.height * 3 / encoded.data.size(), repeats,
+           (double)image.width * image.height * REPEAT / elapsed);
+  }
+}
+
+// Archivo .pov: tamaño de las columnas y decodificación tal como están
+static bool measureFile(const char* path) {
+  FILE* file = fopen(path, "rb");
+  if (file == nullptr) {
+    printf("Error: No se pudo abrir %s\n", path);
+    return false;
+  }
+  std::vector<uint8_t> data;
+  int c;
+  while ((c = fgetc(file)) != EOF) {
+    data.push_back((uint8_t)c);
+  }
+  fclose(file);
+
+  // Header: "POV1", version, pixelFormat, width, height, flags, tableOffset
+  if (data.size() < 16 || memcmp(data.data(), "POV1", 4) != 0) {
+    printf("Error: %s no es un .pov\n", path);
+    return false;
+  }
+  uint8_t pixelFormat = data[5];
+  uint16_t width = data[6] | (data[7] << 8);
+  uint16_t height = data[8] | (data[9] << 8);
+  uint32_t tableOffset = data[12] | (data[13] << 8) | (data[14] << 16) | ((uint32_t)data[15] << 24);
+  uint8_t bits = pixelFormat >= 2 && pixelFormat <= 5 ? 1 << (pixelFormat - 2) : 0;
+  // Animación: los fotogramas se miden como una sola imagen más ancha
+  uint32_t framesOffset = 16 + (bits > 0 ? 3 << bits : 0);
+  if ((data[10] & 1) && framesOffset + 2 <= data.size()) {
+    width *= data[framesOffset] | (data[framesOffset + 1] << 8);
+  }
+  if (tableOffset + ((uint32_t)width + 1) * 4 > data.size()) {
+    printf("Error: %s tiene una tabla inválida\n", path);
+    return false;
+  }
+
+  Image image = makeImage(path, bits > 0 ? 1 : (pixelFormat == 1 ? 2 : 3), bits);
+  image.width = width;
+  image.height = height;
+  if (bits > 0) {
+    image.palette.assign(data.begin() + 16, data.begin() + 16 + (3 << bits));
+  }
+
+  Encoded encoded;
+  uint32_t first = 0;
+  for (uint16_t i = 0; i <= width; i++) {
+    const uint8_t* entry = &data[tableOffset + i * 4];
+    uint32_t offset = entry[0] | (entry[1] << 8) | (entry[2] << 16) | ((uint32_t)entry[3] << 24);
+    if (i == 0) {
+      first = offset;
+    }
+    encoded.offsets.push_back(offset - first);
+  }
+  encoded.data.assign(data.begin() + first, data.end());
+
+  uint16_t repeats = 0;
+  for (uint16_t x = 0; x < width; x++) {
+    repeats += encoded.offsets[x + 1] - encoded.offsets[x] == 1;
+  }
+
+  std::vector<uint8_t> state((size_t)height * 3);
+  std::vector<uint8_t> rgb((size_t)width * height * 3);
+  double start = now();
+  for (int i = 0; i < REPEAT; i++) {
+    if (!decodeAll(image, encoded, state.data(), rgb.data())) {
+      printf("Error: %s no se pudo decodificar\n", path);
+      return false;
+    }
+    sink = rgb[i % rgb.size()];
+  }
+  double elapsed = now() - start;
+
+  uint32_t rawTotal = width * (1 + povRawBytes(height, image.bytesPerPixel, bits));
+  printf("%s: %dx%d, %u bytes de columnas (%.1f%% de raw, %.1fx menos que RGB888), "
+         "%u repetidas, %.0f px/s\n", path, width, height, (unsigned)encoded.data.size(),
+         100.0 * encoded.data.size() / rawTotal, (double)width * height * 3 / encoded.data.size(),
+         repeats, (double)width * height * REPEAT / elapsed);
+  return true;
+}
+
+int main(int argc, char** argv) {
+  if (argc > 1) {
+    bool ok = true;
+    for (int i = 1; i < argc; i++) {
+      ok = measureFile(argv[i]) && ok;
+    }
+    return ok ? 0 : 1;
+  }
+
+  Image corpus[] = {makeText(), makeLogo(), makeStripes(), makeGradient(3, "degradado RGB"),
+                    makeGradient(2, "degradado 565"), makePhoto()};
+
+  printf("Corpus de %dx%d, columna clave cada %d, %d repeticiones\n\n", WIDTH, HEIGHT,
+         POV_KEYFRAME_INTERVAL, REPEAT);
+  printf("%-14s %-7s %8s %8s %7s %5s %14s\n", "Imagen", "Modo", "Bytes", "vs raw", "vs 888",
+         "Rep.", "Decod. px/s");
+
+  for (const Image& image : corpus) {
+    uint32_t rawTotal = image.width * (1 + povRawBytes(image.height, image.bytesPerPixel, image.bits));
+    measure(image, rawTotal);
+  }
+  return 0;
+}
@@ -0,0 +1,199 @@
+/**
+ * @file bench_decode.cpp
+ * @brief Benchmark de host: píxeles/segundo al decodificar BMP y RGB565
+ *
+ * Compara, para cada formato de píxel, el camino antiguo por columna (seek +
+ * read de un píxel y conversión con divisiones) con la lectura por bloques de
+ * filas y la conversión por lotes de src/pixel_convert.h que usa
+ * ImageParser::getRows().
+ *
+ * Compilar y ejecutar en el PC (no necesita Arduino ni PlatformIO):
+ *   g++ -O2 -Isrc test/bench_decode.cpp -o bench_decode && ./bench_decode
+ *
+ * El acceso a archivo usa stdio sobre un temporal, así que las cifras absolutas
+ * no son las de LittleFS; lo que importa es la relación entre ambos caminos.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "pixel_convert.h"
+
+// Dimensiones típicas: tira de 144 LEDs, imagen de 128 columnas
+static const uint16_t WIDTH = 128;
+static const uint16_t HEIGHT = 144;
+static const uint32_t BLOCK_BYTES = 4096;  // DECODE_BLOCK_BYTES
+static const int REPEAT = 20;
+
+enum Format { BGR888, RGB888, RGB565 };
+
+struct Result {
+  double columnPxS;
+  double rowPxS;
+};
+
+static volatile uint32_t sink;
+
+static double now() {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static uint8_t bytesPerPixel(Format format) {
+  return format == RGB565 ? 2 : 3;
+}
+
+static uint32_t rowStride(Format format) {
+  uint32_t bytes = (uint32_t)WIDTH * bytesPerPixel(format);
+  return format == BGR888 ? (bytes + 3) & ~3u : bytes;
+}
+
+static FILE* makeImage(Format format) {
+  FILE* file = tmpfile();
+  if (file == nullptr) {
+    perror("tmpfile");
+    exit(1);
+  }
+  std::vector<uint8_t> row(rowStride(format));
+  for (uint16_t y = 0; y < HEIGHT; y++) {
+    for (size_t i = 0; i < row.size(); i++) {
+      row[i] = (uint8_t)rand();
+    }
+    fwrite(row.data(), 1, row.size(), file);
+  }
+  fflush(file);
+  return file;
+}
+
+// Camino antiguo: una lectura por píxel, conversión píxel a píxel
+static void decodeByColumn(FILE* file, Format format, uint8_t* frame) {
+  uint8_t bpp = bytesPerPixel(format);
+  uint32_t stride = rowStride(format);
+  for (uint16_t x = 0; x < WIDTH; x++) {
+    for (uint16_t y = 0; y < HEIGHT; y++) {
+      uint16_t fileY = format == BGR888 ? HEIGHT - 1 - y : y;
+      uint8_t pixel[3];
+      fseek(file, (long)fileY * stride + x * bpp, SEEK_SET);
+      if (fread(pixel, 1, bpp, file) != bpp) {
+        exit(1);
+      }
+      uint8_t* out = frame + ((size_t)x * HEIGHT + y) * 3;
+      if (format == BGR888) {
+        out[0] = pixel[2];
+        out[1] = pixel[1];
+        out[2] = pixel[0];
+      } else if (format == RGB565) {
+        uint16_t rgb565 = pixel[0] | (pixel[1] << 8);
+        out[0] = ((rgb565 >> 11) & 0x1F) * 255 / 31;
+        out[1] = ((rgb565 >> 5) & 0x3F) * 255 / 63;
+        out[2] = (rgb565 & 0x1F) * 255 / 31;
+      } else {
+        out[0] = pixel[0];
+        out[1] = pixel[1];
+        out[2] = pixel[2];
+      }
+    }
+  }
+}
+
+// Camino nuevo: bloques de filas y conversión por lotes (row-major)
+static void decodeByRows(FILE* file, Format format, uint8_t* frame, uint8_t* block) {
+  uint32_t stride = rowStride(format);
+  uint16_t batch = BLOCK_BYTES / stride > 0 ? BLOCK_BYTES / stride : 1;
+  for (uint16_t y0 = 0; y0 < HEIGHT; y0 += batch) {
+    uint16_t count = HEIGHT - y0 < batch ? HEIGHT - y0 : batch;
+    uint16_t fileRow = format == BGR888 ? HEIGHT - y0 - count : y0;
+    fseek(file, (long)fileRow * stride, SEEK_SET);
+    if (fread(block, 1, (size_t)count * stride, file) != (size_t)count * stride) {
+      exit(1);
+    }
+    for (uint16_t i = 0; i < count; i++) {
+      uint16_t blockRow = format == BGR888 ? count - 1 - i : i;
+      const uint8_t* src = block + (size_t)blockRow * stride;
+      uint8_t* dst = frame + (size_t)(y0 + i) * WIDTH * 3;
+      if (format == BGR888) {
+        convertBGR888(src, dst, WIDTH);
+      } else if (format == RGB565) {
+        convertRGB565(src, dst, WIDTH);
+      } else {
+        convertRGB888(src, dst, WIDTH);
+      }
+    }
+  }
+}
+
+static Result measure(Format format) {
+  FILE* file = makeImage(format);
+  std::vector<uint8_t> columnFrame((size_t)WIDTH * HEIGHT * 3);
+  std::vector<uint8_t> rowFrame((size_t)WIDTH * HEIGHT * 3);
+  std::vector<uint8_t> block(BLOCK_BYTES > rowStride(format) ? BLOCK_BYTES : rowStride(format));
+  double pixels = (double)WIDTH * HEIGHT * REPEAT;
+
+  double start = now();
+  for (int i = 0; i < REPEAT; i++) {
+    decodeByColumn(file, format, columnFrame.data());
+  }
+  double columnTime = now() - start;
+
+  start = now();
+  for (int i = 0; i < REPEAT; i++) {
+    decodeByRows(file, format, rowFrame.data(), block.data());
+  }
+  double rowTime = now() - start;
+
+  // Ambos caminos deben dar los mismos píxeles (uno column-major, otro row-major)
+  for (uint16_t x = 0; x < WIDTH; x++) {
+    for (uint16_t y = 0; y < HEIGHT; y++) {
+      for (int c = 0; c < 3; c++) {
+        if (columnFrame[((size_t)x * HEIGHT + y) * 3 + c] != rowFrame[((size_t)y * WIDTH + x) * 3 + c]) {
+          printf("Error: píxel (%d, %d) distinto\n", x, y);
+          exit(1);
+        }
+      }
+    }
+  }
+  sink = rowFrame[0] + columnFrame[0];
+
+  fclose(file);
+  return Result{pixels / columnTime, pixels / rowTime};
+}
+
+// Solo conversión, sin archivo
+static double measureConvert(Format format) {
+  const uint32_t count = WIDTH * HEIGHT;
+  std::vector<uint8_t> src((size_t)count * bytesPerPixel(format));
+  std::vector<uint8_t> dst((size_t)count * 3);
+  for (size_t i = 0; i < src.size(); i++) {
+    src[i] = (uint8_t)rand();
+  }
+
+  int repeat = REPEAT * 50;
+  double start = now();
+  for (int i = 0; i < repeat; i++) {
+    if (format == BGR888) {
+      convertBGR888(src.data(), dst.data(), count);
+    } else if (format == RGB565) {
+      convertRGB565(src.data(), dst.data(), count);
+    } else {
+      convertRGB888(src.data(), dst.data(), count);
+    }
+    sink = dst[i % dst.size()];
+  }
+  return (double)count * repeat / (now() - start);
+}
+
+int main() {
+  const char* names[] = {"BMP BGR888", "RGB888", "RGB565"};
+  const Format formats[] = {BGR888, RGB888, RGB565};
+
+  printf("Imagen %dx%d, bloque de %u bytes, %d repeticiones\n\n", WIDTH, HEIGHT, BLOCK_BYTES, REPEAT);
+  printf("%-12s %14s %14s %8s %16s\n", "Formato", "Columna px/s", "Filas px/s", "Mejora", "Conversión px/s");
+
+  for (int i = 0; i < 3; i++) {
+    Result result = measure(formats[i]);
+    double convert = measureConvert(formats[i]);
+    printf("%-12s %14.0f %14.0f %7.1fx %16.0f\n", names[i], result.columnPxS, result.rowPxS,
+           result.rowPxS / result.columnPxS, convert);
+  }
+  return 0;
+}
@@ -0,0 +1,208 @@
+/**
+ * @file bench_dedup.cpp
+ * @brief Benchmark y pruebas de host de la deduplicación de /images por hash de contenido
+ *
+ * Simula una flota que sube los mismos 4 recursos (2 BMP que se convierten a
+ * .pov y 2 .pov) 3 veces cada uno con nombres distintos, en el LittleFS en
+ * memoria de test/host/, con el ImageTranscoder y el ImageManager reales:
+ *   - antes: cada subida se guarda entera y addImage() relee el archivo para
+ *     el hash del catálogo
+ *   - ahora: el hash sale de la subida (sin releer) y el contenido repetido
+ *     queda como alias, sin archivo
+ *   - cliente con hash: mira el hash en /api/images y, si ya está, pide el
+ *     nombre con linkImage() en vez de subir (POST /api/image/link)
+ * Muestra KB recibidos, KB en flash y KB leídos al actualizar el catálogo, y
+ * comprueba que los hashes son los del archivo, que cada alias se lee igual
+ * que su subida, que el contenido sobrevive al borrar o sobrescribir el
+ * archivo que lo guarda y que los alias siguen al reconstruir el catálogo.
+ *
+ * Compilar y ejecutar en el PC:
+ *   g++ -std=gnu++17 -O2 -Itest/host -Isrc test/bench_dedup.cpp src/image_manager.cpp \
+ *     src/image_parser.cpp src/image_scaler.cpp src/image_transcoder.cpp src/png_decoder.cpp \
+ *     src/inflater.cpp -o bench_dedup && ./bench_dedup
+ */
+
+#include "bench_util.h"
+#include "image_manager.h"
+#include "image_transcoder.h"
+
+static const int ASSETS = 4;
+static const int COPIES = 3;
+static const size_t CHUNK = 1460;  // Un segmento TCP por llamada, como ESPAsyncWebServer
+
+// Como WebServer::handleUpload(): por segmentos, y el catálogo con los
+// hashes de la subida
+static bool upload(const char* name, const std::vector<uint8_t>& data) {
+  if (!imageTranscoder.begin(name)) {
+    return false;
+  }
+  for (size_t i = 0; i < data.size(); i += CHUNK) {
+    imageTranscoder.write(data.data() + i, min(CHUNK, data.size() - i));
+  }
+  if (!imageTranscoder.finish()) {
+    return false;
+  }
+  return imageManager.addImage(imageTranscoder.getOutputName(), imageTranscoder.getOutputHash(),
+                               imageTranscoder.getSourceHash());
+}
+
+static void uploadName(char* name, size_t size, int asset, int copy) {
+  snprintf(name, size, "r%d_%d.%s", asset, copy, asset < 2 ? "bmp" : "pov");
+}
+
+static void imagePath(char* path, size_t size, int asset, int copy) {
+  snprintf(path, size, IMAGES_DIR "/r%d_%d.pov", asset, copy);
+}
+
+static void clearImages() {
+  for (const ImageInfo& info : imageManager.listImages()) {
+    imageManager.deleteImage(info.filename);
+  }
+}
+
+int main() {
+  Serial.quiet = true;
+  LittleFS.mkdir(IMAGES_DIR);
+  imageManager.init();
+
+  std::vector<uint8_t> assets[ASSETS];
+  for (int i = 0; i < ASSETS; i++) {
+    uint8_t seed = i * 40;
+    if (i < 2) {
+      // Franjas de 32 píxeles: se convierten a .pov comprimido
+      assets[i] = makeBMP(128, 144, [=](uint32_t n) { return (uint8_t)((n / 96) * 7 + seed); });
+    } else {
+      assets[i] = makeRawPOV(128, 144, [=](uint16_t x, uint32_t n) { return (uint8_t)(x * 5 + n * 3 + seed); });
+    }
+  }
+
+  printf("%d recursos x %d copias con nombres distintos, segmentos de %u bytes\n\n", ASSETS, COPIES,
+         (unsigned)CHUNK);
+  printf("%-28s %8s %12s %12s %14s %12s\n", "Caso", "Subidas", "KB recibidos", "KB en flash", "KB leídos cat.",
+         "ms catálogo");
+
+  bool allOk = true;
+  char name[32];
+  char path[40];
+  std::vector<uint8_t> outputs[ASSETS];
+  for (int pass = 0; pass < 3; pass++) {
+    clearImages();
+    size_t received = 0;
+    size_t stored = 0;
+    int uploads = 0;
+    uint64_t catalogRead = 0;
+    double catalogTime = 0;
+    for (int copy = 0; copy < COPIES; copy++) {
+      for (int i = 0; i < ASSETS; i++) {
+        uploadName(name, sizeof(name), i, copy);
+        uint64_t hash = contentHash(assets[i].data(), assets[i].size());
+        String linked;
+        // El cliente con hash pregunta antes de subir
+        if (pass == 2 && copy > 0 && imageManager.linkImage(name, hash, linked)) {
+          continue;
+        }
+
+        // Se mide solo el catálogo: la conversión es la misma en los dos casos
+        bool ok = imageTranscoder.begin(name);
+        for (size_t k = 0; ok && k < assets[i].size(); k += CHUNK) {
+          imageTranscoder.write(assets[i].data() + k, min(CHUNK, assets[i].size() - k));
+        }
+        ok = ok && imageTranscoder.finish();
+        LittleFS.resetCounters();
+        double start = now();
+        ok = ok && (pass == 0 ? imageManager.addImage(imageTranscoder.getOutputName())
+                              : imageManager.addImage(imageTranscoder.getOutputName(),
+                                                      imageTranscoder.getOutputHash(),
+                                                      imageTranscoder.getSourceHash()));
+        catalogTime += now() - start;
+        catalogRead += LittleFS.bytesRead;
+        allOk = allOk && ok;
+
+        received += assets[i].size();
+        uploads++;
+        imagePath(path, sizeof(path), i, copy);
+        if (copy == 0) {
+          outputs[i] = readAll(path);
+        }
+        stored += outputs[i].size();
+      }
+    }
+
+    // Antes no había alias: cada subida ocupaba su archivo
+    size_t flash = 0;
+    for (const ImageInfo& info : imageManager.listImages()) {
+      if (imageManager.getImagePath(info.filename) == info.filename) {
+        flash += info.fileSize;
+      }
+    }
+    if (pass == 0) {
+      flash = stored;
+    }
+    const char* label = pass == 0 ? "Antes (sin alias, relee)" : pass == 1 ? "Hash al subir + alias"
+                                                                            : "Cliente con hash (link)";
+    printf("%-28s %8d %12.1f %12.1f %14.1f %12.3f\n", label, uploads, received / 1024.0, flash / 1024.0,
+           catalogRead / 1024.0, catalogTime * 1e3);
+  }
+  printf("\n");
+
+  // Lo de la última pasada: 4 archivos y 8 alias
+  int files = 0;
+  bool hashesOk = true;
+  bool aliasesOk = true;
+  for (const ImageInfo& info : imageManager.listImages()) {
+    uint64_t hash;
+    std::vector<uint8_t> data = readAll(imageManager.getImagePath(info.filename).c_str());
+    hashesOk = hashesOk && imageManager.getImageHash(info.filename, hash) &&
+               hash == contentHash(data.data(), data.size());
+    if (imageManager.getImagePath(info.filename) == info.filename) {
+      files++;
+    }
+  }
+  for (int copy = 0; copy < COPIES; copy++) {
+    for (int i = 0; i < ASSETS; i++) {
+      imagePath(path, sizeof(path), i, copy);
+      aliasesOk = aliasesOk && readAll(imageManager.getImagePath(path).c_str()) == outputs[i];
+    }
+  }
+  check("Un archivo por contenido", files == ASSETS, allOk);
+  check("Hash del catálogo = hash del archivo", hashesOk, allOk);
+  check("Cada nombre se lee como su subida", aliasesOk, allOk);
+
+  uint64_t sourceHash;
+  bool sourceOk = imageManager.getSourceHash(IMAGES_DIR "/r0_0.pov", sourceHash) &&
+                  sourceHash == contentHash(assets[0].data(), assets[0].size());
+  check("Hash de la subida (BMP) en el catálogo", sourceOk, allOk);
+
+  String linked;
+  check("Link con hash desconocido: falla", !imageManager.linkImage("x.bmp", 1, linked), allOk);
+
+  // Borrar el archivo que guarda el contenido: pasa al primer alias
+  imagePath(path, sizeof(path), 0, 0);
+  String owner = imageManager.getImagePath(path);
+  imageManager.deleteImage(owner.c_str());
+  imagePath(path, sizeof(path), 0, 2);
+  check("Borrado el archivo: los alias siguen", !LittleFS.exists(owner) &&
+        readAll(imageManager.getImagePath(path).c_str()) == outputs[0], allOk);
+
+  // Sobrescribir el archivo con otro contenido: sus alias se quedan el anterior
+  imagePath(path, sizeof(path), 2, 0);
+  owner = imageManager.getImagePath(path);
+  upload(owner.substring(strlen(IMAGES_DIR) + 1).c_str(), assets[3]);
+  imagePath(path, sizeof(path), 2, 1);
+  bool kept = readAll(imageManager.getImagePath(path).c_str()) == outputs[2];
+  imagePath(path, sizeof(path), 3, 0);
+  kept = kept && imageManager.getImagePath(owner.c_str()) == imageManager.getImagePath(path);
+  check("Sobrescrito: los alias siguen con lo suyo", kept, allOk);
+
+  // Catálogo desde el archivo y contrastado con el directorio: los alias siguen
+  ImageManager reloaded;
+  reloaded.init();
+  bool same = reloaded.listImages().size() == imageManager.listImages().size();
+  for (const ImageInfo& info : imageManager.listImages()) {
+    same = same && reloaded.getImagePath(info.filename) == imageManager.getImagePath(info.filename);
+  }
+  check("Alias tras reconstruir la lista", same, allOk);
+
+  printf("\n%s\n", allOk ? "Todo correcto" : "ERRORES");
+  return allOk ? 0 : 1;
+}
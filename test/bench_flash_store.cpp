@@ -0,0 +1,234 @@
+/**
+ * @file bench_flash_store.cpp
+ * @brief Benchmark y pruebas de host del almacén flash (FlashStore)
+ *
+ * La partición es un archivo mapeado con mmap (el sustituto de host de
+ * flash_store.cpp), con la misma semántica de borrado y escritura que la flash
+ * NOR. Con el ImageManager y el ImageParser reales:
+ *   - compara columnas/segundo leyendo de LittleFS (getFrameColumn) y del
+ *     almacén mapeado (getMappedColumn), y cuántas columnas salen sin copia
+ *   - comprueba que las columnas mapeadas son idénticas a las de LittleFS
+ *   - reabre el almacén (como en un arranque), borra, compacta, reemplaza una
+ *     imagen por fuera de la API y corrompe la tabla, comprobando cada vez que
+ *     lo que queda cuadra con /images
+ *
+ * Compilar y ejecutar en el PC:
+ *   g++ -std=gnu++17 -O2 -Itest/host -Isrc -DFLASH_STORE_HOST_FILE='"/tmp/pov_flash_store.bin"' \
+ *     test/bench_flash_store.cpp src/flash_store.cpp src/image_manager.cpp src/image_parser.cpp \
+ *     src/image_scaler.cpp -o bench_flash_store && ./bench_flash_store
+ *
+ * Sin la latencia de flash de LittleFS (aquí está en memoria) la ventaja del
+ * mapeo es solo la de no copiar ni buscar bloques; en el ESP32 es mayor.
+ */
+
+#include <unistd.h>
+#include "bench_util.h"
+#include "flash_store.h"
+#include "image_manager.h"
+
+// El mismo archivo que flash_store.cpp (se compilan con el mismo -D)
+#ifndef FLASH_STORE_HOST_FILE
+#define FLASH_STORE_HOST_FILE "flash_store.bin"
+#endif
+
+static const double MIN_SECONDS = 0.2;
+static volatile uint32_t sink;
+
+enum Content {
+  CONTENT_PHOTO,    // Ruido: casi todas las columnas RAW
+  CONTENT_GRAPHIC,  // Franjas: RLE, DELTA y REPEAT
+  CONTENT_INDEXED   // 4 bits con paleta
+};
+
+// .pov con la codificación más corta por columna, como ImageTranscoder
+static std::vector<uint8_t> makePOV(uint16_t width, uint16_t height, Content content, uint8_t seed) {
+  uint8_t pixelFormat = content == CONTENT_INDEXED ? POV_PIXEL_INDEXED4 : POV_PIXEL_RGB888;
+  uint8_t bytesPerPixel = content == CONTENT_INDEXED ? 1 : 3;
+  std::vector<uint8_t> palette(content == CONTENT_INDEXED ? 16 * 3 : 0);
+  for (uint32_t i = 0; i < palette.size(); i++) {
+    palette[i] = (uint8_t)(i * 41 + seed);
+  }
+  uint32_t noise = 0x12345678u + seed;
+  return makeEncodedPOV(width, height, pixelFormat, palette, [&](uint16_t x, uint8_t* pixels) {
+    for (uint32_t i = 0; i < (uint32_t)height * bytesPerPixel; i++) {
+      uint16_t y = i / bytesPerPixel;
+      noise = noise * 1664525u + 1013904223u;
+      if (content == CONTENT_PHOTO) {
+        pixels[i] = noise >> 24;
+      } else if (content == CONTENT_GRAPHIC) {
+        pixels[i] = (x / 8 % 3 == 0) ? (uint8_t)(y / 16 * 40 + seed) : (uint8_t)(i % 3 * 90);
+      } else {
+        pixels[i] = (x / 6 + y / 10 + seed) % 16;
+      }
+    }
+  });
+}
+
+static void addImage(const char* path, uint16_t width, uint16_t height, Content content, uint8_t seed) {
+  std::vector<uint8_t> data = makePOV(width, height, content, seed);
+  LittleFS.addFile(path, data.data(), data.size());
+}
+
+struct Rate {
+  double fileRate;
+  double mappedRate;
+  uint32_t zeroCopy;  // Columnas devueltas como puntero a la flash
+  uint64_t fileBytes; // Leídos de LittleFS en una pasada
+};
+
+static Rate measure(const char* path) {
+  Rate rate = {0, 0, 0, 0};
+  ImageInfo info;
+  if (!imageManager.getImageInfo(path, info)) {
+    return rate;
+  }
+  CRGB column[MAX_IMAGE_HEIGHT];
+
+  ImageParser parser;
+  File file = LittleFS.open(path, "r");
+  LittleFS.resetCounters();
+  uint32_t columns = 0;
+  double start = now();
+  double elapsed;
+  do {
+    for (uint16_t x = 0; x < info.width; x++) {
+      parser.getFrameColumn(file, info, 0, x, column, MAX_IMAGE_HEIGHT);
+      sink += column[x % info.height].r;
+    }
+    if (columns == 0) {
+      rate.fileBytes = LittleFS.bytesRead;
+    }
+    columns += info.width;
+    elapsed = now() - start;
+  } while (elapsed < MIN_SECONDS);
+  rate.fileRate = columns / elapsed;
+  file.close();
+
+  const uint8_t* image = flashStore.acquire(path, info.fileSize);
+  if (image == nullptr) {
+    return rate;
+  }
+  columns = 0;
+  start = now();
+  do {
+    for (uint16_t x = 0; x < info.width; x++) {
+      const CRGB* line = parser.getMappedColumn(image, info, 0, x, column, MAX_IMAGE_HEIGHT);
+      sink += line[x % info.height].r;
+      if (columns == 0 && line != column) {
+        rate.zeroCopy++;
+      }
+    }
+    columns += info.width;
+    elapsed = now() - start;
+  } while (elapsed < MIN_SECONDS);
+  rate.mappedRate = columns / elapsed;
+  flashStore.release();
+  return rate;
+}
+
+// Todo lo que hay en el almacén se lee igual que desde LittleFS
+static bool storeMatchesFiles() {
+  bool ok = true;
+  ImageParser fileParser;
+  ImageParser mappedParser;
+  CRGB column[MAX_IMAGE_HEIGHT];
+  CRGB buffer[MAX_IMAGE_HEIGHT];
+  for (const ImageInfo& info : imageManager.listImages()) {
+    const uint8_t* image = flashStore.acquire(info.filename, info.fileSize);
+    if (image == nullptr) {
+      continue;
+    }
+    File file = LittleFS.open(info.filename, "r");
+    for (uint16_t x = 0; ok && x < info.width; x++) {
+      const CRGB* line = mappedParser.getMappedColumn(image, info, 0, x, buffer, MAX_IMAGE_HEIGHT);
+      ok = fileParser.getFrameColumn(file, info, 0, x, column, MAX_IMAGE_HEIGHT) && line != nullptr &&
+           memcmp(line, column, info.height * sizeof(CRGB)) == 0;
+    }
+    file.close();
+    flashStore.release();
+  }
+  return ok;
+}
+
+int main() {
+  Serial.quiet = true;
+  unlink(FLASH_STORE_HOST_FILE);
+
+  static const struct {
+    const char* path;
+    Content content;
+  } images[] = {
+    {"/images/foto.pov", CONTENT_PHOTO},
+    {"/images/grafico.pov", CONTENT_GRAPHIC},
+    {"/images/indexado.pov", CONTENT_INDEXED},
+  };
+  LittleFS.mkdir(IMAGES_DIR);
+  for (size_t i = 0; i < 3; i++) {
+    addImage(images[i].path, 128, 144, images[i].content, i);
+  }
+  // Relleno para que falte sitio y haya que compactar
+  char path[32];
+  for (int i = 0; i < 10; i++) {
+    snprintf(path, sizeof(path), IMAGES_DIR "/relleno%d.pov", i);
+    addImage(path, 128, 144, CONTENT_PHOTO, 10 + i);
+  }
+
+  imageManager.init();
+  bool ok = true;
+  check("Almacén disponible (archivo mapeado)", flashStore.init(), ok);
+  printf("%u imágenes copiadas, %u KB libres de %u KB\n\n", (unsigned)flashStore.getImageCount(),
+         (unsigned)(flashStore.getFreeSpace() / 1024), (unsigned)(flashStore.getTotalSpace() / 1024));
+
+  printf("%-14s %16s %16s %12s %14s\n", "Imagen", "LittleFS c/s", "Mapeado c/s", "Sin copia", "Leído LittleFS");
+  for (size_t i = 0; i < 3; i++) {
+    Rate rate = measure(images[i].path);
+    printf("%-14s %16.0f %16.0f %8u/128 %11.1f KB\n", images[i].path + strlen(IMAGES_DIR) + 1, rate.fileRate,
+           rate.mappedRate, rate.zeroCopy, rate.fileBytes / 1024.0);
+  }
+  printf("\n");
+
+  check("Columnas mapeadas iguales a las de LittleFS", storeMatchesFiles(), ok);
+
+  // Arranque: la tabla se relee y no hay nada que copiar
+  size_t stored = flashStore.getImageCount();
+  FlashStore reopened;
+  check("Reabierto con las mismas imágenes", reopened.init() && reopened.getImageCount() == stored, ok);
+
+  // Borrar deja huecos; una imagen que no cabe al final obliga a compactar
+  flashStore.removeImage("foto.pov");
+  flashStore.removeImage("relleno0.pov");
+  flashStore.removeImage("relleno3.pov");
+  addImage("/images/nueva.pov", 256, 300, CONTENT_PHOTO, 99);
+  imageManager.addImage("/images/nueva.pov");
+  bool imported = flashStore.importImage("nueva.pov");
+  check("Importada tras compactar", imported && flashStore.hasImage("nueva.pov"), ok);
+  check("Sin daños tras compactar", storeMatchesFiles(), ok);
+
+  // Fijada (POVEngine la está leyendo): no se compacta
+  ImageInfo info;
+  imageManager.getImageInfo("grafico.pov", info);
+  const uint8_t* pinned = flashStore.acquire("grafico.pov", info.fileSize);
+  check("Sin compactar con una imagen fijada", pinned != nullptr && !flashStore.compact(), ok);
+  flashStore.release();
+
+  // Imagen cambiada por fuera de la API: el arranque la descarta y la vuelve a copiar
+  addImage("/images/grafico.pov", 120, 144, CONTENT_GRAPHIC, 77);
+  imageManager.refreshList();
+  FlashStore changed;
+  changed.init();
+  check("Imagen cambiada vuelta a copiar", changed.hasImage("grafico.pov"), ok);
+  flashStore.init();
+  check("Sin daños tras el cambio", storeMatchesFiles(), ok);
+
+  // Tabla corrupta: almacén vacío y vuelta a llenar desde /images
+  FILE* f = fopen(FLASH_STORE_HOST_FILE, "r+b");
+  fseek(f, sizeof(FlashStoreHeader) + 3, SEEK_SET);
+  fputc('#', f);
+  fclose(f);
+  flashStore.init();
+  check("Tabla corrupta reconstruida", flashStore.getImageCount() > 0, ok);
+  check("Sin daños tras reconstruir", storeMatchesFiles(), ok);
+
+  printf("\n%s\n", ok ? "Todo correcto" : "ERRORES");
+  return ok ? 0 : 1;
+}
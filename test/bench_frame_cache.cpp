@@ -0,0 +1,205 @@
+/**
+ * @file bench_frame_cache.cpp
+ * @brief Benchmark y pruebas de host de la caché de imágenes decodificadas (FrameCache)
+ *
+ * Crea un espectáculo de 6 imágenes (BMP y .pov de 128 columnas y 144 LEDs) en
+ * el LittleFS en memoria de test/host/ y, con el ImageManager y el ImageParser
+ * reales:
+ *   - mide el cambio de imagen sin caché (parsear y decodificar la imagen
+ *     completa con la FrameDecode real, como POVEngine::decodeFrame()) y con
+ *     la caché (FrameCache::acquire()), recorriendo la lista en orden
+ *   - comprueba que lo que devuelve la caché es idéntico a decodificar
+ *   - reduce el presupuesto y comprueba el orden LRU, que la imagen fijada
+ *     (la que se reproduce) no se descarta nunca, y que una imagen borrada o
+ *     subida de nuevo deja de servirse
+ *
+ * Compilar y ejecutar en el PC:
+ *   g++ -std=gnu++17 -O2 -Itest/host -Isrc test/bench_frame_cache.cpp src/frame_decoder.cpp \
+ *     src/frame_cache.cpp src/image_manager.cpp src/image_parser.cpp src/image_scaler.cpp \
+ *     -o bench_frame_cache && ./bench_frame_cache
+ *
+ * Aquí LittleFS está en memoria, así que el cambio sin caché solo cuesta el
+ * parseo y la decodificación; en el ESP32 se suman las lecturas de flash.
+ */
+
+#include "bench_util.h"
+#include "frame_cache.h"
+#include "frame_decoder.h"
+#include "image_manager.h"
+
+static const int IMAGE_COUNT = 6;
+static const int SWITCHES = 600;
+static const uint16_t WIDTH = 128;
+static const uint16_t HEIGHT = 144;
+static const uint16_t NUM_LEDS = 144;
+
+static void makeImage(int i, char* path, size_t pathSize, uint8_t seed) {
+  std::vector<uint8_t> data;
+  if (i % 2 == 0) {
+    snprintf(path, pathSize, IMAGES_DIR "/show%d.bmp", i);
+    data = makeBMP(WIDTH, HEIGHT, [=](uint32_t n) { return (uint8_t)(n * 7 + seed); });
+  } else {
+    snprintf(path, pathSize, IMAGES_DIR "/show%d.pov", i);
+    data = makeRawPOV(WIDTH, HEIGHT, [=](uint16_t x, uint32_t n) { return (uint8_t)(x * 5 + n * 3 + seed); });
+  }
+  LittleFS.addFile(path, data.data(), data.size());
+}
+
+// Lo mismo que POVEngine::decodeFrame() en vertical y sin remuestreo, con la
+// FrameDecode real: parsear y decodificar la imagen entera en column-major
+static bool decodeImage(const char* path, CachedFrame& frame) {
+  static LineResampler resampler;
+  ImageInfo info;
+  if (!imageParser.parseImageInfo(path, info)) {
+    return false;
+  }
+  FrameDecode job;
+  job.parser = &imageParser;
+  job.resampler = &resampler;
+  if (!job.begin(path, info, POV_VERTICAL, POV_RESAMPLE_NEAREST, NUM_LEDS)) {
+    return false;
+  }
+  if (!job.step(job.total) || !job.finish()) {
+    job.abort();
+    return false;
+  }
+  frame = job.frame;
+  frame.delays.clear();
+  return true;
+}
+
+static bool acquire(const char* path, CachedFrame& frame) {
+  return frameCache.acquire(path, POV_VERTICAL, POV_RESAMPLE_NEAREST, NUM_LEDS, frame);
+}
+
+static bool insert(const char* path, const CachedFrame& frame) {
+  return frameCache.insert(path, POV_VERTICAL, POV_RESAMPLE_NEAREST, NUM_LEDS, frame);
+}
+
+// Cambio de imagen como POVEngine::loadImage(): se suelta la anterior y se
+// toma la siguiente de la caché o se decodifica y se ofrece a la caché
+static bool switchTo(const char* path, CachedFrame& current, bool& cached, bool useCache) {
+  if (current.pixels != nullptr) {
+    if (cached) {
+      frameCache.release(current.pixels);
+    } else {
+      free(current.pixels);
+    }
+    current.pixels = nullptr;
+  }
+  if (useCache && acquire(path, current)) {
+    cached = true;
+    return true;
+  }
+  if (!decodeImage(path, current)) {
+    return false;
+  }
+  cached = useCache && insert(path, current);
+  return true;
+}
+
+static bool sameFrame(const CachedFrame& a, const CachedFrame& b) {
+  return a.bytes == b.bytes && memcmp(a.pixels, b.pixels, a.bytes) == 0;
+}
+
+int main() {
+  Serial.quiet = true;
+  char paths[IMAGE_COUNT][32];
+  LittleFS.mkdir(IMAGES_DIR);
+  for (int i = 0; i < IMAGE_COUNT; i++) {
+    makeImage(i, paths[i], sizeof(paths[i]), i * 11);
+  }
+  imageManager.init();
+  size_t imageBytes = (size_t)WIDTH * HEIGHT * sizeof(CRGB);
+
+  printf("%d imágenes de %ux%u (%.1f KB decodificada), %d cambios\n\n", IMAGE_COUNT, WIDTH, HEIGHT,
+         imageBytes / 1024.0, SWITCHES);
+  printf("%-28s %12s %8s %8s %12s\n", "Caso", "us/cambio", "Aciertos", "Fallos", "KB leídos");
+
+  CachedFrame current;
+  current.pixels = nullptr;
+  bool cached = false;
+  bool allOk = true;
+  for (int pass = 0; pass < 2; pass++) {
+    bool useCache = (pass == 1);
+    frameCache.setBudget(useCache ? 2 * 1024 * 1024 : 0);
+    uint32_t hits = frameCache.getHits();
+    uint32_t misses = frameCache.getMisses();
+    LittleFS.resetCounters();
+    double start = now();
+    for (int i = 0; i < SWITCHES; i++) {
+      allOk = switchTo(paths[i % IMAGE_COUNT], current, cached, useCache) && allOk;
+    }
+    double elapsed = now() - start;
+    printf("%-28s %12.2f %8u %8u %12.1f\n", useCache ? "Con caché (2 MB)" : "Sin caché",
+           elapsed * 1e6 / SWITCHES, frameCache.getHits() - hits, frameCache.getMisses() - misses,
+           LittleFS.bytesRead / 1024.0);
+  }
+  printf("\n");
+
+  // Lo que sirve la caché es lo mismo que decodificar
+  bool identical = true;
+  for (int i = 0; i < IMAGE_COUNT; i++) {
+    CachedFrame fresh;
+    CachedFrame hit;
+    bool ok = decodeImage(paths[i], fresh) && acquire(paths[i], hit);
+    identical = identical && ok && sameFrame(fresh, hit) && hit.info.width == fresh.info.width;
+    if (ok) {
+      frameCache.release(hit.pixels);
+      free(fresh.pixels);
+    }
+  }
+  check("Caché idéntica a decodificar", identical, allOk);
+
+  // Presupuesto para 3 imágenes: la que se reproduce (fijada) nunca se descarta
+  frameCache.setBudget(3 * imageBytes);
+  for (int i = 0; i < IMAGE_COUNT; i++) {
+    switchTo(paths[i], current, cached, true);
+  }
+  check("Dentro del presupuesto", frameCache.getUsedBytes() <= frameCache.getBudget() &&
+        frameCache.getImageCount() == 3, allOk);
+  CachedFrame probe;
+  bool lru = acquire(paths[IMAGE_COUNT - 2], probe);
+  if (lru) {
+    frameCache.release(probe.pixels);
+  }
+  lru = lru && !acquire(paths[0], probe);
+  check("Descarta la menos usada", lru, allOk);
+
+  const CRGB* playing = current.pixels;
+  frameCache.setBudget(0);
+  check("Presupuesto 0: la fijada se queda", cached && frameCache.getImageCount() == 1 &&
+        current.pixels == playing, allOk);
+  frameCache.release(current.pixels);
+  current.pixels = nullptr;
+  check("Presupuesto 0: liberada al soltarla", frameCache.getImageCount() == 0, allOk);
+
+  // Imagen subida de nuevo mientras se reproduce: deja de servirse y se libera al soltarla
+  frameCache.setBudget(2 * 1024 * 1024);
+  switchTo(paths[1], current, cached, true);
+  makeImage(1, paths[1], sizeof(paths[1]), 99);
+  imageManager.addImage(paths[1]);
+  frameCache.invalidate(paths[1]);
+  bool replaced = !acquire(paths[1], probe) && frameCache.getImageCount() == 1;
+  switchTo(paths[1], current, cached, true);
+  CachedFrame fresh;
+  replaced = replaced && decodeImage(paths[1], fresh) && sameFrame(current, fresh) &&
+             frameCache.getImageCount() == 1;
+  free(fresh.pixels);
+  check("Imagen reemplazada: vuelve a decodificarse", replaced, allOk);
+
+  // Reemplazo sin invalidate(): el hash del catálogo ya no coincide
+  switchTo(paths[3], current, cached, true);
+  makeImage(1, paths[1], sizeof(paths[1]), 42);
+  imageManager.addImage(paths[1]);
+  check("Hash distinto en el catálogo: fallo", !acquire(paths[1], probe), allOk);
+
+  imageManager.deleteImage(paths[3]);
+  frameCache.invalidate(paths[3]);
+  frameCache.release(current.pixels);
+  check("Imagen borrada: fuera de la caché", !acquire(paths[3], probe) && frameCache.getImageCount() == 0,
+        allOk);
+
+  printf("\n%s\n", allOk ? "Todo correcto" : "ERRORES");
+  return allOk ? 0 : 1;
+}
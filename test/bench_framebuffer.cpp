@@ -0,0 +1,155 @@
+/**
+ * @file bench_framebuffer.cpp
+ * @brief Benchmark de host: latencia por columna con y sin la imagen decodificada en RAM
+ *
+ * Con una imagen BMP y una .pov de 128 columnas y 144 LEDs en el LittleFS en
+ * memoria de test/host/ y el ImageParser real, mide lo que cuesta tener lista
+ * cada columna para la tira por tres caminos:
+ *   - reabriendo el archivo en cada columna, como displayColumn() antes del
+ *     buffer (ImageParser::getColumn() con el nombre: parseo + open + lectura)
+ *   - con el archivo abierto toda la imagen, el respaldo de POVEngine cuando
+ *     la imagen no cabe en memoria (getFrameColumn())
+ *   - desde la imagen decodificada una vez en RAM con la FrameDecode real
+ *     (src/frame_decoder.cpp, la de POVEngine::decodeFrame()): una copia
+ * Muestra la columna media y la más lenta, aperturas y KB leídos por columna y
+ * el coste de decodificar la imagen entera, y comprueba que los tres caminos
+ * dan los mismos píxeles y que desde RAM no se toca el sistema de archivos.
+ *
+ * Compilar y ejecutar en el PC:
+ *   g++ -std=gnu++17 -O2 -Itest/host -Isrc test/bench_framebuffer.cpp src/frame_decoder.cpp \
+ *     src/frame_cache.cpp src/image_manager.cpp src/image_parser.cpp src/image_scaler.cpp \
+ *     -o bench_framebuffer && ./bench_framebuffer
+ *
+ * Aquí LittleFS está en memoria, así que abrir y leer cuesta mucho menos que
+ * en la flash del ESP32: las diferencias reales son mayores.
+ */
+
+#include "bench_util.h"
+#include "frame_decoder.h"
+
+static const uint16_t WIDTH = 128;
+static const uint16_t HEIGHT = 144;
+static const int ROUNDS = 50;
+
+enum Path { REOPEN, OPEN_FILE, FRAME_BUFFER };
+
+struct Result {
+  double average = 0;  // s por columna
+  double slowest = 0;  // Columna más lenta, la mejor de las rondas
+  double opens = 0;    // Por columna
+  double bytesRead = 0;
+};
+
+static bool sameStrip(const std::vector<CRGB>& a, const std::vector<CRGB>& b) {
+  return a.size() == b.size() && memcmp(a.data(), b.data(), a.size() * sizeof(CRGB)) == 0;
+}
+
+static const char* pathName(Path path) {
+  return path == REOPEN ? "Reabrir por columna" : path == OPEN_FILE ? "Archivo abierto" : "Buffer en RAM";
+}
+
+// Todas las columnas de la imagen, ROUNDS veces, por el camino indicado.
+// strip recibe la última pasada entera (column-major) para compararla
+static Result measure(Path path, const char* name, const CachedFrame& frame, std::vector<CRGB>& strip) {
+  ImageParser parser;
+  ImageInfo info;
+  parser.parseImageInfo(name, info);
+  File file = LittleFS.open(name, "r");
+  strip.assign((size_t)WIDTH * HEIGHT, CRGB(0, 0, 0));
+
+  Result r;
+  r.slowest = 1e9;
+  double total = 0;
+  LittleFS.resetCounters();
+  for (int round = 0; round < ROUNDS; round++) {
+    double roundSlowest = 0;
+    for (uint16_t x = 0; x < WIDTH; x++) {
+      CRGB* leds = strip.data() + (size_t)x * HEIGHT;
+      double start = now();
+      if (path == REOPEN) {
+        parser.getColumn(name, x, leds, HEIGHT);
+      } else if (path == OPEN_FILE) {
+        parser.getFrameColumn(file, info, 0, x, leds, HEIGHT);
+      } else {
+        memcpy(leds, frame.pixels + (size_t)x * frame.lineLength, HEIGHT * sizeof(CRGB));
+      }
+      double elapsed = now() - start;
+      total += elapsed;
+      roundSlowest = max(roundSlowest, elapsed);
+    }
+    r.slowest = min(r.slowest, roundSlowest);
+  }
+  uint32_t columns = (uint32_t)ROUNDS * WIDTH;
+  r.average = total / columns;
+  r.opens = (double)LittleFS.opens / columns;
+  r.bytesRead = (double)LittleFS.bytesRead / columns;
+  file.close();
+  return r;
+}
+
+int main() {
+  Serial.quiet = true;
+  LittleFS.mkdir(IMAGES_DIR);
+  const char* names[2] = {IMAGES_DIR "/columns.bmp", IMAGES_DIR "/columns.pov"};
+  std::vector<uint8_t> bmp = makeBMP(WIDTH, HEIGHT, [](uint32_t n) { return (uint8_t)(n * 11 + 5); });
+  std::vector<uint8_t> pov = makeRawPOV(WIDTH, HEIGHT, [](uint16_t x, uint32_t n) {
+    return (uint8_t)(x * 3 + n * 7 + 1);
+  });
+  LittleFS.addFile(names[0], bmp.data(), bmp.size());
+  LittleFS.addFile(names[1], pov.data(), pov.size());
+
+  printf("Imágenes de %ux%u, %d pasadas por imagen\n\n", WIDTH, HEIGHT, ROUNDS);
+  printf("%-6s %-22s %12s %12s %10s %12s\n", "Imagen", "Camino", "Media (us)", "Máx (us)", "Aperturas",
+         "KB leídos");
+
+  LineResampler resampler;
+  bool allOk = true;
+  for (int i = 0; i < 2; i++) {
+    const char* label = i == 0 ? "BMP" : ".pov";
+
+    // Decodificación única, como POVEngine::decodeFrame() en vertical y sin
+    // remuestreo: es el coste que se paga al cargar la imagen
+    double decodeTime = 1e9;
+    FrameDecode job;
+    for (int round = 0; round < ROUNDS; round++) {
+      job.abort();
+      job = FrameDecode();
+      job.parser = &imageParser;
+      job.resampler = &resampler;
+      ImageInfo info;
+      double start = now();
+      bool ok = imageParser.parseImageInfo(names[i], info) &&
+                job.begin(names[i], info, POV_VERTICAL, POV_RESAMPLE_NEAREST, HEIGHT) &&
+                job.step(job.total) && job.finish();
+      decodeTime = min(decodeTime, now() - start);
+      allOk = ok && allOk;
+    }
+
+    Result results[3];
+    std::vector<CRGB> strips[3];
+    for (int p = REOPEN; p <= FRAME_BUFFER; p++) {
+      results[p] = measure((Path)p, names[i], job.frame, strips[p]);
+      printf("%-6s %-22s %12.3f %12.3f %10.2f %12.3f\n", label, pathName((Path)p), results[p].average * 1e6,
+             results[p].slowest * 1e6, results[p].opens, results[p].bytesRead / 1024);
+    }
+    double saved = results[REOPEN].average - results[FRAME_BUFFER].average;
+    printf("%-6s %-22s %12.1f us, se amortiza en %.0f columnas\n\n", label, "Decodificar una vez",
+           decodeTime * 1e6, saved > 0 ? decodeTime / saved : 0.0);
+    job.abort();
+
+    char name[64];
+    snprintf(name, sizeof(name), "%s: los tres caminos dan las mismas columnas", label);
+    check(name, sameStrip(strips[REOPEN], strips[OPEN_FILE]) && sameStrip(strips[OPEN_FILE], strips[FRAME_BUFFER]),
+          allOk);
+    snprintf(name, sizeof(name), "%s: desde RAM sin aperturas ni lecturas", label);
+    check(name, results[FRAME_BUFFER].opens == 0 && results[FRAME_BUFFER].bytesRead == 0, allOk);
+    snprintf(name, sizeof(name), "%s: desde RAM más rápido que reabrir", label);
+    check(name, results[FRAME_BUFFER].average < results[REOPEN].average, allOk);
+    snprintf(name, sizeof(name), "%s: desde RAM más rápido que el archivo abierto", label);
+    check(name, results[FRAME_BUFFER].average < results[OPEN_FILE].average, allOk);
+    printf("\n");
+  }
+
+  printf("%s\n", allOk ? "Todo correcto" : "ERRORES");
+  return allOk ? 0 : 1;
+}
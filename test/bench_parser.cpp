@@ -0,0 +1,215 @@
+/**
+ * @file bench_parser.cpp
+ * @brief Benchmark de host: columnas/segundo de ImageParser por formato y tamaño
+ *
+ * Compila el ImageParser real contra el shim de test/host/ (LittleFS en
+ * memoria) y mide, para BMP de 1, 4, 8 y 24 bits, RGB565 y .pov (RGB888,
+ * RGB565 e indexado, con RLE/REPEAT/DELTA), las columnas por segundo de:
+ *   - getColumn(): una columna cada vez, el camino del modo archivo
+ *   - getRows():   filas por bloques (BMP/RGB565), el camino de la
+ *                  decodificación completa en RAM, expresado en columnas
+ * Sirve de referencia antes y después de optimizar el parser; el fuzzer
+ * (test/fuzz_parser.cpp) comprueba que sigue siendo seguro.
+ *
+ * Compilar y ejecutar en el PC:
+ *   g++ -std=gnu++17 -O2 -Itest/host -Isrc test/bench_parser.cpp \
+ *     src/image_parser.cpp -o bench_parser && ./bench_parser
+ *
+ * Sin la latencia de flash de LittleFS las cifras absolutas son mucho más
+ * altas que en el ESP32; lo que importa es la comparación entre formatos y
+ * entre una versión del parser y otra.
+ */
+
+#include <cmath>
+#include "bench_util.h"
+
+static const double MIN_SECONDS = 0.2;
+
+struct Size {
+  uint16_t width;
+  uint16_t height;
+};
+
+static const Size SIZES[] = {{32, 16}, {128, 144}, {128, 300}};
+
+static volatile uint32_t sink;
+
+// Color de prueba: degradado con franjas, ni todo plano ni todo ruido
+static void sampleColor(uint16_t x, uint16_t y, uint8_t* rgb) {
+  uint8_t band = (x / 12) % 4;
+  rgb[0] = band == 0 ? 255 : (uint8_t)(x * 2);
+  rgb[1] = (uint8_t)(y * 255 / 300);
+  rgb[2] = (y / 8 + x / 16) % 2 ? 200 : (uint8_t)(128 + 100 * sin(x * 0.1));
+}
+
+static uint8_t sampleIndex(uint16_t x, uint16_t y, uint8_t bits) {
+  return ((x / 6 + y / 10) % 7 * 37) & ((1 << bits) - 1);
+}
+
+static uint16_t toRGB565(const uint8_t* rgb) {
+  return ((rgb[0] >> 3) << 11) | ((rgb[1] >> 2) << 5) | (rgb[2] >> 3);
+}
+
+static std::vector<uint8_t> makeBMP(Size size, uint8_t bpp) {
+  if (bpp == 24) {
+    return makeBMPFromColors(size.width, size.height, [](uint16_t x, uint16_t y) {
+      uint8_t rgb[3];
+      sampleColor(x, y, rgb);
+      return CRGB(rgb[0], rgb[1], rgb[2]);
+    });
+  }
+
+  std::vector<uint8_t> out;
+  uint32_t rowStride = putBMPHeader(out, size.width, size.height, bpp);
+  for (uint32_t i = 0; i < (1u << bpp); i++) {
+    put32(out, (i * 97 & 0xFF) << 16 | (i * 57 & 0xFF) << 8 | (i * 31 & 0xFF));
+  }
+
+  // De abajo arriba, como casi todos los BMP
+  for (int32_t y = size.height - 1; y >= 0; y--) {
+    std::vector<uint8_t> row(rowStride, 0);
+    for (uint16_t x = 0; x < size.width; x++) {
+      uint32_t bit = (uint32_t)x * bpp;
+      row[bit / 8] |= sampleIndex(x, y, bpp) << (8 - bpp - bit % 8);
+    }
+    out.insert(out.end(), row.begin(), row.end());
+  }
+  return out;
+}
+
+static std::vector<uint8_t> makeRGB565(Size size) {
+  return makeRGB565(size.width, size.height, [](uint16_t x, uint16_t y) {
+    uint8_t rgb[3];
+    sampleColor(x, y, rgb);
+    return toRGB565(rgb);
+  });
+}
+
+// .pov con la codificación más corta por columna, como ImageTranscoder
+static std::vector<uint8_t> makePOV(Size size, uint8_t pixelFormat) {
+  uint8_t bits = povIndexBits(pixelFormat);
+  std::vector<uint8_t> palette(bits > 0 ? (1u << bits) * 3 : 0);
+  for (uint32_t i = 0; i < palette.size(); i++) {
+    palette[i] = (uint8_t)(i * 41);
+  }
+  return makeEncodedPOV(size.width, size.height, pixelFormat, palette, [&](uint16_t x, uint8_t* pixels) {
+    for (uint16_t y = 0; y < size.height; y++) {
+      uint8_t rgb[3];
+      sampleColor(x, y, rgb);
+      if (bits > 0) {
+        pixels[y] = sampleIndex(x, y, bits);
+      } else if (pixelFormat == POV_PIXEL_RGB565) {
+        uint16_t value = toRGB565(rgb);
+        memcpy(&pixels[y * 2], &value, 2);
+      } else {
+        memcpy(&pixels[y * 3], rgb, 3);
+      }
+    }
+  });
+}
+
+struct Result {
+  double columnRate;
+  double rowRate;  // 0 si el formato no es row-major
+};
+
+static Result measure(const char* path, const std::vector<uint8_t>& data) {
+  LittleFS.addFile(path, data.data(), data.size());
+
+  Result result = {0, 0};
+  ImageParser parser;
+  ImageInfo info;
+  if (!parser.parseImageInfo(path, info)) {
+    fprintf(stderr, "No se pudo parsear %s\n", path);
+    return result;
+  }
+  File file = LittleFS.open(path, "r");
+
+  std::vector<CRGB> column(info.height);
+  uint32_t columns = 0;
+  double start = now();
+  double elapsed;
+  do {
+    for (uint16_t x = 0; x < info.width; x++) {
+      if (!parser.getColumn(file, info, x, column.data(), info.height)) {
+        fprintf(stderr, "Error en la columna %d de %s\n", x, path);
+        return result;
+      }
+      sink += column[x % info.height].r;
+    }
+    columns += info.width;
+    elapsed = now() - start;
+  } while (elapsed < MIN_SECONDS);
+  result.columnRate = columns / elapsed;
+
+  if (parser.isRowMajor(info)) {
+    uint16_t batch = parser.getRowBatch(info);
+    std::vector<CRGB> rows((size_t)batch * info.width);
+    uint32_t images = 0;
+    start = now();
+    do {
+      for (uint16_t y = 0; y < info.height; y += batch) {
+        uint16_t count = min(batch, (uint16_t)(info.height - y));
+        if (!parser.getRows(file, info, y, count, rows.data())) {
+          fprintf(stderr, "Error en la fila %d de %s\n", y, path);
+          return result;
+        }
+        sink += rows[0].g;
+      }
+      images++;
+      elapsed = now() - start;
+    } while (elapsed < MIN_SECONDS);
+    result.rowRate = (double)images * info.width / elapsed;
+  }
+
+  file.close();
+  LittleFS.removeFile(path);
+  return result;
+}
+
+int main() {
+  Serial.quiet = true;
+
+  struct Format {
+    const char* name;
+    const char* path;
+  };
+  static const Format formats[] = {
+    {"BMP 24 bits", "/images/bench.bmp"},
+    {"BMP 8 bits", "/images/bench.bmp"},
+    {"BMP 4 bits", "/images/bench.bmp"},
+    {"BMP 1 bit", "/images/bench.bmp"},
+    {"RGB565", "/images/bench.rgb"},
+    {".pov RGB888", "/images/bench.pov"},
+    {".pov RGB565", "/images/bench.pov"},
+    {".pov 4 bits", "/images/bench.pov"},
+  };
+
+  printf("%-14s %9s %9s %14s %14s\n", "Formato", "Imagen", "Bytes", "getColumn c/s", "getRows c/s");
+  for (const Size& size : SIZES) {
+    for (size_t f = 0; f < sizeof(formats) / sizeof(formats[0]); f++) {
+      std::vector<uint8_t> data;
+      switch (f) {
+        case 0: data = makeBMP(size, 24); break;
+        case 1: data = makeBMP(size, 8); break;
+        case 2: data = makeBMP(size, 4); break;
+        case 3: data = makeBMP(size, 1); break;
+        case 4: data = makeRGB565(size); break;
+        case 5: data = makePOV(size, POV_PIXEL_RGB888); break;
+        case 6: data = makePOV(size, POV_PIXEL_RGB565); break;
+        default: data = makePOV(size, POV_PIXEL_INDEXED4); break;
+      }
+
+      Result result = measure(formats[f].path, data);
+      char dimensions[16];
+      snprintf(dimensions, sizeof(dimensions), "%dx%d", size.width, size.height);
+      printf("%-14s %9s %9zu %14.0f ", formats[f].name, dimensions, data.size(), result.columnRate);
+      if (result.rowRate > 0) {
+        printf("%14.0f\n", result.rowRate);
+      } else {
+        printf("%14s\n", "-");
+      }
+    }
+  }
+  return 0;
+}
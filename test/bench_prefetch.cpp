@@ -0,0 +1,178 @@
+/**
+ * @file bench_prefetch.cpp
+ * @brief Benchmark y pruebas de host de la precarga de la siguiente imagen (lista de reproducción)
+ *
+ * Con imágenes BMP y .pov de 128 columnas y 144 LEDs en el LittleFS en
+ * memoria de test/host/, el ImageParser real y la FrameDecode real
+ * (src/frame_decoder.cpp, la que usan decodeFrame() y la precarga del motor):
+ *   - mide lo que cuesta cambiar de imagen con la carga normal (parsear y
+ *     decodificar la imagen completa de una vez, como POVEngine::decodeFrame():
+ *     ese tiempo es el hueco en negro entre dos imágenes)
+ *   - mide la precarga por pasos, como POVEngine::stepPrefetch(): cada paso
+ *     decodifica PREFETCH_STEP_COLUMNS columnas .pov o un bloque de filas BMP,
+ *     intercalado con la lectura de columnas de la imagen en pantalla con otro
+ *     parser (el de POVEngine). Lo que importa es el paso más largo: es lo que
+ *     se retrasa el loop, no un hueco en los LEDs
+ *   - comprueba que la imagen decodificada por pasos, en vertical y en
+ *     horizontal, es la que da leer cada columna con getFrameColumn(), y que
+ *     el remuestreo suave deja líneas del largo de la tira
+ *
+ * Compilar y ejecutar en el PC:
+ *   g++ -std=gnu++17 -O2 -Itest/host -Isrc test/bench_prefetch.cpp src/frame_decoder.cpp \
+ *     src/frame_cache.cpp src/image_manager.cpp src/image_parser.cpp src/image_scaler.cpp \
+ *     -o bench_prefetch && ./bench_prefetch
+ *
+ * Las medidas son en vertical y sin remuestreo. Aquí LittleFS está en
+ * memoria; en el ESP32 cada paso suma sus lecturas de flash, pero sigue
+ * siendo una fracción de la carga. El cambio de imagen en sí
+ * (POVEngine::swapToNext()) necesita el motor y no se prueba aquí.
+ */
+
+#include "bench_util.h"
+#include "frame_decoder.h"
+
+static const uint16_t WIDTH = 128;
+static const uint16_t HEIGHT = 144;
+static const int REPEATS = 50;
+
+// Parsear y preparar la decodificación, como POVEngine::prefetchImage()
+static bool begin(FrameDecode& job, ImageParser& parser, LineResampler& resampler, const char* path,
+                  POVOrientation orientation, POVResampleMode resampleMode, uint16_t numLeds) {
+  ImageInfo info;
+  job.parser = &parser;
+  job.resampler = &resampler;
+  return parser.parseImageInfo(path, info) && job.begin(path, info, orientation, resampleMode, numLeds);
+}
+
+// Referencia que no pasa por FrameDecode: cada columna leída del archivo con
+// getFrameColumn(), en column-major (vertical) o row-major (horizontal)
+static std::vector<CRGB> readColumns(const char* path, POVOrientation orientation) {
+  ImageParser parser;
+  ImageInfo info;
+  parser.parseImageInfo(path, info);
+  File file = LittleFS.open(path, "r");
+  std::vector<CRGB> pixels((size_t)info.width * info.height);
+  std::vector<CRGB> column(info.height);
+  for (uint16_t x = 0; x < info.width; x++) {
+    parser.getFrameColumn(file, info, 0, x, column.data(), info.height);
+    for (uint16_t y = 0; y < info.height; y++) {
+      pixels[orientation == POV_VERTICAL ? (size_t)x * info.height + y : (size_t)y * info.width + x] = column[y];
+    }
+  }
+  file.close();
+  return pixels;
+}
+
+static bool sameFrame(const FrameDecode& job, const std::vector<CRGB>& pixels) {
+  return job.frame.pixels != nullptr && job.frame.bytes == pixels.size() * sizeof(CRGB) &&
+         memcmp(job.frame.pixels, pixels.data(), job.frame.bytes) == 0;
+}
+
+int main() {
+  Serial.quiet = true;
+  LittleFS.mkdir(IMAGES_DIR);
+  const char* paths[2] = {IMAGES_DIR "/next.bmp", IMAGES_DIR "/next.pov"};
+  std::vector<uint8_t> bmp = makeBMP(WIDTH, HEIGHT, [](uint32_t n) { return (uint8_t)(n * 7 + 3); });
+  std::vector<uint8_t> pov = makeRawPOV(WIDTH, HEIGHT, [](uint16_t x, uint32_t n) {
+    return (uint8_t)(x * 5 + n * 3 + 9);
+  });
+  LittleFS.addFile(paths[0], bmp.data(), bmp.size());
+  LittleFS.addFile(paths[1], pov.data(), pov.size());
+
+  printf("Imágenes de %ux%u, %d repeticiones, pasos de %d columnas .pov\n\n", WIDTH, HEIGHT, REPEATS,
+         PREFETCH_STEP_COLUMNS);
+  printf("%-10s %16s %8s %14s %14s\n", "Imagen", "Carga (us)", "Pasos", "Paso máx (us)", "Paso medio (us)");
+
+  // La imagen en pantalla: su parser lee una columna entre paso y paso
+  ImageParser& playing = imageParser;
+  ImageParser prefetch;
+  LineResampler resampler;
+  bool allOk = true;
+  for (int i = 0; i < 2; i++) {
+    const char* shown = paths[1 - i];
+    ImageInfo shownInfo;
+    playing.parseImageInfo(shown, shownInfo);
+    File shownFile = LittleFS.open(shown, "r");
+    std::vector<CRGB> column(HEIGHT);
+
+    // Carga normal: todo de una vez, como POVEngine::decodeFrame()
+    double start = now();
+    for (int r = 0; r < REPEATS; r++) {
+      FrameDecode whole;
+      allOk = begin(whole, prefetch, resampler, paths[i], POV_VERTICAL, POV_RESAMPLE_NEAREST, HEIGHT) &&
+              whole.step(whole.total) && whole.finish() && allOk;
+      whole.abort();
+    }
+    double blocking = (now() - start) / REPEATS;
+
+    // Precarga por pasos intercalada con la imagen en pantalla, como
+    // POVEngine::stepPrefetch(). El paso más largo es el mejor de las
+    // repeticiones (sin el ruido del sistema)
+    double longest = 1e9;
+    double total = 0;
+    int steps = 0;
+    bool identical = true;
+    for (int r = 0; r < REPEATS; r++) {
+      FrameDecode job;
+      uint16_t x = 0;
+      double repeatLongest = 0;
+      start = now();
+      allOk = begin(job, prefetch, resampler, paths[i], POV_VERTICAL, POV_RESAMPLE_NEAREST, HEIGHT) && allOk;
+      double step = now() - start;
+      while (true) {
+        repeatLongest = max(repeatLongest, step);
+        total += step;
+        steps++;
+        if (job.isDone()) {
+          break;
+        }
+        playing.getFrameColumn(shownFile, shownInfo, 0, x, column.data(), HEIGHT);
+        x = (x + 1) % shownInfo.width;
+        start = now();
+        allOk = job.step(job.rowDecode ? 1 : PREFETCH_STEP_COLUMNS) && allOk;
+        step = now() - start;
+      }
+      allOk = job.finish() && allOk;
+      if (r == 0) {
+        identical = sameFrame(job, readColumns(paths[i], POV_VERTICAL));
+      }
+      job.abort();
+      longest = min(longest, repeatLongest);
+    }
+    shownFile.close();
+
+    printf("%-10s %16.1f %8d %14.1f %14.1f\n", i == 0 ? "BMP" : ".pov", blocking * 1e6, steps / REPEATS,
+           longest * 1e6, total * 1e6 / steps);
+    char name[64];
+    snprintf(name, sizeof(name), "%s: por pasos igual a leer cada columna", i == 0 ? "BMP" : ".pov");
+    check(name, identical, allOk);
+    snprintf(name, sizeof(name), "%s: paso más largo < carga completa", i == 0 ? "BMP" : ".pov");
+    check(name, longest < blocking, allOk);
+  }
+
+  // Las otras disposiciones de FrameDecode: horizontal (row-major) y
+  // remuestreo suave a otra tira, por pasos de una unidad
+  for (int i = 0; i < 2; i++) {
+    FrameDecode job;
+    bool ok = begin(job, prefetch, resampler, paths[i], POV_HORIZONTAL, POV_RESAMPLE_NEAREST, HEIGHT);
+    while (ok && !job.isDone()) {
+      ok = job.step(1);
+    }
+    ok = ok && job.finish() && sameFrame(job, readColumns(paths[i], POV_HORIZONTAL));
+    job.abort();
+    check(i == 0 ? "BMP: horizontal igual a leer cada columna" : ".pov: horizontal igual a leer cada columna",
+          ok, allOk);
+
+    ok = begin(job, prefetch, resampler, paths[i], POV_VERTICAL, POV_RESAMPLE_SMOOTH, 100);
+    while (ok && !job.isDone()) {
+      ok = job.step(1);
+    }
+    ok = ok && job.finish() && job.frame.resampled && job.frame.lineLength == 100 &&
+         job.frame.bytes == (size_t)WIDTH * 100 * sizeof(CRGB);
+    job.abort();
+    check(i == 0 ? "BMP: remuestreada a 100 LEDs" : ".pov: remuestreada a 100 LEDs", ok, allOk);
+  }
+
+  printf("\n%s\n", allOk ? "Todo correcto" : "ERRORES");
+  return allOk ? 0 : 1;
+}
@@ -0,0 +1,236 @@
+/**
+ * @file bench_scheduler.cpp
+ * @brief Pruebas de host del planificador de columnas con un reloj simulado
+ *
+ * Ejercita el ColumnScheduler real (src/column_scheduler.cpp) con instantes
+ * sintéticos, sin esperar al reloj: poll() y advance() llamados justo en cada
+ * deadline, con retrasos aleatorios y tras un parón de varios segundos, con
+ * frecuencias que dividen 1e6 y que no (120, 3000, 7000 Hz...). Compara cada
+ * deadline con la serie ideal start + n * 1e6 / rate calculada aparte y
+ * comprueba que advance() nunca devuelve 0 con el deadline vencido (con
+ * 3000 Hz y la llamada justo en el deadline devolvía 0 y "saltadas" daba la
+ * vuelta a 0xFFFFFFFF).
+ *
+ * Compilar y ejecutar en el PC (no necesita Arduino ni PlatformIO):
+ *   g++ -std=gnu++17 -O2 -Itest/host -Isrc test/bench_scheduler.cpp \
+ *     src/column_scheduler.cpp -o bench_scheduler && ./bench_scheduler
+ */
+
+#include <cstdio>
+#include <random>
+#include "bench_util.h"
+#include "column_scheduler.h"
+
+static const uint32_t RATES[] = {1, 120, 1000, 3000, 7000, 9973, 40000};
+static const uint64_t START_US = 5000000007ULL;  // Lejos de 0 y sin alinear
+static const uint32_t SECONDS = 4;
+
+// Deadline ideal de la columna n, sin anclas intermedias
+static uint64_t ideal(uint32_t rate, uint64_t n) {
+  return START_US + n * 1000000ULL / rate;
+}
+
+// Columnas cuyo deadline ideal ya ha llegado en nowUs (contadas una a una)
+static uint64_t dueBy(uint32_t rate, uint64_t nowUs, uint64_t from) {
+  uint64_t n = from;
+  while (ideal(rate, n) <= nowUs) {
+    n++;
+  }
+  return n;
+}
+
+struct Result {
+  uint64_t calls = 0;
+  uint64_t columns = 0;
+  uint64_t advancing = 0;     // Llamadas que avanzan alguna columna
+  uint64_t skipped = 0;
+  uint64_t zeroSteps = 0;     // advance() == 0 con el deadline vencido
+  uint64_t wrongDeadline = 0; // Deadline distinto del ideal
+  uint64_t wrongCount = 0;    // Columnas avanzadas distintas de las vencidas
+};
+
+// advance() en cada deadline exacto: siempre una columna y ninguna saltada
+static Result advanceOnTime(uint32_t rate) {
+  Result r;
+  ColumnScheduler scheduler;
+  scheduler.setRate(rate, START_US);
+  scheduler.start(START_US);
+
+  uint64_t total = (uint64_t)rate * SECONDS;
+  for (uint64_t n = 0; n < total; n++) {
+    uint64_t nowUs = scheduler.getNextDeadline();
+    if (nowUs != ideal(rate, n)) {
+      r.wrongDeadline++;
+    }
+    uint32_t steps = scheduler.advance(nowUs);
+    r.calls++;
+    r.columns += steps;
+    if (steps == 0) {
+      r.zeroSteps++;
+    }
+    if (steps != 1) {
+      r.wrongCount++;
+    }
+  }
+  r.skipped = scheduler.getSkipped();
+  if (scheduler.getNextDeadline() != ideal(rate, total)) {
+    r.wrongDeadline++;
+  }
+  return r;
+}
+
+// advance() con retrasos aleatorios de hasta 3 periodos y algún parón largo:
+// lo avanzado debe ser justo lo vencido según la serie ideal
+static Result advanceJitter(uint32_t rate, uint32_t seed) {
+  Result r;
+  std::mt19937 rng(seed);
+  ColumnScheduler scheduler;
+  scheduler.setRate(rate, START_US);
+  scheduler.start(START_US);
+
+  uint64_t period = 1000000ULL / rate;
+  uint64_t nowUs = START_US;
+  uint64_t emitted = 0;  // Columnas que el llamador ya ha mostrado
+  uint64_t end = START_US + SECONDS * 1000000ULL;
+  while (nowUs < end) {
+    uint32_t roll = rng() % 100;
+    if (roll == 0) {
+      nowUs += 1000000ULL + rng() % 1000000ULL;    // Parón (LittleFS, WiFi)
+    } else if (roll < 20) {
+      nowUs = scheduler.getNextDeadline();         // Justo en el deadline
+    } else {
+      nowUs += rng() % (3 * period + 2);
+    }
+
+    uint64_t due = dueBy(rate, nowUs, emitted);
+    uint32_t steps = scheduler.advance(nowUs);
+    r.calls++;
+    r.columns += steps;
+    r.advancing += steps > 0 ? 1 : 0;
+    if (due > emitted && steps == 0) {
+      r.zeroSteps++;
+    }
+    if (emitted + steps != due) {
+      r.wrongCount++;
+    }
+    emitted += steps;
+    if (scheduler.getNextDeadline() != ideal(rate, emitted)) {
+      r.wrongDeadline++;
+    }
+  }
+  r.skipped = scheduler.getSkipped();
+  return r;
+}
+
+// poll() en cada deadline exacto: una columna por llamada y sin deriva
+static Result pollOnTime(uint32_t rate) {
+  Result r;
+  ColumnScheduler scheduler;
+  scheduler.setRate(rate, START_US);
+  scheduler.start(START_US);
+
+  uint64_t total = (uint64_t)rate * SECONDS;
+  for (uint64_t n = 0; n < total; n++) {
+    uint64_t nowUs = scheduler.getNextDeadline();
+    if (nowUs != ideal(rate, n)) {
+      r.wrongDeadline++;
+    }
+    // Un microsegundo antes no vence
+    if (nowUs > START_US && scheduler.poll(nowUs - 1)) {
+      r.wrongCount++;
+    }
+    bool due = scheduler.poll(nowUs);
+    r.calls++;
+    r.columns += due ? 1 : 0;
+    if (!due) {
+      r.wrongCount++;
+    }
+  }
+  if (scheduler.getNextDeadline() != ideal(rate, total) || scheduler.getOverruns() != 0) {
+    r.wrongDeadline++;
+  }
+  return r;
+}
+
+static void printRow(const char* mode, uint32_t rate, const Result& r) {
+  printf("%-16s %7u %10llu %10llu %10llu %6llu %8llu %8llu\n", mode, rate,
+         (unsigned long long)r.calls, (unsigned long long)r.columns,
+         (unsigned long long)r.skipped, (unsigned long long)r.zeroSteps,
+         (unsigned long long)r.wrongCount, (unsigned long long)r.wrongDeadline);
+}
+
+int main() {
+  bool allOk = true;
+  bool onTimeOk = true;
+  bool jitterOk = true;
+  bool pollOk = true;
+  bool skippedOk = true;
+
+  printf("%-16s %7s %10s %10s %10s %6s %8s %8s\n", "modo", "Hz", "llamadas", "columnas",
+         "saltadas", "cero", "cuenta", "deadline");
+  for (uint32_t rate : RATES) {
+    Result onTime = advanceOnTime(rate);
+    printRow("advance a tiempo", rate, onTime);
+    onTimeOk = onTimeOk && onTime.zeroSteps == 0 && onTime.wrongCount == 0 &&
+               onTime.wrongDeadline == 0 && onTime.skipped == 0;
+
+    Result jitter = advanceJitter(rate, rate * 31 + 7);
+    printRow("advance jitter", rate, jitter);
+    jitterOk = jitterOk && jitter.zeroSteps == 0 && jitter.wrongCount == 0 &&
+               jitter.wrongDeadline == 0;
+    // Cada llamada que avanza muestra una columna y salta el resto
+    skippedOk = skippedOk && jitter.skipped == jitter.columns - jitter.advancing;
+
+    Result polled = pollOnTime(rate);
+    printRow("poll a tiempo", rate, polled);
+    pollOk = pollOk && polled.wrongCount == 0 && polled.wrongDeadline == 0;
+  }
+  printf("\n");
+
+  // El caso que falló: 3000 Hz (1e6 / 3000 = 333.3 us) y la llamada justo en
+  // el deadline redondeado hacia abajo de la columna 1
+  ColumnScheduler scheduler;
+  scheduler.setRate(3000, 0);
+  scheduler.start(0);
+  uint32_t first = scheduler.advance(0);
+  uint64_t deadline = scheduler.getNextDeadline();
+  uint32_t second = scheduler.advance(deadline);
+  bool exactOk = first == 1 && deadline == 333 && second == 1 &&
+                 scheduler.getSkipped() == 0 && scheduler.getNextDeadline() == 666;
+
+  // Parón de 5 s tras el deadline a 3000 Hz: esa columna y las 15000 de los
+  // 5 s de golpe, 15000 saltadas
+  scheduler.resetStats();
+  uint64_t base = scheduler.getNextDeadline();
+  uint32_t stall = scheduler.advance(base + 5000000ULL);
+  bool stallOk = stall == 15001 && scheduler.getSkipped() == 15000 &&
+                 scheduler.getNextDeadline() > base + 5000000ULL;
+
+  // poll() con más de un periodo de retraso re-ancla en lugar de ir en ráfaga
+  ColumnScheduler late;
+  late.setRate(1000, 0);
+  late.start(0);
+  late.poll(0);
+  bool overrunOk = late.poll(10000) && late.getOverruns() == 1 &&
+                   late.getNextDeadline() == 11000 && !late.poll(10999);
+
+  // Antes de start() y tras stop() no vence nada
+  ColumnScheduler idle;
+  idle.setRate(1000, 0);
+  bool idleOk = !idle.poll(1000000) && idle.advance(1000000) == 0;
+  idle.start(0);
+  idle.stop();
+  idleOk = idleOk && !idle.poll(1000000) && idle.advance(1000000) == 0;
+
+  printf("Comprobaciones:\n");
+  check("advance() en el deadline exacto: 1 columna, sin saltadas", onTimeOk, allOk);
+  check("advance() con jitter: avanza justo las columnas vencidas", jitterOk, allOk);
+  check("saltadas = columnas - llamadas que avanzan (sin vuelta)", skippedOk, allOk);
+  check("poll() en el deadline exacto: sin deriva en 4 s", pollOk, allOk);
+  check("3000 Hz con la llamada justo en el deadline: 1 columna", exactOk, allOk);
+  check("parón de 5 s a 3000 Hz: 15001 columnas, 15000 saltadas", stallOk, allOk);
+  check("poll() con retraso de más de un periodo re-ancla", overrunOk, allOk);
+  check("parado no vence nada", idleOk, allOk);
+  printf("\n%s\n", allOk ? "Todo correcto" : "ERRORES");
+  return allOk ? 0 : 1;
+}
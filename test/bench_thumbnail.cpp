@@ -0,0 +1,198 @@
+/**
+ * @file bench_thumbnail.cpp
+ * @brief Benchmark y pruebas de host de las miniaturas de /images
+ *
+ * Sube una biblioteca de imágenes (BMP de 128x144 que se convierten a .pov)
+ * en el LittleFS en memoria de test/host/, con el ImageTranscoder y el
+ * ImageManager reales, y crea la miniatura de cada una como tras la subida:
+ *   - galería sin miniaturas: el navegador descarga cada imagen entera
+ *   - galería con miniaturas: un BMP de THUMB_MAX_SIZE px de lado mayor
+ *   - revisita: el ETag (hash del contenido) no cambia y cada petición es un
+ *     304 sin cuerpo
+ * Muestra KB descargados, KB leídos de flash y ms para crear las miniaturas,
+ * y comprueba que la miniatura es un BMP que ImageParser lee, con la
+ * proporción y los colores de la imagen por columnas (.pov) y por filas
+ * (BMP), que los alias usan la del archivo con su contenido y que la
+ * miniatura sigue al archivo al borrar, sobrescribir y reconstruir la lista.
+ *
+ * Compilar y ejecutar en el PC:
+ *   g++ -std=gnu++17 -O2 -Itest/host -Isrc test/bench_thumbnail.cpp src/image_manager.cpp \
+ *     src/image_parser.cpp src/image_scaler.cpp src/image_transcoder.cpp src/png_decoder.cpp \
+ *     src/inflater.cpp -o bench_thumbnail && ./bench_thumbnail
+ */
+
+#include "bench_util.h"
+#include "image_manager.h"
+#include "image_transcoder.h"
+
+static const int IMAGES = 24;
+static const uint16_t WIDTH = 128;
+static const uint16_t HEIGHT = 144;
+static const size_t CHUNK = 1460;  // Un segmento TCP por llamada, como ESPAsyncWebServer
+
+// Cuadrantes: rojo a la izquierda, verde arriba; seed varía el azul
+static CRGB quadrant(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint8_t seed) {
+  return CRGB(x < width / 2 ? 240 : 0, y < height / 2 ? 240 : 0, seed);
+}
+
+// Con ruido de hasta NOISE en cada canal, para que las columnas no se
+// compriman más que las de una foto
+static const uint8_t NOISE = 15;
+
+static uint8_t noise(uint16_t x, uint16_t y, uint8_t channel) {
+  uint32_t h = (x * 73856093u) ^ (y * 19349663u) ^ (channel * 83492791u);
+  return (h ^ (h >> 13)) % (NOISE + 1);
+}
+
+static std::vector<uint8_t> makeQuadrantBMP(uint16_t width, uint16_t height, uint8_t seed) {
+  return makeBMPFromColors(width, height, [=](uint16_t x, uint16_t y) {
+    CRGB color = quadrant(x, y, width, height, seed);
+    return CRGB(color.r + noise(x, y, 0), color.g + noise(x, y, 1), color.b + noise(x, y, 2));
+  });
+}
+
+// Como WebServer::handleUpload(): por segmentos, catálogo y miniatura
+static bool upload(const char* name, const std::vector<uint8_t>& data) {
+  if (!imageTranscoder.begin(name)) {
+    return false;
+  }
+  for (size_t i = 0; i < data.size(); i += CHUNK) {
+    imageTranscoder.write(data.data() + i, min(CHUNK, data.size() - i));
+  }
+  String thumbPath;
+  return imageTranscoder.finish() &&
+         imageManager.addImage(imageTranscoder.getOutputName(), imageTranscoder.getOutputHash(),
+                               imageTranscoder.getSourceHash()) &&
+         imageManager.getThumbnail(imageTranscoder.getOutputName(), thumbPath);
+}
+
+// La miniatura leída con ImageParser como un BMP más; colores de los cuadrantes
+static bool checkThumbnail(const String& thumbPath, uint16_t width, uint16_t height, uint8_t seed) {
+  std::vector<uint8_t> data = readAll(thumbPath);
+  LittleFS.addFile("/check.bmp", data.data(), data.size());
+  ImageInfo info;
+  ImageParser parser;
+  uint16_t longest = max(width, height);
+  uint16_t thumbWidth = ((uint32_t)width * THUMB_MAX_SIZE + longest / 2) / longest;
+  uint16_t thumbHeight = ((uint32_t)height * THUMB_MAX_SIZE + longest / 2) / longest;
+  if (!parser.parseImageInfo("/check.bmp", info) || info.width != thumbWidth || info.height != thumbHeight) {
+    return false;
+  }
+
+  std::vector<CRGB> pixels((size_t)info.width * info.height);
+  File file = LittleFS.open("/check.bmp", "r");
+  bool ok = parser.getRows(file, info, 0, info.height, pixels.data());
+  file.close();
+  LittleFS.remove("/check.bmp");
+
+  // Centro de cada cuadrante (los bordes mezclan colores), con el ruido
+  // promediado
+  for (int qy = 0; ok && qy < 2; qy++) {
+    for (int qx = 0; ok && qx < 2; qx++) {
+      uint16_t x = info.width / 4 + qx * info.width / 2;
+      uint16_t y = info.height / 4 + qy * info.height / 2;
+      CRGB expected = quadrant(qx * width / 2, qy * height / 2, width, height, seed);
+      const CRGB& pixel = pixels[(size_t)y * info.width + x];
+      ok = pixel.r >= expected.r && pixel.r <= expected.r + NOISE && pixel.g >= expected.g &&
+           pixel.g <= expected.g + NOISE && pixel.b >= expected.b && pixel.b <= expected.b + NOISE;
+    }
+  }
+  return ok;
+}
+
+int main() {
+  Serial.quiet = true;
+  LittleFS.mkdir(IMAGES_DIR);
+  imageManager.init();
+
+  bool allOk = true;
+  char name[32];
+  size_t imageBytes = 0;
+  for (int i = 0; i < IMAGES; i++) {
+    snprintf(name, sizeof(name), "img%02d.bmp", i);
+    std::vector<uint8_t> bmp = makeQuadrantBMP(WIDTH, HEIGHT, i * 10);
+    bool ok = imageTranscoder.begin(name);
+    for (size_t k = 0; ok && k < bmp.size(); k += CHUNK) {
+      imageTranscoder.write(bmp.data() + k, min(CHUNK, bmp.size() - k));
+    }
+    ok = ok && imageTranscoder.finish() &&
+         imageManager.addImage(imageTranscoder.getOutputName(), imageTranscoder.getOutputHash(),
+                               imageTranscoder.getSourceHash());
+    allOk = allOk && ok;
+  }
+
+  // Las miniaturas, como tras cada subida
+  LittleFS.resetCounters();
+  double start = now();
+  size_t thumbBytes = 0;
+  for (const ImageInfo& info : imageManager.listImages()) {
+    String thumbPath;
+    allOk = imageManager.getThumbnail(info.filename, thumbPath) && allOk;
+    imageBytes += info.fileSize;
+    thumbBytes += readAll(thumbPath).size();
+  }
+  double thumbTime = now() - start;
+  uint64_t thumbRead = LittleFS.bytesRead - thumbBytes;
+
+  printf("%d imágenes de %ux%u (.pov), miniaturas de %d px de lado mayor\n\n", IMAGES, WIDTH, HEIGHT,
+         THUMB_MAX_SIZE);
+  printf("%-30s %14s %14s %14s\n", "Galería", "KB descargados", "KB leídos", "ms (total)");
+  printf("%-30s %14.1f %14s %14s\n", "Imagen completa", imageBytes / 1024.0, "-", "-");
+  printf("%-30s %14.1f %14.1f %14.3f\n", "Miniaturas (crear y servir)", thumbBytes / 1024.0,
+         thumbRead / 1024.0, thumbTime * 1e3);
+  printf("%-30s %14.1f %14s %14s\n", "Revisita (304, mismo ETag)", 0.0, "-", "-");
+  printf("\n");
+
+  // Por columnas (.pov) y por filas (BMP sin convertir)
+  check(".pov: BMP legible, proporción y colores",
+        checkThumbnail(IMAGES_DIR "/img00.pov" THUMB_EXTENSION, WIDTH, HEIGHT, 0), allOk);
+  std::vector<uint8_t> wide = makeQuadrantBMP(300, 40, 77);
+  LittleFS.addFile(IMAGES_DIR "/wide.bmp", wide.data(), wide.size());
+  String thumbPath;
+  check("BMP por filas: proporción y colores",
+        imageManager.addImage("wide.bmp") && imageManager.getThumbnail("wide.bmp", thumbPath) &&
+        checkThumbnail(thumbPath, 300, 40, 77), allOk);
+  check("Miniatura mucho menor que la imagen", thumbBytes * 4 < imageBytes, allOk);
+
+  // Un alias usa la miniatura del archivo con su contenido
+  std::vector<uint8_t> bmp = makeQuadrantBMP(WIDTH, HEIGHT, 30);
+  upload("copia.bmp", bmp);
+  check("Alias: la miniatura de su contenido",
+        imageManager.getThumbnail("copia.pov", thumbPath) &&
+        thumbPath == IMAGES_DIR "/img03.pov" THUMB_EXTENSION &&
+        !LittleFS.exists(IMAGES_DIR "/copia.pov" THUMB_EXTENSION), allOk);
+
+  // Borrar el archivo: la miniatura pasa al alias con el contenido
+  imageManager.deleteImage("img03.pov");
+  check("Borrado: la miniatura sigue al archivo",
+        !LittleFS.exists(IMAGES_DIR "/img03.pov" THUMB_EXTENSION) &&
+        LittleFS.exists(IMAGES_DIR "/copia.pov" THUMB_EXTENSION) &&
+        checkThumbnail(IMAGES_DIR "/copia.pov" THUMB_EXTENSION, WIDTH, HEIGHT, 30), allOk);
+
+  // Sobrescribir con otro contenido: miniatura nueva
+  bmp = makeQuadrantBMP(WIDTH, HEIGHT, 235);
+  upload("img05.bmp", bmp);
+  check("Sobrescrita: miniatura nueva",
+        checkThumbnail(IMAGES_DIR "/img05.pov" THUMB_EXTENSION, WIDTH, HEIGHT, 235), allOk);
+
+  // Falta (imagen de antes de las miniaturas): se crea al pedirla
+  LittleFS.remove(IMAGES_DIR "/img07.pov" THUMB_EXTENSION);
+  check("Sin miniatura: se crea al pedirla",
+        imageManager.getThumbnail("img07.pov", thumbPath) &&
+        checkThumbnail(thumbPath, WIDTH, HEIGHT, 70), allOk);
+
+  // Al reconstruir la lista: fuera las de archivos que ya no están y las de
+  // archivos cambiados por fuera de la API
+  std::vector<uint8_t> ghost = readAll(IMAGES_DIR "/img01.pov" THUMB_EXTENSION);
+  LittleFS.addFile(IMAGES_DIR "/ghost.pov" THUMB_EXTENSION, ghost.data(), ghost.size());
+  LittleFS.addFile(IMAGES_DIR "/img09.pov", wide.data(), 100);
+  ImageManager reloaded;
+  reloaded.init();
+  check("Reconstruida: sin miniaturas sueltas ni viejas",
+        !LittleFS.exists(IMAGES_DIR "/ghost.pov" THUMB_EXTENSION) &&
+        !LittleFS.exists(IMAGES_DIR "/img09.pov" THUMB_EXTENSION) &&
+        LittleFS.exists(IMAGES_DIR "/img01.pov" THUMB_EXTENSION), allOk);
+
+  printf("\n%s\n", allOk ? "Todo correcto" : "ERRORES");
+  return allOk ? 0 : 1;
+}
@@ -0,0 +1,364 @@
+/**
+ * @file fuzz_parser.cpp
+ * @brief Fuzzing de ImageParser en el PC (libFuzzer o modo autónomo)
+ *
+ * Cada entrada se guarda como archivo en el LittleFS en memoria de test/host/
+ * con la extensión que indica su firma ("BM" → .bmp, "R565" → .rgb, "POV1" →
+ * .pov; sin firma conocida se prueban las tres) y se recorre como lo hace el
+ * motor: parseImageInfo(), todas las columnas en orden y a saltos (todos los
+ * fotogramas en los .pov animados), getRows() por bloques y los retardos.
+ * Los .pov se recorren también en memoria con getMappedColumn(), como los lee
+ * el motor desde el almacén flash. Los PNG ("\x89PNG") pasan por el PNGDecoder
+ * y el Inflater reales, como en la subida, en trozos de distintos tamaños.
+ * Con AddressSanitizer, cualquier lectura fuera de los buffers aborta.
+ *
+ * Con clang y libFuzzer:
+ *   clang++ -std=gnu++17 -g -O1 -fsanitize=fuzzer,address,undefined \
+ *     -Itest/host -Isrc test/fuzz_parser.cpp src/image_parser.cpp \
+ *     src/png_decoder.cpp src/inflater.cpp -o fuzz_parser
+ *   ./fuzz_parser -max_len=65536 test/corpus
+ *
+ * Con gcc (sin libFuzzer): reproduce los archivos o directorios dados y,
+ * con -mutate=N, N mutaciones aleatorias de cada uno. Con -check además
+ * comprueba que las semillas "bad_*" se rechazan y el resto se decodifica:
+ *   g++ -std=gnu++17 -g -O1 -fsanitize=address,undefined -DPOV_FUZZ_MAIN \
+ *     -Itest/host -Isrc test/fuzz_parser.cpp src/image_parser.cpp \
+ *     src/png_decoder.cpp src/inflater.cpp -o fuzz_parser
+ *   ./fuzz_parser -check -mutate=2000 test/corpus
+ */
+
+#include <vector>
+#include "image_parser.h"
+#include "png_decoder.h"
+
+// Trabajo máximo por entrada, para que el fuzzer no se atasque en imágenes grandes
+static const uint32_t MAX_COLUMNS = 512;
+static const uint32_t MAX_ROW_PIXELS = 1 << 20;
+
+static void exercise(const char* path, const uint8_t* data, size_t size) {
+  // Parser nuevo en cada entrada: las cachés de tabla y paleta no arrastran
+  // datos de la anterior
+  ImageParser parser;
+  ImageInfo info;
+  if (!parser.parseImageInfo(path, info)) {
+    return;
+  }
+
+  File file = LittleFS.open(path, "r");
+  if (!file) {
+    return;
+  }
+
+  CRGB column[MAX_IMAGE_HEIGHT];
+  uint32_t columns = min((uint32_t)info.width, MAX_COLUMNS);
+
+  // En orden, como el motor, y a saltos hacia atrás (decodifica desde la columna clave)
+  for (uint32_t x = 0; x < columns; x++) {
+    parser.getColumn(file, info, x, column, MAX_IMAGE_HEIGHT);
+  }
+  for (int32_t x = (int32_t)columns - 1; x >= 0; x -= 7) {
+    parser.getColumn(file, info, x, column, MAX_IMAGE_HEIGHT);
+  }
+  parser.getColumn(file, info, info.width, column, MAX_IMAGE_HEIGHT);
+
+  // Animación: cada fotograma y la tabla de columnas repetidas
+  uint16_t delays[MAX_ANIMATION_FRAMES];
+  if (info.frameCount <= MAX_ANIMATION_FRAMES) {
+    parser.getFrameDelays(file, info, delays);
+  }
+  for (uint16_t frame = 0; frame <= info.frameCount; frame++) {
+    for (uint32_t x = 0; x < columns; x += 3) {
+      parser.getFrameColumn(file, info, frame, x, column, MAX_IMAGE_HEIGHT);
+      parser.isRepeatColumn(file, info, frame * info.width + x);
+    }
+  }
+
+  // Filas por bloques (BMP/RGB565)
+  if (parser.isRowMajor(info)) {
+    uint16_t batch = parser.getRowBatch(info);
+    if ((uint32_t)batch * info.width <= MAX_ROW_PIXELS) {
+      std::vector<CRGB> rows((size_t)batch * info.width);
+      for (uint32_t y = 0; y < info.height && y < MAX_COLUMNS; y += batch) {
+        uint16_t count = min((uint32_t)batch, info.height - y);
+        parser.getRows(file, info, y, count, rows.data());
+      }
+      parser.getRows(file, info, info.height - 1, 2, rows.data());
+    }
+  }
+
+  file.close();
+
+  // El mismo .pov en memoria, en una copia exacta: ASan detecta cualquier
+  // lectura más allá del final
+  if (info.format == 2) {
+    std::vector<uint8_t> image(data, data + size);
+    for (uint16_t frame = 0; frame <= info.frameCount; frame++) {
+      for (uint32_t x = 0; x < columns; x++) {
+        parser.getMappedColumn(image.data(), info, frame, x, column, MAX_IMAGE_HEIGHT);
+        parser.isRepeatColumn(image.data(), info, frame * info.width + x);
+      }
+    }
+    for (int32_t x = (int32_t)columns - 1; x >= 0; x -= 5) {
+      parser.getMappedColumn(image.data(), info, 0, x, column, MAX_IMAGE_HEIGHT);
+    }
+  }
+}
+
+// PNGDecoder: lo que recibe ImageTranscoder en la subida. Cada fila se lee
+// entera, así que ASan detecta una fila más corta que el ancho declarado
+struct PNGCheck {
+  PNGDecoder* png;
+  uint32_t rows;
+  uint32_t checksum;
+};
+
+static bool pngHeader(void* context) {
+  PNGCheck* check = static_cast<PNGCheck*>(context);
+  return check->png->getHeight() <= MAX_IMAGE_HEIGHT;
+}
+
+static bool pngRow(void* context, const uint8_t* row) {
+  PNGCheck* check = static_cast<PNGCheck*>(context);
+  uint32_t bytes = (uint32_t)check->png->getWidth() * check->png->getBytesPerPixel();
+  for (uint32_t i = 0; i < bytes; i++) {
+    check->checksum += row[i];
+  }
+  check->rows++;
+  return true;
+}
+
+// Decodifica el PNG entero en trozos de chunkSize bytes (como llegan los
+// chunks de /api/upload). true si se entregaron todas las filas
+static bool decodePNG(const uint8_t* data, size_t size, size_t chunkSize, uint32_t& checksum) {
+  PNGDecoder png;
+  PNGCheck check = {&png, 0, 0};
+  png.begin(TRANSCODE_MAX_WIDTH, PNG_MAX_WINDOW, pngHeader, pngRow, &check);
+  bool ok = true;
+  for (size_t at = 0; at < size && ok; at += chunkSize) {
+    ok = png.write(data + at, min(chunkSize, size - at));
+  }
+  ok = ok && png.isFinished() && check.rows == png.getHeight();
+  png.end();
+  checksum = check.checksum;
+  return ok;
+}
+
+static void exercisePNG(const uint8_t* data, size_t size) {
+  static const size_t chunkSizes[] = {1, 7, 1024, 65536};
+  uint32_t checksum;
+  for (size_t chunkSize : chunkSizes) {
+    decodePNG(data, size, chunkSize, checksum);
+  }
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+  Serial.quiet = true;
+
+  static const char* const paths[] = {"/images/fuzz.bmp", "/images/fuzz.rgb", "/images/fuzz.pov"};
+  int only = -1;
+  if (size >= 2 && memcmp(data, "BM", 2) == 0) {
+    only = 0;
+  } else if (size >= 4 && memcmp(data, "R565", 4) == 0) {
+    only = 1;
+  } else if (size >= 4 && memcmp(data, "POV1", 4) == 0) {
+    only = 2;
+  } else if (size >= 4 && memcmp(data, "\x89PNG", 4) == 0) {
+    only = 3;
+  }
+
+  for (int i = 0; i < 3; i++) {
+    if (only >= 0 && i != only) {
+      continue;
+    }
+    LittleFS.addFile(paths[i], data, size);
+    exercise(paths[i], data, size);
+    LittleFS.removeFile(paths[i]);
+  }
+  if (only < 0 || only == 3) {
+    exercisePNG(data, size);
+  }
+  return 0;
+}
+
+#ifdef POV_FUZZ_MAIN
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <random>
+#include <string>
+
+// Imagen válida: se parsea y se decodifican todas sus columnas y fotogramas;
+// en los .pov, las columnas leídas en memoria tienen que ser las mismas. Un
+// PNG tiene que dar todas sus filas, y las mismas, sea cual sea el trozo
+static bool decodesCleanly(const char* path) {
+  if (String(path).endsWith(".png")) {
+    File file = LittleFS.open(path, "r");
+    std::vector<uint8_t> image(file.size());
+    file.read(image.data(), image.size());
+    file.close();
+    uint32_t whole;
+    uint32_t byteByByte;
+    return decodePNG(image.data(), image.size(), image.size(), whole) &&
+           decodePNG(image.data(), image.size(), 1, byteByByte) && whole == byteByByte;
+  }
+  ImageParser parser;
+  ImageInfo info;
+  if (!parser.parseImageInfo(path, info)) {
+    return false;
+  }
+  File file = LittleFS.open(path, "r");
+  std::vector<uint8_t> image(file.size());
+  file.read(image.data(), image.size());
+  CRGB column[MAX_IMAGE_HEIGHT];
+  CRGB mapped[MAX_IMAGE_HEIGHT];
+  bool ok = true;
+  for (uint16_t frame = 0; frame < info.frameCount && ok; frame++) {
+    for (uint32_t x = 0; x < info.width && ok; x++) {
+      ok = parser.getFrameColumn(file, info, frame, x, column, MAX_IMAGE_HEIGHT);
+      if (ok && info.format == 2) {
+        const CRGB* line = parser.getMappedColumn(image.data(), info, frame, x, mapped, MAX_IMAGE_HEIGHT);
+        ok = line != nullptr && memcmp(line, column, info.height * sizeof(CRGB)) == 0;
+      }
+    }
+  }
+  file.close();
+  return ok;
+}
+
+static bool readFile(const std::string& path, std::vector<uint8_t>& data) {
+  FILE* f = fopen(path.c_str(), "rb");
+  if (f == nullptr) {
+    return false;
+  }
+  uint8_t chunk[4096];
+  size_t n;
+  data.clear();
+  while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) {
+    data.insert(data.end(), chunk, chunk + n);
+  }
+  fclose(f);
+  return true;
+}
+
+static void collect(const std::string& path, std::vector<std::string>& files) {
+  struct stat st;
+  if (stat(path.c_str(), &st) != 0) {
+    fprintf(stderr, "No existe: %s\n", path.c_str());
+    return;
+  }
+  if (!S_ISDIR(st.st_mode)) {
+    files.push_back(path);
+    return;
+  }
+  DIR* dir = opendir(path.c_str());
+  struct dirent* entry;
+  while ((entry = readdir(dir)) != nullptr) {
+    if (entry->d_name[0] != '.') {
+      collect(path + "/" + entry->d_name, files);
+    }
+  }
+  closedir(dir);
+}
+
+// Mutaciones al estilo de libFuzzer: bytes y bits cambiados, enteros extremos,
+// recortes y duplicados
+static void mutate(std::vector<uint8_t>& data, std::mt19937& rng) {
+  int edits = 1 + rng() % 4;
+  for (int e = 0; e < edits && !data.empty(); e++) {
+    size_t at = rng() % data.size();
+    switch (rng() % 6) {
+      case 0:
+        data[at] = rng();
+        break;
+      case 1:
+        data[at] ^= 1 << (rng() % 8);
+        break;
+      case 2: {
+        static const uint32_t extremes[] = {0, 1, 0x7FFF, 0x8000, 0xFFFF, 0x10000, 0x7FFFFFFF, 0x80000000, 0xFFFFFFFF};
+        uint32_t value = extremes[rng() % 9];
+        for (size_t i = 0; i < 4 && at + i < data.size(); i++) {
+          data[at + i] = value >> (8 * i);
+        }
+        break;
+      }
+      case 3:
+        data.resize(at);
+        break;
+      case 4: {
+        std::vector<uint8_t> copy(data.begin() + at, data.begin() + min(data.size(), at + 1 + rng() % 64));
+        data.insert(data.begin() + at, copy.begin(), copy.end());
+        break;
+      }
+      default:
+        data.erase(data.begin() + at, data.begin() + min(data.size(), at + 1 + rng() % 16));
+        break;
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  unsigned long mutations = 0;
+  bool check = false;
+  std::vector<std::string> files;
+  for (int i = 1; i < argc; i++) {
+    if (strncmp(argv[i], "-mutate=", 8) == 0) {
+      mutations = strtoul(argv[i] + 8, nullptr, 10);
+    } else if (strcmp(argv[i], "-check") == 0) {
+      check = true;
+    } else {
+      collect(argv[i], files);
+    }
+  }
+  std::sort(files.begin(), files.end());
+  if (files.empty()) {
+    fprintf(stderr, "Uso: %s [-check] [-mutate=N] archivo|directorio...\n", argv[0]);
+    return 1;
+  }
+
+  std::mt19937 rng(12345);
+  std::vector<uint8_t> data;
+  unsigned long runs = 0;
+  int failures = 0;
+  for (const std::string& path : files) {
+    if (!readFile(path, data)) {
+      fprintf(stderr, "No se pudo leer %s\n", path.c_str());
+      return 1;
+    }
+
+    // -check: las semillas "bad_*" deben rechazarse y el resto decodificarse enteras
+    if (check) {
+      std::string name = path.substr(path.rfind('/') + 1);
+      std::string target = "/images/" + name;
+      LittleFS.addFile(target.c_str(), data.data(), data.size());
+      Serial.quiet = true;
+      bool expected = name.compare(0, 4, "bad_") != 0;
+      if (decodesCleanly(target.c_str()) != expected) {
+        fprintf(stderr, "FALLO: %s %s\n", name.c_str(), expected ? "no se decodifica" : "se acepta");
+        failures++;
+      }
+      LittleFS.removeFile(target.c_str());
+    }
+
+    LLVMFuzzerTestOneInput(data.data(), data.size());
+    runs++;
+
+    std::vector<uint8_t> mutated;
+    for (unsigned long m = 0; m < mutations; m++) {
+      if (m % 8 == 0) {
+        mutated = data;
+      }
+      mutate(mutated, rng);
+      LLVMFuzzerTestOneInput(mutated.data(), mutated.size());
+      runs++;
+    }
+  }
+
+  printf("%lu entradas de %zu archivos sin errores de memoria\n", runs, files.size());
+  if (failures > 0) {
+    printf("%d semillas con resultado inesperado\n", failures);
+    return 1;
+  }
+  return 0;
+}
+
+#endif
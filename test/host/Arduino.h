@@ -0,0 +1,110 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+// Shim mínimo de Arduino para compilar ImageParser e ImageManager en el PC
+// (fuzzing y benchmarks de test/). Solo lo que usan esos módulos y config.h.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <ctype.h>
+#include <math.h>
+#include <string>
+#include <algorithm>
+
+using std::min;
+using std::max;
+
+typedef uint8_t byte;
+
+#define PI 3.1415926535897932384626433832795
+
+// Compilación en el PC: los módulos con código de plataforma (FlashStore)
+// usan su sustituto de host
+#define POV_HOST_BUILD
+
+#if defined(__GLIBC__) && (__GLIBC__ < 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ < 38))
+inline size_t strlcpy(char* dst, const char* src, size_t size) {
+  size_t length = strlen(src);
+  if (size > 0) {
+    size_t copy = length < size - 1 ? length : size - 1;
+    memcpy(dst, src, copy);
+    dst[copy] = '\0';
+  }
+  return length;
+}
+#endif
+
+class String {
+public:
+  String(const char* text = "") : value(text ? text : "") {}
+
+  const char* c_str() const { return value.c_str(); }
+  unsigned int length() const { return value.size(); }
+
+  String substring(unsigned int from) const {
+    return from < value.size() ? String(value.substr(from).c_str()) : String();
+  }
+
+  String substring(unsigned int from, unsigned int to) const {
+    return from < to && from < value.size() ? String(value.substr(from, to - from).c_str()) : String();
+  }
+
+  int lastIndexOf(char c) const {
+    size_t index = value.rfind(c);
+    return index == std::string::npos ? -1 : (int)index;
+  }
+
+  bool startsWith(const char* prefix) const { return value.compare(0, strlen(prefix), prefix) == 0; }
+
+  String operator+(const String& other) const { return String((value + other.value).c_str()); }
+  String operator+(const char* other) const { return String((value + other).c_str()); }
+
+  bool operator==(const String& other) const { return value == other.value; }
+  bool operator==(const char* other) const { return value == other; }
+  bool operator!=(const String& other) const { return value != other.value; }
+  bool operator!=(const char* other) const { return value != other; }
+
+  void toLowerCase() {
+    for (size_t i = 0; i < value.size(); i++) {
+      value[i] = tolower((unsigned char)value[i]);
+    }
+  }
+
+  bool endsWith(const char* suffix) const {
+    size_t n = strlen(suffix);
+    return value.size() >= n && value.compare(value.size() - n, n, suffix) == 0;
+  }
+
+private:
+  std::string value;
+};
+
+// Serial escribe en stderr; quiet = true lo silencia (el fuzzer genera
+// miles de errores esperados)
+class HostSerial {
+public:
+  bool quiet = false;
+
+  void printf(const char* format, ...) {
+    if (quiet) {
+      return;
+    }
+    va_list args;
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+  }
+
+  void println(const char* text = "") {
+    if (!quiet) {
+      fprintf(stderr, "%s\n", text);
+    }
+  }
+};
+
+inline HostSerial Serial;
+
+#endif
@@ -0,0 +1,207 @@
+#ifndef HOST_FS_H
+#define HOST_FS_H
+
+// File sobre buffers en memoria: sin E/S de disco, así que el fuzzer y los
+// benchmarks miden solo el código del firmware. Las lecturas fuera del archivo
+// devuelven menos bytes, como LittleFS. Los directorios son prefijos de ruta
+// (más los creados con mkdir) y openNextFile() devuelve el nombre sin ruta,
+// como LittleFS en ESP32. HostFS cuenta aperturas y bytes leídos/escritos.
+
+#include "Arduino.h"
+#include <map>
+#include <memory>
+#include <set>
+#include <vector>
+
+typedef std::vector<uint8_t> HostFileData;
+
+namespace fs {
+class HostFS;
+}
+
+class File {
+public:
+  File() : fs(nullptr), position(0), writable(false), directory(false), nextChild(0) {}
+
+  operator bool() const { return data != nullptr || directory; }
+
+  size_t size() const { return data ? data->size() : 0; }
+  const char* name() const { return fileName.c_str(); }
+  bool isDirectory() const { return directory; }
+
+  bool seek(uint32_t pos) {
+    if (!data || pos > data->size()) {
+      return false;
+    }
+    position = pos;
+    return true;
+  }
+
+  size_t read(uint8_t* buffer, size_t length);
+  size_t write(const uint8_t* buffer, size_t length);
+  File openNextFile();
+
+  void close() {
+    data.reset();
+    directory = false;
+    children.clear();
+  }
+
+private:
+  friend class fs::HostFS;
+
+  fs::HostFS* fs;
+  std::shared_ptr<HostFileData> data;
+  std::string fileName;
+  size_t position;
+  bool writable;
+  bool directory;
+  std::vector<std::string> children;  // Rutas completas
+  size_t nextChild;
+};
+
+namespace fs {
+
+class HostFS {
+public:
+  uint32_t opens = 0;
+  uint64_t bytesRead = 0;
+  uint64_t bytesWritten = 0;
+
+  bool begin(bool formatOnFail = false) {
+    (void)formatOnFail;
+    return true;
+  }
+
+  // Crea o reemplaza un archivo
+  void addFile(const char* path, const uint8_t* data, size_t size) {
+    files[path] = std::make_shared<HostFileData>(data, data + size);
+  }
+
+  void removeFile(const char* path) { files.erase(path); }
+
+  void resetCounters() {
+    opens = 0;
+    bytesRead = 0;
+    bytesWritten = 0;
+  }
+
+  File open(const String& path, const char* mode = "r") { return open(path.c_str(), mode); }
+
+  File open(const char* path, const char* mode = "r") {
+    File file;
+    file.fs = this;
+    std::string name = path;
+    file.fileName = name.substr(name.rfind('/') + 1);
+
+    if (strcmp(mode, "r") == 0) {
+      auto it = files.find(name);
+      if (it != files.end()) {
+        opens++;
+        file.data = it->second;
+        return file;
+      }
+      if (isDirectory(name)) {
+        opens++;
+        file.directory = true;
+        std::string prefix = name + "/";
+        for (auto entry = files.lower_bound(prefix); entry != files.end() &&
+             entry->first.compare(0, prefix.size(), prefix) == 0; ++entry) {
+          if (entry->first.find('/', prefix.size()) == std::string::npos) {
+            file.children.push_back(entry->first);
+          }
+        }
+      }
+      return file;
+    }
+
+    if (strcmp(mode, "w") == 0) {
+      opens++;
+      std::shared_ptr<HostFileData>& data = files[name];
+      data = std::make_shared<HostFileData>();
+      file.data = data;
+      file.writable = true;
+    }
+    return file;
+  }
+
+  bool exists(const String& path) { return exists(path.c_str()); }
+  bool exists(const char* path) { return files.count(path) > 0 || isDirectory(path); }
+
+  bool remove(const String& path) { return remove(path.c_str()); }
+  bool remove(const char* path) { return files.erase(path) > 0; }
+
+  bool rename(const String& from, const String& to) { return rename(from.c_str(), to.c_str()); }
+  bool rename(const char* from, const char* to) {
+    auto it = files.find(from);
+    if (it == files.end()) {
+      return false;
+    }
+    std::shared_ptr<HostFileData> data = it->second;
+    files.erase(it);
+    files[to] = data;
+    return true;
+  }
+
+  bool mkdir(const char* path) {
+    directories.insert(path);
+    return true;
+  }
+
+  size_t totalBytes() { return 1024 * 1024 * 1024; }
+
+  size_t usedBytes() {
+    size_t used = 0;
+    for (const auto& entry : files) {
+      used += entry.second->size();
+    }
+    return used;
+  }
+
+private:
+  std::map<std::string, std::shared_ptr<HostFileData>> files;
+  std::set<std::string> directories;
+
+  bool isDirectory(const std::string& path) {
+    if (directories.count(path) > 0) {
+      return true;
+    }
+    auto it = files.lower_bound(path + "/");
+    return it != files.end() && it->first.compare(0, path.size() + 1, path + "/") == 0;
+  }
+};
+
+}  // namespace fs
+
+inline size_t File::read(uint8_t* buffer, size_t length) {
+  if (!data || position >= data->size()) {
+    return 0;
+  }
+  size_t count = min(length, data->size() - position);
+  memcpy(buffer, data->data() + position, count);
+  position += count;
+  fs->bytesRead += count;
+  return count;
+}
+
+inline size_t File::write(const uint8_t* buffer, size_t length) {
+  if (!data || !writable) {
+    return 0;
+  }
+  if (data->size() < position + length) {
+    data->resize(position + length);
+  }
+  memcpy(data->data() + position, buffer, length);
+  position += length;
+  fs->bytesWritten += length;
+  return length;
+}
+
+inline File File::openNextFile() {
+  if (!directory || nextChild >= children.size()) {
+    return File();
+  }
+  return fs->open(children[nextChild++].c_str(), "r");
+}
+
+#endif
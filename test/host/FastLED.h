@@ -0,0 +1,22 @@
+#ifndef HOST_FASTLED_H
+#define HOST_FASTLED_H
+
+// CRGB de FastLED: R, G, B contiguos (ImageParser convierte sobre los bytes)
+
+#include "Arduino.h"
+
+struct CRGB {
+  enum HTMLColorCode {
+    Black = 0x000000
+  };
+
+  uint8_t r;
+  uint8_t g;
+  uint8_t b;
+
+  CRGB() : r(0), g(0), b(0) {}
+  CRGB(uint8_t red, uint8_t green, uint8_t blue) : r(red), g(green), b(blue) {}
+  CRGB(HTMLColorCode code) : r((code >> 16) & 0xFF), g((code >> 8) & 0xFF), b(code & 0xFF) {}
+};
+
+#endif
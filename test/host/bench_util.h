@@ -0,0 +1,188 @@
+#ifndef HOST_BENCH_UTIL_H
+#define HOST_BENCH_UTIL_H
+
+// Utilidades comunes de los benchmarks de host (test/bench_*.cpp): reloj,
+// escritura little-endian, generadores de BMP, RGB565 y .pov en memoria,
+// lectura de archivos del LittleFS de host y las líneas de comprobación.
+// Cada benchmark pone sus propios píxeles con las funciones que recibe.
+
+#include <chrono>
+#include <vector>
+#include "image_parser.h"
+
+inline double now() {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+inline void put16(std::vector<uint8_t>& out, uint16_t value) {
+  out.push_back(value & 0xFF);
+  out.push_back(value >> 8);
+}
+
+inline void put32(std::vector<uint8_t>& out, uint32_t value) {
+  put16(out, value & 0xFFFF);
+  put16(out, value >> 16);
+}
+
+// Cabecera BMP (BITMAPINFOHEADER) sin compresión. Con bpp <= 8 los datos
+// empiezan tras una paleta de 2^bpp entradas que añade el llamador. Devuelve
+// los bytes por fila, con el relleno a 4 bytes
+inline uint32_t putBMPHeader(std::vector<uint8_t>& out, uint16_t width, uint16_t height, uint8_t bpp = 24) {
+  uint32_t rowStride = (((uint32_t)bpp * width + 31) / 32) * 4;
+  uint32_t paletteBytes = bpp <= 8 ? (1u << bpp) * 4 : 0;
+  uint32_t dataOffset = 54 + paletteBytes;
+  put16(out, 0x4D42);
+  put32(out, dataOffset + rowStride * height);
+  put32(out, 0);
+  put32(out, dataOffset);
+  put32(out, 40);
+  put32(out, width);
+  put32(out, height);
+  put16(out, 1);
+  put16(out, bpp);
+  for (int i = 0; i < 6; i++) {
+    put32(out, 0);
+  }
+  return rowStride;
+}
+
+// BMP de 24 bits cuyos datos (filas de abajo arriba, relleno incluido) son
+// byteAt(i): un patrón barato cuando no importa cómo se ve la imagen
+template <typename ByteAt>
+std::vector<uint8_t> makeBMP(uint16_t width, uint16_t height, ByteAt byteAt) {
+  std::vector<uint8_t> out;
+  uint32_t rowStride = putBMPHeader(out, width, height);
+  for (uint32_t i = 0; i < rowStride * height; i++) {
+    out.push_back(byteAt(i));
+  }
+  return out;
+}
+
+// BMP de 24 bits con el color colorAt(x, y) de cada píxel (y desde arriba),
+// guardado de abajo arriba en BGR como casi todos los BMP
+template <typename ColorAt>
+std::vector<uint8_t> makeBMPFromColors(uint16_t width, uint16_t height, ColorAt colorAt) {
+  std::vector<uint8_t> out;
+  uint32_t rowStride = putBMPHeader(out, width, height);
+  for (int32_t y = height - 1; y >= 0; y--) {
+    for (uint16_t x = 0; x < width; x++) {
+      CRGB color = colorAt(x, (uint16_t)y);
+      out.push_back(color.b);
+      out.push_back(color.g);
+      out.push_back(color.r);
+    }
+    for (uint32_t i = (uint32_t)width * 3; i < rowStride; i++) {
+      out.push_back(0);
+    }
+  }
+  return out;
+}
+
+// RGB565 crudo ("R565", ancho, alto) con el valor valueAt(x, y) de cada píxel
+template <typename ValueAt>
+std::vector<uint8_t> makeRGB565(uint16_t width, uint16_t height, ValueAt valueAt) {
+  std::vector<uint8_t> out = {'R', '5', '6', '5'};
+  put16(out, width);
+  put16(out, height);
+  for (uint16_t y = 0; y < height; y++) {
+    for (uint16_t x = 0; x < width; x++) {
+      put16(out, valueAt(x, y));
+    }
+  }
+  return out;
+}
+
+// Header .pov de una imagen fija
+inline void putPOVHeader(std::vector<uint8_t>& out, uint16_t width, uint16_t height, uint8_t pixelFormat,
+                         uint32_t tableOffset) {
+  for (char c : {'P', 'O', 'V', '1'}) {
+    out.push_back(c);
+  }
+  out.push_back(POV_FORMAT_VERSION);
+  out.push_back(pixelFormat);
+  put16(out, width);
+  put16(out, height);
+  put16(out, 0);
+  put32(out, tableOffset);
+}
+
+// .pov RGB888 con todas las columnas RAW; byteAt(x, i) es el byte i de la
+// columna x
+template <typename ByteAt>
+std::vector<uint8_t> makeRawPOV(uint16_t width, uint16_t height, ByteAt byteAt) {
+  std::vector<uint8_t> out;
+  putPOVHeader(out, width, height, POV_PIXEL_RGB888, sizeof(POVHeader));
+  uint32_t columnBytes = 1 + (uint32_t)height * 3;
+  uint32_t start = sizeof(POVHeader) + (width + 1) * 4;
+  for (uint32_t x = 0; x <= width; x++) {
+    put32(out, start + x * columnBytes);
+  }
+  for (uint16_t x = 0; x < width; x++) {
+    out.push_back(POV_COLUMN_RAW);
+    for (uint32_t i = 0; i < (uint32_t)height * 3; i++) {
+      out.push_back(byteAt(x, i));
+    }
+  }
+  return out;
+}
+
+// .pov con la codificación más corta por columna, como ImageTranscoder.
+// fillColumn(x, pixels) escribe la columna x sin codificar (3 bytes RGB, 2
+// RGB565 o un índice por píxel); palette son los bytes R, G, B de la paleta
+// en los formatos indexados
+template <typename FillColumn>
+std::vector<uint8_t> makeEncodedPOV(uint16_t width, uint16_t height, uint8_t pixelFormat,
+                                    const std::vector<uint8_t>& palette, FillColumn fillColumn) {
+  uint8_t bits = povIndexBits(pixelFormat);
+  uint8_t bytesPerPixel = bits > 0 ? 1 : pixelFormat == POV_PIXEL_RGB565 ? 2 : 3;
+  uint32_t paletteBytes = bits > 0 ? (1u << bits) * 3 : 0;
+  uint32_t tableOffset = sizeof(POVHeader) + paletteBytes;
+  uint32_t columnBytes = (uint32_t)height * bytesPerPixel;
+
+  std::vector<uint8_t> columns;
+  std::vector<uint32_t> offsets;
+  std::vector<uint8_t> pixels(columnBytes);
+  std::vector<uint8_t> previous(columnBytes);
+  std::vector<uint8_t> encoded(1 + columnBytes);
+  uint32_t dataStart = tableOffset + (width + 1) * 4;
+  for (uint16_t x = 0; x < width; x++) {
+    fillColumn(x, pixels.data());
+    uint32_t length = povEncodeColumn(pixels.data(), povIsKeyframe(x) ? nullptr : previous.data(), height,
+                                      bytesPerPixel, bits, encoded.data());
+    offsets.push_back(dataStart + columns.size());
+    columns.insert(columns.end(), encoded.begin(), encoded.begin() + length);
+    previous = pixels;
+  }
+  offsets.push_back(dataStart + columns.size());
+
+  std::vector<uint8_t> out;
+  putPOVHeader(out, width, height, pixelFormat, tableOffset);
+  for (uint32_t i = 0; i < paletteBytes; i++) {
+    out.push_back(i < palette.size() ? palette[i] : 0);
+  }
+  for (uint32_t offset : offsets) {
+    put32(out, offset);
+  }
+  out.insert(out.end(), columns.begin(), columns.end());
+  return out;
+}
+
+// Contenido completo de un archivo del LittleFS de host (vacío si no existe)
+inline std::vector<uint8_t> readAll(const String& path) {
+  std::vector<uint8_t> data;
+  File file = LittleFS.open(path, "r");
+  if (file) {
+    data.resize(file.size());
+    file.read(data.data(), data.size());
+    file.close();
+  }
+  return data;
+}
+
+// Línea de la lista de comprobaciones; allOk acumula el resultado
+inline void check(const char* name, bool ok, bool& allOk) {
+  printf("%-56s %s\n", name, ok ? "sí" : "NO");
+  allOk = allOk && ok;
+}
+
+#endif
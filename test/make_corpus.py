@@ -0,0 +1,200 @@
+#!/usr/bin/env python3
+"""
+Genera test/corpus/: semillas válidas y malformadas para test/fuzz_parser.cpp.
+
+Las válidas cubren cada formato que lee ImageParser (BMP de 1, 2, 4, 8 y 24
+bits, de abajo arriba y de arriba abajo, RGB565 y .pov raw/RLE/REPEAT/DELTA,
+indexado y animado) y los PNG que decodifica PNGDecoder en la subida (paleta
+con tRNS, gris de 16 bits, RGB, RGBA y gris con alfa, con los cinco filtros);
+las malformadas, los casos límite de los headers: dimensiones que no caben en
+16 bits, datos truncados, offsets fuera del archivo, columnas .pov inválidas y
+chunks PNG repetidos, de más o fuera de sitio. Solo usa la biblioteca estándar.
+
+Uso:
+    python3 test/make_corpus.py [directorio]
+"""
+
+import os
+import struct
+import sys
+import zlib
+
+# Codificaciones de columna (pov_codec.h)
+RAW, RLE, REPEAT, DELTA = 0, 1, 2, 3
+
+
+def bmp(width, height, bpp, top_down=False, colors=None, header_size=40,
+        data_offset=None, compression=0, truncate=0, palette_entries=None):
+    row_stride = ((bpp * width + 31) // 32) * 4
+    rows = abs(height) if isinstance(height, int) else 0
+    # Como mucho 4 KB de píxeles: los casos enormes solo necesitan el header
+    pixels = bytearray()
+    for y in range(min(rows, 4096 // max(row_stride, 1))):
+        pixels += bytearray((x * 7 + y * 13) & 0xFF for x in range(row_stride))
+    palette = b""
+    if bpp <= 8:
+        entries = palette_entries if palette_entries is not None else (1 << bpp)
+        palette = b"".join(struct.pack("<BBBB", i * 3 & 0xFF, i * 5 & 0xFF, i * 11 & 0xFF, 0)
+                           for i in range(entries))
+    if data_offset is None:
+        data_offset = 14 + min(header_size, 124) + len(palette)
+    info = struct.pack("<IiiHHIIiiII", header_size, width, -height if top_down else height,
+                       1, bpp, compression, len(pixels), 2835, 2835,
+                       colors if colors is not None else 0, 0)
+    info += b"\0" * max(0, min(header_size, 124) - 40)
+    body = info + palette
+    padding = data_offset - 14 - len(body)
+    if 0 < padding <= 4096:
+        body += b"\0" * padding
+    data = struct.pack("<HIHHI", 0x4D42, 14 + len(body) + len(pixels), 0, 0, data_offset) + body + pixels
+    return data[:len(data) - truncate] if truncate else data
+
+
+def rgb565(width, height, truncate=0):
+    pixels = b"".join(struct.pack("<H", (x * 2047 + y * 31) & 0xFFFF)
+                      for y in range(height) for x in range(width))
+    data = b"R565" + struct.pack("<HH", width, height) + pixels
+    return data[:len(data) - truncate] if truncate else data
+
+
+def pov(width, height, pixel_format, columns, palette=b"", delays=None, table_offset=None,
+        offsets=None, version=1):
+    flags = 1 if delays is not None else 0
+    frames = b""
+    if delays is not None:
+        frames = struct.pack("<H", len(delays)) + b"".join(struct.pack("<H", d) for d in delays)
+    start = 16 + len(palette) + len(frames)
+    if table_offset is None:
+        table_offset = start
+    table_bytes = (len(columns) + 1) * 4
+    if offsets is None:
+        offsets = [table_offset + table_bytes]
+        for column in columns:
+            offsets.append(offsets[-1] + len(column))
+    header = b"POV1" + struct.pack("<BBHHHI", version, pixel_format, width, height, flags, table_offset)
+    table = b"".join(struct.pack("<I", o & 0xFFFFFFFF) for o in offsets)
+    return header + palette + frames + table + b"".join(columns)
+
+
+def rle(runs, bytes_per_pixel, encoding=RLE):
+    out = bytearray([encoding])
+    for count, value in runs:
+        out.append(count)
+        out += bytes([value] * bytes_per_pixel)
+    return bytes(out)
+
+
+def png_chunk(kind, data):
+    return struct.pack(">I", len(data)) + kind + data + struct.pack(">I", zlib.crc32(kind + data))
+
+
+def png_ihdr(width, height, bit_depth, color_type, interlace=0):
+    return png_chunk(b"IHDR", struct.pack(">IIBBBBB", width, height, bit_depth, color_type, 0, 0, interlace))
+
+
+def png_idat(width, height, bit_depth, channels):
+    """Filas con bytes de prueba; el filtro va rotando 0-4 para cubrir todos."""
+    row_bytes = (width * channels * bit_depth + 7) // 8
+    raw = bytearray()
+    for y in range(height):
+        raw.append(y % 5)
+        raw += bytearray((x * 29 + y * 17 + 3) & 0xFF for x in range(row_bytes))
+    return png_chunk(b"IDAT", zlib.compress(bytes(raw)))
+
+
+def png(width, height, bit_depth, color_type, before=b"", after=b"", interlace=0, idat=None):
+    channels = {0: 1, 2: 3, 3: 1, 4: 2, 6: 4}.get(color_type, 1)
+    if idat is None:
+        idat = png_idat(width, height, bit_depth, channels)
+    return (b"\x89PNG\r\n\x1a\n" + png_ihdr(width, height, bit_depth, color_type, interlace) + before +
+            idat + after + png_chunk(b"IEND", b""))
+
+
+def seeds():
+    yield "bmp24_8x6.bmp", bmp(8, 6, 24)
+    yield "bmp24_topdown.bmp", bmp(5, 7, 24, top_down=True)
+    yield "bmp24_odd_stride.bmp", bmp(3, 4, 24)
+    yield "bmp8_16x8.bmp", bmp(16, 8, 8)
+    yield "bmp8_colors_used.bmp", bmp(9, 5, 8, colors=20, palette_entries=20)
+    yield "bmp4_13x9.bmp", bmp(13, 9, 4)
+    yield "bmp2_7x3.bmp", bmp(7, 3, 2)
+    yield "bmp1_33x4.bmp", bmp(33, 4, 1, top_down=True)
+    yield "bmp24_v5_header.bmp", bmp(4, 4, 24, header_size=124)
+    yield "rgb565_8x6.rgb", rgb565(8, 6)
+    yield "rgb565_1x1.rgb", rgb565(1, 1)
+
+    keyframe = bytes([RAW]) + bytes(range(12))
+    yield "pov_rgb888_raw.pov", pov(3, 4, 0, [keyframe, bytes([REPEAT]), rle([(4, 9)], 3, DELTA)])
+    yield "pov_rgb565_rle.pov", pov(2, 5, 1, [rle([(3, 1), (2, 200)], 2), rle([(5, 7)], 2)])
+    yield "pov_indexed4.pov", pov(18, 6, 4, [rle([(6, x % 16)], 1) for x in range(18)],
+                                  palette=bytes(range(48)))
+    yield "pov_indexed1_raw.pov", pov(2, 9, 2, [bytes([RAW, 0xA5, 0x80]), bytes([REPEAT])],
+                                      palette=bytes(6))
+    yield "pov_animated.pov", pov(2, 3, 0, [rle([(3, f)], 3) for f in range(6)], delays=[100, 50, 0])
+
+    # Malformados: BMP
+    yield "bad_bmp_width_over_16bit.bmp", bmp(70000, 1, 24)
+    yield "bad_bmp_height_int_min.bmp", bmp(4, -0x80000000, 24)
+    yield "bad_bmp_negative_width.bmp", bmp(-4, 4, 24)
+    yield "bad_bmp_truncated.bmp", bmp(16, 16, 24, truncate=100)
+    yield "bad_bmp_data_past_end.bmp", bmp(4, 4, 24, data_offset=0x7FFFFFF0)
+    yield "bad_bmp_header_size_wrap.bmp", bmp(4, 4, 8, header_size=0xFFFFFFF8)
+    yield "bad_bmp_core_header.bmp", bmp(4, 4, 24, header_size=12)
+    yield "bad_bmp_palette_overlap.bmp", bmp(4, 4, 8, data_offset=60)
+    yield "bad_bmp_rle8.bmp", bmp(4, 4, 8, compression=1)
+    yield "bad_bmp_16bit.bmp", bmp(4, 4, 16)
+    yield "bad_bmp_short_header.bmp", bmp(4, 4, 24)[:30]
+    # Malformados: RGB565
+    yield "bad_rgb565_zero_width.rgb", rgb565(0, 5)
+    yield "bad_rgb565_truncated.rgb", rgb565(8, 8, truncate=3)
+    yield "bad_rgb565_huge.rgb", b"R565" + struct.pack("<HH", 0xFFFF, 0xFFFF) + bytes(64)
+    yield "bad_rgb565_magic.rgb", b"R566" + rgb565(2, 2)[4:]
+    # Malformados: .pov
+    yield "bad_pov_table_past_end.pov", pov(3, 4, 0, [keyframe] * 3, table_offset=0xFFFFFFF0)
+    yield "bad_pov_offsets_decreasing.pov", pov(2, 4, 0, [keyframe, keyframe], offsets=[40, 28, 40])
+    yield "bad_pov_offset_past_end.pov", pov(2, 4, 0, [keyframe, keyframe], offsets=[28, 41, 0x100000])
+    yield "bad_pov_repeat_keyframe.pov", pov(1, 4, 0, [bytes([REPEAT])])
+    yield "bad_pov_rle_zero_run.pov", pov(1, 4, 0, [rle([(0, 1), (4, 2)], 3)])
+    yield "bad_pov_rle_short.pov", pov(1, 4, 0, [rle([(2, 1)], 3)])
+    yield "bad_pov_raw_short.pov", pov(1, 4, 0, [bytes([RAW, 1, 2, 3])])
+    yield "bad_pov_encoding.pov", pov(1, 4, 0, [bytes([7]) + bytes(12)])
+    yield "bad_pov_height.pov", pov(1, 301, 0, [rle([(255, 1), (46, 2)], 3)])
+    yield "bad_pov_format.pov", pov(1, 4, 6, [keyframe])
+    yield "bad_pov_version.pov", pov(1, 4, 0, [keyframe], version=2)
+    yield "bad_pov_zero_frames.pov", pov(1, 4, 0, [keyframe], delays=[])
+    yield "bad_pov_too_many_frames.pov", pov(1, 4, 0, [keyframe], delays=[10] * 65)
+    yield "bad_pov_palette_short.pov", pov(1, 4, 5, [rle([(4, 3)], 1)], palette=bytes(30))
+
+    # PNG
+    plte16 = png_chunk(b"PLTE", bytes(range(48)))
+    yield "png_palette4_13x5.png", png(13, 5, 4, 3, before=plte16 + png_chunk(b"tRNS", bytes([0, 128, 255])))
+    yield "png_gray16_5x4.png", png(5, 4, 16, 0, before=png_chunk(b"tRNS", bytes([0x1D, 0x20])))
+    yield "png_rgb_8x6.png", png(8, 6, 8, 2, before=png_chunk(b"tEXt", b"Comment\0corpus"))
+    yield "png_rgba16_3x7.png", png(3, 7, 16, 6)
+    yield "png_gray_alpha_6x3.png", png(6, 3, 8, 4)
+    # Malformados: PNG
+    yield "bad_png_ihdr_repeat.png", png(4, 4, 8, 2, before=png_chunk(b"IHDR", bytes(4000)))
+    yield "bad_png_ihdr_after_idat.png", png(4, 4, 8, 2, after=png_ihdr(900, 4, 8, 2))
+    yield "bad_png_plte_after_idat.png", png(4, 4, 8, 3, before=plte16, after=plte16)
+    yield "bad_png_plte_too_long.png", png(4, 4, 8, 3, before=png_chunk(b"PLTE", bytes(257 * 3)))
+    yield "bad_png_trns_too_long.png", png(4, 4, 8, 2, before=png_chunk(b"tRNS", bytes(4000)))
+    yield "bad_png_trns_rgba.png", png(4, 4, 8, 6, before=png_chunk(b"tRNS", bytes(6)))
+    yield "bad_png_palette_missing.png", png(4, 4, 8, 3)
+    yield "bad_png_interlaced.png", png(4, 4, 8, 2, interlace=1)
+    yield "bad_png_truncated.png", png(8, 8, 8, 2)[:-40]
+    yield "bad_png_bad_filter.png", png(2, 2, 8, 0, idat=png_chunk(b"IDAT", zlib.compress(bytes([7, 1, 2, 0, 3, 4]))))
+
+
+def main():
+    directory = sys.argv[1] if len(sys.argv) > 1 else os.path.join(os.path.dirname(__file__), "corpus")
+    os.makedirs(directory, exist_ok=True)
+    count = 0
+    for name, data in seeds():
+        with open(os.path.join(directory, name), "wb") as f:
+            f.write(data)
+        count += 1
+    print(f"{count} archivos en {directory}")
+
+
+if __name__ == "__main__":
+    main()
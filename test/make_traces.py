@@ -0,0 +1,145 @@
+#!/usr/bin/env python3
+"""
+Genera test/traces/: trazas del acelerómetro para test/test_sweep.cpp.
+
+Cada traza es lo que Accelerometer::update() pasa a SweepEstimator::addSample():
+el instante en microsegundos y la aceleración X calibrada en m/s², una muestra
+cada ACCEL_SAMPLE_PERIOD_US (10 ms) más el retraso del loop(). La señal es la
+de un vaivén x(t) = A sin(wt) con lo que añade el LIS3DH a ±8g: ruido,
+cuantización de 4 mg, saturación y un resto de gravedad que deja la
+calibración. La cabecera de cada archivo lleva el medio periodo y la velocidad
+media de referencia y la tolerancia con que se comparan. Solo usa la
+biblioteca estándar y siempre genera lo mismo (semilla fija).
+
+Uso:
+    python3 test/make_traces.py [directorio]
+"""
+
+import math
+import os
+import random
+import sys
+
+SAMPLE_PERIOD_US = 10000   # ACCEL_SAMPLE_PERIOD_US
+LOOP_JITTER_US = 2000      # Retraso máximo del loop() sobre el periodo
+START_US = 3000000         # El estimador trata 0 como "sin muestras"
+LSB = 0.004 * 9.80665      # 4 mg por cuenta a ±8g
+FULL_SCALE = 8 * 9.80665
+NOISE = 0.2                # m/s² (desviación típica)
+OFFSET = 0.4               # Gravedad que no quitó la calibración (badge algo inclinado)
+PITCH_MM = 4.0             # DEFAULT_COLUMN_PITCH_MM
+
+
+def sensor(accel, rng):
+    value = accel + OFFSET + rng.gauss(0, NOISE)
+    value = max(-FULL_SCALE, min(FULL_SCALE, value))
+    return round(value / LSB) * LSB
+
+
+def sample_times(seconds, rng):
+    t = START_US
+    while t < START_US + seconds * 1000000:
+        yield t
+        t += SAMPLE_PERIOD_US + rng.randint(0, LOOP_JITTER_US)
+
+
+def sine(half_ms, amplitude_mm, seconds, rng):
+    """Vaivén regular: a(t) = -A w² sin(wt)."""
+    omega = math.pi / (half_ms / 1000.0)
+    amplitude = amplitude_mm / 1000.0
+    rows = []
+    for t in sample_times(seconds, rng):
+        s = (t - START_US) / 1000000.0
+        rows.append((t, sensor(-amplitude * omega * omega * math.sin(omega * s), rng)))
+    return rows
+
+
+def hand(half_ms, amplitude_mm, seconds, rng):
+    """Vaivén a mano: frecuencia y amplitud varían un 5% y un 10% (lento, cada
+    3 s) y un tercer armónico deforma la señal. La aceleración es la segunda
+    derivada numérica de la posición. Devuelve también el medio barrido y la
+    amplitud medios del último segundo, que es lo que debe dar el estimador."""
+    step = 0.0001
+    omega0 = math.pi / (half_ms / 1000.0)
+
+    def omega(s):
+        return omega0 * (1 + 0.05 * math.sin(2 * math.pi * s / 3.0))
+
+    def amplitude(s):
+        return amplitude_mm / 1000.0 * (1 + 0.1 * math.sin(2 * math.pi * s / 3.0 + 1.0))
+
+    def position(s):
+        # Fase: integral de omega(s)
+        phase = omega0 * (s - 0.05 * 3.0 / (2 * math.pi) * (math.cos(2 * math.pi * s / 3.0) - 1))
+        return amplitude(s) * (math.sin(phase) + 0.02 * math.sin(3 * phase))
+
+    rows = []
+    for t in sample_times(seconds, rng):
+        s = (t - START_US) / 1000000.0
+        if s < step:
+            s = step
+        accel = (position(s + step) - 2 * position(s) + position(s - step)) / (step * step)
+        rows.append((t, sensor(accel, rng)))
+    last = [seconds - 1 + i / 100.0 for i in range(100)]
+    half_ref = sum(math.pi / omega(s) for s in last) / len(last) * 1000
+    amplitude_ref = sum(amplitude(s) for s in last) / len(last) * 1000
+    return rows, half_ref, amplitude_ref
+
+
+def still(seconds, rng):
+    """Badge quieto en la mano: solo ruido y un poco de temblor."""
+    rows = []
+    for t in sample_times(seconds, rng):
+        s = (t - START_US) / 1000000.0
+        rows.append((t, sensor(0.15 * math.sin(2 * math.pi * 8 * s), rng)))
+    return rows
+
+
+def pause(half_ms, amplitude_mm, rng):
+    """2 s de vaivén, 2 s quieto y otros 3 s de vaivén."""
+    rows = sine(half_ms, amplitude_mm, 2, rng)
+    offset = rows[-1][0] + SAMPLE_PERIOD_US - START_US
+    rows += [(t + offset, a) for t, a in still(2, rng)]
+    offset = rows[-1][0] + SAMPLE_PERIOD_US - START_US
+    rows += [(t + offset, a) for t, a in sine(half_ms, amplitude_mm, 3, rng)]
+    return rows
+
+
+def write(directory, name, description, rows, half_ms, amplitude_mm, locks, turns, period_tol, rate_tol):
+    """locks: veces que el estimador debe llegar a un periodo estable; turns:
+    si los puntos de giro reales caen en START_US + (k + 1/2) medio barrido."""
+    speed = 2 * amplitude_mm / (half_ms / 1000.0) if half_ms else 0
+    expected = "half_us=%d speed_mm_s=%.1f rate=%d locks=%d turn_us=%d" % (
+        round(half_ms * 1000), speed, round(speed / PITCH_MM), locks,
+        START_US + round(half_ms * 500) if turns else 0)
+    with open(os.path.join(directory, name), "w") as out:
+        out.write("# %s\n" % description)
+        out.write("# esperado: %s pitch_mm=%.1f\n" % (expected, PITCH_MM))
+        out.write("# tolerancia: half=%d%% rate=%d%%\n" % (period_tol, rate_tol))
+        out.write("# t_us,ax_ms2\n")
+        for t, a in rows:
+            out.write("%d,%.3f\n" % (t, a))
+    print("%-20s %5d muestras  %s" % (name, len(rows), expected))
+
+
+def main():
+    directory = sys.argv[1] if len(sys.argv) > 1 else os.path.join(os.path.dirname(__file__), "traces")
+    os.makedirs(directory, exist_ok=True)
+    rng = random.Random(20261017)
+    write(directory, "rapido.csv", "Vaivén rápido: medio barrido de 150 ms, A = 120 mm",
+          sine(150, 120, 4, rng), 150, 120, 1, True, 3, 10)
+    write(directory, "medio.csv", "Vaivén típico: medio barrido de 300 ms, A = 200 mm",
+          sine(300, 200, 5, rng), 300, 200, 1, True, 3, 10)
+    write(directory, "lento.csv", "Vaivén lento: medio barrido de 700 ms, A = 300 mm",
+          sine(700, 300, 8, rng), 700, 300, 1, True, 3, 10)
+    rows, half_ms, amplitude_mm = hand(250, 180, 6, rng)
+    write(directory, "mano.csv", "A mano: medio barrido de 250 ms y A = 180 mm de media, con deriva y armónicos",
+          rows, half_ms, amplitude_mm, 1, False, 10, 20)
+    write(directory, "pausa.csv", "Vaivén de 200 ms y A = 150 mm con una pausa de 2 s en medio",
+          pause(200, 150, rng), 200, 150, 2, False, 3, 10)
+    write(directory, "quieto.csv", "Badge quieto: ruido, temblor y gravedad residual, sin barrido",
+          still(4, rng), 0, 0, 0, False, 0, 0)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,169 @@
+/**
+ * @file test_bmp_layout.cpp
+ * @brief Pruebas de host de la disposición de los BMP guardada en ImageInfo
+ *
+ * Guarda la misma imagen como BMP de abajo arriba y de arriba abajo (alto
+ * negativo) en 24, 8, 4 y 1 bits, con relleno de fila, en el LittleFS en
+ * memoria de test/host/. Con el ImageManager real, el catálogo se crea y se
+ * vuelve a cargar de /images.cat, y para cada archivo se comprueba que:
+ *   - la disposición del catálogo (dataOffset, rowStride, topDown, paleta...)
+ *     es la que da un parseImageInfo() nuevo
+ *   - getColumn() con el ImageInfo del catálogo da las mismas columnas que
+ *     getColumn(filename), que parsea el header en cada llamada, y que los
+ *     colores con que se generó la imagen, también con un buffer más corto
+ *     que la columna
+ *   - getRows() por bloques da esos mismos píxeles
+ *
+ * Compilar y ejecutar en el PC:
+ *   g++ -std=gnu++17 -O2 -Itest/host -Isrc test/test_bmp_layout.cpp src/image_manager.cpp \
+ *     src/image_parser.cpp src/image_scaler.cpp src/image_transcoder.cpp src/png_decoder.cpp \
+ *     src/inflater.cpp -o test_bmp_layout && ./test_bmp_layout
+ */
+
+#include "bench_util.h"
+#include "image_manager.h"
+
+static const uint16_t WIDTH = 37;
+static const uint16_t HEIGHT = 21;
+static const uint8_t BITS[] = {24, 8, 4, 1};
+
+static uint8_t sampleIndex(uint16_t x, uint16_t y, uint8_t bpp) {
+  return (x / 3 + y * 5) & ((1 << bpp) - 1);
+}
+
+static CRGB paletteColor(uint32_t index) {
+  return CRGB((uint8_t)(index * 97), (uint8_t)(index * 57), (uint8_t)(255 - index));
+}
+
+// Color del píxel (x, y), y desde arriba
+static CRGB sampleColor(uint16_t x, uint16_t y, uint8_t bpp) {
+  if (bpp <= 8) {
+    return paletteColor(sampleIndex(x, y, bpp));
+  }
+  return CRGB((uint8_t)(x * 7 + y), (uint8_t)(y * 5), (x / 4 + y / 3) % 2 ? 220 : (uint8_t)(x * 3));
+}
+
+// BMP de bpp bits con las filas de abajo arriba o, con topDown, de arriba abajo
+static std::vector<uint8_t> makeBMP(uint8_t bpp, bool topDown) {
+  std::vector<uint8_t> out;
+  uint32_t rowStride = putBMPHeader(out, WIDTH, HEIGHT, bpp);
+  if (topDown) {
+    int32_t height = -(int32_t)HEIGHT;
+    memcpy(&out[22], &height, 4);
+  }
+  for (uint32_t i = 0; bpp <= 8 && i < (1u << bpp); i++) {
+    CRGB color = paletteColor(i);
+    put32(out, (uint32_t)color.r << 16 | color.g << 8 | color.b);
+  }
+  for (uint16_t i = 0; i < HEIGHT; i++) {
+    uint16_t y = topDown ? i : HEIGHT - 1 - i;
+    std::vector<uint8_t> row(rowStride, 0);
+    for (uint16_t x = 0; x < WIDTH; x++) {
+      if (bpp == 24) {
+        CRGB color = sampleColor(x, y, bpp);
+        row[x * 3] = color.b;
+        row[x * 3 + 1] = color.g;
+        row[x * 3 + 2] = color.r;
+      } else {
+        uint32_t bit = (uint32_t)x * bpp;
+        row[bit / 8] |= sampleIndex(x, y, bpp) << (8 - bpp - bit % 8);
+      }
+    }
+    out.insert(out.end(), row.begin(), row.end());
+  }
+  return out;
+}
+
+static bool sameColor(const CRGB& a, const CRGB& b) {
+  return a.r == b.r && a.g == b.g && a.b == b.b;
+}
+
+static bool sameLayout(const ImageInfo& a, const ImageInfo& b) {
+  return a.width == b.width && a.height == b.height && a.format == b.format &&
+         a.dataOffset == b.dataOffset && a.rowStride == b.rowStride && a.topDown == b.topDown &&
+         a.pixelFormat == b.pixelFormat && a.bitsPerPixel == b.bitsPerPixel &&
+         a.paletteOffset == b.paletteOffset && a.paletteSize == b.paletteSize;
+}
+
+// Columnas con el ImageInfo del catálogo, con buffer entero y corto, frente a
+// getColumn(filename) y a los colores generados
+static bool checkColumns(ImageParser& parser, const char* path, const ImageInfo& info, uint8_t bpp) {
+  File file = LittleFS.open(path, "r");
+  CRGB cached[HEIGHT];
+  CRGB fresh[HEIGHT];
+  CRGB shorter[HEIGHT - 5];
+  bool ok = (bool)file;
+  for (uint16_t x = 0; ok && x < WIDTH; x++) {
+    ImageParser other;
+    ok = parser.getColumn(file, info, x, cached, HEIGHT) && other.getColumn(path, x, fresh, HEIGHT) &&
+         parser.getColumn(file, info, x, shorter, HEIGHT - 5);
+    for (uint16_t y = 0; ok && y < HEIGHT; y++) {
+      CRGB expected = sampleColor(x, y, bpp);
+      ok = sameColor(cached[y], expected) && sameColor(fresh[y], expected) &&
+           (y >= HEIGHT - 5 || sameColor(shorter[y], expected));
+    }
+  }
+  file.close();
+  return ok;
+}
+
+static bool checkRows(ImageParser& parser, const char* path, const ImageInfo& info, uint8_t bpp) {
+  File file = LittleFS.open(path, "r");
+  uint16_t batch = parser.getRowBatch(info);
+  std::vector<CRGB> rows((size_t)batch * WIDTH);
+  bool ok = (bool)file && parser.isRowMajor(info);
+  for (uint16_t first = 0; ok && first < HEIGHT; first += batch) {
+    uint16_t count = min(batch, (uint16_t)(HEIGHT - first));
+    ok = parser.getRows(file, info, first, count, rows.data());
+    for (uint16_t i = 0; ok && i < count; i++) {
+      for (uint16_t x = 0; ok && x < WIDTH; x++) {
+        ok = sameColor(rows[(size_t)i * WIDTH + x], sampleColor(x, first + i, bpp));
+      }
+    }
+  }
+  file.close();
+  return ok;
+}
+
+int main() {
+  Serial.quiet = true;
+  LittleFS.mkdir(IMAGES_DIR);
+
+  char name[32];
+  for (uint8_t bpp : BITS) {
+    for (int topDown = 0; topDown < 2; topDown++) {
+      std::vector<uint8_t> data = makeBMP(bpp, topDown);
+      snprintf(name, sizeof(name), IMAGES_DIR "/l%u%s.bmp", bpp, topDown ? "td" : "");
+      LittleFS.addFile(name, data.data(), data.size());
+    }
+  }
+
+  // El primero crea /images.cat; el segundo toma la disposición de ahí
+  imageManager.init();
+  ImageManager catalog;
+  catalog.init();
+
+  bool allOk = true;
+  char label[64];
+  ImageParser parser;
+  for (uint8_t bpp : BITS) {
+    for (int topDown = 0; topDown < 2; topDown++) {
+      snprintf(name, sizeof(name), "l%u%s.bmp", bpp, topDown ? "td" : "");
+      String path = String(IMAGES_DIR) + "/" + name;
+      ImageInfo cached;
+      ImageInfo fresh;
+      bool parsed = catalog.getImageInfo(name, cached) && parser.parseImageInfo(path.c_str(), fresh);
+      const char* order = topDown ? "arriba abajo" : "abajo arriba";
+
+      snprintf(label, sizeof(label), "BMP %u bits, %s: disposición del catálogo", bpp, order);
+      check(label, parsed && sameLayout(cached, fresh) && cached.topDown == (bool)topDown, allOk);
+      snprintf(label, sizeof(label), "BMP %u bits, %s: getColumn()", bpp, order);
+      check(label, parsed && checkColumns(parser, path.c_str(), cached, bpp), allOk);
+      snprintf(label, sizeof(label), "BMP %u bits, %s: getRows()", bpp, order);
+      check(label, parsed && checkRows(parser, path.c_str(), cached, bpp), allOk);
+    }
+  }
+
+  printf("\n%s\n", allOk ? "Todo correcto" : "ERRORES");
+  return allOk ? 0 : 1;
+}
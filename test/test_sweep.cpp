@@ -0,0 +1,177 @@
+/**
+ * @file test_sweep.cpp
+ * @brief Pruebas de host del estimador de barrido con trazas del acelerómetro
+ *
+ * Reproduce cada traza de test/traces/ (instante en us y aceleración X en
+ * m/s², lo que Accelerometer::update() pasa al estimador) por el
+ * SweepEstimator real (src/sweep_estimator.cpp), llamando a pollTurnaround()
+ * tras cada muestra como el loop(). Al final de la traza compara el medio
+ * barrido y las columnas/s de getColumnRate() con los de referencia de la
+ * cabecera, cuenta cuántas veces se engancha el periodo (una pausa larga lo
+ * suelta) y, en los vaivenes regulares, mide cuánto se desvía cada punto de
+ * giro avisado del real y si el sentido del nuevo barrido es el correcto.
+ *
+ * Compilar y ejecutar en el PC (desde la raíz del repositorio):
+ *   g++ -std=gnu++17 -O2 -Itest/host -Isrc test/test_sweep.cpp src/sweep_estimator.cpp \
+ *     -o test_sweep && ./test_sweep
+ *
+ * Sin argumentos usa las trazas de test/traces/ (generadas por
+ * test/make_traces.py); también acepta archivos .csv con el mismo formato.
+ */
+
+#include <cstdio>
+#include <vector>
+#include "bench_util.h"
+#include "sweep_estimator.h"
+
+static const char* DEFAULT_TRACES[] = {
+  "test/traces/rapido.csv", "test/traces/medio.csv", "test/traces/lento.csv",
+  "test/traces/mano.csv",   "test/traces/pausa.csv", "test/traces/quieto.csv",
+};
+
+struct Sample {
+  uint64_t timeUs;
+  float accel;
+};
+
+// Valores de referencia de la cabecera ("# esperado: ..." y "# tolerancia: ...")
+struct Trace {
+  std::vector<Sample> samples;
+  uint32_t halfUs = 0;
+  uint32_t rate = 0;
+  float pitchMm = 0;
+  uint32_t locks = 0;
+  uint64_t turnUs = 0;     // Primer punto de giro real (0: no se comprueba)
+  float halfTolerance = 0;  // Fracción
+  float rateTolerance = 0;
+};
+
+static bool loadTrace(const char* path, Trace& trace) {
+  FILE* file = fopen(path, "r");
+  if (file == nullptr) {
+    return false;
+  }
+  char line[256];
+  while (fgets(line, sizeof(line), file) != nullptr) {
+    unsigned long long timeUs;
+    float accel;
+    unsigned halfTolerance;
+    unsigned rateTolerance;
+    if (line[0] == '#') {
+      unsigned long long turnUs;
+      float speed;
+      if (sscanf(line, "# esperado: half_us=%u speed_mm_s=%f rate=%u locks=%u turn_us=%llu pitch_mm=%f",
+                 &trace.halfUs, &speed, &trace.rate, &trace.locks, &turnUs, &trace.pitchMm) == 6) {
+        trace.turnUs = turnUs;
+      } else if (sscanf(line, "# tolerancia: half=%u%% rate=%u%%", &halfTolerance, &rateTolerance) == 2) {
+        trace.halfTolerance = halfTolerance / 100.0f;
+        trace.rateTolerance = rateTolerance / 100.0f;
+      }
+    } else if (sscanf(line, "%llu,%f", &timeUs, &accel) == 2) {
+      trace.samples.push_back({timeUs, accel});
+    }
+  }
+  fclose(file);
+  return !trace.samples.empty() && trace.pitchMm > 0;
+}
+
+static float relativeError(float value, float expected) {
+  return expected != 0 ? fabsf(value - expected) / expected : value;
+}
+
+static const char* baseName(const char* path) {
+  const char* slash = strrchr(path, '/');
+  return slash != nullptr ? slash + 1 : path;
+}
+
+int main(int argc, char** argv) {
+  std::vector<const char*> paths;
+  for (int i = 1; i < argc; i++) {
+    paths.push_back(argv[i]);
+  }
+  if (paths.empty()) {
+    paths.assign(DEFAULT_TRACES, DEFAULT_TRACES + sizeof(DEFAULT_TRACES) / sizeof(DEFAULT_TRACES[0]));
+  }
+
+  printf("%-12s %8s %10s %10s %7s %7s %8s %6s %11s %11s\n", "Traza", "Muestras", "Medio (ms)", "Ref (ms)",
+         "Col/s", "Ref", "Enganches", "Giros", "Giro medio", "Giro máx");
+
+  bool allOk = true;
+  for (const char* path : paths) {
+    Trace trace;
+    if (!loadTrace(path, trace)) {
+      printf("%-12s no se pudo leer\n", baseName(path));
+      allOk = false;
+      continue;
+    }
+
+    SweepEstimator sweep;
+    bool wasLocked = false;
+    uint32_t locks = 0;
+    uint32_t turns = 0;
+    uint32_t wrongDirection = 0;
+    double turnErrorSum = 0;
+    double turnErrorMax = 0;
+    for (const Sample& sample : trace.samples) {
+      sweep.addSample(sample.timeUs, sample.accel);
+      if (sweep.isLocked() && !wasLocked) {
+        locks++;
+      }
+      wasLocked = sweep.isLocked();
+
+      int8_t direction = sweep.pollTurnaround(sample.timeUs);
+      if (direction == 0) {
+        continue;
+      }
+      turns++;
+      if (trace.turnUs == 0) {
+        continue;
+      }
+      // Giro real más cercano: turnUs + k medios barridos. En los pares el
+      // badge está en +A y vuelve hacia atrás
+      int64_t sinceFirst = (int64_t)(sample.timeUs - trace.turnUs);
+      int64_t k = (sinceFirst + trace.halfUs / 2) / trace.halfUs;
+      double error = fabs((double)(sinceFirst - k * (int64_t)trace.halfUs)) / 1000.0;
+      turnErrorSum += error;
+      turnErrorMax = max(turnErrorMax, error);
+      if (direction != (k % 2 == 0 ? -1 : 1)) {
+        wrongDirection++;
+      }
+    }
+
+    uint16_t rate = sweep.getColumnRate(trace.pitchMm);
+    double turnErrorMean = turns > 0 ? turnErrorSum / turns : 0;
+    const char* name = baseName(path);
+    printf("%-12s %8zu %10.1f %10.1f %7u %7u %8u %6u", name, trace.samples.size(),
+           sweep.getHalfPeriodUs() / 1000.0, trace.halfUs / 1000.0, rate, trace.rate, locks, turns);
+    if (trace.turnUs != 0) {
+      printf(" %8.1f ms %8.1f ms\n", turnErrorMean, turnErrorMax);
+    } else {
+      printf(" %11s %11s\n", "-", "-");
+    }
+
+    char label[96];
+    if (trace.halfUs == 0) {
+      snprintf(label, sizeof(label), "%s: sin periodo, sin giros, 0 columnas/s", name);
+      check(label, locks == 0 && turns == 0 && rate == 0, allOk);
+      continue;
+    }
+    snprintf(label, sizeof(label), "%s: medio barrido dentro del %.0f%%", name, trace.halfTolerance * 100);
+    check(label, sweep.isLocked() &&
+                 relativeError(sweep.getHalfPeriodUs(), trace.halfUs) <= trace.halfTolerance, allOk);
+    snprintf(label, sizeof(label), "%s: columnas/s dentro del %.0f%%", name, trace.rateTolerance * 100);
+    check(label, relativeError(rate, trace.rate) <= trace.rateTolerance, allOk);
+    snprintf(label, sizeof(label), "%s: se engancha %u %s", name, trace.locks, trace.locks == 1 ? "vez" : "veces");
+    check(label, locks == trace.locks, allOk);
+    if (trace.turnUs != 0) {
+      // El aviso llega con la primera muestra tras el giro previsto (10-12 ms
+      // después); en barridos lentos manda el error del periodo
+      double turnLimit = max(12.0, trace.halfUs * 0.05 / 1000.0);
+      snprintf(label, sizeof(label), "%s: giro medio a menos de %.0f ms, sentido bien", name, turnLimit);
+      check(label, turns > 0 && turnErrorMean < turnLimit && wrongDirection == 0, allOk);
+    }
+  }
+
+  printf("\n%s\n", allOk ? "Todo correcto" : "ERRORES");
+  return allOk ? 0 : 1;
+}
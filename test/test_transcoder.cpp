@@ -0,0 +1,174 @@
+/**
+ * @file test_transcoder.cpp
+ * @brief Pruebas de host de la conversión a .pov durante la subida
+ *
+ * Sube BMP de 24 bits (de abajo arriba y de arriba abajo, con relleno de
+ * fila), BMP de paleta de 8, 4 y 1 bits y RGB565 por el ImageTranscoder real,
+ * en el LittleFS en memoria de test/host/, en trozos de 1 byte, de 13 bytes
+ * (cortan el header y las filas por cualquier sitio) y de un segmento TCP.
+ * Comprueba que la salida es un .pov del mismo tamaño que ImageParser decodifica,
+ * columna a columna, con los mismos píxeles que el archivo de origen leído por
+ * el propio ImageParser (y, en 24 bits, que los colores con que se generó), y
+ * que getOutputHash() es el contentHash() del archivo escrito.
+ *
+ * Compilar y ejecutar en el PC:
+ *   g++ -std=gnu++17 -O2 -Itest/host -Isrc test/test_transcoder.cpp src/image_manager.cpp \
+ *     src/image_parser.cpp src/image_scaler.cpp src/image_transcoder.cpp src/png_decoder.cpp \
+ *     src/inflater.cpp -o test_transcoder && ./test_transcoder
+ */
+
+#include "bench_util.h"
+#include "image_manager.h"
+#include "image_transcoder.h"
+
+static const size_t CHUNKS[] = {1, 13, 1460};
+
+static CRGB sampleColor(uint16_t x, uint16_t y) {
+  return CRGB((uint8_t)(x * 7 + y), (uint8_t)(y * 5), (x / 4 + y / 3) % 2 ? 220 : (uint8_t)(x * 3));
+}
+
+static uint8_t sampleIndex(uint16_t x, uint16_t y, uint8_t bpp) {
+  return (x / 3 + y * 5) & ((1 << bpp) - 1);
+}
+
+// BMP de 24 bits guardado de arriba abajo (alto negativo en la cabecera)
+static std::vector<uint8_t> makeTopDownBMP(uint16_t width, uint16_t height) {
+  std::vector<uint8_t> out;
+  uint32_t rowStride = putBMPHeader(out, width, height);
+  int32_t topDown = -(int32_t)height;
+  memcpy(&out[22], &topDown, 4);
+  for (uint16_t y = 0; y < height; y++) {
+    for (uint16_t x = 0; x < width; x++) {
+      CRGB color = sampleColor(x, y);
+      out.push_back(color.b);
+      out.push_back(color.g);
+      out.push_back(color.r);
+    }
+    out.resize(out.size() + rowStride - (uint32_t)width * 3, 0);
+  }
+  return out;
+}
+
+// BMP de paleta de abajo arriba; la paleta no tiene dos colores iguales
+static std::vector<uint8_t> makePaletteBMP(uint16_t width, uint16_t height, uint8_t bpp) {
+  std::vector<uint8_t> out;
+  uint32_t rowStride = putBMPHeader(out, width, height, bpp);
+  for (uint32_t i = 0; i < (1u << bpp); i++) {
+    put32(out, (i * 97 & 0xFF) << 16 | (i * 57 & 0xFF) << 8 | (255 - i));
+  }
+  for (int32_t y = height - 1; y >= 0; y--) {
+    std::vector<uint8_t> row(rowStride, 0);
+    for (uint16_t x = 0; x < width; x++) {
+      uint32_t bit = (uint32_t)x * bpp;
+      row[bit / 8] |= sampleIndex(x, y, bpp) << (8 - bpp - bit % 8);
+    }
+    out.insert(out.end(), row.begin(), row.end());
+  }
+  return out;
+}
+
+// Todas las columnas de path, de izquierda a derecha; vacío si no se lee
+static std::vector<CRGB> readColumns(const char* path, ImageInfo& info) {
+  ImageParser parser;
+  std::vector<CRGB> pixels;
+  if (!parser.parseImageInfo(path, info)) {
+    return pixels;
+  }
+  File file = LittleFS.open(path, "r");
+  pixels.resize((size_t)info.width * info.height);
+  for (uint16_t x = 0; x < info.width; x++) {
+    if (!parser.getColumn(file, info, x, &pixels[(size_t)x * info.height], info.height)) {
+      pixels.clear();
+      break;
+    }
+  }
+  file.close();
+  return pixels;
+}
+
+static bool samePixels(const std::vector<CRGB>& a, const std::vector<CRGB>& b) {
+  if (a.size() != b.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < a.size(); i++) {
+    if (a[i].r != b[i].r || a[i].g != b[i].g || a[i].b != b[i].b) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Como WebServer: begin(), write() por trozos y finish() en update()
+static bool upload(const char* name, const std::vector<uint8_t>& data, size_t chunk) {
+  if (!imageTranscoder.begin(name)) {
+    return false;
+  }
+  for (size_t i = 0; i < data.size(); i += chunk) {
+    imageTranscoder.write(data.data() + i, min(chunk, data.size() - i));
+  }
+  return imageTranscoder.finish();
+}
+
+int main() {
+  Serial.quiet = true;
+  LittleFS.mkdir(IMAGES_DIR);
+  imageManager.init();
+
+  struct Case {
+    const char* label;
+    const char* name;
+    std::vector<uint8_t> data;
+    bool generated;  // 24 bits: se compara también con sampleColor()
+  };
+  const uint16_t width = 37;  // 111 bytes por fila: 1 de relleno
+  const uint16_t height = 21;
+  Case cases[] = {
+    {"BMP 24 bits", "t24.bmp", makeBMPFromColors(width, height, sampleColor), true},
+    {"BMP 24 bits top-down", "t24td.bmp", makeTopDownBMP(width, height), true},
+    {"BMP 8 bits", "t8.bmp", makePaletteBMP(width, height, 8), false},
+    {"BMP 4 bits", "t4.bmp", makePaletteBMP(width, height, 4), false},
+    {"BMP 1 bit", "t1.bmp", makePaletteBMP(width, height, 1), false},
+    {"RGB565", "t565.rgb", makeRGB565(width, height, [](uint16_t x, uint16_t y) {
+       CRGB c = sampleColor(x, y);
+       return (uint16_t)(((c.r >> 3) << 11) | ((c.g >> 2) << 5) | (c.b >> 3));
+     }), false},
+  };
+
+  std::vector<CRGB> generated((size_t)width * height);
+  for (uint16_t x = 0; x < width; x++) {
+    for (uint16_t y = 0; y < height; y++) {
+      generated[(size_t)x * height + y] = sampleColor(x, y);
+    }
+  }
+
+  bool allOk = true;
+  char label[64];
+  for (Case& c : cases) {
+    // Referencia: el archivo de origen leído tal cual
+    String source = String("/origen_") + c.name;
+    LittleFS.addFile(source.c_str(), c.data.data(), c.data.size());
+    ImageInfo sourceInfo;
+    std::vector<CRGB> expected = readColumns(source.c_str(), sourceInfo);
+    LittleFS.removeFile(source.c_str());
+    snprintf(label, sizeof(label), "%s: el origen se lee", c.label);
+    check(label, !expected.empty() && (!c.generated || samePixels(expected, generated)), allOk);
+
+    for (size_t chunk : CHUNKS) {
+      bool uploaded = upload(c.name, c.data, chunk);
+      String path = String(IMAGES_DIR) + "/" + imageTranscoder.getOutputName();
+      ImageInfo info;
+      std::vector<CRGB> pixels = uploaded ? readColumns(path.c_str(), info) : std::vector<CRGB>();
+      std::vector<uint8_t> written = readAll(path);
+
+      snprintf(label, sizeof(label), "%s, trozos de %u B: mismos píxeles", c.label, (unsigned)chunk);
+      check(label, uploaded && path.endsWith(".pov") && info.format == 2 && info.width == width &&
+                   info.height == height && samePixels(pixels, expected), allOk);
+      snprintf(label, sizeof(label), "%s, trozos de %u B: hash", c.label, (unsigned)chunk);
+      check(label, imageTranscoder.getOutputHash() == contentHash(written.data(), written.size()), allOk);
+      LittleFS.remove(path);
+    }
+  }
+
+  printf("\n%s\n", allOk ? "Todo correcto" : "ERRORES");
+  return allOk ? 0 : 1;
+}